@@ -46,6 +46,21 @@ enum class DispatchReentrancy
                      */
 };
 
+/**
+ * \brief Which threads may call a MultiplexingDispatchable's dispatch()
+ */
+enum class DispatchThreading
+{
+    concurrent,     /**< dispatch() may be called on multiple threads simultaneously.
+                     *   Each call dispatches a single ready source.
+                     */
+    single          /**< dispatch() is only called on one thread at a time. Each call
+                     *   dispatches all the sources a single epoll_wait() finds ready
+                     *   (up to a limit), and sequential sources need not be re-armed
+                     *   after each dispatch.
+                     */
+};
+
 /**
  * \brief An adaptor that combines multiple Dispatchables into a single Dispatchable
  * \note Instances are fully thread-safe.
@@ -54,6 +69,7 @@ class MultiplexingDispatchable final : public Dispatchable
 {
 public:
     MultiplexingDispatchable();
+    explicit MultiplexingDispatchable(DispatchThreading threading);
     MultiplexingDispatchable(std::initializer_list<std::shared_ptr<Dispatchable>> dispatchees);
     virtual ~MultiplexingDispatchable() noexcept;
 
@@ -95,8 +111,14 @@ public:
      */
     void remove_watch(Fd const& fd);
 private:
+    struct Watch;
+
+    auto dispatch_one() -> bool;
+    auto dispatch_batch() -> bool;
+
+    DispatchThreading const threading;
     PosixRWMutex lifetime_mutex;
-    std::list<std::pair<std::shared_ptr<Dispatchable>, bool>> dispatchee_holder;
+    std::list<std::shared_ptr<Watch>> dispatchee_holder;
 
     Fd epoll_fd;
 };
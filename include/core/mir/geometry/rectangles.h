@@ -41,6 +41,9 @@ public:
     void add(Rectangle const& rect);
     /// removes at most one matching rectangle
     void remove(Rectangle const& rect);
+    /// removes the area of \p hole, splitting any rectangle it partly covers
+    /// into the (non-overlapping) parts above, below, left and right of it
+    void subtract(Rectangle const& hole);
     void clear();
     Rectangle bounding_rectangle() const;
     void confine(Point& point) const;
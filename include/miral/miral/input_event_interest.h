@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIRAL_INPUT_EVENT_INTEREST_H
+#define MIRAL_INPUT_EVENT_INTEREST_H
+
+struct MirKeyboardEvent;
+struct MirTouchEvent;
+struct MirPointerEvent;
+
+namespace miral
+{
+/**
+ * An optional addition to WindowManagementPolicy for policies that only act on
+ * some input.
+ *
+ * If the policy also inherits from InputEventInterest it is asked about each
+ * input event before the window management lock is taken. Events it is not
+ * interested in bypass the window manager (and its lock) and go directly to
+ * the clients.
+ *
+ * \note The predicates are called without the window management lock, and may
+ * run concurrently with any other policy method. They should only consult
+ * the event and state that is safe to read without the lock.
+ * \remark Since MirAL 3.3
+ */
+class InputEventInterest
+{
+public:
+    /// \return true if the policy's handle_keyboard_event() should see \p event
+    virtual auto wants_keyboard_event(MirKeyboardEvent const* event) const -> bool = 0;
+
+    /// \return true if the policy's handle_touch_event() should see \p event
+    virtual auto wants_touch_event(MirTouchEvent const* event) const -> bool = 0;
+
+    /// \return true if the policy's handle_pointer_event() should see \p event
+    virtual auto wants_pointer_event(MirPointerEvent const* event) const -> bool = 0;
+
+    virtual ~InputEventInterest();
+    InputEventInterest() = default;
+    InputEventInterest(InputEventInterest const&) = delete;
+    InputEventInterest& operator=(InputEventInterest const&) = delete;
+};
+}
+
+#endif //MIRAL_INPUT_EVENT_INTEREST_H
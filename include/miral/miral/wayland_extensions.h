@@ -120,6 +120,12 @@ public:
     /// Could allow a client to extract information about other programs the user is running
     /// \remark Since MirAL 3.1
     static char const* const zwlr_foreign_toplevel_manager_v1;
+
+    /// Allows a client to capture the content of outputs, for screenshots and screen recording
+    /// Could allow a client to see what other programs are showing, so it is recommended to use
+    /// this in conjunction with set_filter()
+    /// \remark Since MirAL 3.3
+    static char const* const zwlr_screencopy_manager_v1;
     /** @} */
 
     /// Add a bespoke Wayland extension both to "supported" and "enabled by default".
@@ -68,6 +68,24 @@ public:
     **/
     virtual bool overlay(RenderableList const& renderlist) = 0;
 
+    /** Like overlay(), for hardware that can overlay some renderables but
+     *  not others. What can be overlaid from the top of renderlist is, and
+     *  the rest is left to the caller to composite beneath it.
+     *  \param [in,out] renderlist
+     *      The renderables that should appear on the screen. On return,
+     *      those (from the bottom of the list) the caller should composite.
+     *  \returns
+     *      True if the hardware has fully composited/overlaid the list;
+     *      False if the caller should render what's left in renderlist
+     *      using a graphics library such as OpenGL.
+     *
+     *  The default overlays all of renderlist or none of it, with overlay().
+    **/
+    virtual bool overlay_top(RenderableList& renderlist)
+    {
+        return overlay(renderlist);
+    }
+
     /**
      * Returns a transformation that the renderer must apply to all rendering.
      * There is usually no transformation required (just the identity matrix)
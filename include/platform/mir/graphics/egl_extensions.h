@@ -317,6 +317,17 @@ struct EGLExtensions
         PFNEGLQUERYDMABUFFORMATSEXTPROC const eglQueryDmaBufFormatsExt;
         PFNEGLQUERYDMABUFMODIFIERSEXTPROC const eglQueryDmaBufModifiersExt;
     };
+
+    /// EGL_ANDROID_native_fence_sync, with the EGL_KHR_wait_sync needed to wait on the GPU
+    struct ANDROIDNativeFenceSync
+    {
+        ANDROIDNativeFenceSync(EGLDisplay dpy);
+
+        PFNEGLCREATESYNCKHRPROC const eglCreateSyncKHR;
+        PFNEGLDESTROYSYNCKHRPROC const eglDestroySyncKHR;
+        PFNEGLWAITSYNCKHRPROC const eglWaitSyncKHR;
+        PFNEGLDUPNATIVEFENCEFDANDROIDPROC const eglDupNativeFenceFDANDROID;
+    };
 };
 
 }
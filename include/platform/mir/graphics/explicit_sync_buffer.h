@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_EXPLICIT_SYNC_BUFFER_H_
+#define MIR_GRAPHICS_EXPLICIT_SYNC_BUFFER_H_
+
+#include "mir/fd.h"
+
+#include <functional>
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * A buffer whose producer and Mir synchronise access through sync_file fences,
+ * rather than relying on the kernel's implicit synchronisation
+ *
+ * Found through dynamic_cast of the buffer's native_buffer_base().
+ */
+class ExplicitSyncBuffer
+{
+public:
+    virtual ~ExplicitSyncBuffer() = default;
+
+    /**
+     * Nothing reads the buffer's content until \a fence is signalled
+     *
+     * The renderer queues the wait on the GPU rather than blocking on it.
+     */
+    virtual void set_acquire_fence(mir::Fd fence) = 0;
+
+    /**
+     * Whether the buffer can be read without waiting (on the CPU) for its acquire fence
+     */
+    virtual auto acquire_fence_signalled() const -> bool = 0;
+
+    /**
+     * When Mir is done with the buffer, \a on_release is called with a fence that
+     * is signalled once outstanding reads have finished
+     *
+     * The fence is an invalid Fd if nothing is outstanding. \a on_release is called
+     * from whichever thread drops the buffer.
+     */
+    virtual void set_release_fence_handler(std::function<void(mir::Fd)> on_release) = 0;
+};
+}
+}
+
+#endif //MIR_GRAPHICS_EXPLICIT_SYNC_BUFFER_H_
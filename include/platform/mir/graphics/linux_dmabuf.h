@@ -66,6 +66,8 @@ private:
 
     EGLDisplay const dpy;
     std::shared_ptr<EGLExtensions> const egl_extensions;
+    /// Null if the driver can't import and export fences
+    std::shared_ptr<EGLExtensions::ANDROIDNativeFenceSync const> const fence_sync;
     std::shared_ptr<DmaBufFormatDescriptors> const formats;
 };
 
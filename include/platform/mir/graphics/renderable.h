@@ -21,6 +21,7 @@
 
 #include <experimental/optional>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangle_f.h>
 #include <glm/glm.hpp>
 #include <memory>
 #include <vector>
@@ -71,6 +72,22 @@ public:
     virtual glm::mat4 transformation() const = 0;
 
     virtual bool shaped() const = 0;  // meaning the pixel format has alpha
+
+    /**
+     * The part of buffer() to draw, in buffer pixels. It is scaled to fill
+     * screen_position(). When unset the whole buffer is drawn.
+     */
+    virtual std::experimental::optional<geometry::RectangleF> src_bounds() const
+    { return {}; }
+
+    /**
+     * The parts of screen_position() the client has declared fully opaque,
+     * in screen coordinates. Even if shaped(), these may be drawn without
+     * blending and hide anything beneath them (when alpha() is 1). Empty
+     * when nothing is known to be opaque.
+     */
+    virtual std::vector<geometry::Rectangle> opaque_region() const
+    { return {}; }
 protected:
     Renderable() = default;
     Renderable(Renderable const&) = delete;
@@ -31,6 +31,7 @@ extern char const* const arw_server_socket_opt;
 extern char const* const enable_input_opt;
 extern char const* const shared_library_prober_report_opt;
 extern char const* const shell_report_opt;
+extern char const* const client_resource_report_opt;
 extern char const* const compositor_report_opt;
 extern char const* const display_report_opt;
 extern char const* const legacy_input_report_opt;
@@ -42,7 +43,10 @@ extern char const* const cursor_opt;
 extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
+extern char const* const gl_batched_draws_opt;
 extern char const* const enable_key_repeat_opt;
+extern char const* const max_hidden_commit_rate_opt;
+extern char const* const max_client_buffers_opt;
 extern char const* const x11_display_opt;
 extern char const* const x11_scale_opt;
 extern char const* const wayland_extensions_opt;
@@ -59,6 +63,7 @@ extern char const* const platform_display_libs;
 extern char const* const platform_rendering_libs;
 extern char const* const platform_input_lib;
 extern char const* const platform_path;
+extern char const* const platform_probe_cache_opt;
 
 extern char const* const console_provider;
 extern char const* const logind_console;
@@ -24,6 +24,8 @@
 #include "mir_toolkit/common.h"
 #include <glm/glm.hpp>
 
+#include <vector>
+
 namespace mir
 {
 namespace renderer
@@ -39,6 +41,24 @@ public:
     virtual void render(graphics::RenderableList const&) const = 0;
     virtual void suspend() = 0; // called when render() is skipped
 
+    /// A copy of part of a rendered frame
+    struct Readback
+    {
+        geometry::Rectangle area;           ///< In scene coordinates, within the viewport
+        geometry::Size size;                ///< In pixels
+        std::vector<unsigned char> pixels;  ///< 32 bit XRGB little endian, top row first, no padding
+        bool read = false;                  ///< Set if pixels were read
+    };
+
+    /// Render, then read \p readbacks from the frame before it is presented.
+    /// Renderers that can't read back frames just render.
+    virtual void render_and_read_back(
+        graphics::RenderableList const& renderables,
+        std::vector<Readback>& /*readbacks*/) const
+    {
+        render(renderables);
+    }
+
 protected:
     Renderer() = default;
     Renderer(const Renderer&) = delete;
@@ -102,6 +102,7 @@ public:
     MOCK_METHOD2(glUniform1f, void(GLint, GLfloat));
     MOCK_METHOD3(glUniform2f, void(GLint, GLfloat, GLfloat));
     MOCK_METHOD2(glUniform1i, void(GLint, GLint));
+    MOCK_METHOD3(glUniform4fv, void(GLint, GLsizei, const GLfloat*));
     MOCK_METHOD4(glUniformMatrix4fv,
                  void(GLuint, GLsizei, GLboolean, const GLfloat *));
     MOCK_METHOD1(glUseProgram, void(GLuint));
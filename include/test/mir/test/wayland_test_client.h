@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_TEST_WAYLAND_TEST_CLIENT_H_
+#define MIR_TEST_WAYLAND_TEST_CLIENT_H_
+
+#include "mir/fd.h"
+#include "mir/geometry/size.h"
+
+#include <wayland-client.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace mir
+{
+namespace test
+{
+/**
+ * A Wayland client for driving an in-process server over the protocol.
+ *
+ * The client has no thread of its own: requests are only sent, and events only
+ * received, by roundtrip() (or by a test dispatching \ref display itself).
+ */
+class WaylandTestClient
+{
+public:
+    explicit WaylandTestClient(mir::Fd const& socket);
+    ~WaylandTestClient();
+
+    /// Sends pending requests and waits for the server to have handled them
+    void roundtrip();
+
+    /// The global of \p interface (or null if the server doesn't advertise it)
+    auto bind(wl_interface const& interface, uint32_t version) -> void*;
+
+    /// The error the server raised, if any
+    /// \returns the code, or -1 if there has been no protocol error
+    auto protocol_error() const -> int;
+    auto protocol_error_interface() const -> std::string;
+
+    /// An shm buffer of the given size, which notes when it is released
+    class Buffer
+    {
+    public:
+        Buffer(wl_shm* shm, geometry::Size size);
+        ~Buffer();
+
+        wl_buffer* const buffer;
+        bool released{false};
+        /// Called (as well as released being set) each time the server releases the buffer
+        std::function<void()> on_release;
+
+    private:
+        Buffer(Buffer const&) = delete;
+        Buffer& operator=(Buffer const&) = delete;
+
+        static wl_buffer_listener const listener;
+    };
+
+    /// A wl_shell toplevel (or fullscreen) surface, mapped with a buffer of \p size
+    class Window
+    {
+    public:
+        enum class State { toplevel, fullscreen };
+
+        Window(WaylandTestClient& client, geometry::Size size, State state = State::toplevel);
+        ~Window();
+
+        wl_surface* const surface;
+        wl_shell_surface* const shell_surface;
+        Buffer buffer;
+
+    private:
+        Window(Window const&) = delete;
+        Window& operator=(Window const&) = delete;
+
+        static wl_shell_surface_listener const listener;
+    };
+
+    /// A (synchronized) subsurface of \p parent, with a buffer of \p size attached and committed
+    class Subsurface
+    {
+    public:
+        Subsurface(WaylandTestClient& client, wl_surface* parent, geometry::Size size);
+        ~Subsurface();
+
+        wl_surface* const surface;
+        wl_subsurface* const subsurface;
+        Buffer buffer;
+
+    private:
+        Subsurface(Subsurface const&) = delete;
+        Subsurface& operator=(Subsurface const&) = delete;
+    };
+
+    wl_display* const display;
+    wl_compositor* compositor{nullptr};
+    wl_subcompositor* subcompositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shell* shell{nullptr};
+
+private:
+    WaylandTestClient(WaylandTestClient const&) = delete;
+    WaylandTestClient& operator=(WaylandTestClient const&) = delete;
+
+    static void handle_global(void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t);
+    static void handle_global_remove(void*, wl_registry*, uint32_t) {}
+    static wl_registry_listener const registry_listener;
+
+    wl_registry* const registry;
+    std::map<std::string, uint32_t> globals;
+};
+}
+}
+
+#endif /* MIR_TEST_WAYLAND_TEST_CLIENT_H_ */
@@ -22,6 +22,7 @@
 #include "mir/posix_rw_mutex.h"
 
 #include <boost/throw_exception.hpp>
+#include <atomic>
 #include <shared_mutex>
 
 #include <sys/epoll.h>
@@ -71,8 +72,27 @@ private:
 
 }
 
+struct md::MultiplexingDispatchable::Watch : std::enable_shared_from_this<Watch>
+{
+    Watch(std::shared_ptr<Dispatchable> const& dispatchee, bool rearm)
+        : dispatchee{dispatchee},
+          rearm{rearm}
+    {
+    }
+
+    std::shared_ptr<Dispatchable> const dispatchee;
+    bool const rearm;                   ///< Registered EPOLLONESHOT, so must be re-armed after dispatch
+    std::atomic<bool> removed{false};   ///< Set under lifetime_mutex, before the watch is dropped
+};
+
 md::MultiplexingDispatchable::MultiplexingDispatchable()
-    : lifetime_mutex{PosixRWMutex::Type::PreferWriterNonRecursive},
+    : MultiplexingDispatchable(DispatchThreading::concurrent)
+{
+}
+
+md::MultiplexingDispatchable::MultiplexingDispatchable(DispatchThreading threading)
+    : threading{threading},
+      lifetime_mutex{PosixRWMutex::Type::PreferWriterNonRecursive},
       epoll_fd{mir::Fd{::epoll_create1(EPOLL_CLOEXEC)}}
 {
     if (epoll_fd == mir::Fd::invalid)
@@ -108,8 +128,12 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
         return false;
     }
 
-    std::shared_ptr<md::Dispatchable> source;
-    bool rearm_source{false};
+    return threading == DispatchThreading::single ? dispatch_batch() : dispatch_one();
+}
+
+auto md::MultiplexingDispatchable::dispatch_one() -> bool
+{
+    std::shared_ptr<Watch> watch;
     epoll_event event;
 
     {
@@ -131,17 +155,15 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
             return true;
         }
 
-        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event.data.ptr);
-
-        source = event_source->first;
-        rearm_source = event_source->second;
+        watch = static_cast<Watch*>(event.data.ptr)->shared_from_this();
     }
 
+    auto const& source = watch->dispatchee;
     if (!source->dispatch(epoll_to_fd_event(event)))
     {
         remove_watch(source);
     }
-    else if (rearm_source)
+    else if (watch->rearm)
     {
         event.events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
         epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &event);
@@ -150,6 +172,57 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
     return true;
 }
 
+auto md::MultiplexingDispatchable::dispatch_batch() -> bool
+{
+    int constexpr max_batch = 16;
+
+    epoll_event events[max_batch];
+    std::shared_ptr<Watch> watches[max_batch];
+    int ready;
+
+    {
+        std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+
+        ready = epoll_wait(epoll_fd, events, max_batch, 0);
+
+        if (ready < 0)
+        {
+            BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                     std::system_category(),
+                                                     "Failed to wait on fds"}));
+        }
+
+        for (auto i = 0; i != ready; ++i)
+        {
+            watches[i] = static_cast<Watch*>(events[i].data.ptr)->shared_from_this();
+        }
+    }
+
+    for (auto i = 0; i != ready; ++i)
+    {
+        auto const& watch = watches[i];
+
+        // An earlier dispatch in this batch may have removed this watch
+        if (watch->removed)
+        {
+            continue;
+        }
+
+        auto const& source = watch->dispatchee;
+        if (!source->dispatch(epoll_to_fd_event(events[i])))
+        {
+            remove_watch(source);
+        }
+        else if (watch->rearm)
+        {
+            events[i].events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &events[i]);
+        }
+    }
+
+    return true;
+}
+
 md::FdEvents md::MultiplexingDispatchable::relevant_events() const
 {
     return md::FdEvent::readable;
@@ -163,23 +236,27 @@ void md::MultiplexingDispatchable::add_watch(std::shared_ptr<md::Dispatchable> c
 void md::MultiplexingDispatchable::add_watch(std::shared_ptr<md::Dispatchable> const& dispatchee,
                                              DispatchReentrancy reentrancy)
 {
+    // When dispatch() is only called on one thread nothing can dispatch a sequential
+    // source while it is already being dispatched, so it needn't be EPOLLONESHOT
+    bool const oneshot =
+        reentrancy == DispatchReentrancy::sequential && threading == DispatchThreading::concurrent;
+
     decltype(dispatchee_holder)::iterator new_holder;
     {
         std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
         new_holder = dispatchee_holder.emplace(dispatchee_holder.begin(),
-                                               dispatchee,
-                                               reentrancy == DispatchReentrancy::sequential);
+                                               std::make_shared<Watch>(dispatchee, oneshot));
     }
 
     epoll_event e;
     ::memset(&e, 0, sizeof(e));
 
     e.events = fd_event_to_epoll(dispatchee->relevant_events());
-    if (reentrancy == DispatchReentrancy::sequential)
+    if (oneshot)
     {
         e.events |= EPOLLONESHOT;
     }
-    e.data.ptr = static_cast<void*>(&(*new_holder));
+    e.data.ptr = static_cast<void*>(new_holder->get());
     if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, dispatchee->watch_fd(), &e) < 0)
     {
         std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
@@ -223,8 +300,13 @@ void md::MultiplexingDispatchable::remove_watch(Fd const& fd)
     }
 
     std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
-    dispatchee_holder.remove_if([&fd](std::pair<std::shared_ptr<Dispatchable>,bool> const& candidate)
+    dispatchee_holder.remove_if([&fd](std::shared_ptr<Watch> const& candidate)
     {
-        return candidate.first->watch_fd() == fd;
+        if (candidate->dispatchee->watch_fd() != fd)
+        {
+            return false;
+        }
+        candidate->removed = true;
+        return true;
     });
 }
@@ -0,0 +1,362 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+#include "mir/thread_name.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <pthread.h>
+
+namespace ml = mir::logging;
+
+namespace
+{
+/// How long a run of repeated messages goes unreported
+auto const repeat_summary_interval = std::chrono::seconds{1};
+
+auto realtime_now() -> timespec
+{
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now;
+}
+
+auto time_between(timespec const& earlier, timespec const& later) -> std::chrono::nanoseconds
+{
+    return std::chrono::seconds{later.tv_sec - earlier.tv_sec} +
+           std::chrono::nanoseconds{later.tv_nsec - earlier.tv_nsec};
+}
+
+std::atomic<unsigned long> next_serial{0};
+
+/// Set in the child of a fork(): only the thread that forked is copied, so there's no writer thread,
+/// and the logger's mutexes may have been held by threads that no longer exist
+std::atomic<bool> in_forked_child{false};
+std::once_flag atfork_registered;
+}
+
+/// A single-producer, single-consumer queue of entries
+///
+/// The producer is the thread the ring belongs to; the consumer is whichever
+/// thread holds the logger's write_mutex.
+class ml::AsyncLogger::Ring
+{
+public:
+    explicit Ring(std::size_t capacity) :
+        slots(capacity)
+    {
+    }
+
+    void push(LogEntry&& entry)
+    {
+        auto const tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - head.load(std::memory_order_acquire) == slots.size())
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        slots[tail % slots.size()] = std::move(entry);
+        this->tail.store(tail + 1, std::memory_order_release);
+    }
+
+    void pop_into(std::vector<LogEntry>& batch)
+    {
+        auto head = this->head.load(std::memory_order_relaxed);
+        auto const tail = this->tail.load(std::memory_order_acquire);
+
+        for (; head != tail; ++head)
+            batch.push_back(std::move(slots[head % slots.size()]));
+
+        this->head.store(head, std::memory_order_release);
+    }
+
+    auto take_dropped() -> unsigned long
+    {
+        return dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    /// The owning thread has exited: once drained, the ring can go
+    std::atomic<bool> orphaned{false};
+
+private:
+    std::vector<LogEntry> slots;
+    std::atomic<std::size_t> head{0};
+    std::atomic<std::size_t> tail{0};
+    std::atomic<unsigned long> dropped{0};
+};
+
+struct ml::AsyncLogger::Repeats
+{
+    bool have_last{false};
+    LogEntry last;
+    unsigned long count{0};
+    timespec first{};
+    timespec latest{};
+
+    auto repeats(LogEntry const& entry) const -> bool
+    {
+        return have_last &&
+               entry.severity == last.severity &&
+               entry.message == last.message &&
+               entry.component == last.component;
+    }
+
+    void summarise_into(std::vector<LogEntry>& out)
+    {
+        if (count == 0)
+            return;
+
+        out.push_back({
+            last.severity,
+            latest,
+            last.component,
+            "last message repeated " + std::to_string(count) + (count == 1 ? " time" : " times")});
+        count = 0;
+    }
+};
+
+auto ml::AsyncLogger::console_sink() -> Sink
+{
+    return [](std::vector<LogEntry> const& batch)
+        {
+            for (auto const& entry : batch)
+                write_to_console(entry);
+
+            std::cerr << std::flush;
+            std::cout << std::flush;
+        };
+}
+
+ml::AsyncLogger::AsyncLogger(Sink sink, std::size_t entries_per_thread) :
+    sink{std::move(sink)},
+    entries_per_thread{entries_per_thread},
+    serial{next_serial++},
+    repeats{std::make_unique<Repeats>()},
+    writer{[this]
+        {
+            mir::set_thread_name("Mir/Logging");
+
+            auto const woken = [this] { return stopping || wake_pending; };
+            std::optional<std::chrono::nanoseconds> summary_due;
+
+            std::unique_lock<decltype(wake_mutex)> lock{wake_mutex};
+            while (!stopping)
+            {
+                // Only a run of repeated messages needs the writer to wake without being told
+                if (summary_due)
+                    wake_cv.wait_for(lock, summary_due.value(), woken);
+                else
+                    wake_cv.wait(lock, woken);
+
+                // An exchange, so draining sees everything queued before the last wake_writer()
+                wake_pending.exchange(false);
+
+                lock.unlock();
+                summary_due = write_pending(false);
+                lock.lock();
+            }
+            lock.unlock();
+
+            write_pending(true);
+        }}
+{
+    std::call_once(atfork_registered, []
+        {
+            pthread_atfork(nullptr, nullptr, [] { in_forked_child = true; });
+        });
+}
+
+ml::AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<decltype(wake_mutex)> lock{wake_mutex};
+        stopping = true;
+    }
+    wake_cv.notify_one();
+    writer.join();
+}
+
+void ml::AsyncLogger::log(Severity severity, const std::string& message, const std::string& component)
+{
+    LogEntry entry{severity, realtime_now(), component, message};
+
+    if (in_forked_child)
+    {
+        // Whatever was queued belongs to the parent, which will write it
+        sink({std::move(entry)});
+        return;
+    }
+
+    if (severity == Severity::critical)
+    {
+        std::lock_guard<decltype(write_mutex)> lock{write_mutex};
+        auto const dropped = take_pending(batch_buffer);
+        batch_buffer.push_back(std::move(entry));
+        write(batch_buffer, dropped, true);
+        return;
+    }
+
+    ring_for_this_thread()->push(std::move(entry));
+    wake_writer();
+}
+
+auto ml::AsyncLogger::dropped() const -> unsigned long
+{
+    return dropped_total;
+}
+
+auto ml::AsyncLogger::ring_for_this_thread() -> std::shared_ptr<Ring>
+{
+    // The rings this thread logs into, for each logger it has used
+    struct ThreadRings
+    {
+        std::vector<std::pair<unsigned long, std::weak_ptr<Ring>>> rings;
+
+        ~ThreadRings()
+        {
+            for (auto const& ring : rings)
+            {
+                if (auto const live = ring.second.lock())
+                    live->orphaned = true;
+            }
+        }
+    };
+    thread_local ThreadRings this_thread;
+
+    for (auto const& ring : this_thread.rings)
+    {
+        if (ring.first == serial)
+        {
+            if (auto const live = ring.second.lock())
+                return live;
+        }
+    }
+
+    this_thread.rings.erase(
+        std::remove_if(
+            begin(this_thread.rings),
+            end(this_thread.rings),
+            [](auto const& ring) { return ring.second.expired(); }),
+        end(this_thread.rings));
+
+    auto const ring = std::make_shared<Ring>(entries_per_thread);
+    {
+        std::lock_guard<decltype(rings_mutex)> lock{rings_mutex};
+        rings.push_back(ring);
+    }
+    this_thread.rings.emplace_back(serial, ring);
+
+    return ring;
+}
+
+void ml::AsyncLogger::wake_writer()
+{
+    // Only the first message since the writer last woke needs to take wake_mutex
+    if (wake_pending.exchange(true))
+        return;
+
+    {
+        // The writer can't miss the flag between checking it and going to sleep,
+        // as it holds wake_mutex for both
+        std::lock_guard<decltype(wake_mutex)> lock{wake_mutex};
+    }
+    wake_cv.notify_one();
+}
+
+auto ml::AsyncLogger::take_pending(std::vector<LogEntry>& batch) -> unsigned long
+{
+    std::vector<std::shared_ptr<Ring>> current_rings;
+    {
+        std::lock_guard<decltype(rings_mutex)> lock{rings_mutex};
+
+        // A ring is orphaned after its thread's last entry is queued, so it can
+        // be forgotten once drained below
+        current_rings = rings;
+        rings.erase(
+            std::remove_if(begin(rings), end(rings), [](auto const& ring) { return ring->orphaned.load(); }),
+            end(rings));
+    }
+
+    unsigned long dropped = 0;
+    for (auto const& ring : current_rings)
+    {
+        ring->pop_into(batch);
+        dropped += ring->take_dropped();
+    }
+
+    // Interleave threads' messages in the order they were logged
+    std::stable_sort(begin(batch), end(batch), [](LogEntry const& a, LogEntry const& b)
+        {
+            return time_between(b.when, a.when).count() < 0;
+        });
+
+    return dropped;
+}
+
+auto ml::AsyncLogger::write_pending(bool summarise_repeats) -> std::optional<std::chrono::nanoseconds>
+{
+    std::lock_guard<decltype(write_mutex)> lock{write_mutex};
+    auto const dropped = take_pending(batch_buffer);
+    return write(batch_buffer, dropped, summarise_repeats);
+}
+
+auto ml::AsyncLogger::write(std::vector<LogEntry>& batch, unsigned long dropped, bool summarise_repeats)
+    -> std::optional<std::chrono::nanoseconds>
+{
+    std::vector<LogEntry> out;
+
+    if (dropped)
+    {
+        dropped_total += dropped;
+        out.push_back({
+            Severity::warning,
+            realtime_now(),
+            "logging",
+            std::to_string(dropped) + " log messages dropped: logging faster than the log can be written"});
+    }
+
+    for (auto& entry : batch)
+    {
+        if (repeats->repeats(entry))
+        {
+            if (repeats->count++ == 0)
+                repeats->first = entry.when;
+            repeats->latest = entry.when;
+            continue;
+        }
+
+        repeats->summarise_into(out);
+        repeats->last = entry;
+        repeats->have_last = true;
+        out.push_back(std::move(entry));
+    }
+    batch.clear();
+
+    // Don't wait for the end of a long run to report it
+    if (summarise_repeats || (repeats->count && time_between(repeats->first, realtime_now()) >= repeat_summary_interval))
+        repeats->summarise_into(out);
+
+    if (!out.empty())
+        sink(out);
+
+    if (repeats->count == 0)
+        return {};
+
+    return repeat_summary_interval - time_between(repeats->first, realtime_now());
+}
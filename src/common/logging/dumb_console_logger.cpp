@@ -24,11 +24,8 @@
 
 namespace ml = mir::logging;
 
-void ml::DumbConsoleLogger::log(ml::Severity severity,
-                                const std::string& message,
-                                const std::string& component)
+void ml::write_to_console(LogEntry const& entry)
 {
-
     static const char* lut[5] =
     {
         "< CRITICAL! > ",
@@ -38,20 +35,30 @@ void ml::DumbConsoleLogger::log(ml::Severity severity,
         "< - debug - > "
     };
 
-    std::ostream& out = severity < ml::Severity::informational ? std::cerr : std::cout;
+    std::ostream& out = entry.severity < ml::Severity::informational ? std::cerr : std::cout;
 
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
+    struct tm local;
     char now[32];
-    auto offset = strftime(now, sizeof(now), "%F %T", localtime(&ts.tv_sec));
-    snprintf(now+offset, sizeof(now)-offset, ".%06ld", ts.tv_nsec / 1000);
+    auto offset = strftime(now, sizeof(now), "%F %T", localtime_r(&entry.when.tv_sec, &local));
+    snprintf(now+offset, sizeof(now)-offset, ".%06ld", entry.when.tv_nsec / 1000);
 
     out << "["
         << now
         << "] "
-        << lut[static_cast<int>(severity)]
-        << component
+        << lut[static_cast<int>(entry.severity)]
+        << entry.component
         << ": "
-        << message
-        << std::endl;
+        << entry.message
+        << '\n';
+}
+
+void ml::DumbConsoleLogger::log(ml::Severity severity,
+                                const std::string& message,
+                                const std::string& component)
+{
+    LogEntry entry{severity, {}, component, message};
+    clock_gettime(CLOCK_REALTIME, &entry.when);
+
+    write_to_console(entry);
+    (severity < ml::Severity::informational ? std::cerr : std::cout) << std::flush;
 }
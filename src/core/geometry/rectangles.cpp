@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <limits>
 #include <ostream>
+#include <utility>
 
 namespace geom = mir::geometry;
 
@@ -61,6 +62,37 @@ void geom::Rectangles::remove(Rectangle const& rect)
     if (i != rectangles.end()) rectangles.erase(i);
 }
 
+void geom::Rectangles::subtract(Rectangle const& hole)
+{
+    std::vector<Rectangle> remaining;
+
+    for (auto const& r : rectangles)
+    {
+        auto const overlap = r.intersection_with(hole);
+        if (overlap.size.width.as_int() <= 0 || overlap.size.height.as_int() <= 0)
+        {
+            remaining.push_back(r);
+            continue;
+        }
+
+        int const left = r.left().as_int(), right = r.right().as_int();
+        int const top = r.top().as_int(), bottom = r.bottom().as_int();
+        int const o_left = overlap.left().as_int(), o_right = overlap.right().as_int();
+        int const o_top = overlap.top().as_int(), o_bottom = overlap.bottom().as_int();
+
+        if (o_top > top)
+            remaining.push_back({{left, top}, {right - left, o_top - top}});
+        if (o_bottom < bottom)
+            remaining.push_back({{left, o_bottom}, {right - left, bottom - o_bottom}});
+        if (o_left > left)
+            remaining.push_back({{left, o_top}, {o_left - left, o_bottom - o_top}});
+        if (o_right < right)
+            remaining.push_back({{o_right, o_top}, {right - o_right, o_bottom - o_top}});
+    }
+
+    rectangles = std::move(remaining);
+}
+
 void geom::Rectangles::clear()
 {
     rectangles.clear();
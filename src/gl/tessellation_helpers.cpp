@@ -26,7 +26,13 @@ namespace geom = mir::geometry;
 mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mg::Renderable const& renderable, geom::Displacement const& offset)
 {
-    auto rect = renderable.screen_position();
+    return tessellate_renderable_into_rectangle(renderable, offset, renderable.screen_position());
+}
+
+mgl::Primitive mgl::tessellate_renderable_into_rectangle(
+    mg::Renderable const& renderable, geom::Displacement const& offset, geom::Rectangle const& part)
+{
+    auto rect = part;
     rect.top_left = rect.top_left - offset;
     GLfloat left = rect.top_left.x.as_int();
     GLfloat right = left + rect.size.width.as_int();
@@ -36,13 +42,45 @@ mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mgl::Primitive rectangle;
     rectangle.type = GL_TRIANGLE_STRIP;
 
-    GLfloat const tex_right = 1.0f;
-    GLfloat const tex_bottom = 1.0f;
+    GLfloat tex_left = 0.0f;
+    GLfloat tex_top = 0.0f;
+    GLfloat tex_right = 1.0f;
+    GLfloat tex_bottom = 1.0f;
+
+    if (auto const src_bounds = renderable.src_bounds())
+    {
+        auto const buffer_size = renderable.buffer()->size();
+        GLfloat const width = buffer_size.width.as_int();
+        GLfloat const height = buffer_size.height.as_int();
+        tex_left = src_bounds.value().left().as_value() / width;
+        tex_top = src_bounds.value().top().as_value() / height;
+        tex_right = src_bounds.value().right().as_value() / width;
+        tex_bottom = src_bounds.value().bottom().as_value() / height;
+    }
+
+    // Interpolate the texture coordinates across the part of the whole
+    auto const whole = renderable.screen_position();
+    if (part != whole)
+    {
+        GLfloat const whole_width = whole.size.width.as_int();
+        GLfloat const whole_height = whole.size.height.as_int();
+        auto const tex_x0 = tex_left;
+        auto const tex_y0 = tex_top;
+        auto const tex_width = tex_right - tex_left;
+        auto const tex_height = tex_bottom - tex_top;
+        auto const tex_x = [&](geom::X x) { return tex_x0 + tex_width * (x - whole.left()).as_int() / whole_width; };
+        auto const tex_y = [&](geom::Y y) { return tex_y0 + tex_height * (y - whole.top()).as_int() / whole_height; };
+
+        tex_left = tex_x(part.left());
+        tex_top = tex_y(part.top());
+        tex_right = tex_x(part.right());
+        tex_bottom = tex_y(part.bottom());
+    }
 
     auto& vertices = rectangle.vertices;
-    vertices[0] = {{left,  top,    0.0f}, {0.0f,      0.0f}};
-    vertices[1] = {{left,  bottom, 0.0f}, {0.0f,      tex_bottom}};
-    vertices[2] = {{right, top,    0.0f}, {tex_right, 0.0f}};
+    vertices[0] = {{left,  top,    0.0f}, {tex_left,  tex_top}};
+    vertices[1] = {{left,  bottom, 0.0f}, {tex_left,  tex_bottom}};
+    vertices[2] = {{right, top,    0.0f}, {tex_right, tex_top}};
     vertices[3] = {{right, bottom, 0.0f}, {tex_right, tex_bottom}};
     return rectangle;
 }
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_LOGGING_ASYNC_LOGGER_H_
+#define MIR_LOGGING_ASYNC_LOGGER_H_
+
+#include "mir/logging/dumb_console_logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace mir
+{
+namespace logging
+{
+/// A logger that never waits for the log to be written
+///
+/// Each logging thread queues messages into its own fixed-size ring buffer,
+/// which a writer thread drains into the sink. If a thread's buffer is full
+/// the message is dropped and counted; the sink is told how many were lost.
+/// Runs of the same message are collapsed into a "repeated" summary.
+///
+/// Critical messages are written (after anything queued) before log() returns,
+/// as they often precede an abort. So is everything logged in a child forked
+/// from the logging process, which has no writer thread.
+class AsyncLogger : public Logger
+{
+public:
+    /// Writes a batch of entries (and flushes, if that is meaningful)
+    using Sink = std::function<void(std::vector<LogEntry> const& batch)>;
+
+    /// Writes to std::cout and std::cerr, like DumbConsoleLogger
+    static auto console_sink() -> Sink;
+
+    explicit AsyncLogger(Sink sink, std::size_t entries_per_thread = 256);
+    ~AsyncLogger();
+
+    void log(Severity severity, const std::string& message, const std::string& component) override;
+
+    /// The number of messages dropped because a thread's buffer was full
+    auto dropped() const -> unsigned long;
+
+private:
+    class Ring;
+    struct Repeats;
+
+    auto ring_for_this_thread() -> std::shared_ptr<Ring>;
+    void wake_writer();
+    /// Moves the queued entries into \p batch, in the order they were logged
+    /// \return the number of entries dropped since the last call
+    auto take_pending(std::vector<LogEntry>& batch) -> unsigned long;
+    /// \return how long until a run of repeated messages is due to be summarised, if one is in progress
+    auto write_pending(bool summarise_repeats) -> std::optional<std::chrono::nanoseconds>;
+    auto write(std::vector<LogEntry>& batch, unsigned long dropped, bool summarise_repeats)
+        -> std::optional<std::chrono::nanoseconds>;
+
+    Sink const sink;
+    std::size_t const entries_per_thread;
+    unsigned long const serial;
+
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+
+    /// Held while draining the rings, and writing to the sink
+    std::mutex write_mutex;
+    std::unique_ptr<Repeats> const repeats;
+    std::vector<LogEntry> batch_buffer;
+    std::atomic<unsigned long> dropped_total{0};
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::atomic<bool> wake_pending{false};
+    bool stopping{false};
+    std::thread writer;
+};
+}
+}
+
+#endif // MIR_LOGGING_ASYNC_LOGGER_H_
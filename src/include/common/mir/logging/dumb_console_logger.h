@@ -21,10 +21,23 @@
 
 #include "mir/logging/logger.h"
 
+#include <ctime>
+
 namespace mir
 {
 namespace logging
 {
+struct LogEntry
+{
+    Severity severity;
+    timespec when;          ///< CLOCK_REALTIME, when the message was logged
+    std::string component;
+    std::string message;
+};
+
+/// Writes \p entry as a line of the console log, without flushing
+void write_to_console(LogEntry const& entry);
+
 class DumbConsoleLogger : public Logger
 {
 public:
@@ -20,6 +20,7 @@
 #define MIR_GL_TESSELLATION_HELPERS_H_
 #include "mir/gl/primitive.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangle.h"
 
 namespace mir
 {
@@ -30,6 +31,10 @@ namespace gl
 Primitive tessellate_renderable_into_rectangle(
     graphics::Renderable const& renderable, geometry::Displacement const& offset);
 
+/// As above, but only covering \p part (in screen coordinates) of the renderable's screen_position()
+Primitive tessellate_renderable_into_rectangle(
+    graphics::Renderable const& renderable, geometry::Displacement const& offset, geometry::Rectangle const& part);
+
 }
 }
 #endif /* MIR_GL_TESSELLATION_HELPERS_H_ */
@@ -59,6 +59,22 @@ public:
      */
     virtual SceneElementSequence scene_elements_for(CompositorID id) = 0;
 
+    /**
+     * As scene_elements_for(), for a group of compositors drawing the same frame.
+     *
+     * The scene is traversed once, and what doesn't depend on the compositor
+     * is shared between the sequences. Each compositor still gets its own
+     * buffers when it renders.
+     * \returns a sequence for each of \a ids, in the same order.
+     */
+    virtual auto scene_elements_for_group(std::vector<CompositorID> const& ids) -> std::vector<SceneElementSequence>
+    {
+        std::vector<SceneElementSequence> sequences;
+        for (auto const id : ids)
+            sequences.push_back(scene_elements_for(id));
+        return sequences;
+    }
+
     /**
      * Return the number of additional frames that you need to render to get
      * fully up to date with the latest data in the scene. For a generic
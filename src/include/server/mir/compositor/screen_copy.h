@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_SCREEN_COPY_H_
+#define MIR_COMPOSITOR_SCREEN_COPY_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/graphics/renderable.h"
+#include "mir/renderer/renderer.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+/**
+ * Copies of what is composited, for screen capture clients.
+ *
+ * Copies are read back from the next frame the compositor renders of the
+ * output showing them, so capturing doesn't need a composition pass of its
+ * own. Copies that wait for damage are held until a frame changes their area.
+ */
+class ScreenCopy
+{
+public:
+    /// What one client last copied, so that its later copies report only what changed
+    class DamageHistory;
+
+    struct Result
+    {
+        bool succeeded;
+        std::vector<unsigned char> pixels;          ///< As renderer::Renderer::Readback::pixels
+        std::vector<geometry::Rectangle> damage;    ///< In copy pixels, since the previous copy with the same history
+        std::chrono::steady_clock::time_point time; ///< When the frame was rendered
+    };
+
+    struct Request
+    {
+        geometry::Rectangle area;                   ///< In scene coordinates, within one output
+        geometry::Size size;                        ///< Of the copy, in pixels
+        std::shared_ptr<DamageHistory> history;     ///< Optional
+        bool wait_for_damage;                       ///< Wait for a frame that differs from the history
+        std::function<void(Result&& result)> on_done; ///< Called on a compositor thread
+    };
+
+    /// The copies to read back from one frame
+    class FrameCopies
+    {
+    public:
+        FrameCopies() = default;
+        FrameCopies(FrameCopies&&) = default;
+        FrameCopies& operator=(FrameCopies&&) = default;
+
+        /// Filled in by renderer::Renderer::render_and_read_back()
+        std::vector<renderer::Renderer::Readback> readbacks;
+
+        auto empty() const -> bool { return readbacks.empty(); }
+
+        /// Send the readbacks to the requesters
+        void complete(std::chrono::steady_clock::time_point time);
+
+    private:
+        friend class ScreenCopy;
+        std::vector<std::shared_ptr<Request>> requests;
+        std::vector<std::vector<geometry::Rectangle>> damage;
+    };
+
+    /// \param [in] schedule_frame  prompts the compositor to render a frame of each output
+    explicit ScreenCopy(std::function<void()> schedule_frame);
+    ~ScreenCopy();
+
+    static auto new_damage_history() -> std::shared_ptr<DamageHistory>;
+
+    /// Copy request.area from the next suitable frame
+    /// \return the pending copy: releasing it cancels the copy
+    auto copy(Request request) -> std::shared_ptr<void>;
+
+    /// Take the copies satisfied by a frame of \p view_area showing \p renderables
+    /// \note called by compositor threads
+    auto copies_for(
+        geometry::Rectangle const& view_area,
+        graphics::RenderableList const& renderables) -> FrameCopies;
+
+private:
+    std::function<void()> const schedule_frame;
+
+    std::mutex mutex;
+    std::vector<std::weak_ptr<Request>> pending;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_SCREEN_COPY_H_ */
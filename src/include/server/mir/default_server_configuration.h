@@ -56,6 +56,7 @@ class Drawer;
 class DisplayBufferCompositorFactory;
 class Compositor;
 class CompositorReport;
+class ScreenCopy;
 }
 namespace frontend
 {
@@ -65,6 +66,8 @@ class EventSink;
 class DisplayChanger;
 class InputConfigurationChanger;
 class SurfaceStack;
+class ClientResources;
+class ClientResourceReport;
 }
 
 namespace shell
@@ -251,6 +254,7 @@ public:
      *  @{ */
     virtual std::shared_ptr<graphics::GraphicBufferAllocator> the_buffer_allocator();
     virtual std::shared_ptr<compositor::Scene>                  the_scene();
+    virtual std::shared_ptr<compositor::ScreenCopy>             the_screen_copy();
     /** @} */
 
     /** @name frontend configuration - dependencies
@@ -265,6 +269,13 @@ public:
     /** @} */
     /** @} */
 
+    /** @name frontend configuration - services
+     * services provided by frontend for the rest of Mir
+     *  @{ */
+    virtual std::shared_ptr<frontend::ClientResources>        the_client_resources();
+    virtual std::shared_ptr<frontend::ClientResourceReport>   the_client_resource_report();
+    /** @} */
+
     // the_focus_controller() is an interface for the_shell().
     std::shared_ptr<shell::FocusController> the_focus_controller();
 
@@ -398,6 +409,8 @@ protected:
     CachedPtr<input::CursorImages> cursor_images;
 
     CachedPtr<frontend::SessionAuthorizer> session_authorizer;
+    CachedPtr<frontend::ClientResources> client_resources;
+    CachedPtr<frontend::ClientResourceReport> client_resource_report;
     CachedPtr<renderer::RendererFactory> renderer_factory;
     CachedPtr<compositor::BufferStreamFactory> buffer_stream_factory;
     CachedPtr<scene::SurfaceStack> scene_surface_stack;
@@ -414,6 +427,7 @@ protected:
     CachedPtr<compositor::DisplayBufferCompositorFactory> display_buffer_compositor_factory;
     CachedPtr<compositor::Compositor> compositor;
     CachedPtr<compositor::CompositorReport> compositor_report;
+    CachedPtr<compositor::ScreenCopy> screen_copy;
     CachedPtr<logging::Logger> logger;
     CachedPtr<graphics::DisplayReport> display_report;
     CachedPtr<time::Clock> clock;
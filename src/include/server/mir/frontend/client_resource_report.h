@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_CLIENT_RESOURCE_REPORT_H_
+#define MIR_FRONTEND_CLIENT_RESOURCE_REPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace mir
+{
+namespace frontend
+{
+/// What a single Wayland client is costing the server
+struct ClientResourceUsage
+{
+    pid_t pid;
+    uint64_t requests;              ///< Wayland requests dispatched since the client connected
+    uint64_t commits;               ///< wl_surface.commits since the client connected
+    unsigned requests_per_second;   ///< Over the last complete second
+    unsigned commits_per_second;    ///< Over the last complete second
+    unsigned buffers_held;          ///< Client buffers submitted to the compositor and not yet released
+    std::size_t buffer_bytes_held;  ///< Pixel data of those buffers
+    uint64_t frames_dropped;        ///< Buffers released unseen to keep the client within its limits
+};
+
+class ClientResourceReport
+{
+public:
+    /// Called about once a second for each client making requests
+    virtual void usage_sampled(ClientResourceUsage const& usage) = 0;
+
+protected:
+    ClientResourceReport() = default;
+    virtual ~ClientResourceReport() = default;
+    ClientResourceReport(ClientResourceReport const&) = delete;
+    ClientResourceReport& operator=(ClientResourceReport const&) = delete;
+};
+}
+}
+
+#endif /* MIR_FRONTEND_CLIENT_RESOURCE_REPORT_H_ */
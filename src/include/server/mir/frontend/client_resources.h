@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_CLIENT_RESOURCES_H_
+#define MIR_FRONTEND_CLIENT_RESOURCES_H_
+
+#include "mir/frontend/client_resource_report.h"
+#include "mir/time/types.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+}
+namespace time
+{
+class Clock;
+}
+namespace frontend
+{
+/**
+ * Accounts for what each Wayland client costs the server, and enforces per-client limits.
+ *
+ * Each connected client has an Account, updated by the frontend as it handles the client's requests.
+ */
+class ClientResources
+{
+public:
+    /// Zero means unlimited
+    struct Limits
+    {
+        unsigned max_hidden_commits_per_second{0};
+        /// Buffers committed but not yet consumed by the compositor. The buffer a surface is
+        /// showing has been consumed, so doesn't count against this.
+        unsigned max_buffers_queued{0};
+    };
+
+    class Account;
+
+    /// \param [in] reporting  whether usage is reported, so every request needs to be counted
+    ClientResources(
+        Limits const& limits,
+        std::shared_ptr<time::Clock> const& clock,
+        std::shared_ptr<ClientResourceReport> const& report,
+        bool reporting);
+
+    auto open_account(pid_t pid) -> std::shared_ptr<Account>;
+
+    /// Whether the frontend needs to call Account::request_dispatched(). When usage is neither reported
+    /// nor limited it can skip the per-request accounting entirely.
+    auto counts_requests() const -> bool;
+
+    /// The usage of every connected client
+    auto usage() const -> std::vector<ClientResourceUsage>;
+
+private:
+    Limits const limits;
+    std::shared_ptr<time::Clock> const clock;
+    std::shared_ptr<ClientResourceReport> const report;
+    bool const reporting;
+
+    std::mutex mutable mutex;
+    std::vector<std::weak_ptr<Account>> accounts;
+};
+
+class ClientResources::Account
+{
+public:
+    Account(
+        pid_t pid,
+        Limits const& limits,
+        std::shared_ptr<time::Clock> const& clock,
+        std::shared_ptr<ClientResourceReport> const& report);
+
+    /// Called on the Wayland thread for each request the client makes
+    void request_dispatched();
+
+    /// Called on the Wayland thread for each wl_surface.commit
+    /// \param [in] buffer          the buffer committed, if any
+    /// \param [in] consumed        set once the compositor has consumed (uploaded or read) \p buffer.
+    ///                             Null if there's nothing to consume.
+    /// \param [in] surface_hidden  whether the surface is hidden or occluded
+    /// \return                     whether the buffer should be shown. If not, the caller releases
+    ///                             it unseen and it is counted as a dropped frame
+    auto commit(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        std::shared_ptr<std::atomic<bool>> const& consumed,
+        bool surface_hidden) -> bool;
+
+    auto usage() const -> ClientResourceUsage;
+
+private:
+    struct HeldBuffer
+    {
+        std::weak_ptr<graphics::Buffer> buffer;
+        std::shared_ptr<std::atomic<bool>> consumed;
+        std::size_t bytes;
+    };
+
+    /// Starts a new sample if the current one is over, returning whether it did. Requires mutex to be held.
+    auto roll_sample(time::Timestamp now) -> bool;
+    /// Forgets buffers the compositor has released. Requires mutex to be held.
+    void prune_buffers();
+    /// Buffers held that the compositor hasn't consumed yet. Requires mutex to be held.
+    auto buffers_queued() const -> unsigned;
+    auto usage(std::unique_lock<std::mutex> const&) const -> ClientResourceUsage;
+
+    pid_t const pid;
+    Limits const limits;
+    std::shared_ptr<time::Clock> const clock;
+    std::shared_ptr<ClientResourceReport> const report;
+
+    std::mutex mutable mutex;
+    uint64_t requests{0};
+    uint64_t commits{0};
+    uint64_t frames_dropped{0};
+    time::Timestamp sample_start;
+    unsigned requests_in_sample{0};
+    unsigned commits_in_sample{0};
+    unsigned hidden_commits_in_sample{0};
+    unsigned requests_per_second{0};
+    unsigned commits_per_second{0};
+    std::vector<HeldBuffer> held_buffers;
+};
+}
+}
+
+#endif /* MIR_FRONTEND_CLIENT_RESOURCES_H_ */
@@ -173,6 +173,8 @@ private:
     std::deque<ServerAction> run_on_halt_queue;
     std::function<void()> before_iteration_hook;
     std::exception_ptr main_loop_exception;
+    detail::ServerActionQueue action_queue;
+    detail::TimerQueue timers;
 };
 
 }
@@ -23,6 +23,7 @@
 #include "mir/thread_safe_list.h"
 #include "mir/fd.h"
 
+#include <deque>
 #include <functional>
 #include <vector>
 #include <mutex>
@@ -67,18 +68,85 @@ private:
 void add_idle_gsource(
     GMainContext* main_context, int priority, std::function<void()> const& callback);
 
-void add_server_action_gsource(
-    GMainContext* main_context,
-    void const* owner,
-    std::function<void()> const& action,
-    std::function<bool(void const*)> const& should_dispatch);
-
-GSourceHandle add_timer_gsource(
-    GMainContext* main_context,
-    std::shared_ptr<time::Clock> const& clock,
-    std::shared_ptr<LockableCallback> const& handler,
-    std::function<void()> const& exception_handler,
-    time::Timestamp target_time);
+/// A single GSource that dispatches queued server actions in order
+///
+/// Actions queued together are dispatched in one iteration of the main
+/// context, and the context is woken at most once per iteration.
+class ServerActionQueue
+{
+public:
+    ServerActionQueue(GMainContext* main_context, std::function<bool(void const*)> const& should_dispatch);
+    ~ServerActionQueue();
+
+    /// Queue an action that waits while should_dispatch(owner) is false
+    void enqueue(void const* owner, std::function<void()>&& action);
+
+    /// Queue an action that is dispatched regardless of its owner
+    void enqueue_unconditionally(std::function<void()>&& action);
+
+private:
+    struct Action
+    {
+        bool pausable;
+        void const* owner;
+        std::function<void()> action;
+    };
+    struct ActionGSource;
+
+    void push(Action&& action);
+    auto ready() -> bool;
+    void dispatch();
+
+    GMainContext* const main_context;
+    std::function<bool(void const*)> const should_dispatch;
+
+    std::mutex mutex;
+    std::deque<Action> actions;
+    bool woken{false};
+
+    GSource* const gsource;
+};
+
+/// A single GSource that dispatches the main loop's timers
+///
+/// The timers are kept on a time::TimerWheel, so scheduling and cancelling
+/// them neither creates nor destroys GSources, and other threads only wake the
+/// context when they schedule a timer earlier than any that is pending.
+class TimerQueue
+{
+public:
+    class Timer
+    {
+    public:
+        virtual ~Timer() = default;
+
+        /// Dispatch the handler at \p target_time, in place of any earlier schedule
+        virtual void schedule(time::Timestamp target_time) = 0;
+
+        /// Stop any scheduled dispatch, waiting for one in progress to finish
+        virtual void cancel() = 0;
+
+    protected:
+        Timer() = default;
+        Timer(Timer const&) = delete;
+        Timer& operator=(Timer const&) = delete;
+    };
+
+    TimerQueue(GMainContext* main_context, std::shared_ptr<time::Clock> const& clock);
+    ~TimerQueue();
+
+    auto create_timer(
+        std::shared_ptr<LockableCallback> const& handler,
+        std::function<void()> const& exception_handler) -> std::shared_ptr<Timer>;
+
+private:
+    struct State;
+    class TimerImpl;
+    struct TimerGSource;
+
+    std::shared_ptr<State> const state;
+    GSource* const gsource;
+};
 
 class FdSources
 {
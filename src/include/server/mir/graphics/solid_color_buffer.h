@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_
+#define MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_
+
+#include "mir/graphics/buffer_basic.h"
+
+#include <glm/glm.hpp>
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * A buffer that is a single colour throughout
+ *
+ * There is no pixel storage behind it: renderers that recognise it fill the
+ * area it covers with colour() instead of sampling a texture. As it has no
+ * storage, a SolidColorBuffer can be any size for free.
+ */
+class SolidColorBuffer : public BufferBasic, public NativeBufferBase
+{
+public:
+    /// \param premultiplied_color  RGBA, with the alpha already applied to RGB
+    SolidColorBuffer(geometry::Size size, glm::vec4 const& premultiplied_color);
+
+    auto size() const -> geometry::Size override;
+    /// An opaque colour has no alpha channel, so it is never treated as shaped
+    auto pixel_format() const -> MirPixelFormat override;
+    auto native_buffer_base() -> NativeBufferBase* override;
+
+    auto color() const -> glm::vec4 { return color_; }
+
+private:
+    geometry::Size const size_;
+    glm::vec4 const color_;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_ */
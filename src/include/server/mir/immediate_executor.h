@@ -0,0 +1,40 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_IMMEDIATE_EXECUTOR_H_
+#define MIR_IMMEDIATE_EXECUTOR_H_
+
+#include "mir/executor.h"
+
+namespace mir
+{
+/**
+ * An Executor that runs work immediately, on the calling thread.
+ *
+ * ObserverMultiplexer recognises observers registered with an ImmediateExecutor
+ * and calls them directly, without wrapping the call in a std::function.
+ */
+class ImmediateExecutor : public Executor
+{
+public:
+    void spawn(std::function<void()>&& work) override
+    {
+        work();
+    }
+};
+}
+
+#endif //MIR_IMMEDIATE_EXECUTOR_H_
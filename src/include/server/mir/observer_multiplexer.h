@@ -23,13 +23,17 @@
 #include "mir/raii.h"
 #include "mir/posix_rw_mutex.h"
 #include "mir/executor.h"
+#include "mir/immediate_executor.h"
 #include "mir/main_loop.h"
 
 #include <vector>
 #include <algorithm>
+#include <cstring>
 #include <mutex>
 #include <thread>
 #include <shared_mutex>
+#include <typeindex>
+#include <type_traits>
 
 namespace mir
 {
@@ -43,6 +47,45 @@ public:
         Executor& executor) override;
     void unregister_interest(Observer const& observer) override;
 
+    /// A pointer to an Observer member function, used to select the notifications an observer receives
+    class Notification
+    {
+    public:
+        template<typename MemberFn, typename = std::enable_if_t<std::is_member_function_pointer<MemberFn>::value>>
+        Notification(MemberFn f)
+            : type{typeid(MemberFn)}
+        {
+            static_assert(sizeof(MemberFn) <= sizeof(storage), "Unexpectedly large member function pointer");
+            std::memcpy(storage, &f, sizeof f);
+        }
+
+        template<typename MemberFn>
+        auto is(MemberFn f) const -> bool
+        {
+            if (type != typeid(MemberFn))
+                return false;
+
+            MemberFn stored;
+            std::memcpy(&stored, storage, sizeof stored);
+            return stored == f;
+        }
+
+    private:
+        std::type_index type;
+        alignas(void*) char storage[2*sizeof(void*)];
+    };
+
+    /**
+     * Add an observer that only receives the listed \p notifications.
+     *
+     * Notifications of other kinds skip this observer without locking it or
+     * spawning work on \p executor, which matters for frequent notifications.
+     */
+    void register_interest(
+        std::weak_ptr<Observer> const& observer,
+        Executor& executor,
+        std::vector<Notification> notifications);
+
 protected:
     /**
      * \param [in] default_executor Executor that will be used as the execution environment
@@ -70,12 +113,37 @@ private:
     class WeakObserver
     {
     public:
-        explicit WeakObserver(std::weak_ptr<Observer> observer, Executor& executor)
-            : observer{observer},
-              executor{executor}
+        /// \param notifications the notifications of interest (or all notifications, if empty)
+        explicit WeakObserver(
+            std::weak_ptr<Observer> observer,
+            Executor& executor,
+            std::vector<Notification> notifications = {})
+            : immediate{dynamic_cast<ImmediateExecutor*>(&executor) != nullptr},
+              observer{observer},
+              executor{executor},
+              notifications{std::move(notifications)}
         {
         }
 
+        /// Does not need to lock: the interests of an observer do not change
+        template<typename MemberFn>
+        auto interested_in(MemberFn f) const -> bool
+        {
+            if (notifications.empty())
+                return true;
+
+            for (auto const& notification : notifications)
+            {
+                if (notification.is(f))
+                    return true;
+            }
+
+            return false;
+        }
+
+        /// Work for this observer can be run directly, rather than spawned
+        bool const immediate;
+
         class LockedObserver
         {
         public:
@@ -162,10 +230,16 @@ private:
         std::recursive_mutex mutex;
         std::weak_ptr<Observer> observer;
         Executor& executor;
+        std::vector<Notification> const notifications;
     };
 
+    using Observers = std::vector<std::shared_ptr<WeakObserver>>;
+
+    void add(std::shared_ptr<WeakObserver> const& observer);
+
     PosixRWMutex observer_mutex;
-    std::vector<std::shared_ptr<WeakObserver>> observers;
+    /// Replaced (not modified) when observers change, so notifying can share it without copying
+    std::shared_ptr<Observers const> observers{std::make_shared<Observers const>()};
 };
 
 template<class Observer>
@@ -178,27 +252,47 @@ template<class Observer>
 void ObserverMultiplexer<Observer>::register_interest(
     std::weak_ptr<Observer> const& observer,
     Executor& executor)
+{
+    add(std::make_shared<WeakObserver>(observer, executor));
+}
+
+template<class Observer>
+void ObserverMultiplexer<Observer>::register_interest(
+    std::weak_ptr<Observer> const& observer,
+    Executor& executor,
+    std::vector<Notification> notifications)
+{
+    add(std::make_shared<WeakObserver>(observer, executor, std::move(notifications)));
+}
+
+template<class Observer>
+void ObserverMultiplexer<Observer>::add(std::shared_ptr<WeakObserver> const& observer)
 {
     std::lock_guard<decltype(observer_mutex)> lock{observer_mutex};
 
-    observers.emplace_back(std::make_shared<WeakObserver>(observer, executor));
+    auto updated = std::make_shared<Observers>(*observers);
+    updated->push_back(observer);
+    observers = std::move(updated);
 }
 
 template<class Observer>
 void ObserverMultiplexer<Observer>::unregister_interest(Observer const& observer)
 {
     std::lock_guard<decltype(observer_mutex)> lock{observer_mutex};
-    observers.erase(
+
+    auto updated = std::make_shared<Observers>(*observers);
+    updated->erase(
         std::remove_if(
-            observers.begin(),
-            observers.end(),
+            updated->begin(),
+            updated->end(),
             [&observer](auto& candidate)
             {
                 // This will wait for any (other) thread to finish with the candidate observer, then reset it
                 // (preventing future notifications from being sent) if it is the same as the unregistered observer.
                 return candidate->maybe_reset(&observer);
             }),
-        observers.end());
+        updated->end());
+    observers = std::move(updated);
 }
 
 template<class Observer>
@@ -209,17 +303,28 @@ void ObserverMultiplexer<Observer>::for_each_observer(MemberFn f, Args&&... args
         std::is_member_function_pointer<MemberFn>::value,
         "f must be of type (Observer::*)(Args...), a pointer to an Observer member function.");
     auto const invokable_mem_fn = std::mem_fn(f);
-    decltype(observers) local_observers;
+    std::shared_ptr<Observers const> local_observers;
     {
-        std::lock_guard<decltype(observer_mutex)> lock{observer_mutex};
+        std::shared_lock<decltype(observer_mutex)> lock{observer_mutex};
         local_observers = observers;
     }
-    for (auto& weak_observer: local_observers)
+    for (auto const& weak_observer: *local_observers)
     {
+        if (!weak_observer->interested_in(f))
+        {
+            continue;
+        }
+
         if (auto observer = weak_observer->lock())
         {
+            if (weak_observer->immediate)
+            {
+                invokable_mem_fn(observer.get(), args...);
+                continue;
+            }
+
             observer.spawn(
-                [invokable_mem_fn, weak_observer = std::move(weak_observer), args...]() mutable
+                [invokable_mem_fn, weak_observer, args...]() mutable
                 {
                     if (auto observer = weak_observer->lock())
                     {
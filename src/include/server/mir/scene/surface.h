@@ -42,6 +42,8 @@ struct StreamInfo
     std::shared_ptr<compositor::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    optional_value<geometry::RectangleF> src_bounds{};
+    std::vector<geometry::Rectangle> opaque_region{}; ///< Relative to the stream's top left
 };
 
 class SurfaceObserver;
@@ -66,6 +68,11 @@ public:
     virtual geometry::Size window_size() const = 0;
 
     virtual graphics::RenderableList generate_renderables(compositor::CompositorID id) const = 0; 
+    /// As generate_renderables(), for several compositors drawing the same frame. The surface is
+    /// snapshotted once and the lists share all but the buffers each compositor locks.
+    /// \returns a list for each of \p ids, in the same order
+    virtual auto generate_renderables_for(std::vector<compositor::CompositorID> const& ids) const
+        -> std::vector<graphics::RenderableList> = 0;
     virtual int buffers_ready_for_compositor(void const* compositor_id) const = 0;
 
     virtual MirWindowType type() const = 0;
@@ -36,7 +36,7 @@ class ObserverRegistrar;
 
 namespace compositor { class Compositor; class DisplayBufferCompositorFactory; class CompositorReport; }
 namespace graphics { class Cursor; class DisplayPlatform; class RenderingPlatform; class Display; class GLConfig; class DisplayConfigurationPolicy; class DisplayConfigurationObserver; }
-namespace input { class CompositeEventFilter; class InputDispatcher; class CursorListener; class CursorImages; class TouchVisualizer; class InputDeviceHub;}
+namespace input { class CompositeEventFilter; class InputDispatcher; class CursorListener; class CursorImages; class TouchVisualizer; class InputDeviceHub; class InputReport;}
 namespace logging { class Logger; }
 namespace options { class Option; }
 namespace frontend
@@ -277,6 +277,9 @@ public:
     /// Sets an override functor for creating the input dispatcher.
     void override_the_input_dispatcher(Builder<input::InputDispatcher> const& input_dispatcher_builder);
 
+    /// Sets an override functor for creating the input report.
+    void override_the_input_report(Builder<input::InputReport> const& input_report_builder);
+
     /// Sets an override functor for creating the input targeter.
     void override_the_input_targeter(Builder<shell::InputTargeter> const& input_targeter_builder);
 
@@ -24,6 +24,7 @@
 #include "mir/frontend/surface_id.h"
 #include "mir/geometry/point.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangle_f.h"
 #include "mir/graphics/buffer_properties.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/frontend/buffer_stream_id.h"
@@ -50,6 +51,8 @@ struct StreamSpecification
     std::weak_ptr<frontend::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    optional_value<geometry::RectangleF> src_bounds{}; ///< In buffer pixels, see graphics::Renderable::src_bounds()
+    std::vector<geometry::Rectangle> opaque_region{}; ///< Relative to the stream's top left
 };
 auto operator==(StreamSpecification const& lhs, StreamSpecification const& rhs) -> bool;
 
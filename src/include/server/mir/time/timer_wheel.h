@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_TIME_TIMER_WHEEL_H_
+#define MIR_TIME_TIMER_WHEEL_H_
+
+#include "mir/time/types.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace time
+{
+/// Timers kept in a hierarchical timing wheel with millisecond ticks
+///
+/// Adding and removing a timer are O(1). Timers due in the same tick share a
+/// slot, so are found together; those further away sit in coarser levels and
+/// move down as their time approaches. Empty stretches of time are skipped.
+///
+/// \note Not thread-safe
+class TimerWheel
+{
+public:
+    /// A timer's place in the wheel: derive from this to attach what it triggers
+    class Timer
+    {
+    public:
+        Timer() = default;
+
+        auto scheduled() const -> bool { return level != unscheduled; }
+        auto deadline() const -> Timestamp { return deadline_; }
+
+    protected:
+        ~Timer() = default;
+
+    private:
+        friend class TimerWheel;
+        Timer(Timer const&) = delete;
+        Timer& operator=(Timer const&) = delete;
+
+        static std::uint8_t const unscheduled = 0xff;
+
+        Timer* prev{nullptr};
+        Timer* next{nullptr};
+        Timestamp deadline_;
+        std::uint64_t tick{0};
+        std::uint8_t level{unscheduled};
+        std::uint8_t slot{0};
+    };
+
+    /// \param origin   no timer is due before this
+    explicit TimerWheel(Timestamp origin);
+
+    /// Schedules \p timer for \p deadline, in place of any previous schedule
+    void add(Timer& timer, Timestamp deadline);
+
+    /// Unschedules \p timer (if it is scheduled)
+    void remove(Timer& timer);
+
+    /// Unschedules the timers due by \p now, appending them to \p due
+    void expire(Timestamp now, std::vector<Timer*>& due);
+
+    /// When expire() next has something to do: no later than the earliest deadline
+    /// (but it can be sooner, when a timer needs to move down a level)
+    /// \return Timestamp::max() if no timer is scheduled
+    auto next_wakeup() const -> Timestamp;
+
+    auto empty() const -> bool;
+
+private:
+    TimerWheel(TimerWheel const&) = delete;
+    TimerWheel& operator=(TimerWheel const&) = delete;
+
+    static unsigned int const levels = 4;
+    static unsigned int const slot_bits = 6;
+    static unsigned int const slots = 1u << slot_bits;
+
+    auto tick_of(Timestamp time) const -> std::uint64_t;
+    void link(Timer& timer);
+    void unlink(Timer& timer);
+    void cascade();
+
+    /// The first tick \p level has timers for (for coarser levels, the start of their slot)
+    auto next_tick_in(unsigned int level) const -> std::uint64_t;
+
+    Timestamp const origin;
+
+    /// Everything before this tick has been expired
+    std::uint64_t current{0};
+
+    std::array<std::array<Timer*, slots>, levels> wheel{};
+    std::array<std::uint64_t, levels> occupied{};
+};
+}
+}
+
+#endif /* MIR_TIME_TIMER_WHEEL_H_ */
@@ -19,6 +19,7 @@
 #include "basic_window_manager.h"
 #include "display_configuration_listeners.h"
 
+#include "miral/input_event_interest.h"
 #include "miral/window_manager_tools.h"
 
 #include <mir/log.h>
@@ -36,6 +37,19 @@
 using namespace mir;
 using namespace mir::geometry;
 
+namespace
+{
+auto pack(Point point) -> uint64_t
+{
+    return uint64_t(uint32_t(point.x.as_int())) << 32 | uint32_t(point.y.as_int());
+}
+
+auto unpack(uint64_t packed) -> Point
+{
+    return {int32_t(uint32_t(packed >> 32)), int32_t(uint32_t(packed))};
+}
+}
+
 auto miral::BasicWindowManager::DisplayArea::bounding_rectangle_of_contained_outputs() const -> Rectangle
 {
     Rectangles box;
@@ -89,6 +103,7 @@ miral::BasicWindowManager::BasicWindowManager(
     display_layout(display_layout),
     persistent_surface_store{persistent_surface_store},
     policy(build(WindowManagerTools{this})),
+    input_interest{dynamic_cast<InputEventInterest const*>(policy.get())},
     display_config_monitor{std::make_shared<DisplayConfigurationListeners>()}
 {
     display_config_monitor->add_listener(this);
@@ -366,27 +381,38 @@ void miral::BasicWindowManager::remove_display(geometry::Rectangle const& /*area
 
 bool miral::BasicWindowManager::handle_keyboard_event(MirKeyboardEvent const* event)
 {
-    Locker lock{this};
     update_event_timestamp(event);
+
+    if (input_interest && !input_interest->wants_keyboard_event(event))
+        return false;
+
+    Locker lock{this};
     return policy->handle_keyboard_event(event);
 }
 
 bool miral::BasicWindowManager::handle_touch_event(MirTouchEvent const* event)
 {
-    Locker lock{this};
     update_event_timestamp(event);
+
+    if (input_interest && !input_interest->wants_touch_event(event))
+        return false;
+
+    Locker lock{this};
     return policy->handle_touch_event(event);
 }
 
 bool miral::BasicWindowManager::handle_pointer_event(MirPointerEvent const* event)
 {
-    Locker lock{this};
     update_event_timestamp(event);
 
-    cursor = {
+    cursor = pack(Point{
         mir_pointer_event_axis_value(event, mir_pointer_axis_x),
-        mir_pointer_event_axis_value(event, mir_pointer_axis_y)};
+        mir_pointer_event_axis_value(event, mir_pointer_axis_y)});
+
+    if (input_interest && !input_interest->wants_pointer_event(event))
+        return false;
 
+    Locker lock{this};
     return policy->handle_pointer_event(event);
 }
 
@@ -400,7 +426,7 @@ void miral::BasicWindowManager::handle_raise_surface(
     if (!surface_known(surface, "raise"))
         return;
 
-    if (timestamp >= last_input_event_timestamp)
+    if (is_current(timestamp))
         policy->handle_raise_window(info_for(surface));
 }
 
@@ -414,7 +440,7 @@ void miral::BasicWindowManager::handle_request_drag_and_drop(
     if (!surface_known(surface, "drag-and-drop"))
         return;
 
-    if (timestamp >= last_input_event_timestamp)
+    if (is_current(timestamp))
         policy->handle_request_drag_and_drop(info_for(surface));
 }
 
@@ -428,9 +454,9 @@ void miral::BasicWindowManager::handle_request_move(
     if (!surface_known(surface, "move"))
         return;
 
-    if (timestamp >= last_input_event_timestamp && last_input_event)
+    if (auto const input_event = current_input_event(timestamp))
     {
-        policy->handle_request_move(info_for(surface), mir_event_get_input_event(last_input_event));
+        policy->handle_request_move(info_for(surface), mir_event_get_input_event(input_event.get()));
     }
 }
 
@@ -445,9 +471,9 @@ void miral::BasicWindowManager::handle_request_resize(
     if (!surface_known(surface, "resize"))
         return;
 
-    if (timestamp >= last_input_event_timestamp && last_input_event)
+    if (auto const input_event = current_input_event(timestamp))
     {
-        policy->handle_request_resize(info_for(surface), mir_event_get_input_event(last_input_event), edge);
+        policy->handle_request_resize(info_for(surface), mir_event_get_input_event(input_event.get()), edge);
     }
 }
 
@@ -701,7 +727,7 @@ auto miral::BasicWindowManager::active_display_area() const -> std::shared_ptr<D
     // Otherwise, the display that contains the pointer, if there is one.
     for (auto const& area : display_areas)
     {
-        if (area->area.contains(cursor))
+        if (area->area.contains(unpack(cursor)))
         {
             // Ignore the (unspecified) possiblity of overlapping areas
             return area;
@@ -1578,6 +1604,7 @@ void miral::BasicWindowManager::update_event_timestamp(MirTouchEvent const* tev)
 
 void miral::BasicWindowManager::update_event_timestamp(MirInputEvent const* iev)
 {
+    std::lock_guard<decltype(last_input_event_mutex)> lock{last_input_event_mutex};
     last_input_event_timestamp = mir_input_event_get_event_time(iev);
 
     if (last_input_event)
@@ -1585,6 +1612,21 @@ void miral::BasicWindowManager::update_event_timestamp(MirInputEvent const* iev)
     last_input_event = mir_event_ref(mir_input_event_get_event(iev));
 }
 
+auto miral::BasicWindowManager::is_current(uint64_t timestamp) const -> bool
+{
+    std::lock_guard<decltype(last_input_event_mutex)> lock{last_input_event_mutex};
+    return timestamp >= last_input_event_timestamp;
+}
+
+auto miral::BasicWindowManager::current_input_event(uint64_t timestamp) const -> std::shared_ptr<MirEvent const>
+{
+    std::lock_guard<decltype(last_input_event_mutex)> lock{last_input_event_mutex};
+    if (timestamp < last_input_event_timestamp || !last_input_event)
+        return {};
+
+    return {mir_event_ref(last_input_event), [](MirEvent const* event) { mir_event_unref(event); }};
+}
+
 void miral::BasicWindowManager::invoke_under_lock(std::function<void()> const& callback)
 {
     Locker lock{this};
@@ -40,6 +40,7 @@
 #include <optional>
 
 #include <map>
+#include <atomic>
 #include <mutex>
 
 namespace mir
@@ -51,6 +52,7 @@ namespace graphics { class DisplayConfigurationObserver; }
 namespace miral
 {
 class DisplayConfigurationListeners;
+class InputEventInterest;
 
 using mir::shell::SurfaceSet;
 using WindowManagementPolicyBuilder =
@@ -248,12 +250,19 @@ private:
     std::shared_ptr<DeadWorkspaces> const dead_workspaces{std::make_shared<DeadWorkspaces>()};
 
     std::unique_ptr<WindowManagementPolicy> const policy;
+    /// The policy's InputEventInterest, if it has one. Input it declines skips the lock.
+    InputEventInterest const* const input_interest;
 
     std::mutex mutex;
     SessionInfoMap app_info;
     SurfaceInfoMap window_info;
     mir::geometry::Rectangles outputs;
-    mir::geometry::Point cursor;
+    /// Published by every pointer event, including those that bypass the lock.
+    /// (Packed as x in the high and y in the low 32 bits, as Point isn't trivially copyable.)
+    std::atomic<uint64_t> cursor{0};
+
+    // Input bypassing the lock still updates these, so they have their own mutex
+    std::mutex mutable last_input_event_mutex;
     uint64_t last_input_event_timestamp{0};
     MirEvent const* last_input_event{nullptr};
     miral::MRUWindowList mru_active_windows;
@@ -280,6 +289,10 @@ private:
     void update_event_timestamp(MirPointerEvent const* pev);
     void update_event_timestamp(MirTouchEvent const* tev);
     void update_event_timestamp(MirInputEvent const* iev);
+    /// Whether \p timestamp is no older than the last input event
+    auto is_current(uint64_t timestamp) const -> bool;
+    /// The last input event, if \p timestamp is no older than it
+    auto current_input_event(uint64_t timestamp) const -> std::shared_ptr<MirEvent const>;
 
     auto surface_known(std::weak_ptr<mir::scene::Surface> const& surface, std::string const& action) -> bool;
 
@@ -17,13 +17,13 @@
  */
 
 #include "launch_app.h"
-#include <mir/log.h>
 
 #include <boost/throw_exception.hpp>
 
 #include <unistd.h>
 #include <signal.h>
 
+#include <cstdio>
 #include <cstring>
 #include <stdexcept>
 #include <system_error>
@@ -116,8 +116,9 @@ auto miral::launch_app_env(
 
         execvp(exec_args[0], const_cast<char*const*>(exec_args.data()));
 
-        mir::log_warning("Failed to execute client (\"%s\") error: %s", exec_args[0], strerror(errno));
-        exit(EXIT_FAILURE);
+        // Mir's logger and exit handlers belong to the parent, so neither is safe to use here
+        fprintf(stderr, "Failed to execute client (\"%s\") error: %s\n", exec_args[0], strerror(errno));
+        _exit(EXIT_FAILURE);
     }
 
     return pid;
@@ -19,6 +19,7 @@
 #include "miral/set_window_management_policy.h"
 #include "basic_window_manager.h"
 #include "window_management_trace.h"
+#include "window_management_trace_buffer.h"
 
 #include <mir/server.h>
 #include <mir/options/option.h>
@@ -40,6 +41,7 @@ miral::SetWindowManagementPolicy::~SetWindowManagementPolicy() = default;
 void miral::SetWindowManagementPolicy::operator()(mir::Server& server) const
 {
     server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    add_binary_trace_options(server);
 
     server.override_the_window_manager_builder([this, &server](msh::FocusController* focus_controller)
         -> std::shared_ptr<msh::WindowManager>
@@ -48,11 +50,14 @@ void miral::SetWindowManagementPolicy::operator()(mir::Server& server) const
 
             auto const persistent_surface_store = server.the_persistent_surface_store();
 
-            if (server.get_options()->is_set(trace_option))
+            auto const binary_trace = binary_trace_buffer_for(server, WindowManagementTrace::call_names());
+
+            if (server.get_options()->is_set(trace_option) || binary_trace)
             {
-                auto trace_builder = [this](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
+                auto trace_builder = [this, binary_trace](WindowManagerTools const& tools)
+                    -> std::unique_ptr<miral::WindowManagementPolicy>
                     {
-                        return std::make_unique<WindowManagementTrace>(tools, builder);
+                        return std::make_unique<WindowManagementTrace>(tools, builder, binary_trace);
                     };
 
                 return std::make_shared<BasicWindowManager>(
@@ -20,6 +20,7 @@
 
 #include "basic_window_manager.h"
 #include "window_management_trace.h"
+#include "window_management_trace_buffer.h"
 
 #include <mir/abnormal_exit.h>
 #include <mir/server.h>
@@ -52,6 +53,7 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
 
     server.add_configuration_option(wm_option, description, policies.begin()->name);
     server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    add_binary_trace_options(server);
 
     server.override_the_window_manager_builder([this, &server](msh::FocusController* focus_controller)
         -> std::shared_ptr<msh::WindowManager>
@@ -66,11 +68,14 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
             {
                 if (selection == option.name)
                 {
-                    if (server.get_options()->is_set(trace_option))
+                    auto const binary_trace = binary_trace_buffer_for(server, WindowManagementTrace::call_names());
+
+                    if (server.get_options()->is_set(trace_option) || binary_trace)
                     {
-                        auto trace_builder = [&option](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
+                        auto trace_builder = [&option, binary_trace](WindowManagerTools const& tools)
+                            -> std::unique_ptr<miral::WindowManagementPolicy>
                             {
-                                return std::make_unique<WindowManagementTrace>(tools, option.build);
+                                return std::make_unique<WindowManagementTrace>(tools, option.build, binary_trace);
                             };
 
                         return std::make_shared<BasicWindowManager>(
@@ -17,6 +17,7 @@
  */
 
 #include "miral/window_management_policy.h"
+#include "miral/input_event_interest.h"
 
 void miral::WindowManagementPolicy::advise_begin() {}
 void miral::WindowManagementPolicy::advise_end() {}
@@ -38,3 +39,5 @@ void miral::WindowManagementPolicy::advise_output_delete(Output const& /*output*
 void miral::WindowManagementPolicy::advise_application_zone_create(Zone const& /*application_zone*/) {}
 void miral::WindowManagementPolicy::advise_application_zone_update(Zone const& /*updated*/, Zone const& /*original*/) {}
 void miral::WindowManagementPolicy::advise_application_zone_delete(Zone const& /*application_zone*/) {}
+
+miral::InputEventInterest::~InputEventInterest() = default;
@@ -17,6 +17,7 @@
  */
 
 #include "window_management_trace.h"
+#include "window_management_trace_buffer.h"
 #include "window_info_defaults.h"
 
 #include <miral/application_info.h>
@@ -28,8 +29,11 @@
 #include <mir/scene/surface.h>
 #include <mir/event_printer.h>
 
+#include <cmath>
 #include <iomanip>
+#include <limits>
 #include <sstream>
+#include <type_traits>
 
 #define MIR_LOG_COMPONENT "miral::Window Management"
 #include <mir/log.h>
@@ -356,21 +360,201 @@ auto dump_of(miral::Zone const& zone) -> std::string
 {
     return dump_of(zone.extents());
 }
+
+/// Accumulates the arguments of a binary trace record: objects are identified by
+/// address and geometry is flattened into its coordinates.
+struct TraceArgs
+{
+    /// Marks a field of a WindowSpecification that is not set
+    static int64_t const unset = std::numeric_limits<int64_t>::min();
+
+    int64_t values[miral::WindowManagementTraceRecord::max_args];
+    std::size_t count = 0;
+
+    void append(int64_t value)
+    {
+        if (count < miral::WindowManagementTraceRecord::max_args)
+            values[count++] = value;
+    }
+
+    template<typename Type, typename = std::enable_if_t<std::is_enum<Type>::value || std::is_integral<Type>::value>>
+    void append(Type value) { append(static_cast<int64_t>(value)); }
+
+    void append(float value) { append(static_cast<int64_t>(std::lround(value))); }
+    void append(void const* object) { append(reinterpret_cast<intptr_t>(object)); }
+
+    void append(std::string const&) {}  // Strings are not traced
+
+    void append(miral::Window const& window) { append(std::shared_ptr<mir::scene::Surface>(window).get()); }
+    void append(miral::Application const& application) { append(application.get()); }
+    void append(miral::WindowInfo const& info) { append(info.window()); }
+    void append(miral::ApplicationInfo const& info) { append(info.application()); }
+    void append(std::shared_ptr<miral::Workspace> const& workspace) { append(workspace.get()); }
+
+    void append(mir::geometry::Point point) { append(point.x.as_int()); append(point.y.as_int()); }
+    void append(mir::geometry::Size size) { append(size.width.as_int()); append(size.height.as_int()); }
+    void append(mir::geometry::Displacement d) { append(d.dx.as_int()); append(d.dy.as_int()); }
+    void append(mir::geometry::Rectangle const& rect) { append(rect.top_left); append(rect.size); }
+    void append(miral::Output const& output) { append(output.extents()); }
+    void append(miral::Zone const& zone) { append(zone.extents()); }
+
+    void append(std::vector<miral::Window> const& windows)
+    {
+        append(windows.size());
+        for (auto const& window : windows)
+            append(window);
+    }
+
+    void append(miral::WindowSpecification const& spec)
+    {
+        if (spec.top_left().is_set()) append(spec.top_left().value()); else { append(unset); append(unset); }
+        if (spec.size().is_set()) append(spec.size().value()); else { append(unset); append(unset); }
+        if (spec.state().is_set()) append(spec.state().value()); else append(unset);
+    }
+
+    void append(MirKeyboardEvent const* event)
+    {
+        append(mir_input_event_get_device_id(mir_keyboard_event_input_event(event)));
+        append(mir_keyboard_event_action(event));
+        append(mir_keyboard_event_keysym(event));
+        append(mir_keyboard_event_scan_code(event));
+        append(mir_keyboard_event_modifiers(event));
+    }
+
+    void append(MirTouchEvent const* event)
+    {
+        append(mir_input_event_get_device_id(mir_touch_event_input_event(event)));
+        append(mir_touch_event_point_count(event));
+        if (mir_touch_event_point_count(event) > 0)
+        {
+            append(mir_touch_event_action(event, 0));
+            append(mir_touch_event_axis_value(event, 0, mir_touch_axis_x));
+            append(mir_touch_event_axis_value(event, 0, mir_touch_axis_y));
+        }
+    }
+
+    void append(MirPointerEvent const* event)
+    {
+        append(mir_input_event_get_device_id(mir_pointer_event_input_event(event)));
+        append(mir_pointer_event_action(event));
+        append(mir_pointer_event_buttons(event));
+        append(mir_pointer_event_axis_value(event, mir_pointer_axis_x));
+        append(mir_pointer_event_axis_value(event, mir_pointer_axis_y));
+        append(mir_pointer_event_modifiers(event));
+    }
+};
 }
 
+#define MIRAL_TRACE_CALLS(X) \
+    X(count_applications) \
+    X(for_each_application) \
+    X(find_application) \
+    X(info_for_session) \
+    X(info_for_surface) \
+    X(info_for_window) \
+    X(ask_client_to_close) \
+    X(active_window) \
+    X(select_active_window) \
+    X(window_at) \
+    X(active_output) \
+    X(active_application_zone) \
+    X(info_for_window_id) \
+    X(id_for_window) \
+    X(place_and_size_for_state) \
+    X(drag_active_window) \
+    X(drag_window) \
+    X(focus_next_application) \
+    X(focus_prev_application) \
+    X(focus_next_within_application) \
+    X(focus_prev_within_application) \
+    X(raise_tree) \
+    X(start_drag_and_drop) \
+    X(end_drag_and_drop) \
+    X(modify_window) \
+    X(invoke_under_lock) \
+    X(create_workspace) \
+    X(add_tree_to_workspace) \
+    X(remove_tree_from_workspace) \
+    X(move_workspace_content_to_workspace) \
+    X(for_each_workspace_containing) \
+    X(for_each_window_in_workspace) \
+    X(place_new_window) \
+    X(handle_window_ready) \
+    X(handle_modify_window) \
+    X(handle_raise_window) \
+    X(handle_keyboard_event) \
+    X(handle_touch_event) \
+    X(handle_pointer_event) \
+    X(confirm_inherited_move) \
+    X(advise_begin) \
+    X(advise_end) \
+    X(advise_new_app) \
+    X(advise_delete_app) \
+    X(advise_new_window) \
+    X(advise_focus_lost) \
+    X(advise_focus_gained) \
+    X(advise_state_change) \
+    X(advise_move_to) \
+    X(advise_resize) \
+    X(advise_delete_window) \
+    X(advise_raise) \
+    X(handle_request_drag_and_drop) \
+    X(handle_request_move) \
+    X(handle_request_resize) \
+    X(advise_adding_to_workspace) \
+    X(advise_removing_from_workspace) \
+    X(confirm_placement_on_display) \
+    X(advise_output_create) \
+    X(advise_output_update) \
+    X(advise_output_delete) \
+    X(advise_application_zone_create) \
+    X(advise_application_zone_update) \
+    X(advise_application_zone_delete)
+
+enum class miral::WindowManagementTrace::Call : uint16_t
+{
+#define MIRAL_TRACE_CALL_ENUMERATOR(call) call,
+    MIRAL_TRACE_CALLS(MIRAL_TRACE_CALL_ENUMERATOR)
+#undef  MIRAL_TRACE_CALL_ENUMERATOR
+};
+
 miral::WindowManagementTrace::WindowManagementTrace(
     WindowManagerTools const& wrapped,
-    WindowManagementPolicyBuilder const& builder) :
+    WindowManagementPolicyBuilder const& builder,
+    std::shared_ptr<WindowManagementTraceBuffer> const& binary_trace) :
     wrapped{wrapped},
-    policy(builder(WindowManagerTools{this}))
+    policy(builder(WindowManagerTools{this})),
+    binary_trace{binary_trace}
+{
+}
+
+auto miral::WindowManagementTrace::call_names() -> std::vector<std::string>
 {
+    return {
+#define MIRAL_TRACE_CALL_NAME(call) #call,
+        MIRAL_TRACE_CALLS(MIRAL_TRACE_CALL_NAME)
+#undef  MIRAL_TRACE_CALL_NAME
+    };
+}
+
+template<typename... Args>
+auto miral::WindowManagementTrace::record(Call call, Args const&... args) const -> bool
+{
+    if (!binary_trace)
+        return false;
+
+    TraceArgs trace_args;
+    (trace_args.append(args), ...);
+    binary_trace->record(static_cast<uint16_t>(call), trace_args.values, trace_args.count);
+    return true;
 }
 
 auto miral::WindowManagementTrace::count_applications() const -> unsigned int
 try {
     log_input();
     auto const result = wrapped.count_applications();
-    mir::log_info("%s -> %d", __func__, result);
+    if (!record(Call::count_applications, result))
+        mir::log_info("%s -> %d", __func__, result);
     trace_count++;
     return result;
 }
@@ -379,7 +563,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_application(std::function<void(miral::ApplicationInfo&)> const& functor)
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (!record(Call::for_each_application))
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.for_each_application(functor);
 }
@@ -390,7 +575,8 @@ auto miral::WindowManagementTrace::find_application(std::function<bool(Applicati
 try {
     log_input();
     auto result = wrapped.find_application(predicate);
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    if (!record(Call::find_application, result))
+        mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
     trace_count++;
     return result;
 }
@@ -400,7 +586,8 @@ auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Session> c
 try {
     log_input();
     auto& result = wrapped.info_for(session);
-    mir::log_info("%s -> %s", __func__, result.application()->name().c_str());
+    if (!record(Call::info_for_session, result))
+        mir::log_info("%s -> %s", __func__, result.application()->name().c_str());
     trace_count++;
     return result;
 }
@@ -410,7 +597,8 @@ auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Surface> c
 try {
     log_input();
     auto& result = wrapped.info_for(surface);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    if (!record(Call::info_for_surface, result))
+        mir::log_info("%s -> %s", __func__, result.name().c_str());
     trace_count++;
     return result;
 }
@@ -420,7 +608,8 @@ auto miral::WindowManagementTrace::info_for(Window const& window) const -> Windo
 try {
     log_input();
     auto& result = wrapped.info_for(window);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    if (!record(Call::info_for_window, result))
+        mir::log_info("%s -> %s", __func__, result.name().c_str());
     trace_count++;
     return result;
 }
@@ -429,7 +618,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::ask_client_to_close(miral::Window const& window)
 try {
     log_input();
-    mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    if (!record(Call::ask_client_to_close, window))
+        mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
     trace_count++;
     wrapped.ask_client_to_close(window);
 }
@@ -439,7 +629,8 @@ auto miral::WindowManagementTrace::active_window() const -> Window
 try {
     log_input();
     auto result = wrapped.active_window();
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    if (!record(Call::active_window, result))
+        mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
     trace_count++;
     return result;
 }
@@ -449,7 +640,8 @@ auto miral::WindowManagementTrace::select_active_window(Window const& hint) -> W
 try {
     log_input();
     auto result = wrapped.select_active_window(hint);
-    mir::log_info("%s hint=%s -> %s", __func__, dump_of(hint).c_str(), dump_of(result).c_str());
+    if (!record(Call::select_active_window, hint, result))
+        mir::log_info("%s hint=%s -> %s", __func__, dump_of(hint).c_str(), dump_of(result).c_str());
     trace_count++;
     return result;
 }
@@ -459,9 +651,12 @@ auto miral::WindowManagementTrace::window_at(mir::geometry::Point cursor) const
 try {
     log_input();
     auto result = wrapped.window_at(cursor);
-    std::stringstream out;
-    out << cursor << " -> " << dump_of(result);
-    mir::log_info("%s cursor=%s", __func__, out.str().c_str());
+    if (!record(Call::window_at, cursor, result))
+    {
+        std::stringstream out;
+        out << cursor << " -> " << dump_of(result);
+        mir::log_info("%s cursor=%s", __func__, out.str().c_str());
+    }
     trace_count++;
     return result;
 }
@@ -471,9 +666,12 @@ auto miral::WindowManagementTrace::active_output() -> mir::geometry::Rectangle c
 try {
     log_input();
     auto result = wrapped.active_output();
-    std::stringstream out;
-    out << result;
-    mir::log_info("%s -> %s", __func__, out.str().c_str());
+    if (!record(Call::active_output, result))
+    {
+        std::stringstream out;
+        out << result;
+        mir::log_info("%s -> %s", __func__, out.str().c_str());
+    }
     trace_count++;
     return result;
 }
@@ -483,9 +681,12 @@ auto miral::WindowManagementTrace::active_application_zone() -> Zone
 try {
     log_input();
     auto result = wrapped.active_application_zone();
-    std::stringstream out;
-    out << result.extents();
-    mir::log_info("%s -> %s", __func__, out.str().c_str());
+    if (!record(Call::active_application_zone, result.extents()))
+    {
+        std::stringstream out;
+        out << result.extents();
+        mir::log_info("%s -> %s", __func__, out.str().c_str());
+    }
     trace_count++;
     return result;
 }
@@ -495,7 +696,8 @@ auto miral::WindowManagementTrace::info_for_window_id(std::string const& id) con
 try {
     log_input();
     auto& result = wrapped.info_for_window_id(id);
-    mir::log_info("%s id=%s -> %s", __func__, id.c_str(), dump_of(result).c_str());
+    if (!record(Call::info_for_window_id, result))
+        mir::log_info("%s id=%s -> %s", __func__, id.c_str(), dump_of(result).c_str());
     trace_count++;
     return result;
 }
@@ -505,7 +707,8 @@ auto miral::WindowManagementTrace::id_for_window(Window const& window) const ->
 try {
     log_input();
     auto result = wrapped.id_for_window(window);
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), result.c_str());
+    if (!record(Call::id_for_window, window))
+        mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), result.c_str());
     trace_count++;
     return result;
 }
@@ -515,7 +718,8 @@ void miral::WindowManagementTrace::place_and_size_for_state(
     WindowSpecification& modifications, WindowInfo const& window_info) const
 try {
     log_input();
-    mir::log_info("%s modifications=%s window_info=%s", __func__, dump_of(modifications).c_str(), dump_of(window_info).c_str());
+    if (!record(Call::place_and_size_for_state, window_info, modifications))
+        mir::log_info("%s modifications=%s window_info=%s", __func__, dump_of(modifications).c_str(), dump_of(window_info).c_str());
     wrapped.place_and_size_for_state(modifications, window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -523,9 +727,12 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::drag_active_window(mir::geometry::Displacement movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s movement=%s", __func__, out.str().c_str());
+    if (!record(Call::drag_active_window, movement))
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s movement=%s", __func__, out.str().c_str());
+    }
     trace_count++;
     wrapped.drag_active_window(movement);
 }
@@ -534,9 +741,12 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::drag_window(Window const& window, mir::geometry::Displacement& movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), out.str().c_str());
+    if (!record(Call::drag_window, window, movement))
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), out.str().c_str());
+    }
     trace_count++;
     wrapped.drag_window(window, movement);
 }
@@ -545,7 +755,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_next_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (!record(Call::focus_next_application))
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.focus_next_application();
 }
@@ -554,7 +765,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_prev_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (!record(Call::focus_prev_application))
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.focus_next_application();
 }
@@ -563,7 +775,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_next_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (!record(Call::focus_next_within_application))
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.focus_next_within_application();
 }
@@ -572,7 +785,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_prev_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (!record(Call::focus_prev_within_application))
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.focus_prev_within_application();
 }
@@ -581,7 +795,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::raise_tree(miral::Window const& root)
 try {
     log_input();
-    mir::log_info("%s root=%s", __func__, dump_of(root).c_str());
+    if (!record(Call::raise_tree, root))
+        mir::log_info("%s root=%s", __func__, dump_of(root).c_str());
     trace_count++;
     wrapped.raise_tree(root);
 }
@@ -590,7 +805,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::start_drag_and_drop(miral::WindowInfo& window_info, std::vector<uint8_t> const& handle)
 try {
     log_input();
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::start_drag_and_drop, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     trace_count++;
     wrapped.start_drag_and_drop(window_info, handle);
 }
@@ -599,7 +815,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::end_drag_and_drop()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (!record(Call::end_drag_and_drop))
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.end_drag_and_drop();
 }
@@ -609,8 +826,9 @@ void miral::WindowManagementTrace::modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
     log_input();
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    if (!record(Call::modify_window, window_info, modifications))
+        mir::log_info("%s window_info=%s, modifications=%s",
+                      __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
     trace_count++;
     wrapped.modify_window(window_info, modifications);
 }
@@ -618,14 +836,16 @@ MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::invoke_under_lock(std::function<void()> const& callback)
 try {
-    mir::log_info("%s", __func__);
+    if (!record(Call::invoke_under_lock))
+        mir::log_info("%s", __func__);
     wrapped.invoke_under_lock(callback);
 }
 MIRAL_TRACE_EXCEPTION
 
 auto miral::WindowManagementTrace::create_workspace() -> std::shared_ptr<Workspace>
 try {
-    mir::log_info("%s", __func__);
+    if (!record(Call::create_workspace))
+        mir::log_info("%s", __func__);
     return wrapped.create_workspace();
 }
 MIRAL_TRACE_EXCEPTION
@@ -633,7 +853,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::add_tree_to_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), static_cast<void*>(workspace.get()));
+    if (!record(Call::add_tree_to_workspace, window, workspace))
+        mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), static_cast<void*>(workspace.get()));
     wrapped.add_tree_to_workspace(window, workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -641,7 +862,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::remove_tree_from_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), static_cast<void*>(workspace.get()));
+    if (!record(Call::remove_tree_from_workspace, window, workspace))
+        mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), static_cast<void*>(workspace.get()));
     wrapped.remove_tree_from_workspace(window, workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -649,7 +871,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::move_workspace_content_to_workspace(
     std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
 try {
-    mir::log_info("%s to_workspace=%p, from_workspace=%p", __func__, static_cast<void*>(to_workspace.get()), static_cast<void*>(from_workspace.get()));
+    if (!record(Call::move_workspace_content_to_workspace, to_workspace, from_workspace))
+        mir::log_info("%s to_workspace=%p, from_workspace=%p", __func__, static_cast<void*>(to_workspace.get()), static_cast<void*>(from_workspace.get()));
     wrapped.move_workspace_content_to_workspace(to_workspace, from_workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -657,7 +880,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_workspace_containing(
     miral::Window const& window, std::function<void(std::shared_ptr<miral::Workspace> const&)> const& callback)
 try {
-    mir::log_info("%s window=%s", __func__, dump_of(window).c_str());
+    if (!record(Call::for_each_workspace_containing, window))
+        mir::log_info("%s window=%s", __func__, dump_of(window).c_str());
     wrapped.for_each_workspace_containing(window, callback);
 }
 MIRAL_TRACE_EXCEPTION
@@ -665,7 +889,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_window_in_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::function<void(miral::Window const&)> const& callback)
 try {
-    mir::log_info("%s workspace =%p", __func__, static_cast<void*>(workspace.get()));
+    if (!record(Call::for_each_window_in_workspace, workspace))
+        mir::log_info("%s workspace =%p", __func__, static_cast<void*>(workspace.get()));
     wrapped.for_each_window_in_workspace(workspace, callback);
 }
 MIRAL_TRACE_EXCEPTION
@@ -675,15 +900,17 @@ auto miral::WindowManagementTrace::place_new_window(
     WindowSpecification const& requested_specification) -> WindowSpecification
 try {
     auto const result = policy->place_new_window(app_info, requested_specification);
-    mir::log_info("%s app_info=%s, requested_specification=%s -> %s",
-              __func__, dump_of(app_info).c_str(), dump_of(requested_specification).c_str(), dump_of(result).c_str());
+    if (!record(Call::place_new_window, app_info, result))
+        mir::log_info("%s app_info=%s, requested_specification=%s -> %s",
+                  __func__, dump_of(app_info).c_str(), dump_of(requested_specification).c_str(), dump_of(result).c_str());
     return result;
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_window_ready(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::handle_window_ready, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->handle_window_ready(window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -691,26 +918,31 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::handle_modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    if (!record(Call::handle_modify_window, window_info, modifications))
+        mir::log_info("%s window_info=%s, modifications=%s",
+                      __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
     policy->handle_modify_window(window_info, modifications);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_raise_window(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::handle_raise_window, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->handle_raise_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 bool miral::WindowManagementTrace::handle_keyboard_event(MirKeyboardEvent const* event)
 try {
-    log_input = [event, this]
-        {
-            mir::log_info("handle_keyboard_event event=%s", dump_of(event).c_str());
-            log_input = []{};
-        };
+    if (!record(Call::handle_keyboard_event, event))
+    {
+        log_input = [event, this]
+            {
+                mir::log_info("handle_keyboard_event event=%s", dump_of(event).c_str());
+                log_input = []{};
+            };
+    }
 
     return policy->handle_keyboard_event(event);
 }
@@ -718,11 +950,14 @@ MIRAL_TRACE_EXCEPTION
 
 bool miral::WindowManagementTrace::handle_touch_event(MirTouchEvent const* event)
 try {
-    log_input = [event, this]
-        {
-            mir::log_info("handle_touch_event event=%s", dump_of(event).c_str());
-            log_input = []{};
-        };
+    if (!record(Call::handle_touch_event, event))
+    {
+        log_input = [event, this]
+            {
+                mir::log_info("handle_touch_event event=%s", dump_of(event).c_str());
+                log_input = []{};
+            };
+    }
 
     return policy->handle_touch_event(event);
 }
@@ -730,11 +965,14 @@ MIRAL_TRACE_EXCEPTION
 
 bool miral::WindowManagementTrace::handle_pointer_event(MirPointerEvent const* event)
 try {
-    log_input = [event, this]
-        {
-            mir::log_info("handle_pointer_event event=%s", dump_of(event).c_str());
-            log_input = []{};
-        };
+    if (!record(Call::handle_pointer_event, event))
+    {
+        log_input = [event, this]
+            {
+                mir::log_info("handle_pointer_event event=%s", dump_of(event).c_str());
+                log_input = []{};
+            };
+    }
 
     return policy->handle_pointer_event(event);
 }
@@ -743,9 +981,12 @@ MIRAL_TRACE_EXCEPTION
 auto miral::WindowManagementTrace::confirm_inherited_move(WindowInfo const& window_info, Displacement movement)
 -> Rectangle
 try {
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window_info=%s, movement=%s", __func__, dump_of(window_info).c_str(), out.str().c_str());
+    if (!record(Call::confirm_inherited_move, window_info, movement))
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s window_info=%s, movement=%s", __func__, dump_of(window_info).c_str(), out.str().c_str());
+    }
 
     return policy->confirm_inherited_move(window_info, movement);
 }
@@ -761,7 +1002,7 @@ MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_end()
 try {
-    if (trace_count.load() > 0)
+    if (trace_count.load() > 0 && !record(Call::advise_end))
         mir::log_info("====");
     policy->advise_end();
 }
@@ -769,84 +1010,96 @@ MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_new_app(miral::ApplicationInfo& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    if (!record(Call::advise_new_app, application))
+        mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
     policy->advise_new_app(application);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_delete_app(miral::ApplicationInfo const& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    if (!record(Call::advise_delete_app, application))
+        mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
     policy->advise_delete_app(application);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_new_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::advise_new_window, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->advise_new_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_focus_lost(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::advise_focus_lost, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->advise_focus_lost(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_focus_gained(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::advise_focus_gained, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->advise_focus_gained(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_state_change(miral::WindowInfo const& window_info, MirWindowState state)
 try {
-    mir::log_info("%s window_info=%s, state=%s", __func__, dump_of(window_info).c_str(), dump_of(state).c_str());
+    if (!record(Call::advise_state_change, window_info, state))
+        mir::log_info("%s window_info=%s, state=%s", __func__, dump_of(window_info).c_str(), dump_of(state).c_str());
     policy->advise_state_change(window_info, state);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_move_to(miral::WindowInfo const& window_info, mir::geometry::Point top_left)
 try {
-    mir::log_info("%s window_info=%s, top_left=%s", __func__, dump_of(window_info).c_str(), dump_of(top_left).c_str());
+    if (!record(Call::advise_move_to, window_info, top_left))
+        mir::log_info("%s window_info=%s, top_left=%s", __func__, dump_of(window_info).c_str(), dump_of(top_left).c_str());
     policy->advise_move_to(window_info, top_left);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_resize(miral::WindowInfo const& window_info, mir::geometry::Size const& new_size)
 try {
-    mir::log_info("%s window_info=%s, new_size=%s", __func__, dump_of(window_info).c_str(), dump_of(new_size).c_str());
+    if (!record(Call::advise_resize, window_info, new_size))
+        mir::log_info("%s window_info=%s, new_size=%s", __func__, dump_of(window_info).c_str(), dump_of(new_size).c_str());
     policy->advise_resize(window_info, new_size);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_delete_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::advise_delete_window, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->advise_delete_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_raise(std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(windows).c_str());
+    if (!record(Call::advise_raise, windows))
+        mir::log_info("%s window_info=%s", __func__, dump_of(windows).c_str());
     policy->advise_raise(windows);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_request_drag_and_drop(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::handle_request_drag_and_drop, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->handle_request_drag_and_drop(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_request_move(miral::WindowInfo& window_info, MirInputEvent const* input_event)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (!record(Call::handle_request_move, window_info))
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->handle_request_move(window_info, input_event);
 }
 MIRAL_TRACE_EXCEPTION
@@ -854,7 +1107,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::handle_request_resize(
     miral::WindowInfo& window_info, MirInputEvent const* input_event, MirResizeEdge edge)
 try {
-    mir::log_info("%s window_info=%s, edge=0x%1x", __func__, dump_of(window_info).c_str(), edge);
+    if (!record(Call::handle_request_resize, window_info, edge))
+        mir::log_info("%s window_info=%s, edge=0x%1x", __func__, dump_of(window_info).c_str(), edge);
     policy->handle_request_resize(window_info, input_event, edge);
 }
 MIRAL_TRACE_EXCEPTION
@@ -862,7 +1116,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::advise_adding_to_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s workspace=%p, windows=%s", __func__, static_cast<void*>(workspace.get()), dump_of(windows).c_str());
+    if (!record(Call::advise_adding_to_workspace, workspace, windows))
+        mir::log_info("%s workspace=%p, windows=%s", __func__, static_cast<void*>(workspace.get()), dump_of(windows).c_str());
     policy->advise_adding_to_workspace(workspace, windows);
 }
 MIRAL_TRACE_EXCEPTION
@@ -870,7 +1125,8 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::advise_removing_from_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s workspace=%p, windows=%s", __func__, static_cast<void*>(workspace.get()), dump_of(windows).c_str());
+    if (!record(Call::advise_removing_from_workspace, workspace, windows))
+        mir::log_info("%s workspace=%p, windows=%s", __func__, static_cast<void*>(workspace.get()), dump_of(windows).c_str());
     policy->advise_removing_from_workspace(workspace, windows);
 }
 MIRAL_TRACE_EXCEPTION
@@ -882,50 +1138,57 @@ auto miral::WindowManagementTrace::confirm_placement_on_display(
     Rectangle const& new_placement) -> Rectangle
 try {
     auto const& result = policy->confirm_placement_on_display(window_info, new_state, new_placement);
-    mir::log_info("%s window_info=%s, new_state= %s, new_placement= %s -> %s", __func__,
-        dump_of(window_info).c_str(), dump_of(new_state).c_str(), dump_of(new_placement).c_str(), dump_of(result).c_str());
+    if (!record(Call::confirm_placement_on_display, window_info, new_state, result))
+        mir::log_info("%s window_info=%s, new_state= %s, new_placement= %s -> %s", __func__,
+            dump_of(window_info).c_str(), dump_of(new_state).c_str(), dump_of(new_placement).c_str(), dump_of(result).c_str());
     return result;
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_output_create(Output const& output)
 try {
-    mir::log_info("%s output=%s", __func__, dump_of(output).c_str());
+    if (!record(Call::advise_output_create, output))
+        mir::log_info("%s output=%s", __func__, dump_of(output).c_str());
     return policy->advise_output_create(output);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_output_update(Output const& updated, Output const& original)
 try {
-    mir::log_info("%s updated=%s, original=%s", __func__, dump_of(updated).c_str(), dump_of(original).c_str());
+    if (!record(Call::advise_output_update, updated, original))
+        mir::log_info("%s updated=%s, original=%s", __func__, dump_of(updated).c_str(), dump_of(original).c_str());
     return policy->advise_output_update(updated, original);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_output_delete(Output const& output)
 try {
-    mir::log_info("%s output=%s", __func__, dump_of(output).c_str());
+    if (!record(Call::advise_output_delete, output))
+        mir::log_info("%s output=%s", __func__, dump_of(output).c_str());
     return policy->advise_output_delete(output);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_application_zone_create(Zone const& application_zone)
 try {
-    mir::log_info("%s application_zone=%s", __func__, dump_of(application_zone).c_str());
+    if (!record(Call::advise_application_zone_create, application_zone))
+        mir::log_info("%s application_zone=%s", __func__, dump_of(application_zone).c_str());
     return policy->advise_application_zone_create(application_zone);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_application_zone_update(Zone const& updated, Zone const& original)
 try {
-    mir::log_info("%s updated=%s, original=%s", __func__, dump_of(updated).c_str(), dump_of(original).c_str());
+    if (!record(Call::advise_application_zone_update, updated, original))
+        mir::log_info("%s updated=%s, original=%s", __func__, dump_of(updated).c_str(), dump_of(original).c_str());
     return policy->advise_application_zone_update(updated, original);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_application_zone_delete(Zone const& application_zone)
 try {
-    mir::log_info("%s application_zone=%s", __func__, dump_of(application_zone).c_str());
+    if (!record(Call::advise_application_zone_delete, application_zone))
+        mir::log_info("%s application_zone=%s", __func__, dump_of(application_zone).c_str());
     return policy->advise_application_zone_delete(application_zone);
 }
 MIRAL_TRACE_EXCEPTION
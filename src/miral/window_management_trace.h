@@ -26,15 +26,27 @@
 #include "miral/window_management_policy.h"
 
 #include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace miral
 {
+class WindowManagementTraceBuffer;
+
 class WindowManagementTrace
     : public WindowManagementPolicy,
       WindowManagerToolsImplementation
 {
 public:
-    WindowManagementTrace(WindowManagerTools const& wrapped, WindowManagementPolicyBuilder const& builder);
+    /// If \p binary_trace is supplied calls are recorded there instead of being logged
+    WindowManagementTrace(
+        WindowManagerTools const& wrapped,
+        WindowManagementPolicyBuilder const& builder,
+        std::shared_ptr<WindowManagementTraceBuffer> const& binary_trace = {});
+
+    /// The names of the calls recorded in a binary trace
+    static auto call_names() -> std::vector<std::string>;
 
 private:
     virtual auto count_applications() const -> unsigned int override;
@@ -168,8 +180,15 @@ public:
     void advise_application_zone_delete(Zone const& application_zone) override;
 
 private:
+    enum class Call : uint16_t;
+
+    /// Records the call in the binary trace (if any), returning false if it should be logged
+    template<typename... Args>
+    auto record(Call call, Args const&... args) const -> bool;
+
     WindowManagerTools wrapped;
     std::unique_ptr<miral::WindowManagementPolicy> const policy;
+    std::shared_ptr<WindowManagementTraceBuffer> const binary_trace;
     std::atomic<unsigned> mutable trace_count;
     std::function<void()> log_input;
 };
@@ -0,0 +1,246 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "window_management_trace_buffer.h"
+
+#include <mir/main_loop.h>
+#include <mir/server.h>
+#include <mir/options/option.h>
+
+#define MIR_LOG_COMPONENT "miral::Window Management"
+#include <mir/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+#include <csignal>
+#include <time.h>
+
+namespace
+{
+char const* const trace_file_option = "window-management-trace-file";
+char const* const trace_seconds_option = "window-management-trace-seconds";
+auto const default_trace_seconds = 30;
+auto const records_per_thread = 64*1024;
+
+char const magic[8] = {'M', 'I', 'R', 'A', 'L', 'W', 'M', 'T'};
+uint32_t const format_version = 1;
+
+std::atomic<uint64_t> next_generation{1};
+
+auto now() -> uint64_t
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec)*1000000000 + ts.tv_nsec;
+}
+
+auto round_up_to_power_of_two(std::size_t n) -> std::size_t
+{
+    std::size_t result = 1;
+    while (result < n) result <<= 1;
+    return result;
+}
+
+template<typename Type>
+void write(std::ostream& out, Type const& value)
+{
+    out.write(reinterpret_cast<char const*>(&value), sizeof value);
+}
+}
+
+/// A single producer ring: each slot is guarded by a sequence number that is
+/// odd while the slot is being written, so that readers can detect torn reads.
+struct miral::WindowManagementTraceBuffer::Ring
+{
+    Ring(std::size_t size, uint16_t thread) :
+        mask{size - 1},
+        thread{thread},
+        slots{new Slot[size]}
+    {
+    }
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{0};
+        WindowManagementTraceRecord record;
+    };
+
+    void push(WindowManagementTraceRecord const& record)
+    {
+        auto const n = next.load(std::memory_order_relaxed);
+        auto& slot = slots[n & mask];
+
+        slot.sequence.store(2*n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.record = record;
+        slot.sequence.store(2*n + 2, std::memory_order_release);
+
+        next.store(n + 1, std::memory_order_release);
+    }
+
+    void copy_since(uint64_t since, std::vector<WindowManagementTraceRecord>& out) const
+    {
+        auto const end = next.load(std::memory_order_acquire);
+        auto const begin = end > mask + 1 ? end - (mask + 1) : 0;
+
+        for (auto n = begin; n != end; ++n)
+        {
+            auto const& slot = slots[n & mask];
+
+            auto const before = slot.sequence.load(std::memory_order_acquire);
+            if (before != 2*n + 2)
+                continue;   // Overwritten already
+
+            WindowManagementTraceRecord copy;
+            std::memcpy(&copy, &slot.record, sizeof copy);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) != before)
+                continue;   // Overwritten while copying
+
+            if (copy.timestamp >= since)
+                out.push_back(copy);
+        }
+    }
+
+    uint64_t const mask;
+    uint16_t const thread;
+    std::unique_ptr<Slot[]> const slots;
+    std::atomic<uint64_t> next{0};
+};
+
+miral::WindowManagementTraceBuffer::WindowManagementTraceBuffer(
+    std::vector<std::string> call_names,
+    std::size_t records_per_ring) :
+    call_names{std::move(call_names)},
+    records_per_ring{round_up_to_power_of_two(records_per_ring)},
+    generation{next_generation++}
+{
+}
+
+miral::WindowManagementTraceBuffer::~WindowManagementTraceBuffer() = default;
+
+auto miral::WindowManagementTraceBuffer::ring_for_this_thread() -> Ring&
+{
+    // Buffers are identified by generation, not address, in case a buffer is
+    // destroyed and another created in its place
+    thread_local std::vector<std::pair<uint64_t, Ring*>> thread_rings;
+
+    for (auto const& thread_ring : thread_rings)
+    {
+        if (thread_ring.first == generation)
+            return *thread_ring.second;
+    }
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    rings.push_back(std::make_unique<Ring>(records_per_ring, static_cast<uint16_t>(rings.size())));
+    thread_rings.emplace_back(generation, rings.back().get());
+    return *rings.back();
+}
+
+void miral::WindowManagementTraceBuffer::record(uint16_t call, int64_t const* args, std::size_t arg_count)
+{
+    auto& ring = ring_for_this_thread();
+
+    WindowManagementTraceRecord record;
+    record.timestamp = now();
+    record.call = call;
+    record.thread = ring.thread;
+    record.arg_count = static_cast<uint16_t>(std::min(arg_count, WindowManagementTraceRecord::max_args));
+    record.reserved = 0;
+    std::fill(std::copy_n(args, record.arg_count, record.args), std::end(record.args), 0);
+
+    ring.push(record);
+}
+
+auto miral::WindowManagementTraceBuffer::snapshot(std::chrono::nanoseconds period) const
+-> std::vector<WindowManagementTraceRecord>
+{
+    auto const time_now = now();
+    auto const since = uint64_t(period.count()) < time_now ? time_now - period.count() : 0;
+
+    std::vector<WindowManagementTraceRecord> result;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        for (auto const& ring : rings)
+            ring->copy_since(since, result);
+    }
+
+    std::stable_sort(begin(result), end(result), [](auto const& lhs, auto const& rhs)
+        { return lhs.timestamp < rhs.timestamp; });
+
+    return result;
+}
+
+void miral::WindowManagementTraceBuffer::dump(std::ostream& out, std::chrono::nanoseconds period) const
+{
+    auto const records = snapshot(period);
+
+    out.write(magic, sizeof magic);
+    write(out, format_version);
+    write(out, uint32_t(sizeof(WindowManagementTraceRecord)));
+    write(out, uint32_t(call_names.size()));
+    for (auto const& name : call_names)
+        out.write(name.c_str(), name.size() + 1);
+
+    write(out, uint64_t(records.size()));
+    out.write(reinterpret_cast<char const*>(records.data()), records.size()*sizeof(WindowManagementTraceRecord));
+}
+
+void miral::add_binary_trace_options(mir::Server& server)
+{
+    server.add_configuration_option(
+        trace_file_option,
+        "write a binary window management trace to this file on SIGUSR2 (decode with decode_wm_trace.py)",
+        mir::OptionType::string);
+    server.add_configuration_option(
+        trace_seconds_option,
+        "period covered by the binary window management trace [seconds]",
+        default_trace_seconds);
+}
+
+auto miral::binary_trace_buffer_for(mir::Server& server, std::vector<std::string> call_names)
+-> std::shared_ptr<WindowManagementTraceBuffer>
+{
+    auto const options = server.get_options();
+
+    if (!options->is_set(trace_file_option))
+        return {};
+
+    auto const filename = options->get<std::string>(trace_file_option);
+    auto const period = std::chrono::seconds{options->get<int>(trace_seconds_option)};
+    auto const buffer = std::make_shared<WindowManagementTraceBuffer>(std::move(call_names), records_per_thread);
+
+    std::weak_ptr<WindowManagementTraceBuffer> const weak_buffer{buffer};
+    server.the_main_loop()->register_signal_handler({SIGUSR2}, [weak_buffer, filename, period](int)
+        {
+            if (auto const buffer = weak_buffer.lock())
+            {
+                std::ofstream out{filename, std::ios::binary | std::ios::trunc};
+                buffer->dump(out, period);
+
+                if (out)
+                    mir::log_info("Window management trace written to %s", filename.c_str());
+                else
+                    mir::log_warning("Failed to write window management trace to %s", filename.c_str());
+            }
+        });
+
+    return buffer;
+}
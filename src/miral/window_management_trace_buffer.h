@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIRAL_WINDOW_MANAGEMENT_TRACE_BUFFER_H
+#define MIRAL_WINDOW_MANAGEMENT_TRACE_BUFFER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mir { class Server; }
+
+namespace miral
+{
+/// A fixed size trace record: the meaning of the arguments depends on the call
+struct WindowManagementTraceRecord
+{
+    static constexpr std::size_t max_args = 6;
+
+    uint64_t timestamp;     ///< CLOCK_MONOTONIC nanoseconds
+    uint16_t call;          ///< Index into the call names written with the trace
+    uint16_t thread;        ///< Index of the recording thread
+    uint16_t arg_count;
+    uint16_t reserved;
+    int64_t args[max_args];
+};
+
+static_assert(sizeof(WindowManagementTraceRecord) == 64, "Trace records should fill a cache line");
+
+/**
+ * Holds the most recent trace records of each thread in a per-thread ring.
+ *
+ * Recording never blocks or allocates (after a thread's first record) so that
+ * tracing can be left enabled. The rings can be dumped at any time from any
+ * thread; records being overwritten while they are read are skipped.
+ */
+class WindowManagementTraceBuffer
+{
+public:
+    /// \param call_names       names of the calls, indexed by WindowManagementTraceRecord::call
+    /// \param records_per_ring rounded up to a power of two
+    WindowManagementTraceBuffer(std::vector<std::string> call_names, std::size_t records_per_ring);
+    ~WindowManagementTraceBuffer();
+
+    /// Record a call: at most WindowManagementTraceRecord::max_args arguments are kept
+    void record(uint16_t call, int64_t const* args, std::size_t arg_count);
+
+    /// The records from the last \p period, in timestamp order
+    auto snapshot(std::chrono::nanoseconds period) const -> std::vector<WindowManagementTraceRecord>;
+
+    /// Write the call names and the records from the last \p period (see tools/decode_wm_trace.py)
+    void dump(std::ostream& out, std::chrono::nanoseconds period) const;
+
+private:
+    struct Ring;
+
+    auto ring_for_this_thread() -> Ring&;
+
+    std::vector<std::string> const call_names;
+    std::size_t const records_per_ring;
+    uint64_t const generation;
+
+    std::mutex mutable mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+};
+
+/// Add the options controlling the binary trace
+void add_binary_trace_options(mir::Server& server);
+
+/// If the binary trace is requested, create a buffer that is dumped on SIGUSR2
+auto binary_trace_buffer_for(mir::Server& server, std::vector<std::string> call_names)
+-> std::shared_ptr<WindowManagementTraceBuffer>;
+}
+
+#endif //MIRAL_WINDOW_MANAGEMENT_TRACE_BUFFER_H
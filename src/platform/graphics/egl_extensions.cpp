@@ -207,3 +207,28 @@ mg::EGLExtensions::EXTImageDmaBufImportModifiers::EXTImageDmaBufImportModifiers(
             std::runtime_error{"EGL_EXT_image_dma_buf_import_modifiers not supported"}));
     }
 }
+
+mg::EGLExtensions::ANDROIDNativeFenceSync::ANDROIDNativeFenceSync(EGLDisplay dpy)
+    : eglCreateSyncKHR{
+        reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"))},
+      eglDestroySyncKHR{
+        reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"))},
+      eglWaitSyncKHR{
+        reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(eglGetProcAddress("eglWaitSyncKHR"))},
+      eglDupNativeFenceFDANDROID{
+        reinterpret_cast<PFNEGLDUPNATIVEFENCEFDANDROIDPROC>(eglGetProcAddress("eglDupNativeFenceFDANDROID"))}
+{
+    auto const egl_extensions = eglQueryString(dpy, EGL_EXTENSIONS);
+    if (!egl_extensions ||
+        !strstr(egl_extensions, "EGL_ANDROID_native_fence_sync") ||
+        !strstr(egl_extensions, "EGL_KHR_wait_sync"))
+    {
+        BOOST_THROW_EXCEPTION((
+            std::runtime_error{"EGL_ANDROID_native_fence_sync not supported"}));
+    }
+
+    if (!eglCreateSyncKHR || !eglDestroySyncKHR || !eglWaitSyncKHR || !eglDupNativeFenceFDANDROID)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"EGL_ANDROID_native_fence_sync functions are null"}));
+    }
+}
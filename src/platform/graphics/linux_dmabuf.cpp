@@ -29,6 +29,7 @@
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/buffer_basic.h"
 #include "mir/graphics/dmabuf_buffer.h"
+#include "mir/graphics/explicit_sync_buffer.h"
 #include "mir/executor.h"
 
 #define MIR_LOG_COMPONENT "linux-dmabuf-import"
@@ -41,8 +42,14 @@
 #include <mutex>
 #include <vector>
 #include <optional>
+#include <cerrno>
+#include <cstring>
 #include <drm_fourcc.h>
 #include <wayland-server.h>
+#include <linux/sync_file.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
 
 namespace mg = mir::graphics;
 namespace mw = mir::wayland;
@@ -874,22 +881,61 @@ bool drm_format_has_alpha(uint32_t format)
     }
 }
 
+auto fence_signalled(mir::Fd const& fence) -> bool
+{
+    pollfd signalled{fence, POLLIN, 0};
+    return poll(&signalled, 1, 0) > 0;
+}
+
+void wait_on_cpu(mir::Fd const& fence)
+{
+    pollfd signalled{fence, POLLIN, 0};
+    while (poll(&signalled, 1, -1) < 0 && errno == EINTR)
+    {
+    }
+}
+
+/// A fence signalled once both \a first and \a second are
+auto merge_fences(mir::Fd const& first, mir::Fd const& second) -> mir::Fd
+{
+    if (first == mir::Fd::invalid)
+    {
+        return second;
+    }
+
+    sync_merge_data merge{};
+    strncpy(merge.name, "mir-release", sizeof(merge.name) - 1);
+    merge.fd2 = second;
+    if (ioctl(first, SYNC_IOC_MERGE, &merge) < 0)
+    {
+        // Unlikely, but the client still mustn't see the buffer released early
+        mir::log_warning("Failed to merge release fences: %s", strerror(errno));
+        wait_on_cpu(first);
+        return second;
+    }
+    return mir::Fd{merge.fence};
+}
+
 class WaylandDmabufTexBuffer :
     public mg::BufferBasic,
     public mg::gl::Texture,
-    public mg::DMABufBuffer
+    public mg::DMABufBuffer,
+    public mg::ExplicitSyncBuffer
 {
 public:
     // Note: Must be called with a current EGL context
     WaylandDmabufTexBuffer(
         WlDmaBufBuffer& source,
         mg::EGLExtensions const& extensions,
+        std::shared_ptr<mg::EGLExtensions::ANDROIDNativeFenceSync const> fence_sync,
         std::shared_ptr<mir::renderer::gl::Context> ctx,
         EGLDisplay dpy,
         std::function<void()>&& on_consumed,
         std::function<void()>&& on_release,
         std::shared_ptr<mir::Executor> wayland_executor)
-        : ctx{std::move(ctx)},
+        : dpy{dpy},
+          fence_sync{std::move(fence_sync)},
+          ctx{std::move(ctx)},
           tex{get_tex_id()},
           desc{source.descriptor()},
           on_consumed{std::move(on_consumed)},
@@ -929,6 +975,11 @@ public:
               context->release_current();
             });
 
+        if (on_release_fence)
+        {
+            on_release_fence(release_fence);
+        }
+
         on_release();
     }
 
@@ -974,6 +1025,8 @@ public:
 
     void bind() override
     {
+        wait_for_acquire_fence();
+
         glBindTexture(desc.target, tex);
 
         std::lock_guard<decltype(consumed_mutex)> lock(consumed_mutex);
@@ -983,6 +1036,59 @@ public:
 
     void add_syncpoint() override
     {
+        {
+            std::lock_guard<decltype(fence_mutex)> lock{fence_mutex};
+            if (!on_release_fence)
+            {
+                // The client relies on implicit synchronisation
+                return;
+            }
+        }
+
+        if (fence_sync)
+        {
+            EGLint const attribs[] = {EGL_NONE};
+            if (auto const sync = fence_sync->eglCreateSyncKHR(dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
+                sync != EGL_NO_SYNC_KHR)
+            {
+                // The fence only gets an fd once the commands before it are flushed
+                glFlush();
+                mir::Fd fence{fence_sync->eglDupNativeFenceFDANDROID(dpy, sync)};
+                fence_sync->eglDestroySyncKHR(dpy, sync);
+
+                if (fence != mir::Fd::invalid)
+                {
+                    // One fence covers every draw so far, whichever compositors made them
+                    std::lock_guard<decltype(fence_mutex)> lock{fence_mutex};
+                    release_fence = merge_fences(release_fence, fence);
+                    return;
+                }
+            }
+        }
+
+        /* Without a fence to hand back, reading has to be finished before the client gets the buffer.
+         * This has to happen here, on the compositor's context: the last reference may be dropped on
+         * a thread without one (such as the Wayland thread, when a newer buffer replaces this).
+         */
+        glFinish();
+    }
+
+    void set_acquire_fence(mir::Fd fence) override
+    {
+        std::lock_guard<decltype(fence_mutex)> lock{fence_mutex};
+        acquire_fence = std::move(fence);
+    }
+
+    auto acquire_fence_signalled() const -> bool override
+    {
+        std::lock_guard<decltype(fence_mutex)> lock{fence_mutex};
+        return acquire_fence == mir::Fd::invalid || fence_signalled(acquire_fence);
+    }
+
+    void set_release_fence_handler(std::function<void(mir::Fd)> on_release) override
+    {
+        std::lock_guard<decltype(fence_mutex)> lock{fence_mutex};
+        on_release_fence = std::move(on_release);
     }
 
     auto drm_fourcc() const -> uint32_t override
@@ -1001,6 +1107,42 @@ public:
     }
 
 private:
+    /// Makes the current context wait for the client to finish drawing, preferably on the GPU
+    void wait_for_acquire_fence()
+    {
+        mir::Fd fence;
+        {
+            std::lock_guard<decltype(fence_mutex)> lock{fence_mutex};
+            fence = acquire_fence;
+        }
+
+        if (fence == mir::Fd::invalid || fence_signalled(fence))
+        {
+            return;
+        }
+
+        if (fence_sync)
+        {
+            // On success EGL takes ownership of the fd
+            EGLint const attribs[] = {EGL_SYNC_NATIVE_FENCE_FD_ANDROID, dup(fence), EGL_NONE};
+            if (attribs[1] >= 0)
+            {
+                if (auto const sync = fence_sync->eglCreateSyncKHR(dpy, EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
+                    sync != EGL_NO_SYNC_KHR)
+                {
+                    fence_sync->eglWaitSyncKHR(dpy, sync, 0);
+                    fence_sync->eglDestroySyncKHR(dpy, sync);
+                    return;
+                }
+                close(attribs[1]);
+            }
+        }
+
+        wait_on_cpu(fence);
+    }
+
+    EGLDisplay const dpy;
+    std::shared_ptr<mg::EGLExtensions::ANDROIDNativeFenceSync const> const fence_sync;
     std::shared_ptr<mir::renderer::gl::Context> const ctx;
     GLuint const tex;
     BufferGLDescription const& desc;
@@ -1009,6 +1151,11 @@ private:
     std::function<void()> on_consumed;
     std::function<void()> const on_release;
 
+    std::mutex mutable fence_mutex;
+    mir::Fd acquire_fence;
+    std::function<void(mir::Fd)> on_release_fence;
+    mir::Fd release_fence;      ///< Signalled once every draw that added a syncpoint has finished
+
     geom::Size const size_;
     Layout const layout_;
     bool const has_alpha;
@@ -1073,6 +1220,19 @@ mg::LinuxDmaBufUnstable::LinuxDmaBufUnstable(
     : mir::wayland::LinuxDmabufV1::Global(display, Version<3>{}),
       dpy{dpy},
       egl_extensions{std::move(egl_extensions)},
+      fence_sync{
+          [dpy]() -> std::shared_ptr<EGLExtensions::ANDROIDNativeFenceSync const>
+          {
+              try
+              {
+                  return std::make_shared<EGLExtensions::ANDROIDNativeFenceSync>(dpy);
+              }
+              catch (std::runtime_error const&)
+              {
+                  mir::log_info("No EGL_ANDROID_native_fence_sync: explicitly synchronised buffers wait on the CPU");
+                  return nullptr;
+              }
+          }()},
       formats{std::make_shared<DmaBufFormatDescriptors>(dpy, dmabuf_ext)}
 {
 }
@@ -1090,6 +1250,7 @@ auto mg::LinuxDmaBufUnstable::buffer_from_resource(
         return std::make_shared<WaylandDmabufTexBuffer>(
             *dmabuf,
             *egl_extensions,
+            fence_sync,
             std::move(ctx),
             dpy,
             std::move(on_consumed),
@@ -35,12 +35,16 @@ char const* const mo::input_report_opt            = "input-report";
 char const* const mo::seat_report_opt            = "seat-report";
 char const* const mo::shared_library_prober_report_opt = "shared-library-prober-report";
 char const* const mo::shell_report_opt            = "shell-report";
+char const* const mo::client_resource_report_opt  = "client-resource-report";
 char const* const mo::touchspots_opt              = "enable-touchspots";
 char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
+char const* const mo::gl_batched_draws_opt        = "gl-batched-draws";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
+char const* const mo::max_hidden_commit_rate_opt  = "max-hidden-commit-rate";
+char const* const mo::max_client_buffers_opt      = "max-client-buffers";
 char const* const mo::x11_display_opt             = "enable-x11";
 char const* const mo::x11_scale_opt               = "x11-scale";
 char const* const mo::wayland_extensions_opt      = "wayland-extensions";
@@ -55,6 +59,7 @@ char const* const mo::platform_display_libs = "platform-display-libs";
 char const* const mo::platform_rendering_libs = "platform-rendering-libs";
 char const* const mo::platform_input_lib = "platform-input-lib";
 char const* const mo::platform_path = "platform-path";
+char const* const mo::platform_probe_cache_opt = "platform-probe-cache";
 
 char const* const mo::console_provider = "console-provider";
 char const* const mo::logind_console = "logind";
@@ -150,6 +155,9 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Library to use for platform input support (default: input-stub.so)")
         (platform_path, po::value<std::string>()->default_value(MIR_SERVER_PLATFORM_PATH),
             "Directory to look for platform libraries (default: " MIR_SERVER_PLATFORM_PATH ")")
+        (platform_probe_cache_opt, po::value<std::string>(),
+            "File to remember the autodetected platform libraries in. If the libraries, "
+            "devices and options are unchanged the next start loads only those. (default: none)")
         (enable_input_opt, po::value<bool>()->default_value(enable_input_default),
             "Enable input.")
         (compositor_report_opt, po::value<std::string>()->default_value(off_opt_value),
@@ -168,11 +176,16 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "How to handle the SharedLibraryProber report. [{log,lttng,off}]")
         (shell_report_opt, po::value<std::string>()->default_value(off_opt_value),
          "How to handle the Shell report. [{log,off}]")
+        (client_resource_report_opt, po::value<std::string>()->default_value(off_opt_value),
+            "How to handle the client resource report. [{log,off}]")
         (composite_delay_opt, po::value<int>()->default_value(0),
             "Compositor frame delay in milliseconds (how long to wait for new "
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
             "Default: A negative value means decide automatically.")
+        (gl_batched_draws_opt, po::value<bool>()->default_value(false),
+            "Draw each frame from a single GL vertex buffer, grouping surfaces "
+            "that share GL state. Reduces driver overhead with many small surfaces.")
         (touchspots_opt,
             "Display visualization of touchspots (e.g. for screencasting).")
         (cursor_opt,
@@ -180,6 +193,13 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Cursor (mouse pointer) to use [{auto,null,software}]")
         (enable_key_repeat_opt, po::value<bool>()->default_value(true),
              "Enable server generated key repeat")
+        (max_hidden_commit_rate_opt, po::value<int>()->default_value(0),
+            "Most commits per second a client may make to hidden or occluded "
+            "surfaces before further buffers are released unseen. 0 means no limit.")
+        (max_client_buffers_opt, po::value<int>()->default_value(0),
+            "Most buffers a single client may have queued for the compositor "
+            "(committed but not yet consumed) before further buffers are "
+            "released unseen. Buffers being shown don't count. 0 means no limit.")
         (fatal_except_opt, "On \"fatal error\" conditions [e.g. drivers behaving "
             "in unexpected ways] throw an exception (instead of a core dump)")
         (debug_opt, "Enable extra development debugging. "
@@ -30,6 +30,7 @@
 #include <boost/throw_exception.hpp>
 #include <mutex>
 #include <atomic>
+#include <optional>
 
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
@@ -313,8 +314,10 @@ public:
         mir::geometry::Size const& size,
         mir::geometry::Stride stride,
         MirPixelFormat format,
+        mg::wayland::ShmRelease release,
         std::function<void()>&& on_consumed)
         : ShmBuffer(size, format, std::move(egl_delegate)),
+          release{release},
           on_consumed{std::move(on_consumed)},
           buffer{std::move(buffer)},
           stride_{stride}
@@ -335,6 +338,16 @@ public:
             on_consumed();
             on_consumed = [](){};
             uploaded = true;
+
+            /* glTexImage2D() has finished reading the client's memory when it
+             * returns, so the texture doesn't need it. Dropping our reference
+             * queues WL_BUFFER_RELEASE on the Wayland loop, without waiting for
+             * the frame to be posted, or for this buffer to be replaced.
+             */
+            if (release == mg::wayland::ShmRelease::after_upload)
+            {
+                buffer.reset();
+            }
         }
     }
 
@@ -346,12 +359,10 @@ public:
 
     void read(std::function<void(unsigned char const*)> const& do_with_pixels) override
     {
+        std::lock_guard<std::mutex> lock{consumption_mutex};
         read_internal(do_with_pixels);
-        {
-            std::lock_guard<std::mutex> lock{consumption_mutex};
-            on_consumed();
-            on_consumed = [](){};
-        }
+        on_consumed();
+        on_consumed = [](){};
     }
 
     mir::geometry::Stride stride() const override
@@ -360,9 +371,14 @@ public:
     }
 
 private:
+    /// \note Must be called with consumption_mutex held
     void read_internal(std::function<void(unsigned char const*)> const& do_with_pixels)
     {
-        if (auto const locked_buffer = buffer.lock())
+        if (!buffer)
+        {
+            mir::log_debug("Wayland buffer released to client after upload; CPU rendering will be incomplete");
+        }
+        else if (auto const locked_buffer = buffer->lock())
         {
             auto const shm_buffer = wl_shm_buffer_get(locked_buffer);
             wl_shm_buffer_begin_access(shm_buffer);
@@ -376,10 +392,11 @@ private:
         }
     }
 
+    mg::wayland::ShmRelease const release;
     std::mutex consumption_mutex;
     bool uploaded{false};
     std::function<void()> on_consumed;
-    SharedWlBuffer const buffer;
+    std::optional<SharedWlBuffer> buffer;
     mir::geometry::Stride const stride_;
 };
 
@@ -387,6 +404,7 @@ auto mg::wayland::buffer_from_wl_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> executor,
     std::shared_ptr<common::EGLContextExecutor> egl_delegate,
+    ShmRelease release,
     std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
 {
     auto const shm_buffer = wl_shm_buffer_get(buffer);
@@ -403,5 +421,6 @@ auto mg::wayland::buffer_from_wl_shm(
         },
         mir::geometry::Stride{wl_shm_buffer_get_stride(shm_buffer)},
         wl_format_to_mir_format(wl_shm_buffer_get_format(shm_buffer)),
+        release,
         std::move(on_consumed));
 }
@@ -40,6 +40,17 @@ class EGLContextExecutor;
 
 namespace wayland
 {
+/// When a SHM buffer is released to the client
+enum class ShmRelease
+{
+    /// As soon as its content has been copied to a texture. After that, it
+    /// can be rendered with GL, but reading it on the CPU finds no content.
+    after_upload,
+
+    /// Only once the mg::Buffer is destroyed, so it can be read at any time
+    when_destroyed
+};
+
 /**
  * Get a mir::graphics::Buffer with the content of the shm buffer.
  *
@@ -51,6 +62,7 @@ namespace wayland
  * \param buffer        [in]    The Wayland SHM buffer to import
  * \param executor      [in]    An Executor that will defer work to the Wayland event loop
  * \param egl_delegate  [in]    An EGL-context-thread delegator
+ * \param release       [in]    When the client can have the buffer back
  * \param on_consumed   [in]    Closure to call when the compositor has consumed this buffer
  * \return                      An mg::Buffer supporting being rendered from in GL and read by the CPU.
  */
@@ -58,6 +70,7 @@ auto buffer_from_wl_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> executor,
     std::shared_ptr<common::EGLContextExecutor> egl_delegate,
+    ShmRelease release,
     std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>;
 }
 }
@@ -566,5 +566,6 @@ auto mge::BufferAllocator::buffer_from_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
+        mg::wayland::ShmRelease::after_upload,
         std::move(on_consumed));
 }
@@ -135,7 +135,8 @@ mie::Platform::Platform(
     udev_context(std::move(udev_context)),
     input_device_registry(registry),
     console{console},
-    platform_dispatchable{std::make_shared<md::MultiplexingDispatchable>()}
+    // Only dispatched as a (sequential) source of the input manager's multiplexer
+    platform_dispatchable{std::make_shared<md::MultiplexingDispatchable>(md::DispatchThreading::single)}
 {
 }
 
@@ -389,5 +389,6 @@ auto mgg::BufferAllocator::buffer_from_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
+        mg::wayland::ShmRelease::after_upload,
         std::move(on_consumed));
 }
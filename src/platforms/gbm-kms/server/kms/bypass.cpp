@@ -43,6 +43,7 @@ bool mgg::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& r
     auto const is_opaque = !((renderable->alpha() != 1.0f) || renderable->shaped());
     auto const fits = (renderable->screen_position() == view_area);
     auto const is_orthogonal = (renderable->transformation() == identity);
-    bypass_is_feasible = (is_opaque && fits && is_orthogonal);
+    auto const is_uncropped = !renderable->src_bounds();
+    bypass_is_feasible = (is_opaque && fits && is_orthogonal && is_uncropped);
     return bypass_is_feasible;
 }
@@ -29,6 +29,7 @@
 #include "mir/graphics/egl_error.h"
 #include "mir/graphics/gl_config.h"
 #include "mir/graphics/dmabuf_buffer.h"
+#include "mir/graphics/explicit_sync_buffer.h"
 
 #include <boost/throw_exception.hpp>
 #include <EGL/egl.h>
@@ -535,8 +536,11 @@ bool mgg::DisplayBuffer::overlay(RenderableList const& renderable_list)
         {
             auto bypass_buffer = (*bypass_it)->buffer();
             auto dmabuf_image = dynamic_cast<mg::DMABufBuffer*>(bypass_buffer->native_buffer_base());
+            // Scanout can't wait for the client to finish drawing, but the renderer can
+            auto explicit_sync = dynamic_cast<mg::ExplicitSyncBuffer*>(bypass_buffer->native_buffer_base());
             if (dmabuf_image &&
-                bypass_buffer->size() == surface.size())
+                bypass_buffer->size() == surface.size() &&
+                (!explicit_sync || explicit_sync->acquire_fence_signalled()))
             {
                 if (auto bufobj = outputs.front()->fb_for(*dmabuf_image))
                 {
@@ -18,6 +18,7 @@
 
 #include "buffer_allocator.h"
 #include "shm_buffer.h"
+#include "client_buffers.h"
 #include "display.h"
 #include "egl_context_executor.h"
 #include "buffer_from_wl_shm.h"
@@ -34,6 +35,7 @@
 #include <boost/throw_exception.hpp>
 #include <boost/exception/errinfo_errno.hpp>
 
+#include <mutex>
 #include <system_error>
 
 namespace mg  = mir::graphics;
@@ -70,12 +72,29 @@ std::unique_ptr<mir::renderer::gl::Context> context_for_output(mg::Display const
                     << boost::throw_file(__FILE__));
     }
 }
+
+auto forwardable_buffers_of(mg::Display const& output) -> std::shared_ptr<mgw::ForwardableBuffers>
+{
+    if (auto const display = dynamic_cast<mgw::Display const*>(&output))
+    {
+        return display->forwardable_buffers();
+    }
+    return nullptr;
+}
+
+/// Lets both the renderer and the host report a buffer consumed, only the first report counting
+auto first_call_only(std::function<void()>&& f) -> std::function<void()>
+{
+    auto const flag = std::make_shared<std::once_flag>();
+    return [flag, f = std::move(f)]() { std::call_once(*flag, f); };
+}
 }
 
 mgw::BufferAllocator::BufferAllocator(graphics::Display const& output) :
     egl_extensions(std::make_shared<mg::EGLExtensions>()),
     ctx{context_for_output(output)},
-    egl_delegate{std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))}
+    egl_delegate{std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
+    forwardable{forwardable_buffers_of(output)}
 {
 }
 
@@ -98,6 +117,17 @@ std::vector<MirPixelFormat> mgw::BufferAllocator::supported_pixel_formats()
 
 void mgw::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Executor> wayland_executor)
 {
+    if (forwardable)
+    {
+        shm_pools = std::unique_ptr<ShmPools, std::function<void(ShmPools*)>>(
+            new ShmPools{display},
+            [wayland_executor](ShmPools* pools)
+            {
+                // As with the dmabuf global, this must be destroyed on the Wayland thread
+                wayland_executor->spawn([pools]() { delete pools; });
+            });
+    }
+
     auto context_guard = mir::raii::paired_calls(
         [this]() { ctx->make_current(); },
         [this]() { ctx->release_current(); });
@@ -159,6 +189,8 @@ void mgw::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
 
 void mgw::BufferAllocator::unbind_display(wl_display* display)
 {
+    shm_pools.reset();
+
     if (egl_display_bound)
     {
         auto context_guard = mir::raii::paired_calls(
@@ -179,6 +211,11 @@ auto mgw::BufferAllocator::buffer_from_resource(
         [this]() { ctx->make_current(); },
         [this]() { ctx->release_current(); });
 
+    if (forwardable)
+    {
+        on_consumed = first_call_only(std::move(on_consumed));
+    }
+
     if (auto dmabuf = dmabuf_extension->buffer_from_resource(
         buffer,
         ctx,
@@ -186,6 +223,10 @@ auto mgw::BufferAllocator::buffer_from_resource(
         std::function<void()>{on_release},
         wayland_executor))
     {
+        if (forwardable)
+        {
+            forwardable->add(dmabuf, {std::nullopt, std::move(on_consumed)});
+        }
         return dmabuf;
     }
     return mg::wayland::buffer_from_resource(
@@ -202,9 +243,26 @@ auto mgw::BufferAllocator::buffer_from_shm(
     std::shared_ptr<Executor> wayland_executor,
     std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
 {
-    return mg::wayland::buffer_from_wl_shm(
+    auto const slice = shm_pools ? ShmPools::slice_of(buffer) : std::nullopt;
+    if (!slice)
+    {
+        return mg::wayland::buffer_from_wl_shm(
+            buffer,
+            std::move(wayland_executor),
+            egl_delegate,
+            mg::wayland::ShmRelease::after_upload,
+            std::move(on_consumed));
+    }
+
+    // The host may be given the client's memory to read, so the client can't have it back early
+    auto const consumed = first_call_only(std::move(on_consumed));
+    auto const result = mg::wayland::buffer_from_wl_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
-        std::move(on_consumed));
+        mg::wayland::ShmRelease::when_destroyed,
+        std::function<void()>{consumed});
+
+    forwardable->add(result, {slice, consumed});
+    return result;
 }
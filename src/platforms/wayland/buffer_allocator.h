@@ -39,6 +39,9 @@ class EGLContextExecutor;
 
 namespace wayland
 {
+class ForwardableBuffers;
+class ShmPools;
+
 class BufferAllocator: public GraphicBufferAllocator
 {
 public:
@@ -68,6 +71,8 @@ private:
     std::unique_ptr<LinuxDmaBufUnstable, std::function<void(LinuxDmaBufUnstable*)>> dmabuf_extension;
     std::shared_ptr<common::EGLContextExecutor> const egl_delegate;
     bool egl_display_bound{false};
+    std::shared_ptr<ForwardableBuffers> const forwardable;  ///< Null if the Display can't show client buffers itself
+    std::unique_ptr<ShmPools, std::function<void(ShmPools*)>> shm_pools;
 };
 }
 }
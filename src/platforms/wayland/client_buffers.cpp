@@ -0,0 +1,187 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_buffers.h"
+
+#include <mir/graphics/buffer.h>
+
+#include <wayland-server-core.h>
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace mgw = mir::graphics::wayland;
+
+namespace
+{
+/// The pools and buffers one client has created
+struct ClientShm
+{
+    std::unordered_map<uint32_t, mir::Fd> pools;           ///< By wl_shm_pool id
+    std::unordered_map<uint32_t, mgw::ShmSlice> buffers;    ///< By wl_buffer id
+};
+
+/// Frees a ClientShm with its client
+struct ClientShmHolder
+{
+    wl_listener destruction_listener;
+    ClientShm* shm;
+};
+
+static_assert(
+    std::is_standard_layout<ClientShmHolder>::value,
+    "ClientShmHolder must be Standard Layout for wl_container_of to be defined behaviour");
+
+void on_client_destroyed(wl_listener* listener, void*)
+{
+    ClientShmHolder* holder;
+    holder = wl_container_of(listener, holder, destruction_listener);
+    delete holder->shm;
+    delete holder;
+}
+
+auto existing_shm_of(wl_client* client) -> ClientShm*
+{
+    if (auto const listener = wl_client_get_destroy_listener(client, &on_client_destroyed))
+    {
+        ClientShmHolder* holder;
+        holder = wl_container_of(listener, holder, destruction_listener);
+        return holder->shm;
+    }
+    return nullptr;
+}
+
+auto shm_of(wl_client* client) -> ClientShm*
+{
+    if (auto const shm = existing_shm_of(client))
+    {
+        return shm;
+    }
+
+    auto const holder = new ClientShmHolder{{}, new ClientShm};
+    holder->destruction_listener.notify = &on_client_destroyed;
+    wl_client_add_destroy_listener(client, &holder->destruction_listener);
+    return holder->shm;
+}
+
+auto is_request(wl_protocol_logger_message const* message, char const* interface, int opcode) -> bool
+{
+    return message->message_opcode == opcode && strcmp(wl_resource_get_class(message->resource), interface) == 0;
+}
+
+void track_shm_requests(void*, wl_protocol_logger_type direction, wl_protocol_logger_message const* message)
+{
+    if (direction != WL_PROTOCOL_LOGGER_REQUEST)
+    {
+        return;
+    }
+
+    auto const client = wl_resource_get_client(message->resource);
+    auto const args = message->arguments;
+
+    if (is_request(message, "wl_shm", 0))                   // create_pool(id, fd, size)
+    {
+        // The fd is still open, as libwayland only closes it once the request has been handled
+        mir::Fd const fd{fcntl(args[1].h, F_DUPFD_CLOEXEC, 0)};
+        if (fd >= 0)
+        {
+            shm_of(client)->pools[args[0].n] = fd;
+        }
+    }
+    else if (is_request(message, "wl_shm_pool", 0))         // create_buffer(id, offset, width, height, stride, format)
+    {
+        if (auto const shm = existing_shm_of(client))
+        {
+            auto const pool = shm->pools.find(wl_resource_get_id(message->resource));
+            if (pool != shm->pools.end())
+            {
+                shm->buffers[args[0].n] = mgw::ShmSlice{pool->second, args[1].i, args[4].i, args[5].u};
+            }
+        }
+    }
+    else if (is_request(message, "wl_shm_pool", 1))         // destroy()
+    {
+        if (auto const shm = existing_shm_of(client))
+        {
+            // Buffers keep their own reference to the pool's fd
+            shm->pools.erase(wl_resource_get_id(message->resource));
+        }
+    }
+    else if (is_request(message, "wl_buffer", 0))           // destroy()
+    {
+        if (auto const shm = existing_shm_of(client))
+        {
+            shm->buffers.erase(wl_resource_get_id(message->resource));
+        }
+    }
+}
+}
+
+mgw::ShmPools::ShmPools(wl_display* display) :
+    logger{wl_display_add_protocol_logger(display, &track_shm_requests, nullptr)}
+{
+}
+
+mgw::ShmPools::~ShmPools()
+{
+    // Clients keep what has been tracked for them until they're destroyed
+    wl_protocol_logger_destroy(logger);
+}
+
+auto mgw::ShmPools::slice_of(wl_resource* buffer) -> std::optional<ShmSlice>
+{
+    if (auto const shm = existing_shm_of(wl_resource_get_client(buffer)))
+    {
+        auto const slice = shm->buffers.find(wl_resource_get_id(buffer));
+        if (slice != shm->buffers.end())
+        {
+            return slice->second;
+        }
+    }
+    return std::nullopt;
+}
+
+void mgw::ForwardableBuffers::add(std::shared_ptr<Buffer> const& buffer, Source source)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (sources.size() >= prune_at)
+    {
+        for (auto i = sources.begin(); i != sources.end();)
+        {
+            i = i->second.first.expired() ? sources.erase(i) : std::next(i);
+        }
+        prune_at = std::max(size_t{16}, 2 * sources.size());
+    }
+
+    sources[buffer.get()] = std::make_pair(buffer, std::move(source));
+}
+
+auto mgw::ForwardableBuffers::find(Buffer const& buffer) const -> std::optional<Source>
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    // A buffer can be allocated where an expired one was, without being added
+    auto const source = sources.find(&buffer);
+    if (source == sources.end() || source->second.first.lock().get() != &buffer)
+    {
+        return std::nullopt;
+    }
+    return source->second.second;
+}
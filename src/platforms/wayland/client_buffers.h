@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_WAYLAND_CLIENT_BUFFERS_H_
+#define MIR_GRAPHICS_WAYLAND_CLIENT_BUFFERS_H_
+
+#include <mir/fd.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+struct wl_display;
+struct wl_resource;
+struct wl_protocol_logger;
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+
+namespace wayland
+{
+/// Where a client's wl_shm buffer is in the memory of the pool it was created from
+struct ShmSlice
+{
+    Fd pool;
+    int32_t offset;
+    int32_t stride;
+    uint32_t format;    ///< A wl_shm format
+};
+
+/**
+ * Keeps the fds clients create their wl_shm pools with.
+ *
+ * libwayland closes these once it has mapped a pool, so they're dup()ed from
+ * each create_pool request as it is dispatched. With them, the host can be
+ * given a client's memory rather than a copy of it.
+ */
+class ShmPools
+{
+public:
+    /// \note This must not be created while \p display is being dispatched
+    explicit ShmPools(wl_display* display);
+
+    /// \note This must be destroyed on the Wayland thread
+    ~ShmPools();
+
+    ShmPools(ShmPools const&) = delete;
+    ShmPools& operator=(ShmPools const&) = delete;
+
+    /**
+     * Where \p buffer is in its pool, if the pool was created while this was tracking
+     *
+     * \note This must be called on the Wayland thread
+     */
+    static auto slice_of(wl_resource* buffer) -> std::optional<ShmSlice>;
+
+private:
+    wl_protocol_logger* const logger;
+};
+
+/**
+ * The client buffers the host could show itself, rather than have them composited.
+ *
+ * These are recorded as they're imported, on the Wayland thread, and looked
+ * up by the compositor threads deciding what to overlay.
+ */
+class ForwardableBuffers
+{
+public:
+    struct Source
+    {
+        std::optional<ShmSlice> shm;        ///< Unset for a dmabuf
+        std::function<void()> consumed;     ///< To call once the host has been given the buffer
+    };
+
+    void add(std::shared_ptr<Buffer> const& buffer, Source source);
+
+    auto find(Buffer const& buffer) const -> std::optional<Source>;
+
+private:
+    std::mutex mutable mutex;
+    std::unordered_map<Buffer const*, std::pair<std::weak_ptr<Buffer>, Source>> sources;
+    size_t prune_at{16};
+};
+}
+}
+}
+
+#endif // MIR_GRAPHICS_WAYLAND_CLIENT_BUFFERS_H_
@@ -194,6 +194,11 @@ auto mgw::Display::create_gl_context() const -> std::unique_ptr<mrg::Context>
     return std::make_unique<GlContext>(egldisplay, eglconfig, eglctx);
 }
 
+auto mgw::Display::forwardable_buffers() const -> std::shared_ptr<ForwardableBuffers>
+{
+    return forwardable;
+}
+
 void mgw::Display::for_each_display_sync_group(const std::function<void(DisplaySyncGroup&)>& f)
 {
     DisplayClient::for_each_display_sync_group(f);
@@ -96,6 +96,9 @@ public:
 
     auto create_gl_context() const -> std::unique_ptr<mir::renderer::gl::Context> override;
 
+    /// The client buffers the outputs can pass through to the host, rather than composite
+    auto forwardable_buffers() const -> std::shared_ptr<ForwardableBuffers>;
+
 private:
 
     void keyboard_key(wl_keyboard* keyboard, uint32_t serial, uint32_t time, uint32_t key, uint32_t state) override;
@@ -16,13 +16,25 @@
  */
 
 #include "displayclient.h"
+#include "client_buffers.h"
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
 #include "mir/graphics/egl_error.h"
+#include <mir/fd.h>
+#include <mir/graphics/buffer.h>
+#include <mir/graphics/dmabuf_buffer.h>
+#include <mir/graphics/explicit_sync_buffer.h>
 #include <mir/graphics/pixel_format_utils.h>
+#include <mir/graphics/renderable.h>
+#include <mir/graphics/texture.h>
 
 #include <wayland-client.h>
 #include <wayland-egl.h>
+#include <drm_fourcc.h>
+
+#include <GLES2/gl2.h>
 
 #include <fcntl.h>
+#include <unistd.h>
 #include <sys/mman.h>
 #include <xkbcommon/xkbcommon.h>
 
@@ -31,11 +43,291 @@
 #include <algorithm>
 #include <condition_variable>
 #include <cstring>
+#include <optional>
 #include <stdlib.h>
 #include <system_error>
+#include <tuple>
 
+namespace mg = mir::graphics;
 namespace mgw = mir::graphics::wayland;
 
+namespace
+{
+auto is_host_shm_format(uint32_t format) -> bool
+{
+    // The host is only guaranteed to support these
+    return format == WL_SHM_FORMAT_ARGB8888 || format == WL_SHM_FORMAT_XRGB8888;
+}
+
+/// A host wl_buffer made from a client's memory: a slice of its shm pool, or its dmabufs
+class HostBuffer
+{
+public:
+    /// The client memory a host buffer is made from: (fd, offset, stride, format, size)
+    using Memory = std::tuple<int, int32_t, int32_t, uint32_t, mir::geometry::Size>;
+
+    static auto memory_of(mgw::ShmSlice const& slice, mir::geometry::Size size) -> Memory
+    {
+        return Memory{slice.pool, slice.offset, slice.stride, slice.format, size};
+    }
+
+    static auto memory_of(mg::DMABufBuffer const& dmabuf) -> Memory
+    {
+        auto const& plane = dmabuf.planes().front();
+        return Memory{plane.dma_buf, plane.offset, plane.stride, dmabuf.drm_fourcc(), dmabuf.size()};
+    }
+
+    HostBuffer(wl_shm* shm, mgw::ShmSlice const& slice, mir::geometry::Size size) :
+        memory{memory_of(slice, size)},
+        fd{slice.pool}
+    {
+        // The pool only needs to reach the end of this buffer
+        auto const pool = wl_shm_create_pool(shm, fd, slice.offset + slice.stride * size.height.as_int());
+        buffer = wl_shm_pool_create_buffer(
+            pool, slice.offset, size.width.as_int(), size.height.as_int(), slice.stride, slice.format);
+        wl_shm_pool_destroy(pool);
+
+        add_listener();
+    }
+
+    HostBuffer(zwp_linux_dmabuf_v1* linux_dmabuf, mg::DMABufBuffer const& dmabuf, uint32_t flags) :
+        memory{memory_of(dmabuf)},
+        fd{dmabuf.planes().front().dma_buf}
+    {
+        auto const params = zwp_linux_dmabuf_v1_create_params(linux_dmabuf);
+        auto const modifier = dmabuf.modifier().value_or(DRM_FORMAT_MOD_INVALID);
+        auto const& planes = dmabuf.planes();
+        for (auto i = 0u; i != planes.size(); ++i)
+        {
+            zwp_linux_buffer_params_v1_add(
+                params, planes[i].dma_buf, i, planes[i].offset, planes[i].stride, modifier >> 32, modifier & 0xffffffff);
+        }
+
+        // The host has listed this format and modifier, so doesn't fail the import for those
+        auto const size = dmabuf.size();
+        buffer = zwp_linux_buffer_params_v1_create_immed(
+            params, size.width.as_int(), size.height.as_int(), dmabuf.drm_fourcc(), flags);
+        zwp_linux_buffer_params_v1_destroy(params);
+
+        add_listener();
+    }
+
+    ~HostBuffer()
+    {
+        wl_buffer_destroy(buffer);
+    }
+
+    HostBuffer(HostBuffer const&) = delete;
+    HostBuffer& operator=(HostBuffer const&) = delete;
+
+    /// Attach to \p surface, keeping \p client_buffer until the host is done reading it
+    void attach(wl_surface* surface, std::shared_ptr<mg::Buffer> client_buffer)
+    {
+        {
+            std::lock_guard<decltype(mutex)> lock{mutex};
+            shown = std::move(client_buffer);
+        }
+        wl_surface_attach(surface, buffer, 0, 0);
+    }
+
+    auto idle() const -> bool
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        return !shown;
+    }
+
+    Memory const memory;
+
+private:
+    void add_listener()
+    {
+        static wl_buffer_listener const buffer_listener{
+            [](void* data, wl_buffer*) { static_cast<HostBuffer*>(data)->released(); }
+        };
+        wl_buffer_add_listener(buffer, &buffer_listener, this);
+    }
+
+    void released()
+    {
+        std::shared_ptr<mg::Buffer> released_buffer;
+        {
+            std::lock_guard<decltype(mutex)> lock{mutex};
+            released_buffer = std::move(shown);
+        }
+        // Dropping the client's buffer (outside the lock) lets the client have it back
+    }
+
+    mir::Fd const fd;   ///< Keeps the fd number in memory from being reused while this exists
+    wl_buffer* buffer;
+
+    std::mutex mutable mutex;
+    std::shared_ptr<mg::Buffer> shown;  ///< Set while the host may be reading the client's buffer
+};
+
+struct FrameSync
+{
+    explicit FrameSync(wl_surface* surface) :
+        callback{wl_surface_frame(surface)}
+    {
+        static struct wl_callback_listener const frame_listener =
+            {
+                [](void* data, auto... args)
+                    { static_cast<FrameSync*>(data)->frame_done(args...); },
+            };
+
+        wl_callback_add_listener(callback, &frame_listener, this);
+    }
+
+    ~FrameSync()
+    {
+        wl_callback_destroy(callback);
+    }
+
+    void frame_done(wl_callback*, uint32_t)
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        posted = true;
+        cv.notify_all();
+    }
+
+    void wait_for_done()
+    {
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        cv.wait(lock, [this]{ return posted; });
+    }
+
+    std::mutex mutex;
+    bool posted = false;
+    std::condition_variable cv;
+
+    wl_callback* const callback;
+};
+}
+
+/// A host wl_subsurface showing a client buffer that didn't need compositing
+class mgw::DisplayClient::Subsurface
+{
+public:
+    Subsurface(DisplayClient const* owner, wl_surface* parent) :
+        surface{wl_compositor_create_surface(owner->compositor)},
+        owner{owner},
+        subsurface{wl_subcompositor_get_subsurface(owner->subcompositor, surface, parent)}
+    {
+        // Input is handled by the parent surface
+        auto const empty_region = wl_compositor_create_region(owner->compositor);
+        wl_surface_set_input_region(surface, empty_region);
+        wl_region_destroy(empty_region);
+    }
+
+    ~Subsurface()
+    {
+        wl_subsurface_destroy(subsurface);
+        wl_surface_destroy(surface);
+    }
+
+    Subsurface(Subsurface const&) = delete;
+    Subsurface& operator=(Subsurface const&) = delete;
+
+    /// Update the (synchronized) subsurface state; this is applied by the next commit of the parent
+    void update(
+        Renderable const& renderable,
+        ForwardableBuffers::Source const& source,
+        geometry::Displacement offset,
+        wl_surface* below)
+    {
+        auto const buffer = renderable.buffer();
+        auto const position = renderable.screen_position().top_left - offset;
+
+        wl_subsurface_set_position(subsurface, position.x.as_int(), position.y.as_int());
+        wl_subsurface_place_above(subsurface, below);
+
+        if (buffer->id() != last_buffer_id || hidden)
+        {
+            auto const size = buffer->size();
+
+            host_buffer_for(*buffer, source)->attach(surface, buffer);
+            wl_surface_damage(surface, 0, 0, size.width.as_int(), size.height.as_int());
+            source.consumed();
+
+            last_buffer_id = buffer->id();
+            hidden = false;
+        }
+
+        wl_surface_commit(surface);
+    }
+
+    void hide()
+    {
+        if (!hidden)
+        {
+            wl_surface_attach(surface, nullptr, 0, 0);
+            wl_surface_commit(surface);
+            hidden = true;
+        }
+    }
+
+    wl_surface* const surface;
+
+private:
+    /// Host buffers kept, when idle, for a client cycling through its buffers
+    static size_t const max_idle_host_buffers{3};
+
+    auto host_buffer_for(Buffer& buffer, ForwardableBuffers::Source const& source) -> HostBuffer*
+    {
+        auto const dmabuf = dynamic_cast<DMABufBuffer*>(buffer.native_buffer_base());
+        auto const memory = source.shm ?
+            HostBuffer::memory_of(*source.shm, buffer.size()) :
+            HostBuffer::memory_of(*dmabuf);
+
+        auto const reusable = std::find_if(begin(host_buffers), end(host_buffers),
+            [&](auto const& b) { return b->memory == memory && b->idle(); });
+
+        std::unique_ptr<HostBuffer> host_buffer;
+        if (reusable != end(host_buffers))
+        {
+            host_buffer = std::move(*reusable);
+            host_buffers.erase(reusable);
+        }
+        else if (source.shm)
+        {
+            host_buffer = std::make_unique<HostBuffer>(owner->shm, *source.shm, buffer.size());
+        }
+        else
+        {
+            // Y-inverted client buffers stay so for the host
+            auto const texture = dynamic_cast<gl::Texture*>(&buffer);
+            auto const flags = texture && texture->layout() == gl::Texture::Layout::TopRowFirst ?
+                ZWP_LINUX_BUFFER_PARAMS_V1_FLAGS_Y_INVERT : 0;
+            host_buffer = std::make_unique<HostBuffer>(owner->linux_dmabuf, *dmabuf, flags);
+        }
+
+        // Most recently used last, so the least recently used idle buffers go first
+        host_buffers.push_back(std::move(host_buffer));
+
+        auto idle = std::count_if(begin(host_buffers), end(host_buffers), [](auto const& b) { return b->idle(); });
+        for (auto b = begin(host_buffers); idle > static_cast<long>(max_idle_host_buffers);)
+        {
+            if ((*b)->idle())
+            {
+                b = host_buffers.erase(b);
+                --idle;
+            }
+            else
+            {
+                ++b;
+            }
+        }
+
+        return host_buffers.back().get();
+    }
+
+    DisplayClient const* const owner;
+    wl_subsurface* const subsurface;
+    std::vector<std::unique_ptr<HostBuffer>> host_buffers;
+    BufferID last_buffer_id;
+    bool hidden{true};
+};
+
 class mgw::DisplayClient::Output  :
     public DisplaySyncGroup,
     public renderer::gl::RenderTarget,
@@ -103,6 +395,7 @@ public:
     // DisplayBuffer implementation
     auto view_area() const -> geometry::Rectangle override;
     bool overlay(RenderableList const& renderlist) override;
+    bool overlay_top(RenderableList& renderlist) override;
     auto transformation() const -> glm::mat2 override;
     auto native_display_buffer() -> NativeDisplayBuffer* override;
 
@@ -111,6 +404,20 @@ public:
     void release_current() override;
     void swap_buffers() override;
     void bind() override;
+
+private:
+    using Forwarded = std::vector<std::pair<std::shared_ptr<Renderable>, ForwardableBuffers::Source>>;
+
+    auto forwardable(Renderable const& renderable) const -> std::optional<ForwardableBuffers::Source>;
+    auto host_can_import(Buffer& buffer) const -> bool;
+    void place_subsurfaces(Forwarded const& forwarded);
+    void hide_subsurfaces();
+    void commit_and_wait_for_frame();
+
+    // Client buffers passed through to the host, keyed by Renderable::ID
+    std::unordered_map<Renderable::ID, std::unique_ptr<Subsurface>> subsurfaces;
+    bool placed_this_frame{false};  ///< Whether subsurfaces were placed for the next commit of the parent
+    bool parent_cleared{false};     ///< Whether the parent surface shows nothing composited
 };
 
 namespace
@@ -328,11 +635,139 @@ auto mgw::DisplayClient::Output::view_area() const -> geometry::Rectangle
     return dcout.extents();
 }
 
-bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const&)
+auto mgw::DisplayClient::Output::forwardable(Renderable const& renderable) const
+    -> std::optional<ForwardableBuffers::Source>
+{
+    // Without wp_viewporter the host can't scale, and subsurfaces can't be rotated or blended
+    auto const buffer = renderable.buffer();
+    if (renderable.alpha() != 1.0f ||
+        renderable.transformation() != glm::mat4{1} ||
+        renderable.clip_area() ||
+        renderable.src_bounds() ||
+        renderable.screen_position().size != buffer->size() ||
+        !view_area().contains(renderable.screen_position()))
+    {
+        return std::nullopt;
+    }
+
+    auto source = owner->forwardable->find(*buffer);
+    if (!source ||
+        (source->shm && !is_host_shm_format(source->shm->format)) ||
+        (!source->shm && !host_can_import(*buffer)))
+    {
+        return std::nullopt;
+    }
+
+    return source;
+}
+
+auto mgw::DisplayClient::Output::host_can_import(Buffer& buffer) const -> bool
+{
+    auto const dmabuf = dynamic_cast<DMABufBuffer*>(buffer.native_buffer_base());
+    // The host can't wait for the client to finish drawing, but the renderer can
+    auto const explicit_sync = dynamic_cast<ExplicitSyncBuffer*>(buffer.native_buffer_base());
+
+    return dmabuf &&
+        owner->linux_dmabuf &&
+        (!explicit_sync || explicit_sync->acquire_fence_signalled()) &&
+        owner->host_dmabuf_formats.count({dmabuf->drm_fourcc(), dmabuf->modifier().value_or(DRM_FORMAT_MOD_INVALID)});
+}
+
+bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const& renderlist)
 {
+    auto to_composite = renderlist;
+    if (overlay_top(to_composite))
+    {
+        return true;
+    }
+
+    // The renderer composites everything, so needs nothing above it
+    placed_this_frame = false;
     return false;
 }
 
+bool mgw::DisplayClient::Output::overlay_top(mir::graphics::RenderableList& renderlist)
+{
+    // Subsurfaces can only go above what's composited into the parent surface, so
+    // only the renderables above the top one the host can't show are forwarded
+    Forwarded forwarded;
+    if (owner->subcompositor && dcout.scale == 1.0f && dcout.orientation == mir_orientation_normal)
+    {
+        for (auto r = renderlist.rbegin(); r != renderlist.rend(); ++r)
+        {
+            auto source = forwardable(**r);
+            if (!source)
+            {
+                break;
+            }
+            forwarded.emplace_back(*r, std::move(*source));
+        }
+    }
+
+    if (forwarded.empty())
+    {
+        // The renderer composites everything, and its commit of the parent hides any subsurfaces
+        return false;
+    }
+
+    std::reverse(begin(forwarded), end(forwarded));
+    place_subsurfaces(forwarded);
+    renderlist.resize(renderlist.size() - forwarded.size());
+
+    if (!renderlist.empty())
+    {
+        // The renderer composites the rest into the parent, and its commit applies the subsurface state
+        return false;
+    }
+
+    if (parent_cleared)
+    {
+        commit_and_wait_for_frame();
+    }
+    else
+    {
+        // The parent still shows the last composited frame: replace it with
+        // a cleared one, the subsurface state is applied by the same commit.
+        make_current();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        swap_buffers();
+        parent_cleared = true;
+    }
+
+    return true;
+}
+
+void mgw::DisplayClient::Output::place_subsurfaces(Forwarded const& forwarded)
+{
+    auto const offset = as_displacement(view_area().top_left);
+    auto below = surface;
+
+    decltype(subsurfaces) current;
+    for (auto const& [renderable, source] : forwarded)
+    {
+        auto existing = subsurfaces.find(renderable->id());
+        auto subsurface = existing != subsurfaces.end() ?
+            std::move(existing->second) :
+            std::make_unique<Subsurface>(owner, surface);
+
+        subsurface->update(*renderable, source, offset, below);
+        below = subsurface->surface;
+        current[renderable->id()] = std::move(subsurface);
+    }
+
+    // Anything not moved to current is no longer on this output
+    subsurfaces = std::move(current);
+    placed_this_frame = true;
+}
+
+void mgw::DisplayClient::Output::hide_subsurfaces()
+{
+    // Unmapping is applied by the next commit of the parent
+    for (auto const& subsurface : subsurfaces)
+        subsurface.second->hide();
+}
+
 auto mgw::DisplayClient::Output::transformation() const -> glm::mat2
 {
     return glm::mat2{1};
@@ -359,44 +794,16 @@ void mgw::DisplayClient::Output::release_current()
 
 void mgw::DisplayClient::Output::swap_buffers()
 {
-    struct FrameSync
+    // Subsurfaces not placed for this frame (e.g. when the renderer composites
+    // everything) would hide what's composited beneath them.
+    if (!placed_this_frame)
     {
-        explicit FrameSync(wl_surface* surface) :
-            callback{wl_surface_frame(surface)}
-        {
-            static struct wl_callback_listener const frame_listener =
-                {
-                    [](void* data, auto... args)
-                        { static_cast<FrameSync*>(data)->frame_done(args...); },
-                };
-
-            wl_callback_add_listener(callback, &frame_listener, this);
-        }
-
-        ~FrameSync()
-        {
-            wl_callback_destroy(callback);
-        }
-
-        void frame_done(wl_callback*, uint32_t)
-        {
-            std::lock_guard<decltype(mutex)> lock{mutex};
-            posted = true;
-            cv.notify_all();
-        }
-
-        void wait_for_done()
-        {
-            std::unique_lock<decltype(mutex)> lock{mutex};
-            cv.wait(lock, [this]{ return posted; });
-        }
-
-        std::mutex mutex;
-        bool posted = false;
-        std::condition_variable cv;
+        hide_subsurfaces();
+    }
+    placed_this_frame = false;
+    parent_cleared = false;
 
-        wl_callback* const callback;
-    } frame_sync{surface};
+    FrameSync frame_sync{surface};
 
     // Avoid throttling compositing by blocking in eglSwapBuffers().
     // Instead we use the frame "done" notification.
@@ -408,6 +815,18 @@ void mgw::DisplayClient::Output::swap_buffers()
     frame_sync.wait_for_done();
 }
 
+void mgw::DisplayClient::Output::commit_and_wait_for_frame()
+{
+    placed_this_frame = false;
+
+    FrameSync frame_sync{surface};
+
+    wl_surface_commit(surface);
+    wl_display_flush(owner->display);
+
+    frame_sync.wait_for_done();
+}
+
 void mgw::DisplayClient::Output::bind()
 {
 }
@@ -416,6 +835,7 @@ mgw::DisplayClient::DisplayClient(
     wl_display* display,
     std::shared_ptr<GLConfig> const& gl_config) :
     display{display},
+    forwardable{std::make_shared<ForwardableBuffers>()},
     keyboard_context_{xkb_context_new(XKB_CONTEXT_NO_FLAGS)},
     registry{nullptr, [](auto){}}
 {
@@ -469,6 +889,10 @@ mgw::DisplayClient::DisplayClient(
         BOOST_THROW_EXCEPTION(egl_error("eglCreateContext failed"));
 
     wl_display_roundtrip(display);
+
+    // The host lists the dmabuf formats it can import in response to binding linux_dmabuf
+    if (linux_dmabuf)
+        wl_display_roundtrip(display);
 }
 
 void mgw::DisplayClient::on_output_changed(Output const* /*output*/)
@@ -544,6 +968,18 @@ void mgw::DisplayClient::new_global(
     {
         self->shell = static_cast<decltype(self->shell)>(wl_registry_bind(registry, id, &wl_shell_interface, std::min(version, 1u)));
     }
+    else if (strcmp(interface, "wl_subcompositor") == 0)
+    {
+        self->subcompositor =
+            static_cast<decltype(self->subcompositor)>(wl_registry_bind(registry, id, &wl_subcompositor_interface, 1));
+    }
+    else if (strcmp(interface, "zwp_linux_dmabuf_v1") == 0 && version >= 3)
+    {
+        // Version 3 lists the modifiers the host supports, and has create_immed()
+        self->linux_dmabuf =
+            static_cast<decltype(self->linux_dmabuf)>(wl_registry_bind(registry, id, &zwp_linux_dmabuf_v1_interface, 3));
+        add_linux_dmabuf_listener(self, self->linux_dmabuf);
+    }
 }
 
 void mgw::DisplayClient::remove_global(
@@ -840,6 +1276,26 @@ void mir::graphics::wayland::DisplayClient::shm_format(wl_shm* /*wl_shm*/, uint3
     }
 }
 
+void mgw::DisplayClient::add_linux_dmabuf_listener(DisplayClient* self, zwp_linux_dmabuf_v1* linux_dmabuf)
+{
+    static struct zwp_linux_dmabuf_v1_listener linux_dmabuf_listener =
+        {
+            [](void*, zwp_linux_dmabuf_v1*, uint32_t) {},  // Each format is also sent with its modifiers
+            [](void* self, auto... args) { static_cast<DisplayClient*>(self)->linux_dmabuf_modifier(args...); },
+        };
+
+    zwp_linux_dmabuf_v1_add_listener(linux_dmabuf, &linux_dmabuf_listener, self);
+}
+
+void mgw::DisplayClient::linux_dmabuf_modifier(
+    zwp_linux_dmabuf_v1* /*linux_dmabuf*/,
+    uint32_t format,
+    uint32_t modifier_hi,
+    uint32_t modifier_lo)
+{
+    host_dmabuf_formats.emplace(format, (uint64_t{modifier_hi} << 32) | modifier_lo);
+}
+
 namespace mir
 {
 namespace graphics
@@ -32,11 +32,13 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <mir/geometry/displacement.h>
 
 struct xkb_context;
 struct xkb_keymap;
 struct xkb_state;
+struct zwp_linux_dmabuf_v1;
 
 namespace mir
 {
@@ -44,6 +46,7 @@ namespace graphics
 {
 namespace wayland
 {
+class ForwardableBuffers;
 
 class DisplayClient
 {
@@ -124,6 +127,7 @@ protected:
         wl_fixed_t orientation);
 
     class Output;
+    class Subsurface;
     void on_new_output(Output const*);
     void on_output_changed(Output const*);
     void on_output_gone(Output const*);
@@ -132,6 +136,11 @@ protected:
     wl_shell* shell = nullptr;
     wl_seat* seat = nullptr;
     wl_shm* shm = nullptr;
+    wl_subcompositor* subcompositor = nullptr;
+    zwp_linux_dmabuf_v1* linux_dmabuf = nullptr;
+
+    /// The client buffers Outputs can pass through to the host
+    std::shared_ptr<ForwardableBuffers> const forwardable;
 
     static void new_global(
         void* data,
@@ -153,6 +162,11 @@ protected:
     void shm_format(wl_shm *wl_shm, uint32_t format);
     MirPixelFormat shm_pixel_format{mir_pixel_format_invalid};
 
+    static void add_linux_dmabuf_listener(DisplayClient* self, zwp_linux_dmabuf_v1* linux_dmabuf);
+    void linux_dmabuf_modifier(zwp_linux_dmabuf_v1* linux_dmabuf, uint32_t format, uint32_t hi, uint32_t lo);
+    /// The (DRM format, modifier) pairs the host can import; only sent as linux_dmabuf is bound
+    std::set<std::pair<uint32_t, uint64_t>> host_dmabuf_formats;
+
     xkb_context* keyboard_context_;
     xkb_keymap* keyboard_map_ = nullptr;
     xkb_state* keyboard_state_ = nullptr;
@@ -242,5 +242,6 @@ auto mgx::BufferAllocator::buffer_from_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
+        mg::wayland::ShmRelease::after_upload,
         std::move(on_consumed));
 }
@@ -0,0 +1,271 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "GLRenderer"
+
+#include "program_binary_cache.h"
+#include "mir/log.h"
+
+#include <EGL/egl.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mrg = mir::renderer::gl;
+
+namespace
+{
+char const magic[8] = {'M', 'I', 'R', 'G', 'L', 'P', 'R', 'G'};
+uint32_t const format_version = 1;
+
+auto default_cache_dir() -> std::string
+{
+    std::string cache_home;
+
+    if (auto const xdg_cache_home = getenv("XDG_CACHE_HOME"))
+        cache_home = xdg_cache_home;
+    else if (auto const home = getenv("HOME"))
+        (cache_home = home) += "/.cache";
+
+    if (cache_home.empty())
+        return {};
+
+    auto const cache_dir = cache_home + "/mir/gl-programs";
+
+    // Make each missing level; failures are caught when writing
+    for (auto slash = cache_dir.find('/', 1); slash != std::string::npos; slash = cache_dir.find('/', slash + 1))
+        mkdir(cache_dir.substr(0, slash).c_str(), 0700);
+    mkdir(cache_dir.c_str(), 0700);
+
+    return cache_dir;
+}
+
+auto gl_string(GLenum name) -> std::string
+{
+    auto const value = reinterpret_cast<char const*>(glGetString(name));
+    return value ? value : "";
+}
+
+auto hash(std::string const& key) -> uint64_t
+{
+    // FNV-1a: stable across builds, unlike std::hash
+    uint64_t result = 0xcbf29ce484222325;
+    for (unsigned char c : key)
+    {
+        result ^= c;
+        result *= 0x100000001b3;
+    }
+    return result;
+}
+
+template<typename Type>
+void write(std::ostream& out, Type const& value)
+{
+    out.write(reinterpret_cast<char const*>(&value), sizeof value);
+}
+
+template<typename Type>
+auto read(std::istream& in) -> Type
+{
+    Type value{};
+    in.read(reinterpret_cast<char*>(&value), sizeof value);
+    return value;
+}
+}
+
+mrg::ProgramBinaryCache::ProgramBinaryCache(
+    std::string cache_dir,
+    PFNGLGETPROGRAMBINARYOESPROC get_program_binary,
+    PFNGLPROGRAMBINARYOESPROC program_binary) :
+    cache_dir{std::move(cache_dir)},
+    get_program_binary{get_program_binary},
+    program_binary{program_binary}
+{
+}
+
+auto mrg::ProgramBinaryCache::instance_for_current_context() -> ProgramBinaryCache*
+{
+    auto const extensions = gl_string(GL_EXTENSIONS);
+    if (extensions.find("GL_OES_get_program_binary") == std::string::npos)
+        return nullptr;
+
+    // Some drivers advertise the extension without supporting any format
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+    if (formats <= 0)
+        return nullptr;
+
+    static ProgramBinaryCache* const instance = []() -> ProgramBinaryCache*
+        {
+            auto const get_program_binary =
+                reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(eglGetProcAddress("glGetProgramBinaryOES"));
+            auto const program_binary =
+                reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(eglGetProcAddress("glProgramBinaryOES"));
+
+            if (!get_program_binary || !program_binary)
+                return nullptr;
+
+            // Intentionally leaked: renderers may outlive static destruction order
+            return new ProgramBinaryCache{default_cache_dir(), get_program_binary, program_binary};
+        }();
+
+    return instance;
+}
+
+auto mrg::ProgramBinaryCache::key_for(char const* vertex_source, char const* fragment_source) -> std::string
+{
+    std::string key;
+    for (auto const name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION})
+        (key += gl_string(name)) += '\n';
+
+    ((key += vertex_source) += '\0') += fragment_source;
+    return key;
+}
+
+auto mrg::ProgramBinaryCache::load(std::string const& key, GLuint program) -> bool
+{
+    std::vector<Binary> candidates;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        auto const found = binaries.find(key);
+        if (found != binaries.end())
+            candidates.push_back(found->second);
+    }
+
+    if (candidates.empty())
+        candidates = read_file(key);
+
+    for (auto const& binary : candidates)
+    {
+        program_binary(program, binary.format, binary.data.data(), static_cast<GLint>(binary.data.size()));
+
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (ok)
+        {
+            std::lock_guard<decltype(mutex)> lock{mutex};
+            binaries.emplace(key, binary);
+            return true;
+        }
+    }
+
+    // Not found, or the driver rejected it (e.g. after a driver update that
+    // kept the version string)
+    return false;
+}
+
+void mrg::ProgramBinaryCache::store(std::string const& key, GLuint program)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0)
+        return;
+
+    Binary binary{0, std::vector<char>(length)};
+    GLsizei written = 0;
+    get_program_binary(program, length, &written, &binary.format, binary.data.data());
+    if (written <= 0)
+        return;
+    binary.data.resize(written);
+
+    write_file(key, binary);
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    binaries[key] = std::move(binary);
+}
+
+auto mrg::ProgramBinaryCache::filename_for(std::string const& key) const -> std::string
+{
+    char name[32];
+    snprintf(name, sizeof name, "/%016llx.bin", static_cast<unsigned long long>(hash(key)));
+    return cache_dir + name;
+}
+
+auto mrg::ProgramBinaryCache::read_file(std::string const& key) const -> std::vector<Binary>
+{
+    if (cache_dir.empty())
+        return {};
+
+    std::ifstream in{filename_for(key), std::ios::binary};
+    if (!in)
+        return {};
+
+    char file_magic[sizeof magic];
+    in.read(file_magic, sizeof file_magic);
+    if (!in || memcmp(file_magic, magic, sizeof magic) || read<uint32_t>(in) != format_version)
+        return {};
+
+    // The full key is stored, so that a hash collision can't load the wrong program
+    auto const key_size = read<uint64_t>(in);
+    if (!in || key_size != key.size())
+        return {};
+
+    std::string file_key(key_size, '\0');
+    in.read(&file_key[0], key_size);
+    if (!in || file_key != key)
+        return {};
+
+    Binary binary{read<uint32_t>(in), {}};
+    auto const data_size = read<uint64_t>(in);
+    if (!in || data_size > 64*1024*1024)
+        return {};
+
+    binary.data.resize(data_size);
+    in.read(binary.data.data(), data_size);
+    if (!in)
+        return {};
+
+    return {std::move(binary)};
+}
+
+void mrg::ProgramBinaryCache::write_file(std::string const& key, Binary const& binary) const
+{
+    if (cache_dir.empty())
+        return;
+
+    // Write to a temporary file and rename it, so other servers never see a partial file
+    auto const filename = filename_for(key);
+    auto const temp_filename = filename + "." + std::to_string(getpid());
+    {
+        std::ofstream out{temp_filename, std::ios::binary | std::ios::trunc};
+        out.write(magic, sizeof magic);
+        write(out, format_version);
+        write(out, uint64_t(key.size()));
+        out.write(key.data(), key.size());
+        write(out, uint32_t(binary.format));
+        write(out, uint64_t(binary.data.size()));
+        out.write(binary.data.data(), binary.data.size());
+
+        if (!out)
+        {
+            mir::log_debug("Failed to write GL program binary cache file %s", temp_filename.c_str());
+            unlink(temp_filename.c_str());
+            return;
+        }
+    }
+
+    if (rename(temp_filename.c_str(), filename.c_str()))
+    {
+        mir::log_debug("Failed to write GL program binary cache file %s", filename.c_str());
+        unlink(temp_filename.c_str());
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_PROGRAM_BINARY_CACHE_H_
+#define MIR_RENDERER_GL_PROGRAM_BINARY_CACHE_H_
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+/**
+ * Linked GL program binaries (GL_OES_get_program_binary), kept in memory for
+ * all renderers in the process and written to disk for the next start.
+ *
+ * Binaries are keyed on the driver and the shader sources: a binary is only
+ * ever loaded into a program for exactly the same driver and sources, and a
+ * binary the driver rejects is simply recompiled.
+ */
+class ProgramBinaryCache
+{
+public:
+    /// \param cache_dir where binaries are stored; if empty they are only kept in memory
+    ProgramBinaryCache(
+        std::string cache_dir,
+        PFNGLGETPROGRAMBINARYOESPROC get_program_binary,
+        PFNGLPROGRAMBINARYOESPROC program_binary);
+
+    /// The cache shared by every renderer, or nullptr if the current GL context
+    /// doesn't support program binaries.
+    /// \note This must be called with a current GL context
+    static auto instance_for_current_context() -> ProgramBinaryCache*;
+
+    /// A key for the driver of the current GL context and the shader sources
+    /// \note This must be called with a current GL context
+    static auto key_for(char const* vertex_source, char const* fragment_source) -> std::string;
+
+    /// Load the binary for \p key into \p program
+    /// \return whether \p program is now successfully linked
+    /// \note This must be called with a current GL context
+    auto load(std::string const& key, GLuint program) -> bool;
+
+    /// Save the binary of the linked \p program as \p key
+    /// \note This must be called with a current GL context
+    void store(std::string const& key, GLuint program);
+
+private:
+    struct Binary
+    {
+        GLenum format;
+        std::vector<char> data;
+    };
+
+    auto filename_for(std::string const& key) const -> std::string;
+    auto read_file(std::string const& key) const -> std::vector<Binary>;
+    void write_file(std::string const& key, Binary const& binary) const;
+
+    std::string const cache_dir;
+    PFNGLGETPROGRAMBINARYOESPROC const get_program_binary;
+    PFNGLPROGRAMBINARYOESPROC const program_binary;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Binary> binaries;
+};
+}
+}
+}
+
+#endif // MIR_RENDERER_GL_PROGRAM_BINARY_CACHE_H_
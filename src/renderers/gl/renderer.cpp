@@ -19,9 +19,11 @@
 #define MIR_LOG_COMPONENT "GLRenderer"
 
 #include "renderer.h"
+#include "program_binary_cache.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/buffer.h"
+#include "mir/graphics/solid_color_buffer.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/gl/tessellation_helpers.h"
 #include "mir/log.h"
@@ -30,6 +32,7 @@
 #include "mir/graphics/texture.h"
 #include "mir/graphics/program_factory.h"
 #include "mir/graphics/program.h"
+#include "mir/geometry/rectangles.h"
 
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp>
@@ -38,7 +41,10 @@
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <cstddef>
 #include <sstream>
 #include <mutex>
 
@@ -105,6 +111,15 @@ public:
         from.id = 0;
     }
 
+    GLHandle& operator=(GLHandle&& from)
+    {
+        if (id && id != from.id)
+            (*deleter)(id);
+        id = from.id;
+        from.id = 0;
+        return *this;
+    }
+
     operator GLuint() const
     {
         return id;
@@ -148,6 +163,165 @@ const GLchar* const vertex_shader_src =
     "   v_texcoord = texcoord;\n"
     "}\n"
 };
+
+// A SolidColorBuffer has nothing to sample, so texcoord is ignored
+char const solid_color_shader_id = 0;
+const GLchar* const solid_color_fragment_src =
+{
+    "uniform vec4 color;\n"
+    "vec4 sample_to_rgba(in vec2 texcoord)\n"
+    "{\n"
+    "    return color;\n"
+    "}\n"
+};
+
+struct BlendState  // Represents parameters of glBlendFuncSeparate() and glBlendColor()
+{
+    GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
+    GLfloat constant_alpha;
+
+    bool enabled() const { return dst_rgb != GL_ZERO; }
+
+    bool same_func(BlendState const& other) const
+    {
+        return src_rgb == other.src_rgb && dst_rgb == other.dst_rgb &&
+               src_alpha == other.src_alpha && dst_alpha == other.dst_alpha;
+    }
+};
+
+BlendState const no_blending{GL_ONE,  GL_ZERO, GL_ZERO, GL_ONE, 1.0f};  // Avoid using src_alpha!
+
+auto blend_state_for(mg::Renderable const& renderable) -> BlendState
+{
+    // These renderable method names could be better (see LP: #1236224)
+    if (renderable.shaped())  // Client is RGBA:
+    {
+        return {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
+                GL_ONE, GL_ONE_MINUS_SRC_ALPHA, 1.0f};
+    }
+    else if (renderable.alpha() == 1.0f)  // RGBX and no window translucency:
+    {
+        return no_blending;
+    }
+    else
+    {   // Client is RGBX but we also have window translucency.
+        // The texture alpha channel is possibly uninitialized so we must be
+        // careful and avoid using SRC_ALPHA (LP: #1423462).
+        return {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
+                GL_ZERO, GL_ONE, renderable.alpha()};
+    }
+}
+
+/// The parts of a renderable drawn with \p blend that may be drawn without blending
+auto opaque_parts_of(mg::Renderable const& renderable, BlendState const& blend) -> std::vector<geom::Rectangle>
+{
+    if (blend.dst_rgb != GL_ONE_MINUS_SRC_ALPHA || renderable.alpha() < 1.0f)
+        return {};
+
+    return renderable.opaque_region();
+}
+
+/// \p area less \p holes, as non-overlapping rectangles
+auto subtract(geom::Rectangle const& area, std::vector<geom::Rectangle> const& holes) -> std::vector<geom::Rectangle>
+{
+    geom::Rectangles remaining{area};
+    for (auto const& hole : holes)
+        remaining.subtract(hole);
+
+    return {remaining.begin(), remaining.end()};
+}
+
+/// Whether \p primitives are just the rectangle of \p renderable's screen_position()
+auto is_plain_rectangle(std::vector<mgl::Primitive> const& primitives, mg::Renderable const& renderable) -> bool
+{
+    if (primitives.size() != 1)
+        return false;
+
+    auto const& p = primitives.front();
+    auto const rectangle = mgl::tessellate_renderable_into_rectangle(renderable, geom::Displacement{0,0});
+    return p.type == rectangle.type &&
+           p.nvertices == rectangle.nvertices &&
+           memcmp(p.vertices, rectangle.vertices, p.nvertices * sizeof p.vertices[0]) == 0;
+}
+
+auto texture_transform_for(mg::Renderable const& renderable, mg::gl::Texture const& texture) -> glm::mat4
+{
+    glm::mat4 transform = renderable.transformation();
+    if (texture.layout() == mg::gl::Texture::Layout::TopRowFirst)
+    {
+        // GL textures have (0,0) at bottom-left rather than top-left
+        // We have to invert this texture to get it the way up GL expects.
+        transform *= glm::mat4{
+            1.0, 0.0, 0.0, 0.0,
+            0.0, -1.0, 0.0, 0.0,
+            0.0, 0.0, 1.0, 0.0,
+            -1.0, 1.0, 0.0, 1.0
+        };
+    }
+    return transform;
+}
+
+/// The screen area covered by the tessellated vertices, or nothing if that can't be known
+auto screen_bounds(mg::Renderable const& renderable, mgl::Vertex const* begin, mgl::Vertex const* end)
+-> std::experimental::optional<geom::Rectangle>
+{
+    // Anything transformed could be anywhere on screen
+    if (begin == end || renderable.transformation() != glm::mat4{1})
+        return {};
+
+    auto left = begin->position[0], right = left;
+    auto top = begin->position[1], bottom = top;
+
+    for (auto v = begin; v != end; ++v)
+    {
+        // ...as could anything out of the z=0 plane
+        if (v->position[2] != 0.0f)
+            return {};
+
+        left = std::min(left, v->position[0]);
+        right = std::max(right, v->position[0]);
+        top = std::min(top, v->position[1]);
+        bottom = std::max(bottom, v->position[1]);
+    }
+
+    geom::Point const top_left{std::floor(left), std::floor(top)};
+    geom::Point const bottom_right{std::ceil(right), std::ceil(bottom)};
+    return geom::Rectangle{top_left, as_size(bottom_right - top_left)};
+}
+
+auto bounding_rectangle(geom::Rectangle const& a, geom::Rectangle const& b) -> geom::Rectangle
+{
+    geom::Point const top_left{
+        std::min(a.top_left.x, b.top_left.x),
+        std::min(a.top_left.y, b.top_left.y)};
+    geom::Point const bottom_right{
+        std::max(a.bottom_right().x, b.bottom_right().x),
+        std::max(a.bottom_right().y, b.bottom_right().y)};
+    return {top_left, as_size(bottom_right - top_left)};
+}
+
+/// The renderables that may be drawn together: they share a program and blend
+/// function, and nothing drawn between them in the original order overlaps them.
+struct Batch
+{
+    mrg::Renderer::Program const* program;
+    BlendState blend;
+    std::experimental::optional<geom::Rectangle> bounds;  // Unset if unbounded
+    std::vector<std::size_t> draws;
+
+    bool accepts(mrg::Renderer::Program const* program, BlendState const& blend) const
+    {
+        return this->program == program && this->blend.same_func(blend);
+    }
+
+    bool overlaps(std::experimental::optional<geom::Rectangle> const& other) const
+    {
+        return !bounds || !other || bounds.value().overlaps(other.value());
+    }
+};
+
+// How far back to look for a batch to join: bounds the cost of batching large scenes
+auto const max_batch_lookback = 8;
 }
 
 class mrg::Renderer::ProgramFactory : public mir::graphics::gl::ProgramFactory
@@ -155,7 +329,8 @@ class mrg::Renderer::ProgramFactory : public mir::graphics::gl::ProgramFactory
 public:
     // NOTE: This must be called with a current GL context
     ProgramFactory()
-        : vertex_shader{compile_shader(GL_VERTEX_SHADER, vertex_shader_src)}
+        : binary_cache{ProgramBinaryCache::instance_for_current_context()},
+          vertex_shader{0}
     {
     }
 
@@ -215,22 +390,42 @@ public:
         // GL shader compilation is *not* threadsafe, and requires external synchronisation
         std::lock_guard<std::mutex> lock{compilation_mutex};
 
-        ShaderHandle const opaque_shader{
-            compile_shader(GL_FRAGMENT_SHADER, opaque_fragment.str().c_str())};
-        ShaderHandle const alpha_shader{
-            compile_shader(GL_FRAGMENT_SHADER, alpha_fragment.str().c_str())};
-
         programs.emplace_back(id, std::make_unique<::Program>(
-            link_shader(vertex_shader, opaque_shader),
-            link_shader(vertex_shader, alpha_shader)));
+            cached_or_linked_program(opaque_fragment.str()),
+            cached_or_linked_program(alpha_fragment.str())));
 
         return *programs.back().second;
-
-        // We delete opaque_shader and alpha_shader here. This is fine; it only marks them
-        // for deletion. GL will only delete them once the GL Program they're linked in is destroyed.
     }
 
 private:
+    ProgramHandle cached_or_linked_program(std::string const& fragment_src)
+    {
+        std::string key;
+        if (binary_cache)
+        {
+            key = ProgramBinaryCache::key_for(vertex_shader_src, fragment_src.c_str());
+
+            ProgramHandle program{glCreateProgram()};
+            if (binary_cache->load(key, program))
+                return program;
+        }
+
+        // Only compile the vertex shader if something isn't cached
+        if (!vertex_shader)
+            vertex_shader = ShaderHandle{compile_shader(GL_VERTEX_SHADER, vertex_shader_src)};
+
+        ShaderHandle const fragment_shader{compile_shader(GL_FRAGMENT_SHADER, fragment_src.c_str())};
+        auto program = link_shader(vertex_shader, fragment_shader);
+
+        if (binary_cache)
+            binary_cache->store(key, program);
+
+        return program;
+
+        // We delete fragment_shader here. This is fine; it only marks it for deletion.
+        // GL will only delete it once the GL Program it's linked in is destroyed.
+    }
+
     static GLuint compile_shader(GLenum type, GLchar const* src)
     {
         GLuint id = glCreateShader(type);
@@ -278,7 +473,8 @@ private:
         return program;
     }
 
-    ShaderHandle const vertex_shader;
+    ProgramBinaryCache* const binary_cache;
+    ShaderHandle vertex_shader;
     std::vector<std::pair<void const*, std::unique_ptr<::Program>>> programs;
     // GL requires us to synchronise multi-threaded access to the shader APIs.
     std::mutex compilation_mutex;
@@ -302,13 +498,15 @@ mrg::Renderer::Program::Program(GLuint program_id)
     transform_uniform = glGetUniformLocation(id, "transform");
     screen_to_gl_coords_uniform = glGetUniformLocation(id, "screen_to_gl_coords");
     alpha_uniform = glGetUniformLocation(id, "alpha");
+    color_uniform = glGetUniformLocation(id, "color");
 }
 
-mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer, DrawPath draw_path)
     : render_target(&display_buffer),
       clear_color{0.0f, 0.0f, 0.0f, 0.0f},
       program_factory{std::make_unique<ProgramFactory>()},
-      display_transform(1)
+      display_transform(1),
+      draw_path{draw_path}
 {
     eglBindAPI(EGL_OPENGL_ES_API);
     EGLDisplay disp = eglGetCurrentDisplay();
@@ -365,6 +563,9 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
 mrg::Renderer::~Renderer()
 {
     render_target.ensure_current();
+
+    if (vertex_buffer)
+        glDeleteBuffers(1, &vertex_buffer);
 }
 
 void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
@@ -374,7 +575,36 @@ void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
     primitives[0] = mgl::tessellate_renderable_into_rectangle(renderable, geom::Displacement{0,0});
 }
 
+void mrg::Renderer::tessellate_by_opacity(
+    mg::Renderable const& renderable,
+    std::vector<geom::Rectangle> const& opaque_parts) const
+{
+    primitives.clear();
+    opaque_primitives.clear();
+
+    tessellate(primitives, renderable);
+
+    // Only the default tessellation can be split. Any other (such as a deformed window) is blended as a whole.
+    if (opaque_parts.empty() || !is_plain_rectangle(primitives, renderable))
+        return;
+
+    primitives.clear();
+    for (auto const& part : opaque_parts)
+        opaque_primitives.push_back(mgl::tessellate_renderable_into_rectangle(renderable, {}, part));
+
+    for (auto const& part : subtract(renderable.screen_position(), opaque_parts))
+        primitives.push_back(mgl::tessellate_renderable_into_rectangle(renderable, {}, part));
+}
+
 void mrg::Renderer::render(mg::RenderableList const& renderables) const
+{
+    std::vector<Readback> no_readbacks;
+    render_and_read_back(renderables, no_readbacks);
+}
+
+void mrg::Renderer::render_and_read_back(
+    mg::RenderableList const& renderables,
+    std::vector<Readback>& readbacks) const
 {
     render_target.bind();
 
@@ -383,10 +613,21 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
     glClear(GL_COLOR_BUFFER_BIT);
 
     ++frameno;
-    for (auto const& r : renderables)
+    if (draw_path == DrawPath::batched)
     {
-        draw(*r);
+        draw_batched(renderables);
     }
+    else
+    {
+        for (auto const& r : renderables)
+        {
+            draw(*r);
+        }
+    }
+
+    // The back buffer's content is undefined once it is swapped
+    for (auto& readback : readbacks)
+        read_back(readback);
 
     render_target.swap_buffers();
 
@@ -394,6 +635,48 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
         mir::log_debug("GL error: %d", gl_error);
 }
 
+void mrg::Renderer::read_back(Readback& readback) const
+{
+    readback.read = false;
+
+    // Reading back rotated or reflected outputs isn't supported
+    if (display_transform != glm::mat4(1))
+        return;
+
+    if (readback.area.intersection_with(viewport) != readback.area ||
+        readback.area.size.width.as_int() <= 0 || readback.area.size.height.as_int() <= 0)
+        return;
+
+    GLint gl_viewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_VIEWPORT, gl_viewport);
+    auto const scale_x = float(gl_viewport[2]) / viewport.size.width.as_int();
+    auto const scale_y = float(gl_viewport[3]) / viewport.size.height.as_int();
+
+    GLsizei const width = readback.size.width.as_int();
+    GLsizei const height = readback.size.height.as_int();
+    if (std::lround(readback.area.size.width.as_int() * scale_x) != width ||
+        std::lround(readback.area.size.height.as_int() * scale_y) != height)
+        return;
+
+    // GL framebuffer coordinates start at the bottom left
+    GLint const x = gl_viewport[0] + std::lround((readback.area.left() - viewport.left()).as_int() * scale_x);
+    GLint const y = gl_viewport[1] + std::lround((viewport.bottom() - readback.area.bottom()).as_int() * scale_y);
+
+    auto const stride = 4 * width;
+    readback.pixels.resize(stride * height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, readback.pixels.data());
+
+    // Rows come bottom first, and RGBA in memory is ABGR on little endian
+    auto const pixels = readback.pixels.data();
+    for (GLsizei row = 0; row < height / 2; ++row)
+        std::swap_ranges(pixels + row * stride, pixels + (row + 1) * stride, pixels + (height - row - 1) * stride);
+    for (auto pixel = pixels; pixel != pixels + stride * height; pixel += 4)
+        std::swap(pixel[0], pixel[2]);
+
+    readback.read = true;
+}
+
 void mrg::Renderer::draw(mg::Renderable const& renderable) const
 {
     auto const clip_area = renderable.clip_area();
@@ -412,8 +695,10 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         );
     }
 
-    auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
-    if (!texture)
+    auto const buffer = renderable.buffer();
+    auto const solid_color = dynamic_cast<mg::SolidColorBuffer const*>(buffer.get());
+    auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(buffer);
+    if (!texture && !solid_color)
     {
         mir::log_error("Buffer does not support GL rendering!");
         return;
@@ -422,7 +707,8 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
     auto const& prog =
         [this, &texture](bool alpha) -> Program const&
         {
-                auto const& family = static_cast<::Program const&>(texture->shader(*program_factory));
+                auto const& family = static_cast<::Program const&>(
+                    texture ? texture->shader(*program_factory) : solid_color_shader());
                 if (alpha)
                 {
                     return family.alpha;
@@ -457,18 +743,9 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
                       rect.size.height.as_int() / 2.0f;
     glUniform2f(prog.centre_uniform, centrex, centrey);
 
-    glm::mat4 transform = renderable.transformation();
-    if (texture->layout() == mg::gl::Texture::Layout::TopRowFirst)
-    {
-        // GL textures have (0,0) at bottom-left rather than top-left
-        // We have to invert this texture to get it the way up GL expects.
-        transform *= glm::mat4{
-            1.0, 0.0, 0.0, 0.0,
-            0.0, -1.0, 0.0, 0.0,
-            0.0, 0.0, 1.0, 0.0,
-            -1.0, 1.0, 0.0, 1.0
-        };
-    }
+    glm::mat4 const transform = texture ?
+        texture_transform_for(renderable, *texture) :
+        renderable.transformation();
 
     glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
                        glm::value_ptr(transform));
@@ -476,55 +753,30 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
     if (prog.alpha_uniform >= 0)
         glUniform1f(prog.alpha_uniform, renderable.alpha());
 
+    if (solid_color)
+        glUniform4fv(prog.color_uniform, 1, glm::value_ptr(solid_color->color()));
+
     glEnableVertexAttribArray(prog.position_attr);
-    glEnableVertexAttribArray(prog.texcoord_attr);
+    if (prog.texcoord_attr >= 0)
+        glEnableVertexAttribArray(prog.texcoord_attr);
 
     primitives.clear();
-    tessellate(primitives, renderable);
+    opaque_primitives.clear();
 
-    // if we fail to load the texture, we need to carry on (part of lp:1629275)
-    try
-    {
-        typedef struct  // Represents parameters of glBlendFuncSeparate()
+    auto const draw_primitive = [&](mgl::Primitive const& p, BlendState const& blend)
         {
-            GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
-        } BlendSeparate;
-
-        BlendSeparate client_blend;
-
-        // These renderable method names could be better (see LP: #1236224)
-        if (renderable.shaped())  // Client is RGBA:
-        {
-            client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
-                            GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
-        }
-        else if (renderable.alpha() == 1.0f)  // RGBX and no window translucency:
-        {
-            client_blend = {GL_ONE,  GL_ZERO,
-                            GL_ZERO, GL_ONE};  // Avoid using src_alpha!
-        }
-        else
-        {   // Client is RGBX but we also have window translucency.
-            // The texture alpha channel is possibly uninitialized so we must be
-            // careful and avoid using SRC_ALPHA (LP: #1423462).
-            client_blend = {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
-                            GL_ZERO, GL_ONE};
-            glBlendColor(0.0f, 0.0f, 0.0f, renderable.alpha());
-        }
-
-        for (auto const& p : primitives)
-        {
-            BlendSeparate blend;
-
-            blend = client_blend;
-            texture->bind();
+            if (texture)
+                texture->bind();
 
             glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT,
                                   GL_FALSE, sizeof(mgl::Vertex),
                                   &p.vertices[0].position);
-            glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].texcoord);
+            if (prog.texcoord_attr >= 0)
+            {
+                glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
+                                      GL_FALSE, sizeof(mgl::Vertex),
+                                      &p.vertices[0].texcoord);
+            }
 
             if (blend.dst_rgb == GL_ZERO)
             {
@@ -540,15 +792,33 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
             glDrawArrays(p.type, 0, p.nvertices);
 
             // We're done with the texture for now
-            texture->add_syncpoint();
-        }
+            if (texture)
+                texture->add_syncpoint();
+        };
+
+    // if we fail to load the texture, we need to carry on (part of lp:1629275)
+    try
+    {
+        auto const client_blend = blend_state_for(renderable);
+
+        if (client_blend.dst_rgb == GL_ONE_MINUS_CONSTANT_ALPHA)
+            glBlendColor(0.0f, 0.0f, 0.0f, client_blend.constant_alpha);
+
+        tessellate_by_opacity(renderable, opaque_parts_of(renderable, client_blend));
+
+        // The opaque parts (if any) don't overlap the rest, so the order doesn't matter
+        for (auto const& p : opaque_primitives)
+            draw_primitive(p, no_blending);
+        for (auto const& p : primitives)
+            draw_primitive(p, client_blend);
     }
     catch (std::exception const& ex)
     {
         report_exception();
     }
 
-    glDisableVertexAttribArray(prog.texcoord_attr);
+    if (prog.texcoord_attr >= 0)
+        glDisableVertexAttribArray(prog.texcoord_attr);
     glDisableVertexAttribArray(prog.position_attr);
     if (renderable.clip_area())
     {
@@ -556,6 +826,298 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
     }
 }
 
+void mrg::Renderer::draw_batched(mg::RenderableList const& renderables) const
+{
+    struct Draw
+    {
+        mg::Renderable const* renderable;
+        std::shared_ptr<mg::gl::Texture> texture;           // Unset for a solid colour
+        std::experimental::optional<glm::vec4> solid_color;
+        Program const* program;
+        BlendState blend;
+        std::size_t first_primitive;
+        std::size_t end_primitive;
+    };
+
+    struct PrimitiveRange
+    {
+        GLenum type;
+        GLint first;
+        GLsizei count;
+    };
+
+    std::vector<Draw> draws;
+    std::vector<PrimitiveRange> ranges;
+    std::vector<Batch> batches;
+    draws.reserve(renderables.size());
+    frame_vertices.clear();
+
+    for (auto const& r : renderables)
+    {
+        auto const buffer = r->buffer();
+        std::experimental::optional<glm::vec4> solid_color;
+        if (auto const solid = dynamic_cast<mg::SolidColorBuffer const*>(buffer.get()))
+            solid_color = solid->color();
+
+        auto texture = std::dynamic_pointer_cast<mg::gl::Texture>(buffer);
+        if (!texture && !solid_color)
+        {
+            mir::log_error("Buffer does not support GL rendering!");
+            continue;
+        }
+
+        auto const& family = static_cast<::Program const&>(
+            texture ? texture->shader(*program_factory) : solid_color_shader());
+        auto const program = r->alpha() < 1.0f ? &family.alpha : &family.opaque;
+
+        auto const add_draw = [&](std::vector<mgl::Primitive> const& draw_primitives, BlendState const& blend)
+            {
+                auto const first_primitive = ranges.size();
+                auto const first_vertex = frame_vertices.size();
+
+                for (auto const& p : draw_primitives)
+                {
+                    ranges.push_back({p.type, static_cast<GLint>(frame_vertices.size()), p.nvertices});
+                    frame_vertices.insert(frame_vertices.end(), p.vertices, p.vertices + p.nvertices);
+                }
+
+                auto const bounds = screen_bounds(
+                    *r, frame_vertices.data() + first_vertex, frame_vertices.data() + frame_vertices.size());
+
+                auto const index = draws.size();
+                draws.push_back({r.get(), texture, solid_color, program, blend, first_primitive, ranges.size()});
+
+                // Move the draw back to an earlier batch with the same state, as long
+                // as nothing drawn after that batch overlaps it.
+                auto target = batches.rend();
+                auto lookback = 0;
+                for (auto b = batches.rbegin(); b != batches.rend() && lookback != max_batch_lookback; ++b, ++lookback)
+                {
+                    if (b->accepts(program, blend))
+                    {
+                        target = b;
+                        break;
+                    }
+
+                    if (b->overlaps(bounds))
+                        break;
+                }
+
+                if (target != batches.rend())
+                {
+                    target->draws.push_back(index);
+                    if (target->bounds && bounds)
+                        target->bounds = bounding_rectangle(target->bounds.value(), bounds.value());
+                    else
+                        target->bounds = {};
+                }
+                else
+                {
+                    batches.push_back({program, blend, bounds, {index}});
+                }
+            };
+
+        auto const blend = blend_state_for(*r);
+        tessellate_by_opacity(*r, opaque_parts_of(*r, blend));
+
+        // A renderable's opaque parts don't overlap the rest of it, so are drawn separately
+        if (!opaque_primitives.empty())
+            add_draw(opaque_primitives, no_blending);
+        if (!primitives.empty())
+            add_draw(primitives, blend);
+    }
+
+    if (draws.empty())
+        return;
+
+    if (!vertex_buffer)
+        glGenBuffers(1, &vertex_buffer);
+
+    // Respecifying the whole buffer each frame lets the driver orphan the old storage
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        frame_vertices.size() * sizeof(mgl::Vertex),
+        frame_vertices.data(),
+        GL_STREAM_DRAW);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    Program const* current_program = nullptr;
+    std::experimental::optional<BlendState> current_blend;
+    bool scissor_enabled = false;
+
+    for (auto const& batch : batches)
+    {
+        for (auto const index : batch.draws)
+        {
+            auto const& draw = draws[index];
+            auto const& renderable = *draw.renderable;
+            auto const& prog = *draw.program;
+
+            if (current_program != &prog)
+            {
+                if (current_program)
+                {
+                    if (current_program->texcoord_attr >= 0)
+                        glDisableVertexAttribArray(current_program->texcoord_attr);
+                    glDisableVertexAttribArray(current_program->position_attr);
+                }
+
+                glUseProgram(prog.id);
+                if (prog.last_used_frameno != frameno)
+                {   // Avoid reloading the screen-global uniforms on every renderable
+                    prog.last_used_frameno = frameno;
+                    for (auto i = 0u; i < prog.tex_uniforms.size(); ++i)
+                    {
+                        if (prog.tex_uniforms[i] != -1)
+                        {
+                            glUniform1i(prog.tex_uniforms[i], i);
+                        }
+                    }
+                    glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
+                                       glm::value_ptr(display_transform));
+                    glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
+                                       glm::value_ptr(screen_to_gl_coords));
+                }
+
+                glEnableVertexAttribArray(prog.position_attr);
+                glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT, GL_FALSE, sizeof(mgl::Vertex),
+                                      reinterpret_cast<void const*>(offsetof(mgl::Vertex, position)));
+                if (prog.texcoord_attr >= 0)
+                {
+                    glEnableVertexAttribArray(prog.texcoord_attr);
+                    glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT, GL_FALSE, sizeof(mgl::Vertex),
+                                          reinterpret_cast<void const*>(offsetof(mgl::Vertex, texcoord)));
+                }
+
+                current_program = &prog;
+            }
+
+            auto const& blend = draw.blend;
+            if (!current_blend || current_blend.value().enabled() != blend.enabled())
+            {
+                if (blend.enabled())
+                    glEnable(GL_BLEND);
+                else
+                    glDisable(GL_BLEND);
+            }
+            if (blend.enabled())
+            {
+                if (!current_blend || !current_blend.value().enabled() || !current_blend.value().same_func(blend))
+                {
+                    glBlendFuncSeparate(blend.src_rgb,   blend.dst_rgb,
+                                        blend.src_alpha, blend.dst_alpha);
+                }
+                if (blend.dst_rgb == GL_ONE_MINUS_CONSTANT_ALPHA &&
+                    (!current_blend || current_blend.value().constant_alpha != blend.constant_alpha))
+                {
+                    glBlendColor(0.0f, 0.0f, 0.0f, blend.constant_alpha);
+                }
+            }
+            current_blend = blend;
+
+            auto const clip_area = renderable.clip_area();
+            if (clip_area)
+            {
+                if (!scissor_enabled)
+                {
+                    glEnable(GL_SCISSOR_TEST);
+                    scissor_enabled = true;
+                }
+                glScissor(
+                    clip_area.value().top_left.x.as_int() -
+                        viewport.top_left.x.as_int(),
+                    viewport.top_left.y.as_int() +
+                        viewport.size.height.as_int() -
+                        clip_area.value().top_left.y.as_int() -
+                        clip_area.value().size.height.as_int(),
+                    clip_area.value().size.width.as_int(),
+                    clip_area.value().size.height.as_int()
+                );
+            }
+            else if (scissor_enabled)
+            {
+                glDisable(GL_SCISSOR_TEST);
+                scissor_enabled = false;
+            }
+
+            glm::mat4 const transform = draw.texture ?
+                texture_transform_for(renderable, *draw.texture) :
+                renderable.transformation();
+            if (transform != prog.last_transform)
+            {
+                glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE, glm::value_ptr(transform));
+                prog.last_transform = transform;
+            }
+
+            // The centre only matters to the shader if there's a transformation
+            if (transform != glm::mat4{1})
+            {
+                auto const& rect = renderable.screen_position();
+                glm::vec2 const centre{
+                    rect.top_left.x.as_int() + rect.size.width.as_int() / 2.0f,
+                    rect.top_left.y.as_int() + rect.size.height.as_int() / 2.0f};
+
+                if (centre != prog.last_centre)
+                {
+                    glUniform2f(prog.centre_uniform, centre.x, centre.y);
+                    prog.last_centre = centre;
+                }
+            }
+
+            if (prog.alpha_uniform >= 0 && renderable.alpha() != prog.last_alpha)
+            {
+                glUniform1f(prog.alpha_uniform, renderable.alpha());
+                prog.last_alpha = renderable.alpha();
+            }
+
+            if (draw.solid_color && draw.solid_color.value() != prog.last_color)
+            {
+                glUniform4fv(prog.color_uniform, 1, glm::value_ptr(draw.solid_color.value()));
+                prog.last_color = draw.solid_color.value();
+            }
+
+            if (!draw.texture)
+            {
+                for (auto i = draw.first_primitive; i != draw.end_primitive; ++i)
+                    glDrawArrays(ranges[i].type, ranges[i].first, ranges[i].count);
+                continue;
+            }
+
+            // if we fail to load the texture, we need to carry on (part of lp:1629275)
+            try
+            {
+                draw.texture->bind();
+
+                for (auto i = draw.first_primitive; i != draw.end_primitive; ++i)
+                    glDrawArrays(ranges[i].type, ranges[i].first, ranges[i].count);
+
+                // We're done with the texture for now
+                draw.texture->add_syncpoint();
+            }
+            catch (std::exception const& ex)
+            {
+                report_exception();
+            }
+        }
+    }
+
+    if (current_program->texcoord_attr >= 0)
+        glDisableVertexAttribArray(current_program->texcoord_attr);
+    glDisableVertexAttribArray(current_program->position_attr);
+    if (scissor_enabled)
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+auto mrg::Renderer::solid_color_shader() const -> mg::gl::Program&
+{
+    return program_factory->compile_fragment_shader(&solid_color_shader_id, "", solid_color_fragment_src);
+}
+
 void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
 {
     if (rect == viewport)
@@ -34,7 +34,7 @@
 namespace mir
 {
 namespace gl { class TextureCache; }
-namespace graphics { class DisplayBuffer; }
+namespace graphics { class DisplayBuffer; namespace gl { class Program; } }
 namespace renderer
 {
 namespace gl
@@ -57,13 +57,25 @@ private:
 class Renderer : public renderer::Renderer
 {
 public:
-    Renderer(graphics::DisplayBuffer& display_buffer);
+    enum class DrawPath
+    {
+        /// draw() each renderable in turn
+        per_renderable,
+        /// Upload the frame's vertices to a single vertex buffer and group
+        /// renderables by program and blend state, skipping redundant GL calls
+        batched
+    };
+
+    Renderer(graphics::DisplayBuffer& display_buffer, DrawPath draw_path = DrawPath::per_renderable);
     virtual ~Renderer();
 
     // These are called with a valid GL context:
     void set_viewport(geometry::Rectangle const& rect) override;
     void set_output_transform(glm::mat2 const&) override;
     void render(graphics::RenderableList const&) const override;
+    void render_and_read_back(
+        graphics::RenderableList const& renderables,
+        std::vector<Readback>& readbacks) const override;
 
     // This is called _without_ a GL context:
     void suspend() override;
@@ -83,8 +95,15 @@ public:
         GLint transform_uniform = -1;
         GLint screen_to_gl_coords_uniform = -1;
         GLint alpha_uniform = -1;
+        GLint color_uniform = -1;
         mutable long long last_used_frameno = 0;
 
+        // The per-renderable uniforms last set by the batched draw path
+        mutable glm::mat4 last_transform{0.0f};
+        mutable glm::vec2 last_centre{0.0f, 0.0f};
+        mutable GLfloat last_alpha = -1.0f;
+        mutable glm::vec4 last_color{-1.0f};
+
         Program(GLuint program_id);
     };
 private:
@@ -101,6 +120,9 @@ protected:
      *                            grown and/or modified.
      * \param [in]     renderable The renderable surface being tessellated.
      *
+     * \note Renderables that are blended but have an opaque_region(), and
+     *       that this leaves as a single rectangle, are then split into
+     *       rectangles, so their opaque parts can be drawn without blending.
      * \note The cohesion of this function to gl::Renderer is quite loose and it
      *       does not strictly need to reside here.
      *       However it seems a good choice under gl::Renderer while this remains
@@ -118,6 +140,15 @@ protected:
 
 private:
     void update_gl_viewport();
+    void draw_batched(graphics::RenderableList const& renderables) const;
+    void read_back(Readback& readback) const;
+    /// Tessellates the renderable (through tessellate()) into primitives, to blend as usual. If that is just its
+    /// rectangle, \p opaque_parts are instead split out into opaque_primitives (to draw without blending).
+    void tessellate_by_opacity(
+        graphics::Renderable const& renderable,
+        std::vector<geometry::Rectangle> const& opaque_parts) const;
+    /// The program family that fills renderables with a SolidColorBuffer's colour
+    auto solid_color_shader() const -> graphics::gl::Program&;
 
     class ProgramFactory;
     std::unique_ptr<ProgramFactory> const program_factory;
@@ -125,6 +156,11 @@ private:
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+    std::vector<mir::gl::Primitive> mutable opaque_primitives;
+
+    DrawPath const draw_path;
+    GLuint mutable vertex_buffer{0};
+    std::vector<mir::gl::Vertex> mutable frame_vertices;
 };
 
 }
@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buffer_mailbox.h"
+#include "mir/graphics/buffer.h"
+
+#include <thread>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+// The published state is (submission count << slot_bits) | slot. The counter
+// means a compositor can tell the state hasn't changed, even if a slot is reused.
+//
+// A compositor reading a slot announces itself (readers) and then checks the slot
+// is still published; the submitter publishes a different slot and then checks
+// for readers before reusing or clearing a slot. With sequentially consistent
+// operations on both sides, one of them always sees the other.
+namespace
+{
+unsigned int const slot_bits = 3;
+std::uint64_t const slot_mask = (1u << slot_bits) - 1;
+
+auto slot_of(std::uint64_t state) -> unsigned int
+{
+    return state & slot_mask;
+}
+}
+
+mc::BufferMailbox::BufferMailbox() :
+    published{slot_count}
+{
+    static_assert(slot_count < slot_mask, "slot_count (meaning \"empty\") must fit in slot_bits");
+}
+
+mc::BufferMailbox::~BufferMailbox() = default;
+
+void mc::BufferMailbox::submit(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    auto const previous = published.load();
+
+    auto slot = slot_count;
+    if (buffer)
+    {
+        // Any slot but the published one, that no compositor is reading from
+        for (;;)
+        {
+            for (auto i = 0u; i != slot_count && slot == slot_count; ++i)
+            {
+                if (i != slot_of(previous) && slots[i].readers == 0)
+                    slot = i;
+            }
+
+            if (slot != slot_count)
+                break;
+
+            std::this_thread::yield();
+        }
+
+        slots[slot].buffer = buffer;
+    }
+
+    published = (((previous >> slot_bits) + 1) << slot_bits) | slot;
+
+    // Compositors can no longer reach the other buffers: let them go back to the client
+    for (auto i = 0u; i != slot_count; ++i)
+    {
+        if (i != slot && slots[i].readers == 0)
+            slots[i].buffer.reset();
+    }
+}
+
+auto mc::BufferMailbox::take() -> std::shared_ptr<mg::Buffer>
+{
+    auto const state = published.load();
+    auto const buffer = slot_of(state) == slot_count ? nullptr : slots[slot_of(state)].buffer;
+
+    submit(nullptr);
+    return buffer;
+}
+
+auto mc::BufferMailbox::latest() -> std::shared_ptr<mg::Buffer>
+{
+    std::uint64_t state;
+    return read(state);
+}
+
+auto mc::BufferMailbox::acquire(CompositorID id) -> std::shared_ptr<mg::Buffer>
+{
+    auto& consumer = consumer_for(id);
+
+    std::uint64_t state;
+    auto buffer = read(state);
+    if (buffer)
+        consumer.seen = state;
+
+    return buffer;
+}
+
+auto mc::BufferMailbox::ready_for(CompositorID id) const -> bool
+{
+    auto const state = published.load();
+    if (slot_of(state) == slot_count)
+        return false;
+
+    for (auto const& consumer : consumers)
+    {
+        if (consumer.id == id)
+            return consumer.seen != state;
+    }
+
+    return true;
+}
+
+auto mc::BufferMailbox::empty() const -> bool
+{
+    return slot_of(published) == slot_count;
+}
+
+auto mc::BufferMailbox::read(std::uint64_t& state) -> std::shared_ptr<mg::Buffer>
+{
+    for (;;)
+    {
+        state = published.load();
+        auto const slot = slot_of(state);
+        if (slot == slot_count)
+            return nullptr;
+
+        ++slots[slot].readers;
+        if (published.load() == state)
+        {
+            auto buffer = slots[slot].buffer;
+            --slots[slot].readers;
+            return buffer;
+        }
+
+        // A submission overtook us: try the new state
+        --slots[slot].readers;
+    }
+}
+
+auto mc::BufferMailbox::consumer_for(CompositorID id) -> Consumer&
+{
+    for (auto& consumer : consumers)
+    {
+        if (consumer.id == id)
+            return consumer;
+    }
+
+    for (;;)
+    {
+        // Claim an unused entry, or failing that the one that saw the oldest state
+        auto claim = &consumers[0];
+        auto claim_id = claim->id.load();
+        for (auto& consumer : consumers)
+        {
+            auto const consumer_id = consumer.id.load();
+            if (!consumer_id)
+            {
+                claim = &consumer;
+                claim_id = consumer_id;
+                break;
+            }
+            if (consumer.seen < claim->seen)
+            {
+                claim = &consumer;
+                claim_id = consumer_id;
+            }
+        }
+
+        if (claim->id.compare_exchange_strong(claim_id, id))
+        {
+            claim->seen = 0;
+            return *claim;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_BUFFER_MAILBOX_H_
+#define MIR_COMPOSITOR_BUFFER_MAILBOX_H_
+
+#include "mir/compositor/compositor_id.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace mir
+{
+namespace graphics { class Buffer; }
+namespace compositor
+{
+/// Holds only the most recently submitted buffer of a frame-dropping stream
+///
+/// Compositors acquire the buffer without taking a lock, so they never wait
+/// for (or hold up) a submission. Submissions must come from one thread at a
+/// time: the owning stream serialises them.
+class BufferMailbox
+{
+public:
+    BufferMailbox();
+    ~BufferMailbox();
+
+    /// Replaces the latest buffer (a null \p buffer empties the mailbox)
+    void submit(std::shared_ptr<graphics::Buffer> const& buffer);
+
+    /// Empties the mailbox (a submission, so must be serialised with submit())
+    /// \return the buffer it held
+    auto take() -> std::shared_ptr<graphics::Buffer>;
+
+    /// The latest buffer, or null if there is none
+    auto latest() -> std::shared_ptr<graphics::Buffer>;
+
+    /// The latest buffer (or null), noting that compositor \p id has seen it
+    auto acquire(CompositorID id) -> std::shared_ptr<graphics::Buffer>;
+
+    /// Whether there is a buffer compositor \p id hasn't acquired
+    auto ready_for(CompositorID id) const -> bool;
+
+    auto empty() const -> bool;
+
+private:
+    BufferMailbox(BufferMailbox const&) = delete;
+    BufferMailbox& operator=(BufferMailbox const&) = delete;
+
+    /// Enough that a submission can almost always find a slot no compositor is reading
+    static unsigned int const slot_count = 4;
+
+    /// Compositors whose view of the mailbox is tracked. If there are more
+    /// the one seen longest ago is forgotten, and so is shown the latest buffer again.
+    static unsigned int const consumer_count = 8;
+
+    struct Slot
+    {
+        std::shared_ptr<graphics::Buffer> buffer;
+        std::atomic<unsigned int> readers{0};
+    };
+
+    struct Consumer
+    {
+        std::atomic<CompositorID> id{nullptr};
+        std::atomic<std::uint64_t> seen{0};
+    };
+
+    /// Reads the latest buffer, and the published state it was read from
+    auto read(std::uint64_t& state) -> std::shared_ptr<graphics::Buffer>;
+    auto consumer_for(CompositorID id) -> Consumer&;
+
+    std::array<Slot, slot_count> slots;
+    std::array<Consumer, consumer_count> consumers;
+
+    /// A submission counter, and the slot holding the latest buffer
+    std::atomic<std::uint64_t> published;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_BUFFER_MAILBOX_H_ */
@@ -22,6 +22,8 @@
 #include "buffer_stream_factory.h"
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
+#include "mir/compositor/screen_copy.h"
+#include "mir/input/scene.h"
 #include "gl/renderer_factory.h"
 #include "mir/main_loop.h"
 
@@ -50,7 +52,23 @@ mir::DefaultServerConfiguration::the_display_buffer_compositor_factory()
         [this]()
         {
             return wrap_display_buffer_compositor_factory(std::make_shared<mc::DefaultDisplayBufferCompositorFactory>(
-                the_renderer_factory(), the_compositor_report()));
+                the_renderer_factory(), the_compositor_report(), the_screen_copy()));
+        });
+}
+
+std::shared_ptr<mc::ScreenCopy>
+mir::DefaultServerConfiguration::the_screen_copy()
+{
+    return screen_copy(
+        [this]()
+        {
+            std::weak_ptr<input::Scene> const scene = the_input_scene();
+            return std::make_shared<mc::ScreenCopy>(
+                [scene]
+                {
+                    if (auto const input_scene = scene.lock())
+                        input_scene->emit_scene_changed();
+                });
         });
 }
 
@@ -84,8 +102,12 @@ mir::DefaultServerConfiguration::the_compositor()
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]()
         {
-            return std::make_shared<mir::renderer::gl::RendererFactory>();
+            auto const draw_path = the_options()->get<bool>(options::gl_batched_draws_opt) ?
+                mir::renderer::gl::Renderer::DrawPath::batched :
+                mir::renderer::gl::Renderer::DrawPath::per_renderable;
+
+            return std::make_shared<mir::renderer::gl::RendererFactory>(draw_path);
         });
 }
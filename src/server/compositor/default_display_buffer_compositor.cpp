@@ -21,6 +21,7 @@
 
 #include "mir/compositor/scene.h"
 #include "mir/compositor/scene_element.h"
+#include "mir/compositor/screen_copy.h"
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/graphics/buffer.h"
@@ -37,10 +38,12 @@ namespace mg = mir::graphics;
 mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
     mg::DisplayBuffer& display_buffer,
     std::shared_ptr<mir::renderer::Renderer> const& renderer,
-    std::shared_ptr<mc::CompositorReport> const& report) :
+    std::shared_ptr<mc::CompositorReport> const& report,
+    std::shared_ptr<mc::ScreenCopy> const& screen_copy) :
     display_buffer(display_buffer),
     renderer(renderer),
-    report(report)
+    report(report),
+    screen_copy(screen_copy)
 {
 }
 
@@ -72,7 +75,15 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      */
     scene_elements.clear();  // Those in use are still in renderable_list
 
-    if (display_buffer.overlay(renderable_list))
+    auto copies = screen_copy ?
+        screen_copy->copies_for(view_area, renderable_list) :
+        ScreenCopy::FrameCopies{};
+
+    // What the display buffer leaves for us to composite
+    auto to_composite = renderable_list;
+
+    // Copies are read back from what we render, so they need a rendered frame
+    if (copies.empty() && display_buffer.overlay_top(to_composite))
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
@@ -81,7 +92,15 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     {
         renderer->set_output_transform(display_buffer.transformation());
         renderer->set_viewport(view_area);
-        renderer->render(renderable_list);
+        if (copies.empty())
+        {
+            renderer->render(to_composite);
+        }
+        else
+        {
+            renderer->render_and_read_back(renderable_list, copies.readbacks);
+            copies.complete(std::chrono::steady_clock::now());
+        }
 
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
@@ -96,8 +115,11 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
          *        clear() doesn't contribute anything. In that case the
          *        problematic IPC (LP: #1395421) will instead occur in buffer
          *        acquisition calls when we composite the next frame.
+         * Note: Wayland SHM buffers don't wait for this; they are released
+         *       to the client as soon as render() uploads them to a texture.
          */
         renderable_list.clear();
+        to_composite.clear();
     }
 
     report->finished_frame(this);
@@ -37,6 +37,7 @@ namespace compositor
 {
 
 class Scene;
+class ScreenCopy;
 
 class DefaultDisplayBufferCompositor : public DisplayBufferCompositor
 {
@@ -44,7 +45,8 @@ public:
     DefaultDisplayBufferCompositor(
         graphics::DisplayBuffer& display_buffer,
         std::shared_ptr<renderer::Renderer> const& renderer,
-        std::shared_ptr<CompositorReport> const& report);
+        std::shared_ptr<CompositorReport> const& report,
+        std::shared_ptr<ScreenCopy> const& screen_copy = {});
 
     void composite(SceneElementSequence&& scene_sequence) override;
 
@@ -52,6 +54,7 @@ private:
     graphics::DisplayBuffer& display_buffer;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<ScreenCopy> const screen_copy;
 };
 
 }
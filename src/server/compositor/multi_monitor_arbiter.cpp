@@ -117,6 +117,13 @@ void mc::MultiMonitorArbiter::advance_schedule()
     } 
 }
 
+std::shared_ptr<mg::Buffer> mc::MultiMonitorArbiter::take_current_buffer()
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    clear_current_users();
+    return std::move(current_buffer);
+}
+
 void mc::MultiMonitorArbiter::add_current_buffer_user(mc::CompositorID id)
 {
     // First try and find an empty slot in our vector…
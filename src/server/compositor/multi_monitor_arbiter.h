@@ -46,6 +46,9 @@ public:
     void set_schedule(std::shared_ptr<Schedule> const& schedule);
     bool buffer_ready_for(compositor::CompositorID id);
     void advance_schedule();
+    /// Forget the current buffer (so that the schedule has the only references)
+    /// \return the buffer that was current
+    std::shared_ptr<graphics::Buffer> take_current_buffer();
 
 private:
     void add_current_buffer_user(compositor::CompositorID id);
@@ -108,6 +108,10 @@ public:
                     scene->unregister_compositor(std::get<1>(compositor).get());
             });
 
+        std::vector<mc::CompositorID> compositor_ids;
+        for (auto& compositor : compositors)
+            compositor_ids.push_back(std::get<1>(compositor).get());
+
         started.set_value();
 
         try
@@ -135,10 +139,12 @@ public:
                     not_posted_yet = false;
                     lock.unlock();
 
+                    // One traversal of the scene serves every output, including those on other threads
+                    auto scene_elements = scene->scene_elements_for_group(compositor_ids);
+                    auto elements = scene_elements.begin();
                     for (auto& tuple : compositors)
                     {
-                        auto& compositor = std::get<1>(tuple);
-                        compositor->composite(scene->scene_elements_for(compositor.get()));
+                        std::get<1>(tuple)->composite(std::move(*elements++));
                     }
                     group.post();
 
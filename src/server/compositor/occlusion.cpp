@@ -56,8 +56,23 @@ bool renderable_is_occluded(
         }
     }
 
-    if (!occluded && renderable.alpha() == 1.0f && !renderable.shaped())
-        coverage.push_back(clipped_window);
+    if (!occluded && renderable.alpha() == 1.0f)
+    {
+        if (!renderable.shaped())
+        {
+            coverage.push_back(clipped_window);
+        }
+        else
+        {
+            // Translucent clients may still promise some of their area is opaque
+            for (auto const& opaque : renderable.opaque_region())
+            {
+                auto const clipped_opaque = opaque.intersection_with(clipped_window);
+                if (clipped_opaque != empty)
+                    coverage.push_back(clipped_opaque);
+            }
+        }
+    }
 
     return occluded;
 }
@@ -0,0 +1,224 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/screen_copy.h"
+#include "mir/graphics/buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// Everything about a renderable that changes how it is drawn
+struct ElementState
+{
+    mg::Renderable::ID id;
+    mg::BufferID buffer;
+    geom::Rectangle position;
+    geom::Rectangle visible;
+    std::experimental::optional<geom::RectangleF> src_bounds;
+    float alpha;
+    glm::mat4 transformation;
+
+    auto same_content_as(ElementState const& other) const -> bool
+    {
+        return id == other.id &&
+               buffer == other.buffer &&
+               position == other.position &&
+               visible == other.visible &&
+               src_bounds == other.src_bounds &&
+               alpha == other.alpha &&
+               transformation == other.transformation;
+    }
+};
+
+auto states_in(geom::Rectangle const& area, mg::RenderableList const& renderables) -> std::vector<ElementState>
+{
+    std::vector<ElementState> result;
+    for (auto const& renderable : renderables)
+    {
+        auto const position = renderable->screen_position();
+        auto visible = position.intersection_with(area);
+        if (auto const clip = renderable->clip_area())
+            visible = visible.intersection_with(clip.value());
+
+        if (visible.size.width.as_int() <= 0 || visible.size.height.as_int() <= 0)
+            continue;
+
+        auto const buffer = renderable->buffer();
+        result.push_back({
+            renderable->id(),
+            buffer ? buffer->id() : mg::BufferID{},
+            position,
+            visible,
+            renderable->src_bounds(),
+            renderable->alpha(),
+            renderable->transformation()});
+    }
+    return result;
+}
+
+/// Maps \p rect in scene coordinates into a copy of \p area that is \p size pixels
+auto copy_pixels_for(geom::Rectangle const& rect, geom::Rectangle const& area, geom::Size size) -> geom::Rectangle
+{
+    auto const scale_x = float(size.width.as_int()) / area.size.width.as_int();
+    auto const scale_y = float(size.height.as_int()) / area.size.height.as_int();
+
+    // Round outwards, so scaling never loses damage
+    int const left = std::floor((rect.left() - area.left()).as_int() * scale_x);
+    int const top = std::floor((rect.top() - area.top()).as_int() * scale_y);
+    int const right = std::ceil((rect.right() - area.left()).as_int() * scale_x);
+    int const bottom = std::ceil((rect.bottom() - area.top()).as_int() * scale_y);
+
+    return {{left, top}, {right - left, bottom - top}};
+}
+}
+
+class mc::ScreenCopy::DamageHistory
+{
+public:
+    /// Record the frame's \p states for \p area
+    /// \return what differs from the recorded frame, in scene coordinates
+    auto update(geom::Rectangle const& area, std::vector<ElementState>&& states) -> std::vector<geom::Rectangle>
+    {
+        std::vector<geom::Rectangle> damage;
+
+        if (!recorded || area != last_area)
+        {
+            damage.push_back(area);
+        }
+        else
+        {
+            // Anything that moved, changed or changed stacking order is damaged
+            // where it was and where it is
+            auto const common = std::min(states.size(), last_states.size());
+            std::size_t unchanged = 0;
+            while (unchanged != common && states[unchanged].same_content_as(last_states[unchanged]))
+                ++unchanged;
+
+            for (auto i = unchanged; i != states.size(); ++i)
+                damage.push_back(states[i].visible);
+            for (auto i = unchanged; i != last_states.size(); ++i)
+                damage.push_back(last_states[i].visible);
+        }
+
+        recorded = true;
+        last_area = area;
+        last_states = std::move(states);
+        return damage;
+    }
+
+private:
+    std::mutex mutex;
+    bool recorded = false;
+    geom::Rectangle last_area;
+    std::vector<ElementState> last_states;
+
+    friend class mc::ScreenCopy;
+};
+
+void mc::ScreenCopy::FrameCopies::complete(std::chrono::steady_clock::time_point time)
+{
+    for (std::size_t i = 0; i != requests.size(); ++i)
+    {
+        auto& readback = readbacks[i];
+        requests[i]->on_done({readback.read, std::move(readback.pixels), std::move(damage[i]), time});
+    }
+
+    requests.clear();
+    readbacks.clear();
+    damage.clear();
+}
+
+mc::ScreenCopy::ScreenCopy(std::function<void()> schedule_frame) :
+    schedule_frame{std::move(schedule_frame)}
+{
+}
+
+mc::ScreenCopy::~ScreenCopy() = default;
+
+auto mc::ScreenCopy::new_damage_history() -> std::shared_ptr<DamageHistory>
+{
+    return std::make_shared<DamageHistory>();
+}
+
+auto mc::ScreenCopy::copy(Request request) -> std::shared_ptr<void>
+{
+    auto const wait_for_damage = request.wait_for_damage;
+    auto const pending_copy = std::make_shared<Request>(std::move(request));
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        pending.push_back(pending_copy);
+    }
+
+    // A copy that waits for damage waits for the scene to change anyway
+    if (!wait_for_damage)
+        schedule_frame();
+
+    return pending_copy;
+}
+
+auto mc::ScreenCopy::copies_for(
+    geom::Rectangle const& view_area,
+    mg::RenderableList const& renderables) -> FrameCopies
+{
+    FrameCopies result;
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    if (pending.empty())
+        return result;
+
+    pending.erase(
+        std::remove_if(begin(pending), end(pending), [&](std::weak_ptr<Request> const& weak_request)
+            {
+                auto const request = weak_request.lock();
+                if (!request)
+                    return true;    // Cancelled
+
+                auto const& area = request->area;
+                if (view_area.intersection_with(area) != area)
+                    return false;   // Shown by another output
+
+                std::vector<geom::Rectangle> damage;
+                if (request->history)
+                {
+                    std::lock_guard<decltype(request->history->mutex)> history_lock{request->history->mutex};
+                    damage = request->history->update(area, states_in(area, renderables));
+                }
+                else
+                {
+                    damage.push_back(area);
+                }
+
+                if (damage.empty() && request->wait_for_damage)
+                    return false;
+
+                for (auto& rect : damage)
+                    rect = copy_pixels_for(rect, area, request->size);
+
+                result.readbacks.push_back({area, request->size, {}, false});
+                result.damage.push_back(std::move(damage));
+                result.requests.push_back(request);
+                return true;
+            }),
+        end(pending));
+
+    return result;
+}
@@ -19,9 +19,9 @@
 
 #include "stream.h"
 #include "queueing_schedule.h"
-#include "dropping_schedule.h"
 #include "mir/graphics/buffer.h"
 #include <boost/throw_exception.hpp>
+#include <cmath>
 
 namespace mc = mir::compositor;
 namespace geom = mir::geometry;
@@ -57,7 +57,10 @@ void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
         std::lock_guard<decltype(mutex)> lk(mutex);
         pf = buffer->pixel_format();
         latest_buffer_size = buffer->size();
-        schedule->schedule(buffer);
+        if (schedule_mode == ScheduleMode::Dropping)
+            mailbox.submit(buffer);
+        else
+            schedule->schedule(buffer);
         first_frame_posted = true;
     }
     {
@@ -69,7 +72,17 @@ void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
 void mc::Stream::with_most_recent_buffer_do(std::function<void(mg::Buffer&)> const& fn)
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
-    fn(*arbiter->snapshot_acquire());
+    if (schedule_mode == ScheduleMode::Dropping)
+    {
+        auto const buffer = mailbox.latest();
+        if (!buffer)
+            BOOST_THROW_EXCEPTION(std::logic_error("no buffer to give to snapshotter"));
+        fn(*buffer);
+    }
+    else
+    {
+        fn(*arbiter->snapshot_acquire());
+    }
 }
 
 MirPixelFormat mc::Stream::pixel_format() const
@@ -87,6 +100,21 @@ void mc::Stream::set_frame_posted_callback(
 
 std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
 {
+    // The common case: a frame-dropping stream with a buffer
+    if (schedule_mode == ScheduleMode::Dropping)
+    {
+        if (auto buffer = mailbox.acquire(id))
+            return buffer;
+    }
+
+    // Otherwise hold the mode steady while we look
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    if (schedule_mode == ScheduleMode::Dropping)
+    {
+        if (auto buffer = mailbox.acquire(id))
+            return buffer;
+        BOOST_THROW_EXCEPTION(std::logic_error("no buffer to give to compositor"));
+    }
     return arbiter->compositor_acquire(id);
 }
 
@@ -103,12 +131,20 @@ void mc::Stream::allow_framedropping(bool dropping)
     std::lock_guard<decltype(mutex)> lk(mutex);
     if (dropping && schedule_mode == ScheduleMode::Queueing)
     {
-        transition_schedule(std::make_shared<mc::DroppingSchedule>(), lk);
+        // Only the newest buffer survives
+        auto latest = arbiter->take_current_buffer();
+        while (schedule->num_scheduled())
+            latest = schedule->next_buffer();
+
+        if (latest)
+            mailbox.submit(latest);
         schedule_mode = ScheduleMode::Dropping;
     }
     else if (!dropping && schedule_mode == ScheduleMode::Dropping)
     {
-        transition_schedule(std::make_shared<mc::QueueingSchedule>(), lk);
+        // A compositor that saw the old mode finds the mailbox empty, and rechecks under the lock
+        if (auto const latest = mailbox.take())
+            schedule->schedule(latest);
         schedule_mode = ScheduleMode::Queueing;
     }
 }
@@ -118,21 +154,14 @@ bool mc::Stream::framedropping() const
     return schedule_mode == ScheduleMode::Dropping;
 }
 
-void mc::Stream::transition_schedule(
-    std::shared_ptr<mc::Schedule>&& new_schedule, std::lock_guard<std::mutex> const&)
-{
-    std::vector<std::shared_ptr<mg::Buffer>> transferred_buffers;
-    while(schedule->num_scheduled())
-        transferred_buffers.emplace_back(schedule->next_buffer());
-    for(auto& buffer : transferred_buffers)
-        new_schedule->schedule(buffer);
-    schedule = new_schedule;
-    arbiter->set_schedule(schedule);
-}
-
 int mc::Stream::buffers_ready_for_compositor(void const* id) const
 {
+    if (schedule_mode == ScheduleMode::Dropping && !mailbox.empty())
+        return mailbox.ready_for(id) ? 1 : 0;
+
     std::lock_guard<decltype(mutex)> lk(mutex);
+    if (schedule_mode == ScheduleMode::Dropping)
+        return mailbox.ready_for(id) ? 1 : 0;
     if (arbiter->buffer_ready_for(id))
         return 1;
     return 0;
@@ -141,6 +170,11 @@ int mc::Stream::buffers_ready_for_compositor(void const* id) const
 void mc::Stream::drop_old_buffers()
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
+
+    // The mailbox only ever holds the newest buffer
+    if (schedule_mode == ScheduleMode::Dropping)
+        return;
+
     std::vector<std::shared_ptr<mg::Buffer>> transferred_buffers;
     while(schedule->num_scheduled())
         transferred_buffers.emplace_back(schedule->next_buffer());
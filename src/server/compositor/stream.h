@@ -26,6 +26,8 @@
 #include "mir/lockable_callback.h"
 #include "mir/geometry/size.h"
 #include "multi_monitor_arbiter.h"
+#include "buffer_mailbox.h"
+#include <atomic>
 #include <mutex>
 #include <memory>
 #include <set>
@@ -59,12 +61,13 @@ public:
 
 private:
     enum class ScheduleMode;
-    void transition_schedule(std::shared_ptr<Schedule>&& new_schedule, std::lock_guard<std::mutex> const&);
 
     std::mutex mutable mutex;
-    ScheduleMode schedule_mode;
+    std::atomic<ScheduleMode> schedule_mode;
     std::shared_ptr<Schedule> schedule;
     std::shared_ptr<MultiMonitorArbiter> const arbiter;
+    /// When dropping frames, compositors take buffers from here without locking mutex
+    BufferMailbox mailbox;
     geometry::Size latest_buffer_size;
     float scale_{1.0f};
     MirPixelFormat pf;
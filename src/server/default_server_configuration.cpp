@@ -26,7 +26,7 @@
 #include "mir/cookie/authority.h"
 #include "mir/frontend/wayland.h"
 
-#include "mir/logging/dumb_console_logger.h"
+#include "mir/logging/async_logger.h"
 #include "mir/options/program_option.h"
 #include "mir/frontend/session_credentials.h"
 #include "mir/frontend/session_authorizer.h"
@@ -219,6 +219,7 @@ auto mir::DefaultServerConfiguration::the_logger()
     return logger(
         []() -> std::shared_ptr<ml::Logger>
         {
-            return std::make_shared<ml::DumbConsoleLogger>();
+            // Logging mustn't stall the compositor, input or Wayland threads
+            return std::make_shared<ml::AsyncLogger>(ml::AsyncLogger::console_sink());
         });
 }
@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/frontend/client_resources.h"
+#include "mir/graphics/buffer.h"
+#include "mir/time/clock.h"
+
+#include <algorithm>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+
+namespace
+{
+auto const sample_period = std::chrono::seconds{1};
+
+auto bytes_in(mg::Buffer const& buffer) -> std::size_t
+{
+    auto const size = buffer.size();
+    return std::size_t(size.width.as_uint32_t()) * size.height.as_uint32_t() *
+        MIR_BYTES_PER_PIXEL(buffer.pixel_format());
+}
+}
+
+mf::ClientResources::ClientResources(
+    Limits const& limits,
+    std::shared_ptr<time::Clock> const& clock,
+    std::shared_ptr<ClientResourceReport> const& report,
+    bool reporting) :
+    limits{limits},
+    clock{clock},
+    report{report},
+    reporting{reporting}
+{
+}
+
+auto mf::ClientResources::open_account(pid_t pid) -> std::shared_ptr<Account>
+{
+    auto const account = std::make_shared<Account>(pid, limits, clock, report);
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    accounts.erase(
+        std::remove_if(begin(accounts), end(accounts), [](auto const& a) { return a.expired(); }),
+        end(accounts));
+    accounts.push_back(account);
+
+    return account;
+}
+
+auto mf::ClientResources::counts_requests() const -> bool
+{
+    return reporting || limits.max_hidden_commits_per_second || limits.max_buffers_queued;
+}
+
+auto mf::ClientResources::usage() const -> std::vector<ClientResourceUsage>
+{
+    std::vector<ClientResourceUsage> result;
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    for (auto const& weak_account : accounts)
+    {
+        if (auto const account = weak_account.lock())
+            result.push_back(account->usage());
+    }
+
+    return result;
+}
+
+mf::ClientResources::Account::Account(
+    pid_t pid,
+    Limits const& limits,
+    std::shared_ptr<time::Clock> const& clock,
+    std::shared_ptr<ClientResourceReport> const& report) :
+    pid{pid},
+    limits{limits},
+    clock{clock},
+    report{report},
+    sample_start{clock->now()}
+{
+}
+
+void mf::ClientResources::Account::request_dispatched()
+{
+    std::unique_lock<decltype(mutex)> lock{mutex};
+    auto const sampled = roll_sample(clock->now());
+    ++requests;
+    ++requests_in_sample;
+
+    if (sampled)
+    {
+        auto const sample = usage(lock);
+        lock.unlock();
+        report->usage_sampled(sample);
+    }
+}
+
+auto mf::ClientResources::Account::commit(
+    std::shared_ptr<mg::Buffer> const& buffer,
+    std::shared_ptr<std::atomic<bool>> const& consumed,
+    bool surface_hidden) -> bool
+{
+    std::unique_lock<decltype(mutex)> lock{mutex};
+    auto const sampled = roll_sample(clock->now());
+    ++commits;
+    ++commits_in_sample;
+
+    if (surface_hidden)
+        ++hidden_commits_in_sample;
+
+    bool show = true;
+    if (buffer)
+    {
+        prune_buffers();
+
+        if ((surface_hidden &&
+             limits.max_hidden_commits_per_second &&
+             hidden_commits_in_sample > limits.max_hidden_commits_per_second) ||
+            (limits.max_buffers_queued && buffers_queued() >= limits.max_buffers_queued))
+        {
+            ++frames_dropped;
+            show = false;
+        }
+        else
+        {
+            held_buffers.push_back({buffer, consumed, bytes_in(*buffer)});
+        }
+    }
+
+    if (sampled)
+    {
+        auto const sample = usage(lock);
+        lock.unlock();
+        report->usage_sampled(sample);
+    }
+
+    return show;
+}
+
+auto mf::ClientResources::Account::usage() const -> ClientResourceUsage
+{
+    std::unique_lock<decltype(mutex)> lock{mutex};
+    return usage(lock);
+}
+
+auto mf::ClientResources::Account::roll_sample(time::Timestamp now) -> bool
+{
+    auto const elapsed = now - sample_start;
+    if (elapsed < sample_period)
+        return false;
+
+    // If a whole sample period passed without activity the client was idle for it
+    bool const consecutive = elapsed < 2*sample_period;
+    requests_per_second = consecutive ? requests_in_sample : 0;
+    commits_per_second = consecutive ? commits_in_sample : 0;
+
+    requests_in_sample = 0;
+    commits_in_sample = 0;
+    hidden_commits_in_sample = 0;
+    sample_start = now;
+    return true;
+}
+
+void mf::ClientResources::Account::prune_buffers()
+{
+    held_buffers.erase(
+        std::remove_if(begin(held_buffers), end(held_buffers), [](auto const& b) { return b.buffer.expired(); }),
+        end(held_buffers));
+}
+
+auto mf::ClientResources::Account::buffers_queued() const -> unsigned
+{
+    return std::count_if(begin(held_buffers), end(held_buffers), [](auto const& b)
+        {
+            return !b.buffer.expired() && b.consumed && !*b.consumed;
+        });
+}
+
+auto mf::ClientResources::Account::usage(std::unique_lock<std::mutex> const&) const -> ClientResourceUsage
+{
+    bool const idle = clock->now() - sample_start >= 2*sample_period;
+
+    ClientResourceUsage result{
+        pid,
+        requests,
+        commits,
+        idle ? 0 : requests_per_second,
+        idle ? 0 : commits_per_second,
+        0,
+        0,
+        frames_dropped};
+
+    for (auto const& held : held_buffers)
+    {
+        if (!held.buffer.expired())
+        {
+            ++result.buffers_held;
+            result.buffer_bytes_held += held.bytes;
+        }
+    }
+
+    return result;
+}
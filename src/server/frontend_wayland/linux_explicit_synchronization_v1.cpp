@@ -0,0 +1,241 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linux_explicit_synchronization_v1.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
+#include "wl_surface.h"
+
+#include "mir/executor.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/explicit_sync_buffer.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <linux/sync_file.h>
+#include <sys/ioctl.h>
+
+namespace mw = mir::wayland;
+namespace mg = mir::graphics;
+
+namespace mir
+{
+namespace frontend
+{
+class LinuxExplicitSynchronizationV1 : public wayland::LinuxExplicitSynchronizationV1
+{
+public:
+    LinuxExplicitSynchronizationV1(wl_resource* resource);
+
+    class Global : public wayland::LinuxExplicitSynchronizationV1::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_zwp_linux_explicit_synchronization_v1) override;
+    };
+
+private:
+    void get_synchronization(wl_resource* id, wl_resource* surface) override;
+};
+
+/// Records a surface's fence and release for the next commit. The surface does the work on commit.
+class LinuxSurfaceSynchronizationV1 : public wayland::LinuxSurfaceSynchronizationV1
+{
+public:
+    LinuxSurfaceSynchronizationV1(wl_resource* id, WlSurface* surface);
+    ~LinuxSurfaceSynchronizationV1();
+
+private:
+    void set_acquire_fence(Fd fd) override;
+    void get_release(wl_resource* release) override;
+
+    auto surface_or_error() const -> WlSurface&;
+
+    wayland::Weak<WlSurface> const surface;
+};
+}
+}
+
+namespace
+{
+auto is_sync_file(mir::Fd const& fd) -> bool
+{
+    sync_file_info info{};
+    return ioctl(fd, SYNC_IOC_FILE_INFO, &info) == 0;
+}
+}
+
+auto mir::frontend::create_linux_explicit_synchronization_v1(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<LinuxExplicitSynchronizationV1::Global>(display);
+}
+
+auto mir::frontend::buffer_with_release(
+    std::shared_ptr<graphics::Buffer> buffer,
+    wayland::Weak<wayland::LinuxBufferReleaseV1> const& release,
+    std::shared_ptr<Executor> const& wayland_executor) -> std::shared_ptr<graphics::Buffer>
+{
+    if (!release)
+    {
+        return buffer;
+    }
+
+    auto send_release = [release, executor = wayland_executor](Fd fence)
+        {
+            executor->spawn([release, fence]()
+                {
+                    if (release)
+                    {
+                        if (fence != Fd::invalid)
+                        {
+                            release.value().send_fenced_release_event(fence);
+                        }
+                        else
+                        {
+                            release.value().send_immediate_release_event();
+                        }
+                        release.value().destroy_and_delete();
+                    }
+                });
+        };
+
+    if (auto const explicit_sync = dynamic_cast<mg::ExplicitSyncBuffer*>(buffer->native_buffer_base()))
+    {
+        explicit_sync->set_release_fence_handler(std::move(send_release));
+        return buffer;
+    }
+
+    // Anything else is finished with once the last reference is dropped
+    auto const raw_buffer = buffer.get();
+    return std::shared_ptr<mg::Buffer>{
+        raw_buffer,
+        [buffer = std::move(buffer), send_release = std::move(send_release)](mg::Buffer*) mutable
+        {
+            buffer.reset();
+            send_release(Fd{});
+        }};
+}
+
+void mir::frontend::release_immediately(wayland::Weak<wayland::LinuxBufferReleaseV1> const& release)
+{
+    if (release)
+    {
+        release.value().send_immediate_release_event();
+        release.value().destroy_and_delete();
+    }
+}
+
+mir::frontend::LinuxExplicitSynchronizationV1::Global::Global(wl_display* display) :
+    wayland::LinuxExplicitSynchronizationV1::Global::Global{display, Version<2>{}}
+{
+}
+
+void mir::frontend::LinuxExplicitSynchronizationV1::Global::bind(wl_resource* new_zwp_linux_explicit_synchronization_v1)
+{
+    new LinuxExplicitSynchronizationV1{new_zwp_linux_explicit_synchronization_v1};
+}
+
+mir::frontend::LinuxExplicitSynchronizationV1::LinuxExplicitSynchronizationV1(wl_resource* resource) :
+    wayland::LinuxExplicitSynchronizationV1{resource, Version<2>{}}
+{
+}
+
+void mir::frontend::LinuxExplicitSynchronizationV1::get_synchronization(wl_resource* id, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->has_synchronization())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::synchronization_exists,
+            "wl_surface@%d already has a synchronization object",
+            wl_resource_get_id(surface)));
+    }
+
+    new LinuxSurfaceSynchronizationV1{id, wl_surface};
+}
+
+mir::frontend::LinuxSurfaceSynchronizationV1::LinuxSurfaceSynchronizationV1(wl_resource* id, WlSurface* surface) :
+    wayland::LinuxSurfaceSynchronizationV1{id, Version<2>{}},
+    surface{mw::make_weak(surface)}
+{
+    surface->set_synchronization(this);
+}
+
+mir::frontend::LinuxSurfaceSynchronizationV1::~LinuxSurfaceSynchronizationV1()
+{
+    // A fence set since the last commit is discarded, but not a release
+    if (surface)
+    {
+        surface.value().set_pending_acquire_fence(std::experimental::nullopt);
+    }
+}
+
+void mir::frontend::LinuxSurfaceSynchronizationV1::set_acquire_fence(Fd fd)
+{
+    auto& target = surface_or_error();
+
+    if (!is_sync_file(fd))
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_fence,
+            "fd %d is not a sync_file fence",
+            static_cast<int>(fd)));
+    }
+
+    if (target.has_pending_acquire_fence())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::duplicate_fence,
+            "wl_surface@%d already has an acquire fence for this commit",
+            wl_resource_get_id(target.raw_resource())));
+    }
+
+    target.set_pending_acquire_fence(fd);
+}
+
+void mir::frontend::LinuxSurfaceSynchronizationV1::get_release(wl_resource* release)
+{
+    auto& target = surface_or_error();
+
+    if (target.has_pending_buffer_release())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::duplicate_release,
+            "wl_surface@%d already has a release for this commit",
+            wl_resource_get_id(target.raw_resource())));
+    }
+
+    target.set_pending_buffer_release(
+        new wayland::LinuxBufferReleaseV1{release, wayland::LinuxBufferReleaseV1::Version<1>{}});
+}
+
+auto mir::frontend::LinuxSurfaceSynchronizationV1::surface_or_error() const -> WlSurface&
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::no_surface,
+            "The wl_surface of zwp_linux_surface_synchronization_v1@%d was destroyed",
+            wl_resource_get_id(resource)));
+    }
+    return surface.value();
+}
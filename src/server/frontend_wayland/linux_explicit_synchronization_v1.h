@@ -0,0 +1,54 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_LINUX_EXPLICIT_SYNCHRONIZATION_V1_H
+#define MIR_FRONTEND_LINUX_EXPLICIT_SYNCHRONIZATION_V1_H
+
+#include "mir/wayland/wayland_base.h"
+
+#include <memory>
+
+struct wl_display;
+
+namespace mir
+{
+class Executor;
+
+namespace graphics
+{
+class Buffer;
+}
+namespace wayland
+{
+class LinuxBufferReleaseV1;
+}
+namespace frontend
+{
+auto create_linux_explicit_synchronization_v1(wl_display* display) -> std::shared_ptr<void>;
+
+/// \p buffer, arranged to send \p release's event once Mir has finished reading it
+/// \note The returned buffer must be used in place of \p buffer
+auto buffer_with_release(
+    std::shared_ptr<graphics::Buffer> buffer,
+    wayland::Weak<wayland::LinuxBufferReleaseV1> const& release,
+    std::shared_ptr<Executor> const& wayland_executor) -> std::shared_ptr<graphics::Buffer>;
+
+/// Sends \p release's event (if it is still alive) for a buffer Mir never read
+void release_immediately(wayland::Weak<wayland::LinuxBufferReleaseV1> const& release);
+}
+}
+
+#endif  // MIR_FRONTEND_LINUX_EXPLICIT_SYNCHRONIZATION_V1_H
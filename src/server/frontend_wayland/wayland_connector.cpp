@@ -424,6 +424,16 @@ int halt_eventloop(int fd, uint32_t /*mask*/, void* data)
     }
     return 0;
 }
+
+/// Charges each request to the client making it
+void account_for_request(void* /*data*/, wl_protocol_logger_type type, wl_protocol_logger_message const* message)
+{
+    if (type != WL_PROTOCOL_LOGGER_REQUEST)
+        return;
+
+    if (auto const client = mf::WlClient::from(wl_resource_get_client(message->resource)))
+        client->resources().request_dispatched();
+}
 }
 
 namespace
@@ -494,9 +504,12 @@ mf::WaylandConnector::WaylandConnector(
     std::shared_ptr<MirDisplay> const& display_config,
     std::shared_ptr<mi::InputDeviceHub> const& input_hub,
     std::shared_ptr<mi::Seat> const& seat,
+    std::shared_ptr<mi::InputReport> const& input_report,
     std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
     std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
     std::shared_ptr<SurfaceStack> const& surface_stack,
+    std::shared_ptr<mc::ScreenCopy> const& screen_copy,
+    std::shared_ptr<ClientResources> const& client_resources,
     std::shared_ptr<ms::Clipboard> const& clipboard,
     std::shared_ptr<MainLoop> const& main_loop,
     bool arw_socket,
@@ -546,7 +559,7 @@ mf::WaylandConnector::WaylandConnector(
         std::make_shared<FrameExecutor>(*main_loop),
         this->allocator);
     subcompositor_global = std::make_unique<mf::WlSubcompositor>(display.get());
-    seat_global = std::make_unique<mf::WlSeat>(display.get(), input_hub, seat, enable_key_repeat);
+    seat_global = std::make_unique<mf::WlSeat>(display.get(), input_hub, seat, input_report, enable_key_repeat);
     output_manager = std::make_unique<mf::OutputManager>(
         display.get(),
         display_config,
@@ -561,7 +574,8 @@ mf::WaylandConnector::WaylandConnector(
         clipboard,
         seat_global.get(),
         output_manager.get(),
-        surface_stack});
+        surface_stack,
+        screen_copy});
 
     wl_display_init_shm(display.get());
 
@@ -596,7 +610,12 @@ mf::WaylandConnector::WaylandConnector(
 
     auto wayland_loop = wl_display_get_event_loop(display.get());
 
-    WlClient::setup_new_client_handler(display.get(), shell, session_authorizer, [this](WlClient& client)
+    if (client_resources->counts_requests())
+    {
+        wl_display_add_protocol_logger(display.get(), &account_for_request, nullptr);
+    }
+
+    WlClient::setup_new_client_handler(display.get(), shell, session_authorizer, client_resources, [this](WlClient& client)
         {
             int const fd = wl_client_get_fd(client.raw_client());
             auto const handler_iter = connect_handlers.find(fd);
@@ -36,6 +36,7 @@ class Executor;
 namespace input
 {
 class InputDeviceHub;
+class InputReport;
 class Seat;
 }
 namespace graphics
@@ -46,6 +47,10 @@ namespace geometry
 {
 struct Size;
 }
+namespace compositor
+{
+class ScreenCopy;
+}
 namespace shell
 {
 class Shell;
@@ -66,6 +71,7 @@ class SessionAuthorizer;
 class WlDataDeviceManager;
 class WlSurface;
 class SurfaceStack;
+class ClientResources;
 
 class WaylandExtensions
 {
@@ -80,6 +86,7 @@ public:
         WlSeat* seat;
         OutputManager* output_manager;
         std::shared_ptr<SurfaceStack> surface_stack;
+        std::shared_ptr<compositor::ScreenCopy> screen_copy;
     };
 
     WaylandExtensions() = default;
@@ -112,9 +119,12 @@ public:
         std::shared_ptr<MirDisplay> const& display_config,
         std::shared_ptr<input::InputDeviceHub> const& input_hub,
         std::shared_ptr<input::Seat> const& seat,
+        std::shared_ptr<input::InputReport> const& input_report,
         std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
         std::shared_ptr<SessionAuthorizer> const& session_authorizer,
         std::shared_ptr<SurfaceStack> const& surface_stack,
+        std::shared_ptr<compositor::ScreenCopy> const& screen_copy,
+        std::shared_ptr<ClientResources> const& client_resources,
         std::shared_ptr<scene::Clipboard> const& clipboard,
         std::shared_ptr<MainLoop> const& main_loop,
         bool arw_socket,
@@ -30,16 +30,27 @@
 #include "xdg-output-unstable-v1_wrapper.h"
 #include "foreign_toplevel_manager_v1.h"
 #include "wlr-foreign-toplevel-management-unstable-v1_wrapper.h"
+#include "wlr_screencopy_v1.h"
+#include "wlr-screencopy-unstable-v1_wrapper.h"
 #include "pointer-constraints-unstable-v1_wrapper.h"
 #include "pointer_constraints_unstable_v1.h"
 #include "relative-pointer-unstable-v1_wrapper.h"
 #include "relative_pointer_unstable_v1.h"
+#include "viewporter_wrapper.h"
+#include "wp_viewporter.h"
+#include "single-pixel-buffer-v1_wrapper.h"
+#include "wp_single_pixel_buffer_v1.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
+#include "linux_explicit_synchronization_v1.h"
 
+#include "mir/frontend/client_resources.h"
 #include "mir/graphics/platform.h"
 #include "mir/options/default_configuration.h"
 #include "mir/scene/session.h"
 #include "mir/log.h"
 
+#include <algorithm>
+
 namespace mf = mir::frontend;
 namespace ms = mir::scene;
 namespace msh = mir::shell;
@@ -115,6 +126,16 @@ std::vector<ExtensionBuilder> const internal_extension_builders = {
                     ctx.surface_stack);
             }
     },
+    {
+        mw::ScreencopyManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            {
+                return create_wlr_screencopy_manager_v1(
+                    ctx.display,
+                    ctx.wayland_executor,
+                    ctx.output_manager,
+                    ctx.screen_copy);
+            }
+    },
     {
         mw::RelativePointerManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
             { return mf::create_relative_pointer_unstable_v1(ctx.display, ctx.shell); }
@@ -123,6 +144,18 @@ std::vector<ExtensionBuilder> const internal_extension_builders = {
         mw::PointerConstraintsV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
             { return mf::create_pointer_constraints_unstable_v1(ctx.display, *ctx.wayland_executor, ctx.shell); }
     },
+    {
+        mw::Viewporter::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_wp_viewporter(ctx.display); }
+    },
+    {
+        mw::SinglePixelBufferManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_wp_single_pixel_buffer_manager_v1(ctx.display); }
+    },
+    {
+        mw::LinuxExplicitSynchronizationV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_linux_explicit_synchronization_v1(ctx.display); }
+    },
 };
 
 ExtensionBuilder const xwayland_builder {
@@ -217,7 +250,9 @@ auto mf::get_standard_extensions() -> std::vector<std::string>
         mw::Shell::interface_name,
         mw::XdgWmBase::interface_name,
         mw::XdgShellV6::interface_name,
-        mw::XdgOutputManagerV1::interface_name};
+        mw::XdgOutputManagerV1::interface_name,
+        mw::Viewporter::interface_name,
+        mw::SinglePixelBufferManagerV1::interface_name};
 }
 
 auto mf::get_supported_extensions() -> std::vector<std::string>
@@ -254,9 +289,12 @@ std::shared_ptr<mf::Connector>
                 display_config,
                 the_input_device_hub(),
                 the_seat(),
+                the_input_report(),
                 the_buffer_allocator(),
                 the_session_authorizer(),
                 the_frontend_surface_stack(),
+                the_screen_copy(),
+                the_client_resources(),
                 the_clipboard(),
                 the_main_loop(),
                 arw_socket,
@@ -269,6 +307,27 @@ std::shared_ptr<mf::Connector>
         });
 }
 
+auto mir::DefaultServerConfiguration::the_client_resources() -> std::shared_ptr<mf::ClientResources>
+{
+    return client_resources(
+        [this]()
+        {
+            auto const options = the_options();
+
+            mf::ClientResources::Limits limits;
+            limits.max_hidden_commits_per_second =
+                std::max(0, options->get<int>(options::max_hidden_commit_rate_opt));
+            limits.max_buffers_queued =
+                std::max(0, options->get<int>(options::max_client_buffers_opt));
+
+            bool const reporting =
+                options->get<std::string>(options::client_resource_report_opt) != options::off_opt_value;
+
+            return std::make_shared<mf::ClientResources>(
+                limits, the_clock(), the_client_resource_report(), reporting);
+        });
+}
+
 void mir::DefaultServerConfiguration::add_wayland_extension(
     std::string const& name,
     std::function<std::shared_ptr<void>(
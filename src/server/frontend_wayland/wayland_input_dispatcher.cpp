@@ -82,6 +82,7 @@ void mf::WaylandInputDispatcher::handle_event(MirInputEvent const* event)
             {
                 keyboard->event(keyboard_event, wl_surface.value());
             });
+        seat->report_published(client, event);
     }   break;
 
     case mir_input_event_type_pointer:
@@ -91,6 +92,7 @@ void mf::WaylandInputDispatcher::handle_event(MirInputEvent const* event)
             {
                 pointer->event(pointer_event, wl_surface.value());
             });
+        seat->report_published(client, event);
     }   break;
 
     case mir_input_event_type_touch:
@@ -105,9 +105,22 @@ auto mf::WindowWlSurfaceRole::scene_surface() const -> std::experimental::option
 
 void mf::WindowWlSurfaceRole::populate_spec_with_surface_data(shell::SurfaceSpecification& spec)
 {
-    spec.streams = std::vector<shell::StreamSpecification>();
-    spec.input_shape = std::vector<geom::Rectangle>();
-    surface->populate_surface_data(spec.streams.value(), spec.input_shape.value(), {});
+    std::vector<shell::StreamSpecification> streams;
+    std::vector<geom::Rectangle> input_shape;
+    surface->populate_surface_data(streams, input_shape, {});
+
+    // Moving or (un)mapping one subsurface often leaves the input shape, or even the streams, as they were
+    if (streams != committed_streams)
+    {
+        committed_streams = streams;
+        spec.streams = std::move(streams);
+    }
+
+    if (input_shape != committed_input_shape)
+    {
+        committed_input_shape = input_shape;
+        spec.input_shape = std::move(input_shape);
+    }
 }
 
 void mf::WindowWlSurfaceRole::refresh_surface_data_now()
@@ -116,7 +129,8 @@ void mf::WindowWlSurfaceRole::refresh_surface_data_now()
     {
         shell::SurfaceSpecification surface_data_spec;
         populate_spec_with_surface_data(surface_data_spec);
-        shell->modify_surface(session, scene_surface, surface_data_spec);
+        if (!surface_data_spec.is_empty())
+            shell->modify_surface(session, scene_surface, surface_data_spec);
     }
 }
 
@@ -476,6 +490,8 @@ void mf::WindowWlSurfaceRole::create_scene_surface()
     params->streams = std::vector<shell::StreamSpecification>{};
     params->input_shape = std::vector<geom::Rectangle>{};
     surface->populate_surface_data(params->streams.value(), params->input_shape.value(), {});
+    committed_streams = params->streams.value();
+    committed_input_shape = params->input_shape.value();
 
     auto const scene_surface = shell->create_surface(session, *params, observer);
     weak_scene_surface = scene_surface;
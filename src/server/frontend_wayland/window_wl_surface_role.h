@@ -26,11 +26,13 @@
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/rectangle.h"
+#include "mir/shell/surface_specification.h"
 
 #include <mir_toolkit/common.h>
 
 #include <experimental/optional>
 #include <chrono>
+#include <vector>
 
 struct wl_client;
 struct wl_resource;
@@ -46,7 +48,6 @@ class Session;
 }
 namespace shell
 {
-struct SurfaceSpecification;
 class Shell;
 }
 namespace frontend
@@ -73,6 +74,7 @@ public:
 
     auto scene_surface() const -> std::experimental::optional<std::shared_ptr<scene::Surface>> override;
 
+    /// Adds the streams and input shape of the surface tree to spec, if they have changed
     void populate_spec_with_surface_data(shell::SurfaceSpecification& spec);
     void refresh_surface_data_now() override;
 
@@ -153,6 +155,12 @@ private:
     geometry::Size committed_max_size;
     /// @}
 
+    /// The surface data the scene surface was last given, so a refresh only sends what has changed
+    /// @{
+    std::vector<shell::StreamSpecification> committed_streams;
+    std::vector<geometry::Rectangle> committed_input_shape;
+    /// @}
+
     std::unique_ptr<shell::SurfaceSpecification> pending_changes;
 
     shell::SurfaceSpecification& spec();
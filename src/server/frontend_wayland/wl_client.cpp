@@ -38,9 +38,11 @@ struct ConstructionCtx
     ConstructionCtx(
         std::shared_ptr<msh::Shell> const& shell,
         std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
+        std::shared_ptr<mf::ClientResources> const& client_resources,
         std::function<void(mf::WlClient&)>&& client_created_callback)
         : shell{shell},
           session_authorizer{session_authorizer},
+          client_resources{client_resources},
           client_created_callback{std::make_unique<std::function<void(mf::WlClient&)>>(std::move(client_created_callback))}
     {
     }
@@ -49,6 +51,7 @@ struct ConstructionCtx
     wl_listener display_destruction_listener;
     std::shared_ptr<msh::Shell> const shell;
     std::shared_ptr<mf::SessionAuthorizer> const session_authorizer;
+    std::shared_ptr<mf::ClientResources> const client_resources;
     /// Needs to be a pointer so std::is_standard_layout passes
     std::unique_ptr<std::function<void(mf::WlClient&)>> const client_created_callback;
 };
@@ -101,9 +104,14 @@ void mf::WlClient::setup_new_client_handler(
     wl_display* display,
     std::shared_ptr<shell::Shell> const& shell,
     std::shared_ptr<SessionAuthorizer> const& session_authorizer,
+    std::shared_ptr<ClientResources> const& client_resources,
     std::function<void(WlClient&)>&& client_created_callback)
 {
-    auto context = new ConstructionCtx{shell, session_authorizer, std::move(client_created_callback)};
+    auto context = new ConstructionCtx{
+        shell,
+        session_authorizer,
+        client_resources,
+        std::move(client_created_callback)};
 
     context->client_construction_listener.notify = &handle_client_created;
     wl_display_add_client_created_listener(display, &context->client_construction_listener);
@@ -129,10 +137,15 @@ mf::WlClient::~WlClient()
     shell->close_session(session);
 }
 
-mf::WlClient::WlClient(wl_client* client, std::shared_ptr<ms::Session> const& session, msh::Shell* shell)
+mf::WlClient::WlClient(
+    wl_client* client,
+    std::shared_ptr<ms::Session> const& session,
+    msh::Shell* shell,
+    std::shared_ptr<ClientResources::Account> const& resource_account)
     : shell{shell},
       client{client},
-      session{session}
+      session{session},
+      resource_account{resource_account}
 {
 }
 
@@ -161,7 +174,11 @@ void mf::WlClient::handle_client_created(wl_listener* listener, void* data)
 
     // Can't use std::make_unique because WlClient constructor is private
     auto wl_client = std::unique_ptr<mf::WlClient>{
-        new mf::WlClient{client, session, construction_context->shell.get()}};
+        new mf::WlClient{
+            client,
+            session,
+            construction_context->shell.get(),
+            construction_context->client_resources->open_account(client_pid)}};
     auto client_context = new ClientCtx{std::move(wl_client)};
     client_context->destroy_listener.notify = &cleanup_client_ctx;
     wl_client_add_destroy_listener(client, &client_context->destroy_listener);
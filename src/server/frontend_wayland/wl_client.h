@@ -27,6 +27,7 @@ struct wl_display;
 #include <functional>
 
 #include "mir/wayland/wayland_base.h"
+#include "mir/frontend/client_resources.h"
 
 namespace mir
 {
@@ -52,6 +53,7 @@ public:
         wl_display* display,
         std::shared_ptr<shell::Shell> const& shell,
         std::shared_ptr<SessionAuthorizer> const& session_authorizer,
+        std::shared_ptr<ClientResources> const& client_resources,
         std::function<void(WlClient&)>&& client_created_callback);
 
     static auto from(wl_client* client) -> WlClient*;
@@ -69,6 +71,9 @@ public:
     /// individual apps.
     auto client_session() const -> std::shared_ptr<scene::Session> { return session; }
 
+    /// What this client is costing the server, and whether it is within its limits
+    auto resources() const -> ClientResources::Account& { return *resource_account; }
+
     /// The XDG output protocol implementation sends the Mir-internal logical position and scale of outputs multiplied
     /// by this. It's currently just used by XWayland.
     /// @{
@@ -77,7 +82,11 @@ public:
     /// @}
 
 private:
-    WlClient(wl_client* client, std::shared_ptr<scene::Session> const& session, shell::Shell* shell);
+    WlClient(
+        wl_client* client,
+        std::shared_ptr<scene::Session> const& session,
+        shell::Shell* shell,
+        std::shared_ptr<ClientResources::Account> const& resource_account);
 
     static void handle_client_created(wl_listener* listener, void* data);
 
@@ -85,6 +94,7 @@ private:
     shell::Shell* const shell;
     wl_client* const client;
     std::shared_ptr<scene::Session> const session;
+    std::shared_ptr<ClientResources::Account> const resource_account;
 
     float output_geometry_scale_{1};
 };
@@ -32,6 +32,7 @@
 #include "mir/input/device.h"
 #include "mir/input/parameter_keymap.h"
 #include "mir/input/mir_keyboard_config.h"
+#include "mir/input/input_report.h"
 
 #include <mutex>
 #include <unordered_set>
@@ -151,6 +152,7 @@ mf::WlSeat::WlSeat(
     wl_display* display,
     std::shared_ptr<mi::InputDeviceHub> const& input_hub,
     std::shared_ptr<mi::Seat> const& seat,
+    std::shared_ptr<mi::InputReport> const& input_report,
     bool enable_key_repeat)
     :   Global(display, Version<6>()),
         keymap{std::make_shared<input::ParameterKeymap>()},
@@ -166,6 +168,7 @@ mf::WlSeat::WlSeat(
         touch_listeners{std::make_shared<ListenerList<WlTouch>>()},
         input_hub{input_hub},
         seat{seat},
+        input_report{input_report},
         enable_key_repeat{enable_key_repeat}
 {
     input_hub->add_observer(config_observer);
@@ -307,3 +310,23 @@ void mf::WlSeat::server_restart()
     if (focus.client)
         for_each_listener(focus.client, [](WlKeyboard* keyboard) { keyboard->resync_keyboard(); });
 }
+
+void mf::WlSeat::report_published(wl_client* client, MirInputEvent const* event) const
+{
+    auto const client_fd = wl_client_get_fd(client);
+    auto const event_time = mir_input_event_get_event_time(event);
+
+    switch (mir_input_event_get_type(event))
+    {
+    case mir_input_event_type_key:
+        input_report->published_key_event(client_fd, 0, event_time);
+        break;
+
+    case mir_input_event_type_pointer:
+        input_report->published_motion_event(client_fd, 0, event_time);
+        break;
+
+    default:
+        break;
+    }
+}
@@ -20,6 +20,7 @@
 #define MIR_FRONTEND_WL_SEAT_H
 
 #include "wayland_wrapper.h"
+#include "mir_toolkit/events/event.h"
 
 #include <unordered_map>
 #include <vector>
@@ -30,6 +31,7 @@ namespace mir
 namespace input
 {
 class InputDeviceHub;
+class InputReport;
 class Seat;
 class Keymap;
 }
@@ -46,6 +48,7 @@ public:
         wl_display* display,
         std::shared_ptr<mir::input::InputDeviceHub> const& input_hub,
         std::shared_ptr<mir::input::Seat> const& seat,
+        std::shared_ptr<mir::input::InputReport> const& input_report,
         bool enable_key_repeat);
 
     ~WlSeat();
@@ -74,6 +77,9 @@ public:
 
     void server_restart();
 
+    /// Reports an input event being sent to a client (for input latency tracing)
+    void report_published(wl_client* client, MirInputEvent const* event) const;
+
 private:
     wl_client* focused_client{nullptr}; ///< Can be null
     std::vector<ListenerTracker*> focus_listeners;
@@ -104,6 +110,7 @@ private:
 
     std::shared_ptr<input::InputDeviceHub> const input_hub;
     std::shared_ptr<input::Seat> const seat;
+    std::shared_ptr<input::InputReport> const input_report;
     bool const enable_key_repeat;
 
     void bind(wl_resource* new_wl_seat) override;
@@ -139,14 +139,28 @@ void mf::WlSubsurface::set_position(int32_t x, int32_t y)
 
 void mf::WlSubsurface::place_above(struct wl_resource* sibling)
 {
-    (void)sibling;
-    log_warning("TODO: wl_subsurface.place_above not implemented");
+    place(sibling, true);
 }
 
 void mf::WlSubsurface::place_below(struct wl_resource* sibling)
 {
-    (void)sibling;
-    log_warning("TODO: wl_subsurface.place_below not implemented");
+    place(sibling, false);
+}
+
+void mf::WlSubsurface::place(wl_resource* sibling, bool above)
+{
+    if (!parent)
+        return;
+
+    if (!parent.value().place_subsurface(this, WlSurface::from(sibling), above))
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_surface,
+            "wl_surface@%d is not a sibling or the parent of wl_subsurface@%d",
+            wl_resource_get_id(sibling),
+            wl_resource_get_id(resource)));
+    }
 }
 
 void mf::WlSubsurface::set_sync()
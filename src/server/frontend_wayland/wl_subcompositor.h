@@ -67,10 +67,16 @@ public:
 
     auto subsurface_at(geometry::Point point) -> std::experimental::optional<WlSurface*>;
 
+    auto wl_surface() const -> WlSurface* { return surface; }
+
+    /// So the parent can hold a wayland::Weak<WlSubsurface>
+    using wayland::Subsurface::destroyed_flag;
+
 private:
     void set_position(int32_t x, int32_t y) override;
     void place_above(struct wl_resource* sibling) override;
     void place_below(struct wl_resource* sibling) override;
+    void place(wl_resource* sibling, bool above);
     void set_sync() override;
     void set_desync() override;
 
@@ -18,13 +18,18 @@
 
 #include "wl_surface.h"
 
+#include "wl_client.h"
 #include "wayland_utils.h"
 #include "wl_surface_role.h"
 #include "wl_subcompositor.h"
 #include "wl_region.h"
 #include "deleted_for_resource.h"
+#include "wp_single_pixel_buffer_v1.h"
+#include "linux_explicit_synchronization_v1.h"
 
 #include "wayland_wrapper.h"
+#include "viewporter_wrapper.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
 
 #include "wayland_frontend.tp.h"
 
@@ -34,12 +39,15 @@
 #include "mir/compositor/buffer_stream.h"
 #include "mir/executor.h"
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/explicit_sync_buffer.h"
 #include "mir/scene/surface.h"
 #include "mir/shell/surface_specification.h"
 #include "mir/log.h"
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <iterator>
 #include <boost/throw_exception.hpp>
 #include <wayland-server-protocol.h>
 
@@ -56,8 +64,17 @@ mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource)
 void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
 {
     if (source.buffer)
+    {
         buffer = source.buffer;
 
+        // The buffer this replaces will never be used
+        if (buffer_release != source.buffer_release)
+            release_immediately(buffer_release);
+
+        acquire_fence = source.acquire_fence;
+        buffer_release = source.buffer_release;
+    }
+
     if (source.scale)
         scale = source.scale;
 
@@ -67,10 +84,22 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.opaque_region)
+        opaque_region = source.opaque_region;
+
+    if (source.viewport_source)
+        viewport_source = source.viewport_source;
+
+    if (source.viewport_destination)
+        viewport_destination = source.viewport_destination;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
 
+    if (source.children)
+        children = source.children;
+
     if (source.surface_data_invalidated)
         surface_data_invalidated = true;
 }
@@ -79,6 +108,10 @@ bool mf::WlSurfaceState::surface_data_needs_refresh() const
 {
     return offset ||
            input_shape ||
+           opaque_region ||
+           viewport_source ||
+           viewport_destination ||
+           children ||
            surface_data_invalidated;
 }
 
@@ -107,6 +140,8 @@ mf::WlSurface::~WlSurface()
     // all bases and non-variant members have already been destroyed."
     try
     {
+        // A release for a commit that never came won't be needed
+        release_immediately(pending.buffer_release);
         // Destroy the buffer stream first, as surface_destroyed() may throw
         session->destroy_buffer_stream(stream);
         role->surface_destroyed();
@@ -130,17 +165,23 @@ auto mf::WlSurface::subsurface_at(geom::Point point) -> std::experimental::optio
         return std::experimental::nullopt;
     }
     point = point - offset_;
-    // loop backwards so the first subsurface we find that accepts the input is the topmost one
-    for (auto child_it = children.rbegin(); child_it != children.rend(); ++child_it)
-    {
-        if (auto result = (*child_it)->subsurface_at(point))
-            return result;
-    }
     geom::Rectangle surface_rect = {geom::Point{}, buffer_size_.value_or(geom::Size{})};
-    for (auto& rect : input_shape.value_or(std::vector<geom::Rectangle>{surface_rect}))
+    // loop backwards so the first surface we find that accepts the input is the topmost one
+    for (auto child_it = children.rbegin(); child_it != children.rend(); ++child_it)
     {
-        if (rect.intersection_with(surface_rect).contains(point))
-            return this;
+        if (*child_it)
+        {
+            if (auto result = (*child_it)->subsurface_at(point))
+                return result;
+        }
+        else
+        {
+            for (auto& rect : input_shape.value_or(std::vector<geom::Rectangle>{surface_rect}))
+            {
+                if (rect.intersection_with(surface_rect).contains(point))
+                    return this;
+            }
+        }
     }
     return std::experimental::nullopt;
 }
@@ -167,6 +208,53 @@ void mf::WlSurface::set_pending_offset(std::experimental::optional<geom::Displac
     pending.offset = offset;
 }
 
+void mf::WlSurface::set_viewport(mw::Viewport* viewport)
+{
+    this->viewport = mw::make_weak(viewport);
+}
+
+void mf::WlSurface::set_pending_viewport_source(std::experimental::optional<geom::RectangleF> const& source)
+{
+    pending.viewport_source = source;
+}
+
+void mf::WlSurface::set_pending_viewport_destination(std::experimental::optional<geom::Size> const& destination)
+{
+    pending.viewport_destination = destination;
+}
+
+void mf::WlSurface::set_synchronization(mw::LinuxSurfaceSynchronizationV1* synchronization)
+{
+    this->synchronization = mw::make_weak(synchronization);
+}
+
+void mf::WlSurface::set_pending_acquire_fence(std::experimental::optional<Fd> const& fence)
+{
+    pending.acquire_fence = fence;
+}
+
+void mf::WlSurface::set_pending_buffer_release(mw::LinuxBufferReleaseV1* release)
+{
+    pending.buffer_release = mw::make_weak(release);
+}
+
+namespace
+{
+auto slots_of(std::vector<mf::WlSubsurface*> const& order) -> std::vector<mf::SubsurfaceSlot>
+{
+    std::vector<mf::SubsurfaceSlot> result;
+    result.reserve(order.size());
+    for (mf::WlSubsurface* entry : order)
+    {
+        if (entry)
+            result.push_back(mw::make_weak(entry));
+        else
+            result.push_back(std::experimental::nullopt);
+    }
+    return result;
+}
+}
+
 void mf::WlSurface::add_subsurface(WlSubsurface* child)
 {
     if (std::find(children.begin(), children.end(), child) != children.end())
@@ -175,7 +263,9 @@ void mf::WlSurface::add_subsurface(WlSubsurface* child)
         return;
     }
 
+    // A new subsurface is immediately placed on top
     children.push_back(child);
+    surface_data = std::experimental::nullopt;
 }
 
 void mf::WlSurface::remove_subsurface(WlSubsurface* child)
@@ -186,10 +276,68 @@ void mf::WlSurface::remove_subsurface(WlSubsurface* child)
             children.end(),
             child),
         children.end());
+    surface_data = std::experimental::nullopt;
+}
+
+auto mf::WlSurface::place_subsurface(WlSubsurface* child, WlSurface const* sibling, bool above) -> bool
+{
+    if (sibling == child->wl_surface())
+    {
+        return false;
+    }
+
+    auto order = pending.children ? current_subsurfaces_in(pending.children.value()) : children;
+    order.erase(std::remove(order.begin(), order.end(), child), order.end());
+
+    auto position = std::find_if(order.begin(), order.end(), [this, sibling](WlSubsurface* entry)
+        {
+            return entry ? entry->wl_surface() == sibling : sibling == this;
+        });
+
+    if (position == order.end())
+    {
+        return false;
+    }
+
+    if (above)
+        ++position;
+    order.insert(position, child);
+
+    pending.children = slots_of(order);
+    return true;
+}
+
+auto mf::WlSurface::current_subsurfaces_in(std::vector<SubsurfaceSlot> const& order) const
+    -> std::vector<WlSubsurface*>
+{
+    std::vector<WlSubsurface*> result;
+    for (auto const& slot : order)
+    {
+        if (!slot)
+        {
+            result.push_back(nullptr);
+        }
+        else if (slot.value())
+        {
+            WlSubsurface* const entry = &slot.value().value();
+            if (std::find(children.begin(), children.end(), entry) != children.end())
+                result.push_back(entry);
+        }
+    }
+
+    for (WlSubsurface* child : children)
+    {
+        if (std::find(result.begin(), result.end(), child) == result.end())
+            result.push_back(child);
+    }
+
+    return result;
 }
 
 void mf::WlSurface::refresh_surface_data_now()
 {
+    // This is how a desynchronized subsurface's change reaches the surfaces above it
+    surface_data = std::experimental::nullopt;
     role->refresh_surface_data_now();
 }
 
@@ -197,9 +345,59 @@ void mf::WlSurface::populate_surface_data(std::vector<shell::StreamSpecification
                                           std::vector<geom::Rectangle>& input_shape_accumulator,
                                           geometry::Displacement const& parent_offset) const
 {
-    geometry::Displacement offset = parent_offset + offset_;
+    if (!surface_data)
+    {
+        SurfaceData data;
+        for (WlSubsurface* subsurface : children)
+        {
+            if (subsurface)
+            {
+                subsurface->populate_surface_data(data.streams, data.input_shape, {});
+            }
+            else
+            {
+                populate_own_surface_data(data.streams, data.input_shape, {});
+            }
+        }
+        surface_data = std::move(data);
+    }
+
+    geometry::Displacement const offset = parent_offset + offset_;
+
+    for (auto stream_spec : surface_data.value().streams)
+    {
+        stream_spec.displacement = stream_spec.displacement + offset;
+        buffer_streams.push_back(std::move(stream_spec));
+    }
+
+    for (auto rect : surface_data.value().input_shape)
+    {
+        // Empty rectangles (from clipping, or standing for an empty input shape) stay where they are
+        if (rect.size != geom::Size{})
+            rect.top_left = rect.top_left + offset;
+        input_shape_accumulator.push_back(rect);
+    }
+}
 
-    buffer_streams.push_back(msh::StreamSpecification{stream, offset, {}});
+void mf::WlSurface::populate_own_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
+                                              std::vector<geom::Rectangle>& input_shape_accumulator,
+                                              geometry::Displacement const& offset) const
+{
+    msh::StreamSpecification stream_spec{stream, offset, {}};
+    if (buffer_size_ && (viewport_source || viewport_destination))
+    {
+        stream_spec.size = buffer_size_.value();
+    }
+    if (viewport_source)
+    {
+        // The source is in surface coordinates before scaling, the renderer wants buffer pixels
+        auto const& source = viewport_source.value();
+        stream_spec.src_bounds = geom::RectangleF{
+            {source.left().as_value() * buffer_scale, source.top().as_value() * buffer_scale},
+            {source.size.width.as_value() * buffer_scale, source.size.height.as_value() * buffer_scale}};
+    }
+    stream_spec.opaque_region = opaque_region;
+    buffer_streams.push_back(stream_spec);
     geom::Rectangle surface_rect = {geom::Point{} + offset, buffer_size_.value_or(geom::Size{})};
     if (input_shape)
     {
@@ -223,11 +421,6 @@ void mf::WlSurface::populate_surface_data(std::vector<shell::StreamSpecification
     {
         input_shape_accumulator.push_back(surface_rect);
     }
-
-    for (WlSubsurface* subsurface : children)
-    {
-        subsurface->populate_surface_data(buffer_streams, input_shape_accumulator, offset);
-    }
 }
 
 mf::WlSurface* mf::WlSurface::from(wl_resource* resource)
@@ -287,8 +480,11 @@ void mf::WlSurface::frame(wl_resource* new_callback)
 
 void mf::WlSurface::set_opaque_region(std::experimental::optional<wl_resource*> const& region)
 {
-    (void)region;
-    // This isn't essential, but could enable optimizations
+    // A null region means nothing is opaque
+    if (region)
+        pending.opaque_region = WlRegion::from(region.value())->rectangle_vector();
+    else
+        pending.opaque_region = std::vector<geom::Rectangle>{};
 }
 
 void mf::WlSurface::set_input_region(std::experimental::optional<wl_resource*> const& region)
@@ -343,14 +539,29 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     // callbacks should be sent at once.
     frame_callbacks.insert(end(frame_callbacks), begin(state.frame_callbacks), end(state.frame_callbacks));
 
+    if (state.children)
+        children = current_subsurfaces_in(state.children.value());
+
     if (state.offset)
         offset_ = state.offset.value();
 
     if (state.input_shape)
         input_shape = state.input_shape.value();
 
+    if (state.opaque_region)
+        opaque_region = state.opaque_region.value();
+
     if (state.scale)
+    {
+        buffer_scale = state.scale.value();
         stream->set_scale(state.scale.value());
+    }
+
+    if (state.viewport_source)
+        viewport_source = state.viewport_source.value();
+
+    if (state.viewport_destination)
+        viewport_destination = state.viewport_destination.value();
 
     auto const executor_send_frame_callbacks = [executor = wayland_executor, weak_self = mw::make_weak(this)]()
         {
@@ -370,6 +581,8 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         if (buffer == nullptr)
         {
             // TODO: unmap surface, and unmap all subsurfaces
+            release_immediately(state.buffer_release);
+            account_for_commit(nullptr, nullptr);
             buffer_size_ = std::experimental::nullopt;
             send_frame_callbacks();
         }
@@ -377,7 +590,23 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         {
             std::shared_ptr<graphics::Buffer> mir_buffer;
 
-            if (auto const shm_buffer = wl_shm_buffer_get(buffer))
+            // Until the compositor consumes the buffer it counts as queued against the client's limit
+            auto const consumed = std::make_shared<std::atomic<bool>>(false);
+            auto const on_consumed = [consumed, executor_send_frame_callbacks]()
+                {
+                    *consumed = true;
+                    executor_send_frame_callbacks();
+                };
+
+            if (auto const single_pixel_buffer = single_pixel_buffer_from(buffer))
+            {
+                // There's no client memory to read, so the client can have the buffer straight back
+                mir_buffer = single_pixel_buffer;
+                *consumed = true;
+                wl_resource_post_event(buffer, wayland::Buffer::Opcode::release);
+                frame_callback_executor->spawn(executor_send_frame_callbacks);
+            }
+            else if (auto const shm_buffer = wl_shm_buffer_get(buffer))
             {
                 auto const stride = wl_shm_buffer_get_stride(shm_buffer);
                 auto const width = wl_shm_buffer_get_width(shm_buffer);
@@ -396,7 +625,7 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                 mir_buffer = allocator->buffer_from_shm(
                     buffer,
                     wayland_executor,
-                    std::move(executor_send_frame_callbacks));
+                    on_consumed);
                 tracepoint(
                     mir_server_wayland,
                     sw_buffer_committed,
@@ -416,35 +645,148 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
 
                 mir_buffer = allocator->buffer_from_resource(
                     buffer,
-                    std::move(executor_send_frame_callbacks),
+                    on_consumed,
                     std::move(release_buffer));
                 tracepoint(
                     mir_server_wayland,
                     hw_buffer_committed,
                     wl_resource_get_client(resource),
                     mir_buffer->id().as_value());
+
+                if (state.acquire_fence)
+                {
+                    if (auto const explicit_sync =
+                            dynamic_cast<graphics::ExplicitSyncBuffer*>(mir_buffer->native_buffer_base()))
+                    {
+                        // The renderer waits for the fence, so a slow client doesn't hold up the compositor
+                        explicit_sync->set_acquire_fence(state.acquire_fence.value());
+                    }
+                    else if (synchronization)
+                    {
+                        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                            synchronization.value().resource,
+                            mw::LinuxSurfaceSynchronizationV1::Error::unsupported_buffer,
+                            "wl_buffer@%d does not support explicit synchronization",
+                            wl_resource_get_id(buffer)));
+                    }
+                }
             }
 
-            stream->submit_buffer(mir_buffer);
-            auto const new_buffer_size = stream->stream_size();
+            mir_buffer = buffer_with_release(std::move(mir_buffer), state.buffer_release, wayland_executor);
 
-            if (!input_shape && std::experimental::make_optional(new_buffer_size) != buffer_size_)
+            if (account_for_commit(mir_buffer, consumed))
             {
-                state.invalidate_surface_data(); // input shape needs to be recalculated for the new size
-            }
+                stream->submit_buffer(mir_buffer);
+                auto const new_buffer_size = viewport_size(stream->stream_size());
+
+                if (std::experimental::make_optional(new_buffer_size) != buffer_size_)
+                {
+                    state.invalidate_surface_data(); // input shape needs to be recalculated (or clipped) for the new size
+                }
 
-            buffer_size_ = new_buffer_size;
+                buffer_size_ = new_buffer_size;
+            }
+            else
+            {
+                // Dropping our reference releases the buffer unseen; the client can draw the next frame anyway
+                frame_callback_executor->spawn(std::move(executor_send_frame_callbacks));
+            }
         }
     }
     else
     {
+        release_immediately(state.buffer_release);
+        account_for_commit(nullptr, nullptr);
         frame_callback_executor->spawn(std::move(executor_send_frame_callbacks));
+
+        if (buffer_size_ && (state.viewport_source || state.viewport_destination))
+        {
+            buffer_size_ = viewport_size(stream->stream_size());
+        }
+    }
+
+    if (state.scale)
+    {
+        state.invalidate_surface_data(); // the viewport source is scaled to buffer pixels
     }
 
     for (WlSubsurface* child: children)
     {
-        child->parent_has_committed();
+        if (child)
+            child->parent_has_committed();
+    }
+
+    // Synchronized subsurfaces have just applied what they cached, so that's worked out again too
+    surface_data = std::experimental::nullopt;
+}
+
+auto mf::WlSurface::account_for_commit(
+    std::shared_ptr<graphics::Buffer> const& buffer,
+    std::shared_ptr<std::atomic<bool>> const& consumed) -> bool
+{
+    auto const wl_client = WlClient::from(client);
+    if (!wl_client)
+    {
+        return true;
+    }
+
+    bool hidden = false;
+    if (auto const maybe_scene_surface = scene_surface())
+    {
+        if (auto const scene_surface = *maybe_scene_surface)
+        {
+            hidden = !scene_surface->visible() ||
+                scene_surface->query(mir_window_attrib_visibility) == mir_window_visibility_occluded;
+        }
+    }
+
+    return wl_client->resources().commit(buffer, consumed, hidden);
+}
+
+auto mf::WlSurface::viewport_size(geom::Size const& content_size) const -> geom::Size
+{
+    if (!viewport)
+    {
+        return content_size;
+    }
+
+    if (viewport_source)
+    {
+        auto const& source = viewport_source.value();
+        geom::RectangleF const content{{}, geom::SizeF{content_size}};
+        if (!content.contains(source))
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                viewport.value().resource,
+                mw::Viewport::Error::out_of_buffer,
+                "Source rectangle %gx%g+%g+%g is outside of the %dx%d content",
+                source.size.width.as_value(), source.size.height.as_value(),
+                source.left().as_value(), source.top().as_value(),
+                content_size.width.as_int(), content_size.height.as_int()));
+        }
+    }
+
+    if (viewport_destination)
+    {
+        return viewport_destination.value();
+    }
+
+    if (viewport_source)
+    {
+        auto const& size = viewport_source.value().size;
+        if (std::trunc(size.width.as_value()) != size.width.as_value() ||
+            std::trunc(size.height.as_value()) != size.height.as_value())
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                viewport.value().resource,
+                mw::Viewport::Error::bad_size,
+                "Source size %gx%g is not integral and no destination size is set",
+                size.width.as_value(), size.height.as_value()));
+        }
+        return geom::Size{static_cast<int>(size.width.as_value()), static_cast<int>(size.height.as_value())};
     }
+
+    return content_size;
 }
 
 void mf::WlSurface::commit()
@@ -458,6 +800,36 @@ void mf::WlSurface::commit()
     if (pending.input_shape && *pending.input_shape == input_shape)
         pending.input_shape = std::experimental::nullopt;
 
+    if (pending.opaque_region && *pending.opaque_region == opaque_region)
+        pending.opaque_region = std::experimental::nullopt;
+
+    if (pending.children && current_subsurfaces_in(pending.children.value()) == children)
+        pending.children = std::experimental::nullopt;
+
+    if (synchronization && (pending.acquire_fence || pending.buffer_release))
+    {
+        // Attaching null is enough for a release (which is immediate), but there's nothing to fence
+        auto const buffer = pending.buffer.value_or(nullptr);
+        if (!pending.buffer || (pending.acquire_fence && !buffer))
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                synchronization.value().resource,
+                mw::LinuxSurfaceSynchronizationV1::Error::no_buffer,
+                "Explicit synchronization of wl_surface@%d without a buffer",
+                wl_resource_get_id(resource)));
+        }
+
+        // Their content is copied (or has none), there's nothing to wait for on the GPU
+        if (pending.acquire_fence && (wl_shm_buffer_get(buffer) || single_pixel_buffer_from(buffer)))
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                synchronization.value().resource,
+                mw::LinuxSurfaceSynchronizationV1::Error::unsupported_buffer,
+                "wl_buffer@%d does not support an acquire fence",
+                wl_resource_get_id(buffer)));
+        }
+    }
+
     // order is important
     auto const state = std::move(pending);
     pending = WlSurfaceState();
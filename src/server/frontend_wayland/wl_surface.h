@@ -26,7 +26,10 @@
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
+#include "mir/geometry/rectangle_f.h"
+#include "mir/fd.h"
 
+#include <atomic>
 #include <vector>
 #include <map>
 
@@ -37,6 +40,7 @@ class Executor;
 namespace graphics
 {
 class GraphicBufferAllocator;
+class Buffer;
 }
 namespace scene
 {
@@ -54,11 +58,21 @@ namespace compositor
 {
 class BufferStream;
 }
+namespace wayland
+{
+class Viewport;
+class LinuxSurfaceSynchronizationV1;
+class LinuxBufferReleaseV1;
+}
 namespace frontend
 {
 class WlSurface;
 class WlSubsurface;
 
+/// A place in a surface's stacking order: one of its subsurfaces or, if unset, the surface's own content. The handle
+/// is weak, as an order cached with surface state can outlive subsurfaces in it.
+using SubsurfaceSlot = std::experimental::optional<wayland::Weak<WlSubsurface>>;
+
 struct WlSurfaceState
 {
     class Callback : public wayland::Callback
@@ -82,7 +96,16 @@ struct WlSurfaceState
     std::experimental::optional<int> scale;
     std::experimental::optional<geometry::Displacement> offset;
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
+    std::experimental::optional<std::vector<geometry::Rectangle>> opaque_region;
+    std::experimental::optional<std::experimental::optional<geometry::RectangleF>> viewport_source;
+    std::experimental::optional<std::experimental::optional<geometry::Size>> viewport_destination;
     std::vector<wayland::Weak<Callback>> frame_callbacks;
+    /// Set if the subsurfaces have been restacked (see WlSurface::children)
+    std::experimental::optional<std::vector<SubsurfaceSlot>> children;
+
+    // Explicit synchronisation of the buffer above, so these are only ever set along with it
+    std::experimental::optional<Fd> acquire_fence;
+    wayland::Weak<wayland::LinuxBufferReleaseV1> buffer_release;
 
 private:
     // only set to true if invalidate_surface_data() is called
@@ -126,8 +149,25 @@ public:
     void set_role(WlSurfaceRole* role_);
     void clear_role();
     void set_pending_offset(std::experimental::optional<geometry::Displacement> const& offset);
+    /// The wp_viewport cropping and scaling this surface, if any
+    bool has_viewport() const { return static_cast<bool>(viewport); }
+    void set_viewport(wayland::Viewport* viewport);
+    void set_pending_viewport_source(std::experimental::optional<geometry::RectangleF> const& source);
+    void set_pending_viewport_destination(std::experimental::optional<geometry::Size> const& destination);
+    /// The zwp_linux_surface_synchronization_v1 of this surface, if any
+    bool has_synchronization() const { return static_cast<bool>(synchronization); }
+    void set_synchronization(wayland::LinuxSurfaceSynchronizationV1* synchronization);
+    bool has_pending_acquire_fence() const { return static_cast<bool>(pending.acquire_fence); }
+    void set_pending_acquire_fence(std::experimental::optional<Fd> const& fence);
+    bool has_pending_buffer_release() const { return static_cast<bool>(pending.buffer_release); }
+    void set_pending_buffer_release(wayland::LinuxBufferReleaseV1* release);
     void add_subsurface(WlSubsurface* child);
     void remove_subsurface(WlSubsurface* child);
+    /// Restacks child directly above or below sibling, which is either another subsurface of this surface or this
+    /// surface itself. Like the rest of this surface's state, the new order takes effect on the next commit (and is
+    /// cached with it while this surface is a synchronized subsurface).
+    /// \return false if sibling is neither
+    auto place_subsurface(WlSubsurface* child, WlSurface const* sibling, bool above) -> bool;
     void refresh_surface_data_now();
     void pending_invalidate_surface_data() { pending.invalidate_surface_data(); }
     void populate_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
@@ -148,15 +188,44 @@ private:
 
     NullWlSurfaceRole null_role;
     WlSurfaceRole* role;
-    std::vector<WlSubsurface*> children; // ordering is from bottom to top
+    /// Ordering is from bottom to top. The null entry is this surface's own content, which subsurfaces can be placed
+    /// below.
+    std::vector<WlSubsurface*> children{nullptr};
 
     WlSurfaceState pending;
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
     std::vector<wayland::Weak<WlSurfaceState::Callback>> frame_callbacks;
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
+    std::vector<mir::geometry::Rectangle> opaque_region;
+    int buffer_scale{1};
+    wayland::Weak<wayland::Viewport> viewport;
+    std::experimental::optional<geometry::RectangleF> viewport_source;
+    std::experimental::optional<geometry::Size> viewport_destination;
+    wayland::Weak<wayland::LinuxSurfaceSynchronizationV1> synchronization;
+
+    /// What populate_surface_data() gives for this surface and its subsurfaces, relative to this surface. Unset when
+    /// it needs working out again, so a change to one subsurface doesn't rebuild the data of its siblings.
+    struct SurfaceData
+    {
+        std::vector<shell::StreamSpecification> streams;
+        std::vector<geometry::Rectangle> input_shape;
+    };
+    std::experimental::optional<SurfaceData> mutable surface_data;
 
     void send_frame_callbacks();
+    /// \p order, without subsurfaces removed since and with subsurfaces added since on top
+    auto current_subsurfaces_in(std::vector<SubsurfaceSlot> const& order) const -> std::vector<WlSubsurface*>;
+    void populate_own_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
+                                   std::vector<mir::geometry::Rectangle>& input_shape_accumulator,
+                                   geometry::Displacement const& offset) const;
+    /// Charges a commit of \p buffer (if any) to the client, as queued until \p consumed is set
+    /// \return whether the buffer is within the client's limits and should be shown
+    auto account_for_commit(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        std::shared_ptr<std::atomic<bool>> const& consumed) -> bool;
+    /// The surface size once the viewport is applied to content of \p content_size
+    auto viewport_size(geometry::Size const& content_size) const -> geometry::Size;
 
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
     void damage(int32_t x, int32_t y, int32_t width, int32_t height) override;
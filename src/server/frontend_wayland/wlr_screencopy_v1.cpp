@@ -0,0 +1,405 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wlr_screencopy_v1.h"
+
+#include "wlr-screencopy-unstable-v1_wrapper.h"
+#include "deleted_for_resource.h"
+#include "output_manager.h"
+#include "wl_client.h"
+#include "mir/compositor/screen_copy.h"
+#include "mir/executor.h"
+
+#include <boost/throw_exception.hpp>
+#include <wayland-server-protocol.h>
+
+#include <cmath>
+#include <cstring>
+#include <map>
+
+namespace mf = mir::frontend;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+namespace mir
+{
+namespace frontend
+{
+class WlrScreencopyManagerV1Global : public wayland::ScreencopyManagerV1::Global
+{
+public:
+    WlrScreencopyManagerV1Global(
+        wl_display* display,
+        std::shared_ptr<Executor> const& wayland_executor,
+        OutputManager* output_manager,
+        std::shared_ptr<compositor::ScreenCopy> const& screen_copy);
+
+    std::shared_ptr<Executor> const wayland_executor;
+    OutputManager* const output_manager;
+    std::shared_ptr<compositor::ScreenCopy> const screen_copy;
+
+private:
+    void bind(wl_resource* new_resource) override;
+};
+
+class WlrScreencopyManagerV1 : public wayland::ScreencopyManagerV1
+{
+public:
+    WlrScreencopyManagerV1(wl_resource* new_resource, WlrScreencopyManagerV1Global const& global);
+
+private:
+    void capture_output(wl_resource* frame, int32_t overlay_cursor, wl_resource* output) override;
+    void capture_output_region(
+        wl_resource* frame,
+        int32_t overlay_cursor,
+        wl_resource* output,
+        int32_t x, int32_t y,
+        int32_t width, int32_t height) override;
+
+    /// Creates the frame capturing \p region (in output logical coordinates), or all of \p output if unset
+    void create_frame(wl_resource* frame, wl_resource* output, std::experimental::optional<geom::Rectangle> region);
+
+    /// Damage is reported relative to the previous copy of the same output by this manager
+    auto damage_history_for(graphics::DisplayConfigurationOutputId id) -> std::shared_ptr<compositor::ScreenCopy::DamageHistory>;
+
+    WlrScreencopyManagerV1Global const& global;
+    std::map<graphics::DisplayConfigurationOutputId, std::shared_ptr<compositor::ScreenCopy::DamageHistory>> histories;
+};
+
+class WlrScreencopyFrameV1 : public wayland::ScreencopyFrameV1
+{
+public:
+    WlrScreencopyFrameV1(
+        wl_resource* new_resource,
+        std::shared_ptr<Executor> const& wayland_executor,
+        std::shared_ptr<compositor::ScreenCopy> const& screen_copy,
+        std::shared_ptr<compositor::ScreenCopy::DamageHistory> const& history,
+        geometry::Rectangle const& area,
+        geometry::Size const& size);
+
+    /// A frame that cannot be captured
+    WlrScreencopyFrameV1(wl_resource* new_resource);
+
+private:
+    void copy(wl_resource* buffer) override;
+    void copy_with_damage(wl_resource* buffer) override;
+
+    void start_copy(wl_resource* buffer, bool with_damage);
+
+    /// Called on the Wayland thread once the compositor has read the copy back
+    void finish_copy(compositor::ScreenCopy::Result const& result, bool with_damage);
+
+    std::shared_ptr<Executor> const wayland_executor;
+    std::shared_ptr<compositor::ScreenCopy> const screen_copy;
+    std::shared_ptr<compositor::ScreenCopy::DamageHistory> const history;
+    geometry::Rectangle const area;
+    geometry::Size const size;
+    bool const capturable;
+
+    bool used{false};
+    wl_resource* buffer{nullptr};
+    std::shared_ptr<bool> buffer_destroyed;
+    std::shared_ptr<void> pending_copy;
+};
+}
+}
+
+namespace
+{
+uint32_t const format = WL_SHM_FORMAT_XRGB8888;
+int const bytes_per_pixel = 4;
+
+auto stride_for(geom::Size const& size) -> int
+{
+    return size.width.as_int() * bytes_per_pixel;
+}
+}
+
+auto mf::create_wlr_screencopy_manager_v1(
+    wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    OutputManager* output_manager,
+    std::shared_ptr<compositor::ScreenCopy> const& screen_copy) -> std::shared_ptr<WlrScreencopyManagerV1Global>
+{
+    return std::make_shared<WlrScreencopyManagerV1Global>(display, wayland_executor, output_manager, screen_copy);
+}
+
+mf::WlrScreencopyManagerV1Global::WlrScreencopyManagerV1Global(
+    wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    OutputManager* output_manager,
+    std::shared_ptr<compositor::ScreenCopy> const& screen_copy)
+    : Global{display, Version<3>()},
+      wayland_executor{wayland_executor},
+      output_manager{output_manager},
+      screen_copy{screen_copy}
+{
+}
+
+void mf::WlrScreencopyManagerV1Global::bind(wl_resource* new_resource)
+{
+    new WlrScreencopyManagerV1{new_resource, *this};
+}
+
+mf::WlrScreencopyManagerV1::WlrScreencopyManagerV1(
+    wl_resource* new_resource,
+    WlrScreencopyManagerV1Global const& global)
+    : ScreencopyManagerV1{new_resource, Version<3>()},
+      global{global}
+{
+}
+
+void mf::WlrScreencopyManagerV1::capture_output(wl_resource* frame, int32_t /*overlay_cursor*/, wl_resource* output)
+{
+    create_frame(frame, output, std::experimental::nullopt);
+}
+
+void mf::WlrScreencopyManagerV1::capture_output_region(
+    wl_resource* frame,
+    int32_t /*overlay_cursor*/,
+    wl_resource* output,
+    int32_t x, int32_t y,
+    int32_t width, int32_t height)
+{
+    // The region is in the client's logical coordinates, which may be scaled from ours
+    auto const geometry_scale = WlClient::from(client)->output_geometry_scale();
+    int const left = std::floor(x / geometry_scale);
+    int const top = std::floor(y / geometry_scale);
+    int const right = std::ceil((x + width) / geometry_scale);
+    int const bottom = std::ceil((y + height) / geometry_scale);
+
+    create_frame(frame, output, geom::Rectangle{{left, top}, {right - left, bottom - top}});
+}
+
+void mf::WlrScreencopyManagerV1::create_frame(
+    wl_resource* frame,
+    wl_resource* output,
+    std::experimental::optional<geom::Rectangle> region)
+{
+    auto const output_id = global.output_manager->output_id_for(client, output);
+    if (!output_id)
+    {
+        // The output has gone away, the frame can only fail
+        new WlrScreencopyFrameV1{frame};
+        return;
+    }
+
+    std::experimental::optional<geom::Rectangle> area;
+    std::experimental::optional<geom::Size> size;
+    global.output_manager->display_config()->for_each_output(
+        [&](mg::DisplayConfigurationOutput const& config)
+        {
+            if (config.id != output_id.value() || !config.used || config.current_mode_index >= config.modes.size())
+                return;
+
+            auto const extents = config.extents();
+            auto mode_size = config.modes[config.current_mode_index].size;
+            if (config.orientation == mir_orientation_left || config.orientation == mir_orientation_right)
+                mode_size = {mode_size.height.as_int(), mode_size.width.as_int()};
+
+            if (region)
+            {
+                auto const clipped = extents.intersection_with(
+                    {extents.top_left + as_displacement(region.value().top_left), region.value().size});
+                if (clipped.size.width.as_int() <= 0 || clipped.size.height.as_int() <= 0)
+                    return;
+
+                auto const scale_x = float(mode_size.width.as_int()) / extents.size.width.as_int();
+                auto const scale_y = float(mode_size.height.as_int()) / extents.size.height.as_int();
+                area = clipped;
+                size = geom::Size{
+                    static_cast<int>(std::lround(clipped.size.width.as_int() * scale_x)),
+                    static_cast<int>(std::lround(clipped.size.height.as_int() * scale_y))};
+            }
+            else
+            {
+                area = extents;
+                size = mode_size;
+            }
+        });
+
+    if (!area)
+    {
+        new WlrScreencopyFrameV1{frame};
+        return;
+    }
+
+    new WlrScreencopyFrameV1{
+        frame,
+        global.wayland_executor,
+        global.screen_copy,
+        damage_history_for(output_id.value()),
+        area.value(),
+        size.value()};
+}
+
+auto mf::WlrScreencopyManagerV1::damage_history_for(mg::DisplayConfigurationOutputId id)
+    -> std::shared_ptr<mc::ScreenCopy::DamageHistory>
+{
+    auto& history = histories[id];
+    if (!history)
+        history = mc::ScreenCopy::new_damage_history();
+    return history;
+}
+
+mf::WlrScreencopyFrameV1::WlrScreencopyFrameV1(
+    wl_resource* new_resource,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<mc::ScreenCopy> const& screen_copy,
+    std::shared_ptr<mc::ScreenCopy::DamageHistory> const& history,
+    geom::Rectangle const& area,
+    geom::Size const& size)
+    : ScreencopyFrameV1{new_resource, Version<3>()},
+      wayland_executor{wayland_executor},
+      screen_copy{screen_copy},
+      history{history},
+      area{area},
+      size{size},
+      capturable{true}
+{
+    send_buffer_event(format, size.width.as_uint32_t(), size.height.as_uint32_t(), stride_for(size));
+    if (version_supports_buffer_done())
+        send_buffer_done_event();
+}
+
+mf::WlrScreencopyFrameV1::WlrScreencopyFrameV1(wl_resource* new_resource)
+    : ScreencopyFrameV1{new_resource, Version<3>()},
+      capturable{false}
+{
+    // Clients still need a buffer to make the copy that fails
+    send_buffer_event(format, 1, 1, stride_for({1, 1}));
+    if (version_supports_buffer_done())
+        send_buffer_done_event();
+}
+
+void mf::WlrScreencopyFrameV1::copy(wl_resource* buffer)
+{
+    start_copy(buffer, false);
+}
+
+void mf::WlrScreencopyFrameV1::copy_with_damage(wl_resource* buffer)
+{
+    start_copy(buffer, true);
+}
+
+void mf::WlrScreencopyFrameV1::start_copy(wl_resource* buffer, bool with_damage)
+{
+    if (used)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::already_used,
+            "Frame already used to copy a buffer"));
+    }
+    used = true;
+
+    auto const shm_buffer = wl_shm_buffer_get(buffer);
+    if (!shm_buffer)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_buffer,
+            "Only wl_shm buffers are supported"));
+    }
+
+    auto const expected_size = capturable ? size : geom::Size{1, 1};
+    if (wl_shm_buffer_get_format(shm_buffer) != format ||
+        wl_shm_buffer_get_width(shm_buffer) != expected_size.width.as_int() ||
+        wl_shm_buffer_get_height(shm_buffer) != expected_size.height.as_int() ||
+        wl_shm_buffer_get_stride(shm_buffer) != stride_for(expected_size))
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_buffer,
+            "Buffer is %dx%d, stride %d, format %d; expected %dx%d, stride %d, format %d",
+            wl_shm_buffer_get_width(shm_buffer),
+            wl_shm_buffer_get_height(shm_buffer),
+            wl_shm_buffer_get_stride(shm_buffer),
+            wl_shm_buffer_get_format(shm_buffer),
+            expected_size.width.as_int(),
+            expected_size.height.as_int(),
+            stride_for(expected_size),
+            format));
+    }
+
+    if (!capturable)
+    {
+        send_failed_event();
+        return;
+    }
+
+    this->buffer = buffer;
+    buffer_destroyed = deleted_flag_for_resource(buffer);
+
+    pending_copy = screen_copy->copy({
+        area,
+        size,
+        history,
+        with_damage,
+        [executor = wayland_executor, frame = mw::make_weak(this), with_damage](mc::ScreenCopy::Result&& result)
+        {
+            auto const shared_result = std::make_shared<mc::ScreenCopy::Result>(std::move(result));
+            executor->spawn([frame, shared_result, with_damage]()
+                {
+                    if (frame)
+                        frame.value().finish_copy(*shared_result, with_damage);
+                });
+        }});
+}
+
+void mf::WlrScreencopyFrameV1::finish_copy(mc::ScreenCopy::Result const& result, bool with_damage)
+{
+    pending_copy.reset();
+
+    auto const row_size = stride_for(size);
+    auto const shm_buffer = *buffer_destroyed ? nullptr : wl_shm_buffer_get(buffer);
+    if (!result.succeeded || !shm_buffer || result.pixels.size() != std::size_t(row_size) * size.height.as_int())
+    {
+        send_failed_event();
+        return;
+    }
+
+    wl_shm_buffer_begin_access(shm_buffer);
+    auto const data = static_cast<unsigned char*>(wl_shm_buffer_get_data(shm_buffer));
+    auto const stride = wl_shm_buffer_get_stride(shm_buffer);
+    for (auto row = 0; row != size.height.as_int(); ++row)
+    {
+        memcpy(data + row * stride, result.pixels.data() + row * row_size, row_size);
+    }
+    wl_shm_buffer_end_access(shm_buffer);
+
+    if (with_damage && version_supports_damage())
+    {
+        geom::Rectangle const copy_area{{0, 0}, size};
+        for (auto const& damage : result.damage)
+        {
+            auto const rect = damage.intersection_with(copy_area);
+            send_damage_event(
+                rect.left().as_uint32_t(), rect.top().as_uint32_t(),
+                rect.size.width.as_uint32_t(), rect.size.height.as_uint32_t());
+        }
+    }
+
+    send_flags_event(0);
+
+    auto const since_epoch = result.time.time_since_epoch();
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    auto const nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds);
+    uint64_t const sec = seconds.count();
+    send_ready_event(sec >> 32, sec & 0xffffffff, nanoseconds.count());
+}
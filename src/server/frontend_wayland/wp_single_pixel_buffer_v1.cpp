@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wp_single_pixel_buffer_v1.h"
+#include "single-pixel-buffer-v1_wrapper.h"
+#include "wayland_wrapper.h"
+
+#include "mir/graphics/solid_color_buffer.h"
+
+#include <limits>
+
+namespace mw = mir::wayland;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace mir
+{
+namespace frontend
+{
+class WpSinglePixelBufferManagerV1 : public wayland::SinglePixelBufferManagerV1
+{
+public:
+    WpSinglePixelBufferManagerV1(wl_resource* resource);
+
+    class Global : public wayland::SinglePixelBufferManagerV1::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_wp_single_pixel_buffer_manager_v1) override;
+    };
+
+private:
+    void create_u32_rgba_buffer(wl_resource* id, uint32_t r, uint32_t g, uint32_t b, uint32_t a) override;
+};
+
+/// A wl_buffer that is just a colour. There's no client memory behind it, so nothing to copy or import.
+class SinglePixelBuffer : public wayland::Buffer
+{
+public:
+    SinglePixelBuffer(wl_resource* id, glm::vec4 const& premultiplied_color);
+
+    std::shared_ptr<mg::SolidColorBuffer> const buffer;
+};
+}
+}
+
+auto mir::frontend::create_wp_single_pixel_buffer_manager_v1(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<WpSinglePixelBufferManagerV1::Global>(display);
+}
+
+auto mir::frontend::single_pixel_buffer_from(wl_resource* buffer) -> std::shared_ptr<mg::Buffer>
+{
+    if (auto const single_pixel_buffer = dynamic_cast<SinglePixelBuffer*>(mw::Buffer::from(buffer)))
+    {
+        return single_pixel_buffer->buffer;
+    }
+    return nullptr;
+}
+
+mir::frontend::WpSinglePixelBufferManagerV1::Global::Global(wl_display* display) :
+    wayland::SinglePixelBufferManagerV1::Global::Global{display, Version<1>{}}
+{
+}
+
+void mir::frontend::WpSinglePixelBufferManagerV1::Global::bind(wl_resource* new_wp_single_pixel_buffer_manager_v1)
+{
+    new WpSinglePixelBufferManagerV1{new_wp_single_pixel_buffer_manager_v1};
+}
+
+mir::frontend::WpSinglePixelBufferManagerV1::WpSinglePixelBufferManagerV1(wl_resource* resource) :
+    wayland::SinglePixelBufferManagerV1{resource, Version<1>{}}
+{
+}
+
+void mir::frontend::WpSinglePixelBufferManagerV1::create_u32_rgba_buffer(
+    wl_resource* id,
+    uint32_t r,
+    uint32_t g,
+    uint32_t b,
+    uint32_t a)
+{
+    auto const channel = [](uint32_t value)
+        {
+            return static_cast<float>(double(value) / std::numeric_limits<uint32_t>::max());
+        };
+
+    new SinglePixelBuffer{id, {channel(r), channel(g), channel(b), channel(a)}};
+}
+
+mir::frontend::SinglePixelBuffer::SinglePixelBuffer(wl_resource* id, glm::vec4 const& premultiplied_color) :
+    wayland::Buffer{id, Version<1>{}},
+    buffer{std::make_shared<mg::SolidColorBuffer>(geom::Size{1, 1}, premultiplied_color)}
+{
+}
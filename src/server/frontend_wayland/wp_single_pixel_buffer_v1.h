@@ -0,0 +1,40 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_WP_SINGLE_PIXEL_BUFFER_V1_H
+#define MIR_FRONTEND_WP_SINGLE_PIXEL_BUFFER_V1_H
+
+#include <memory>
+
+struct wl_display;
+struct wl_resource;
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+}
+namespace frontend
+{
+auto create_wp_single_pixel_buffer_manager_v1(wl_display* display) -> std::shared_ptr<void>;
+
+/// The solid colour buffer for \p buffer if it is a single-pixel buffer, otherwise null
+auto single_pixel_buffer_from(wl_resource* buffer) -> std::shared_ptr<graphics::Buffer>;
+}
+}
+
+#endif  // MIR_FRONTEND_WP_SINGLE_PIXEL_BUFFER_V1_H
@@ -0,0 +1,175 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wp_viewporter.h"
+#include "viewporter_wrapper.h"
+#include "wl_surface.h"
+
+#include <boost/throw_exception.hpp>
+
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+namespace mir
+{
+namespace frontend
+{
+class WpViewporter : public wayland::Viewporter
+{
+public:
+    WpViewporter(wl_resource* resource);
+
+    class Global : public wayland::Viewporter::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_wp_viewporter) override;
+    };
+
+private:
+    void get_viewport(wl_resource* id, wl_resource* surface) override;
+};
+
+/// Crops and scales a surface. The surface does the work on commit, this just records the pending state.
+class WpViewport : public wayland::Viewport
+{
+public:
+    WpViewport(wl_resource* id, WlSurface* surface);
+    ~WpViewport();
+
+private:
+    void set_source(double x, double y, double width, double height) override;
+    void set_destination(int32_t width, int32_t height) override;
+
+    auto surface_or_error() const -> WlSurface&;
+
+    wayland::Weak<WlSurface> const surface;
+};
+}
+}
+
+auto mir::frontend::create_wp_viewporter(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<WpViewporter::Global>(display);
+}
+
+mir::frontend::WpViewporter::Global::Global(wl_display* display) :
+    wayland::Viewporter::Global::Global{display, Version<1>{}}
+{
+}
+
+void mir::frontend::WpViewporter::Global::bind(wl_resource* new_wp_viewporter)
+{
+    new WpViewporter{new_wp_viewporter};
+}
+
+mir::frontend::WpViewporter::WpViewporter(wl_resource* resource) :
+    wayland::Viewporter{resource, Version<1>{}}
+{
+}
+
+void mir::frontend::WpViewporter::get_viewport(wl_resource* id, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->has_viewport())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::viewport_exists,
+            "wl_surface@%d already has a viewport",
+            wl_resource_get_id(surface)));
+    }
+
+    new WpViewport{id, wl_surface};
+}
+
+mir::frontend::WpViewport::WpViewport(wl_resource* id, WlSurface* surface) :
+    wayland::Viewport{id, Version<1>{}},
+    surface{mw::make_weak(surface)}
+{
+    surface->set_viewport(this);
+}
+
+mir::frontend::WpViewport::~WpViewport()
+{
+    // The crop and scale state is removed on the next commit
+    if (surface)
+    {
+        surface.value().set_pending_viewport_source(std::experimental::nullopt);
+        surface.value().set_pending_viewport_destination(std::experimental::nullopt);
+    }
+}
+
+void mir::frontend::WpViewport::set_source(double x, double y, double width, double height)
+{
+    auto& target = surface_or_error();
+
+    if (x == -1 && y == -1 && width == -1 && height == -1)
+    {
+        target.set_pending_viewport_source(std::experimental::nullopt);
+        return;
+    }
+
+    if (x < 0 || y < 0 || width <= 0 || height <= 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_value,
+            "Invalid source rectangle %gx%g+%g+%g",
+            width, height, x, y));
+    }
+
+    target.set_pending_viewport_source(geom::RectangleF{
+        {static_cast<float>(x), static_cast<float>(y)},
+        {static_cast<float>(width), static_cast<float>(height)}});
+}
+
+void mir::frontend::WpViewport::set_destination(int32_t width, int32_t height)
+{
+    auto& target = surface_or_error();
+
+    if (width == -1 && height == -1)
+    {
+        target.set_pending_viewport_destination(std::experimental::nullopt);
+        return;
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_value,
+            "Invalid destination size %dx%d",
+            width, height));
+    }
+
+    target.set_pending_viewport_destination(geom::Size{width, height});
+}
+
+auto mir::frontend::WpViewport::surface_or_error() const -> WlSurface&
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::no_surface,
+            "The wl_surface of wp_viewport@%d was destroyed",
+            wl_resource_get_id(resource)));
+    }
+    return surface.value();
+}
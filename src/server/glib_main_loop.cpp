@@ -35,33 +35,31 @@ class AlarmImpl : public mir::time::Alarm
 {
 public:
     AlarmImpl(
-        GMainContext* main_context,
+        mir::detail::TimerQueue& timers,
         std::shared_ptr<mir::time::Clock> const& clock,
         std::unique_ptr<mir::LockableCallback>&& callback,
         std::function<void()> const& exception_handler)
-        : main_context{g_main_context_ref(main_context)},
-          clock{clock},
+        : clock{clock},
           state_{State::cancelled},
-          exception_handler{exception_handler},
-          wrapped_callback{std::make_shared<mir::LockableCallbackWrapper>(
-              std::move(callback), [this] { state_ = State::triggered; })}
+          timer{timers.create_timer(
+              std::make_shared<mir::LockableCallbackWrapper>(
+                  std::move(callback), [this] { state_ = State::triggered; }),
+              exception_handler)}
     {
     }
 
     ~AlarmImpl() override
     {
-        gsource.ensure_no_further_dispatch();
-        g_main_context_unref(main_context);
+        timer->cancel();
     }
 
     bool cancel() override
     {
         std::lock_guard<std::mutex> lock{alarm_mutex};
 
-        gsource.ensure_no_further_dispatch();
+        timer->cancel();
         if (state_ ==  State::pending)
         {
-            gsource = mir::detail::GSourceHandle{};
             state_ = State::cancelled;
         }
         return state_ == State::cancelled;
@@ -84,24 +82,16 @@ public:
 
         auto old_state = state_;
         state_ = State::pending;
-        gsource = mir::detail::add_timer_gsource(
-            main_context,
-            clock,
-            wrapped_callback,
-            exception_handler,
-            time_point);
+        timer->schedule(time_point);
 
         return old_state == State::pending;
     }
 
 private:
     mutable std::mutex alarm_mutex;
-    GMainContext* main_context;
     std::shared_ptr<mir::time::Clock> const clock;
     State state_;
-    std::function<void()> exception_handler;
-    std::shared_ptr<mir::LockableCallback> wrapped_callback;
-    mir::detail::GSourceHandle gsource;
+    std::shared_ptr<mir::detail::TimerQueue::Timer> const timer;
 };
 
 }
@@ -131,7 +121,9 @@ mir::GLibMainLoop::GLibMainLoop(
       running_{false},
       fd_sources{main_context},
       signal_sources{fd_sources},
-      before_iteration_hook{[]{}}
+      before_iteration_hook{[]{}},
+      action_queue{main_context, [this](void const* owner) { return should_process_actions_for(owner); }},
+      timers{main_context, clock}
 {
 }
 
@@ -249,25 +241,19 @@ void mir::GLibMainLoop::unregister_fd_handler(
 
 void mir::GLibMainLoop::enqueue(void const* owner, ServerAction const& action)
 {
-    auto const action_with_exception_handling =
+    action_queue.enqueue(
+        owner,
         [this, action]
         {
             try { action(); }
             catch (...) { handle_exception(std::current_exception()); }
-        };
-
-    detail::add_server_action_gsource(main_context, owner,
-        action_with_exception_handling,
-        [this] (void const* owner)
-        {
-            return should_process_actions_for(owner);
         });
 }
 
 
 void mir::GLibMainLoop::enqueue_with_guaranteed_execution(mir::ServerAction const& action)
 {
-    auto const action_with_exception_handling =
+    auto action_with_exception_handling =
         [this]
         {
             try
@@ -301,10 +287,7 @@ void mir::GLibMainLoop::enqueue_with_guaranteed_execution(mir::ServerAction cons
         }
     }
 
-    detail::add_idle_gsource(
-        main_context,
-        G_PRIORITY_DEFAULT,
-        action_with_exception_handling);
+    action_queue.enqueue_unconditionally(std::move(action_with_exception_handling));
 }
 
 void mir::GLibMainLoop::pause_processing_for(void const* owner)
@@ -351,7 +334,7 @@ std::unique_ptr<mir::time::Alarm> mir::GLibMainLoop::create_alarm(
         };
 
     return std::make_unique<AlarmImpl>(
-        main_context, clock, std::move(callback), exception_hander);
+        timers, clock, std::move(callback), exception_hander);
 }
 
 void mir::GLibMainLoop::reprocess_all_sources()
@@ -453,16 +436,10 @@ void mir::GLibMainLoop::handle_exception(std::exception_ptr const& e)
 
 void mir::GLibMainLoop::spawn(std::function<void()>&& work)
 {
-    auto const action_with_exception_handling =
+    action_queue.enqueue_unconditionally(
         [this, action = std::move(work)]
         {
             try { action(); }
             catch (...) { handle_exception(std::current_exception()); }
-        };
-
-    detail::add_server_action_gsource(
-        main_context,
-        nullptr,
-        action_with_exception_handling,
-        [](auto) { return true; });
+        });
 }
@@ -19,12 +19,16 @@
 
 #include "mir/glib_main_loop_sources.h"
 #include "mir/lockable_callback.h"
+#include "mir/time/timer_wheel.h"
 #include "mir/raii.h"
 #include <mir/log.h>
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <system_error>
+#include <unordered_set>
+#include <utility>
 #include <sstream>
 
 #include <csignal>
@@ -180,192 +184,355 @@ void md::add_idle_gsource(
     g_source_attach(gsource, main_context);
 }
 
-void md::add_server_action_gsource(
-    GMainContext* main_context,
-    void const* owner,
-    std::function<void()> const& action,
-    std::function<bool(void const*)> const& should_dispatch)
-{
-    struct ServerActionContext
-    {
-        void const* const owner;
-        std::function<void(void)> const action;
-        std::function<bool(void const*)> const should_dispatch;
-
-        // If we come to finalize() before dispatch() we have already
-        // torn down most of Mir and even unloaded some shared libraries.
-        // That means the action could refer to  stuff that is no longer
-        // in the address space.
-        // We will just leak any resources instead of crashing.
-        bool mutable dispatched{false};
-    };
+/*********************
+ * ServerActionQueue *
+ *********************/
 
-    struct ServerActionGSource
+struct md::ServerActionQueue::ActionGSource
+{
+    GSource gsource;
+    ServerActionQueue* queue;
+
+    static gboolean prepare(GSource* source, gint *timeout)
     {
-        GSource gsource;
-        ServerActionContext ctx;
-        bool ctx_constructed;
+        *timeout = -1;
+        return reinterpret_cast<ActionGSource*>(source)->queue->ready();
+    }
 
-        static gboolean prepare(GSource* source, gint *timeout)
-        {
-            *timeout = -1;
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            return ctx.should_dispatch(ctx.owner);
-        }
+    static gboolean check(GSource* source)
+    {
+        return reinterpret_cast<ActionGSource*>(source)->queue->ready();
+    }
 
-        static gboolean check(GSource* source)
-        {
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            return ctx.should_dispatch(ctx.owner);
-        }
+    static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+    {
+        reinterpret_cast<ActionGSource*>(source)->queue->dispatch();
+        return G_SOURCE_CONTINUE;
+    }
+};
 
-        static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+md::ServerActionQueue::ServerActionQueue(
+    GMainContext* main_context,
+    std::function<bool(void const*)> const& should_dispatch) :
+    main_context{main_context},
+    should_dispatch{should_dispatch},
+    gsource{[this]
         {
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            ctx.action();
-            ctx.dispatched = true;
-            return FALSE;
-        }
+            static GSourceFuncs gsource_funcs{
+                ActionGSource::prepare,
+                ActionGSource::check,
+                ActionGSource::dispatch,
+                nullptr,
+                nullptr,
+                nullptr
+            };
+
+            auto const gsource = g_source_new(&gsource_funcs, sizeof(ActionGSource));
+            reinterpret_cast<ActionGSource*>(gsource)->queue = this;
+            return gsource;
+        }()}
+{
+    g_source_attach(gsource, main_context);
+}
 
-        static void finalize(GSource* source)
-        {
-            auto const sa_gsource = reinterpret_cast<ServerActionGSource*>(source);
-            if (sa_gsource->ctx_constructed && sa_gsource->ctx.dispatched)
-                sa_gsource->ctx.~ServerActionContext();
-        }
-    };
+md::ServerActionQueue::~ServerActionQueue()
+{
+    g_source_destroy(gsource);
+    g_source_unref(gsource);
 
-    static GSourceFuncs gsource_funcs{
-        ServerActionGSource::prepare,
-        ServerActionGSource::check,
-        ServerActionGSource::dispatch,
-        ServerActionGSource::finalize,
-        nullptr,
-        nullptr
-    };
+    // Actions that were never dispatched could refer to stuff that is no
+    // longer in the address space (we have torn down most of Mir, and even
+    // unloaded some shared libraries). We will just leak them instead of
+    // crashing.
+    if (!actions.empty())
+        new std::deque<Action>{std::move(actions)};
+}
 
-    GSourceRef gsource{g_source_new(&gsource_funcs, sizeof(ServerActionGSource))};
-    auto const sa_gsource = reinterpret_cast<ServerActionGSource*>(static_cast<GSource*>(gsource));
+void md::ServerActionQueue::enqueue(void const* owner, std::function<void()>&& action)
+{
+    push({true, owner, std::move(action)});
+}
 
-    sa_gsource->ctx_constructed = false;
-    new (&sa_gsource->ctx) decltype(sa_gsource->ctx){owner, action, should_dispatch};
-    sa_gsource->ctx_constructed = true;
+void md::ServerActionQueue::enqueue_unconditionally(std::function<void()>&& action)
+{
+    push({false, nullptr, std::move(action)});
+}
 
-    g_source_attach(gsource, main_context);
+void md::ServerActionQueue::push(Action&& action)
+{
+    bool wake;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        actions.push_back(std::move(action));
+        wake = !std::exchange(woken, true);
+    }
+
+    // A burst of actions needs only one wakeup: the next iteration sees them all.
+    // And the thread running the context will prepare() before it next polls.
+    if (wake && !g_main_context_is_owner(main_context))
+        g_main_context_wakeup(main_context);
 }
 
-md::GSourceHandle md::add_timer_gsource(
-    GMainContext* main_context,
-    std::shared_ptr<time::Clock> const& clock,
-    std::shared_ptr<LockableCallback> const& handler,
-    std::function<void()> const& exception_handler,
-    time::Timestamp target_time)
+auto md::ServerActionQueue::ready() -> bool
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    // Anything queued after this needs to wake the context again
+    woken = false;
+
+    return std::any_of(begin(actions), end(actions), [this](Action const& action)
+        {
+            return !action.pausable || should_dispatch(action.owner);
+        });
+}
+
+void md::ServerActionQueue::dispatch()
 {
-    struct TimerContext
+    std::deque<Action> batch;
     {
-        TimerContext(std::shared_ptr<time::Clock> const& clock,
-                     std::shared_ptr<LockableCallback> const& handler,
-                     std::function<void()> const& exception_handler,
-                     time::Timestamp target_time)
-            : clock{clock}, handler{handler}, exception_handler{exception_handler},
-              target_time{target_time}, enabled{true}
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        batch.swap(actions);
+    }
+
+    // Actions for paused owners keep their place ahead of anything queued meanwhile.
+    // Once an owner's action is held back so are its later ones, even if an earlier
+    // action resumes the owner: they must not run ahead of the held action.
+    std::deque<Action> paused;
+    std::unordered_set<void const*> paused_owners;
+    for (auto& action : batch)
+    {
+        if (action.pausable && (paused_owners.count(action.owner) || !should_dispatch(action.owner)))
         {
+            paused_owners.insert(action.owner);
+            paused.push_back(std::move(action));
         }
-        std::shared_ptr<time::Clock> clock;
-        std::shared_ptr<LockableCallback> handler;
-        std::function<void()> exception_handler;
-        time::Timestamp target_time;
-        std::recursive_mutex mutex;
-        bool enabled;
-    };
+        else
+        {
+            action.action();
+        }
+    }
 
-    struct TimerGSource
+    if (!paused.empty())
     {
-        GSource gsource;
-        TimerContext ctx;
-        bool ctx_constructed;
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        actions.insert(
+            begin(actions),
+            std::make_move_iterator(begin(paused)),
+            std::make_move_iterator(end(paused)));
+    }
+}
 
-        static gboolean prepare(GSource* source, gint *timeout)
-        {
-            auto const& ctx = reinterpret_cast<TimerGSource*>(source)->ctx;
+/**************
+ * TimerQueue *
+ **************/
+
+struct md::TimerQueue::State
+{
+    State(GMainContext* main_context, std::shared_ptr<time::Clock> const& clock) :
+        main_context{g_main_context_ref(main_context)},
+        clock{clock},
+        wheel{clock->now()}
+    {
+    }
 
-            auto const now = ctx.clock->now();
-            bool const ready = (now >= ctx.target_time);
-            if (ready)
-                *timeout = -1;
-            else
-                *timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    ctx.clock->min_wait_until(ctx.target_time)).count();
+    ~State()
+    {
+        g_main_context_unref(main_context);
+    }
 
-            return ready;
-        }
+    auto ready(gint* timeout) -> bool;
+    void dispatch();
 
-        static gboolean check(GSource* source)
-        {
-            auto const& ctx = reinterpret_cast<TimerGSource*>(source)->ctx;
+    GMainContext* const main_context;
+    std::shared_ptr<time::Clock> const clock;
 
-            auto const now = ctx.clock->now();
-            bool const ready = (now >= ctx.target_time);
-            return ready;
+    std::mutex mutex;
+    time::TimerWheel wheel;
+    std::vector<time::TimerWheel::Timer*> expired;
+    std::vector<std::pair<std::shared_ptr<TimerImpl>, std::uint64_t>> due;
+};
+
+class md::TimerQueue::TimerImpl :
+    public TimerQueue::Timer,
+    public time::TimerWheel::Timer,
+    public std::enable_shared_from_this<TimerImpl>
+{
+public:
+    TimerImpl(
+        std::shared_ptr<State> const& state,
+        std::shared_ptr<LockableCallback> const& handler,
+        std::function<void()> const& exception_handler) :
+        state{state},
+        handler{handler},
+        exception_handler{exception_handler}
+    {
+    }
+
+    ~TimerImpl()
+    {
+        std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+        state->wheel.remove(*this);
+    }
+
+    void schedule(time::Timestamp target_time) override
+    {
+        bool wake;
+        {
+            std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+            wake = target_time < state->wheel.next_wakeup();
+            ++generation;
+            state->wheel.add(*this, target_time);
         }
 
-        static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+        // The thread running the context will prepare() again before it next polls
+        if (wake && !g_main_context_is_owner(state->main_context))
+            g_main_context_wakeup(state->main_context);
+    }
+
+    void cancel() override
+    {
+        std::lock_guard<decltype(dispatch_mutex)> dispatch_lock{dispatch_mutex};
+        std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+        ++generation;
+        state->wheel.remove(*this);
+    }
+
+    void dispatch(std::uint64_t scheduled_generation)
+    {
+        try
         {
-            auto& ctx = reinterpret_cast<TimerGSource*>(source)->ctx;
-            try
-            {
-                // Attempt to preserve locking order during callback dispatching
-                // so we acquire the caller's lock before our own.
-                auto& handler = *ctx.handler;
-                std::lock_guard<LockableCallback> handler_lock{handler};
-                std::lock_guard<decltype(ctx.mutex)> lock{ctx.mutex};
-                if (ctx.enabled)
-                    handler();
-            }
-            catch(...)
+            // Attempt to preserve locking order during callback dispatching
+            // so we acquire the caller's lock before our own.
+            std::lock_guard<LockableCallback> handler_lock{*handler};
+            std::lock_guard<decltype(dispatch_mutex)> dispatch_lock{dispatch_mutex};
+
+            bool still_scheduled;
             {
-                ctx.exception_handler();
+                std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+                still_scheduled = generation == scheduled_generation;
             }
 
-            return FALSE;
+            if (still_scheduled)
+                (*handler)();
         }
-
-        static void finalize(GSource* source)
+        catch(...)
         {
-            auto const timer_gsource = reinterpret_cast<TimerGSource*>(source);
-            if (timer_gsource->ctx_constructed)
-                timer_gsource->ctx.~TimerContext();
+            exception_handler();
         }
+    }
 
-        static void disable(GSource* source)
-        {
-            auto& ctx = reinterpret_cast<TimerGSource*>(source)->ctx;
-            std::lock_guard<decltype(ctx.mutex)> lock{ctx.mutex};
-            ctx.enabled = false;
-        }
-    };
+    /// Changed by every schedule() and cancel(): guarded by state->mutex
+    std::uint64_t generation{0};
 
-    static GSourceFuncs gsource_funcs{
-        TimerGSource::prepare,
-        TimerGSource::check,
-        TimerGSource::dispatch,
-        TimerGSource::finalize,
-        nullptr,
-        nullptr
-    };
+private:
+    std::shared_ptr<State> const state;
+    std::shared_ptr<LockableCallback> const handler;
+    std::function<void()> const exception_handler;
 
-    GSourceHandle gsource{
-        g_source_new(&gsource_funcs, sizeof(TimerGSource)),
-        [](GSource* gsource) { TimerGSource::disable(gsource); }};
-    auto const timer_gsource = reinterpret_cast<TimerGSource*>(static_cast<GSource*>(gsource));
+    /// Held while dispatching, so cancel() can wait for that to finish
+    std::recursive_mutex dispatch_mutex;
+};
+
+auto md::TimerQueue::State::ready(gint* timeout) -> bool
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    expired.clear();
+    wheel.expire(clock->now(), expired);
+
+    for (auto const timer : expired)
+    {
+        // A timer being destroyed is waiting for the lock to remove itself
+        if (auto const live = static_cast<TimerImpl*>(timer)->weak_from_this().lock())
+            due.emplace_back(live, live->generation);
+    }
 
-    timer_gsource->ctx_constructed = false;
-    new (&timer_gsource->ctx) TimerContext{clock, handler, exception_handler, target_time};
-    timer_gsource->ctx_constructed = true;
+    if (timeout)
+    {
+        auto const wakeup = wheel.next_wakeup();
+        if (!due.empty() || wakeup == time::Timestamp::max())
+            *timeout = -1;
+        else
+            *timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                clock->min_wait_until(wakeup)).count();
+    }
 
+    return !due.empty();
+}
+
+void md::TimerQueue::State::dispatch()
+{
+    decltype(due) batch;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        batch.swap(due);
+    }
+
+    for (auto const& timer : batch)
+        timer.first->dispatch(timer.second);
+}
+
+struct md::TimerQueue::TimerGSource
+{
+    GSource gsource;
+    State* state;
+
+    static gboolean prepare(GSource* source, gint *timeout)
+    {
+        return reinterpret_cast<TimerGSource*>(source)->state->ready(timeout);
+    }
+
+    static gboolean check(GSource* source)
+    {
+        return reinterpret_cast<TimerGSource*>(source)->state->ready(nullptr);
+    }
+
+    static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+    {
+        reinterpret_cast<TimerGSource*>(source)->state->dispatch();
+        return G_SOURCE_CONTINUE;
+    }
+};
+
+md::TimerQueue::TimerQueue(GMainContext* main_context, std::shared_ptr<time::Clock> const& clock) :
+    state{std::make_shared<State>(main_context, clock)},
+    gsource{[this]
+        {
+            static GSourceFuncs gsource_funcs{
+                TimerGSource::prepare,
+                TimerGSource::check,
+                TimerGSource::dispatch,
+                nullptr,
+                nullptr,
+                nullptr
+            };
+
+            auto const gsource = g_source_new(&gsource_funcs, sizeof(TimerGSource));
+            reinterpret_cast<TimerGSource*>(gsource)->state = state.get();
+            return gsource;
+        }()}
+{
     g_source_attach(gsource, main_context);
+}
 
-    return gsource;
+md::TimerQueue::~TimerQueue()
+{
+    g_source_destroy(gsource);
+    g_source_unref(gsource);
+
+    // Timers that were due, but never dispatched, refer back to the state
+    decltype(state->due) undispatched;
+    {
+        std::lock_guard<decltype(state->mutex)> lock{state->mutex};
+        undispatched.swap(state->due);
+    }
+}
+
+auto md::TimerQueue::create_timer(
+    std::shared_ptr<LockableCallback> const& handler,
+    std::function<void()> const& exception_handler) -> std::shared_ptr<Timer>
+{
+    return std::make_shared<TimerImpl>(state, handler, exception_handler);
 }
 
 /*************
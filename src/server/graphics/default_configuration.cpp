@@ -26,6 +26,7 @@
 #include "null_cursor.h"
 #include "software_cursor.h"
 #include "platform_probe.h"
+#include "platform_probe_cache.h"
 
 #include "mir/graphics/gl_config.h"
 #include "mir/graphics/platform.h"
@@ -142,6 +143,16 @@ auto select_platforms_from_list(std::string const& selection, std::vector<std::s
 
     return selected_modules;
 }
+
+auto probe_cache_for(mir::options::Option const& options) -> std::unique_ptr<mg::PlatformProbeCache>
+{
+    if (!options.is_set(mir::options::platform_probe_cache_opt))
+        return nullptr;
+
+    return std::make_unique<mg::PlatformProbeCache>(
+        options.get<std::string>(mir::options::platform_probe_cache_opt),
+        options.get<std::string>(mir::options::platform_path));
+}
 }
 
 auto mir::DefaultServerConfiguration::the_display_platforms() -> std::vector<std::shared_ptr<graphics::DisplayPlatform>> const&
@@ -154,41 +165,59 @@ auto mir::DefaultServerConfiguration::the_display_platforms() -> std::vector<std
         try
         {
             auto const& path = the_options()->get<std::string>(options::platform_path);
-            auto platforms = mir::libraries_for_path(path, *the_shared_library_prober_report());
+            auto const probe_cache = probe_cache_for(*the_options());
 
-            if (platforms.empty())
+            // A warm start needn't load and probe every module
+            if (probe_cache && !the_options()->is_set(options::platform_display_libs))
             {
-                auto msg = "Failed to find any platform plugins in: " + path;
-                throw std::runtime_error(msg.c_str());
+                platform_modules = mir::graphics::display_modules_from_paths(
+                    probe_cache->lookup("display"),
+                    dynamic_cast<mir::options::ProgramOption&>(*the_options()),
+                    the_console_services());
             }
 
-            if (the_options()->is_set(options::platform_display_libs))
+            if (platform_modules.empty())
             {
-                platform_modules =
-                    select_platforms_from_list(the_options()->get<std::string>(options::platform_display_libs), platforms);
+                auto platforms = mir::libraries_for_path(path, *the_shared_library_prober_report());
 
-                for (auto const& platform : platform_modules)
+                if (platforms.empty())
                 {
-                    auto const platform_priority =
-                        graphics::probe_display_module(
-                            *platform,
-                            dynamic_cast<mir::options::ProgramOption&>(*the_options()),
-                            the_console_services());
+                    auto msg = "Failed to find any platform plugins in: " + path;
+                    throw std::runtime_error(msg.c_str());
+                }
 
-                    if (platform_priority < mir::graphics::PlatformPriority::supported)
-                    {
-                        auto const describe_module = platform->load_function<mg::DescribeModule>(
-                            "describe_graphics_module",
-                            MIR_SERVER_GRAPHICS_PLATFORM_VERSION);
-                        auto const descriptor = describe_module();
+                if (the_options()->is_set(options::platform_display_libs))
+                {
+                    platform_modules =
+                        select_platforms_from_list(the_options()->get<std::string>(options::platform_display_libs), platforms);
 
-                        mir::log_warning("Manually-specified graphics platform %s does not claim to support this system. Trying anyway...", descriptor->name);
+                    for (auto const& platform : platform_modules)
+                    {
+                        auto const platform_priority =
+                            graphics::probe_display_module(
+                                *platform,
+                                dynamic_cast<mir::options::ProgramOption&>(*the_options()),
+                                the_console_services());
+
+                        if (platform_priority < mir::graphics::PlatformPriority::supported)
+                        {
+                            auto const describe_module = platform->load_function<mg::DescribeModule>(
+                                "describe_graphics_module",
+                                MIR_SERVER_GRAPHICS_PLATFORM_VERSION);
+                            auto const descriptor = describe_module();
+
+                            mir::log_warning("Manually-specified graphics platform %s does not claim to support this system. Trying anyway...", descriptor->name);
+                        }
                     }
                 }
-            }
-            else
-            {
-                platform_modules = mir::graphics::display_modules_for_device(platforms, dynamic_cast<mir::options::ProgramOption&>(*the_options()), the_console_services());
+                else
+                {
+                    mg::PlatformPriority priority{mg::unsupported};
+                    platform_modules = mir::graphics::display_modules_for_device(platforms, dynamic_cast<mir::options::ProgramOption&>(*the_options()), the_console_services(), priority);
+
+                    if (probe_cache)
+                        probe_cache->store("display", platform_modules, priority);
+                }
             }
 
             for (auto const& platform : platform_modules)
@@ -247,41 +276,59 @@ auto mir::DefaultServerConfiguration::the_rendering_platforms() ->
         try
         {
             auto const& path = the_options()->get<std::string>(options::platform_path);
-            auto platforms = mir::libraries_for_path(path, *the_shared_library_prober_report());
+            auto const probe_cache = probe_cache_for(*the_options());
 
-            if (platforms.empty())
+            // A warm start needn't load and probe every module
+            if (probe_cache && !the_options()->is_set(options::platform_rendering_libs))
             {
-                auto msg = "Failed to find any platform plugins in: " + path;
-                throw std::runtime_error(msg.c_str());
+                platform_modules = mir::graphics::rendering_modules_from_paths(
+                    probe_cache->lookup("rendering"),
+                    dynamic_cast<mir::options::ProgramOption&>(*the_options()),
+                    the_console_services());
             }
 
-            if (the_options()->is_set(options::platform_rendering_libs))
+            if (platform_modules.empty())
             {
-                platform_modules =
-                    select_platforms_from_list(the_options()->get<std::string>(options::platform_rendering_libs), platforms);
+                auto platforms = mir::libraries_for_path(path, *the_shared_library_prober_report());
+
+                if (platforms.empty())
+                {
+                    auto msg = "Failed to find any platform plugins in: " + path;
+                    throw std::runtime_error(msg.c_str());
+                }
 
-                for (auto const& platform : platform_modules)
+                if (the_options()->is_set(options::platform_rendering_libs))
                 {
-                    auto const platform_priority =
-                        graphics::probe_rendering_module(
-                            *platform,
-                            dynamic_cast<mir::options::ProgramOption&>(*the_options()),
-                            the_console_services());
+                    platform_modules =
+                        select_platforms_from_list(the_options()->get<std::string>(options::platform_rendering_libs), platforms);
 
-                    if (platform_priority < mir::graphics::PlatformPriority::supported)
+                    for (auto const& platform : platform_modules)
                     {
-                        auto const describe_module = platform->load_function<mg::DescribeModule>(
-                            "describe_graphics_module",
-                            MIR_SERVER_GRAPHICS_PLATFORM_VERSION);
-                        auto const descriptor = describe_module();
-
-                        mir::log_warning("Manually-specified graphics platform %s does not claim to support this system. Trying anyway...", descriptor->name);
+                        auto const platform_priority =
+                            graphics::probe_rendering_module(
+                                *platform,
+                                dynamic_cast<mir::options::ProgramOption&>(*the_options()),
+                                the_console_services());
+
+                        if (platform_priority < mir::graphics::PlatformPriority::supported)
+                        {
+                            auto const describe_module = platform->load_function<mg::DescribeModule>(
+                                "describe_graphics_module",
+                                MIR_SERVER_GRAPHICS_PLATFORM_VERSION);
+                            auto const descriptor = describe_module();
+
+                            mir::log_warning("Manually-specified graphics platform %s does not claim to support this system. Trying anyway...", descriptor->name);
+                        }
                     }
                 }
-            }
-            else
-            {
-                platform_modules = mir::graphics::rendering_modules_for_device(platforms, dynamic_cast<mir::options::ProgramOption&>(*the_options()), the_console_services());
+                else
+                {
+                    mg::PlatformPriority priority{mg::unsupported};
+                    platform_modules = mir::graphics::rendering_modules_for_device(platforms, dynamic_cast<mir::options::ProgramOption&>(*the_options()), the_console_services(), priority);
+
+                    if (probe_cache)
+                        probe_cache->store("rendering", platform_modules, priority);
+                }
             }
 
             for (auto const& platform : platform_modules)
@@ -19,9 +19,17 @@
 #include "mir/log.h"
 #include "mir/graphics/platform.h"
 #include "platform_probe.h"
+#include "mir/console_services.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <set>
+
+#include <sys/sysmacros.h>
+
 namespace
 {
 auto probe_module(
@@ -84,16 +92,164 @@ enum class ModuleType
     Display
 };
 
+/// Lets modules probe concurrently
+///
+/// Console services implementations aren't thread-safe, so calls are serialised.
+/// And each device is handed to one probe at a time, so one module's probe
+/// can't make another's fail by holding (say) DRM master.
+class ProbingConsoleServices : public mir::ConsoleServices
+{
+public:
+    explicit ProbingConsoleServices(std::shared_ptr<mir::ConsoleServices> const& wrapped) :
+        state{std::make_shared<State>(wrapped)}
+    {
+    }
+
+    void register_switch_handlers(
+        mir::graphics::EventHandlerRegister& handlers,
+        std::function<bool()> const& switch_away,
+        std::function<bool()> const& switch_back) override
+    {
+        std::lock_guard<decltype(state->call_mutex)> lock{state->call_mutex};
+        state->wrapped->register_switch_handlers(handlers, switch_away, switch_back);
+    }
+
+    void restore() override
+    {
+        std::lock_guard<decltype(state->call_mutex)> lock{state->call_mutex};
+        state->wrapped->restore();
+    }
+
+    auto create_vt_switcher() -> std::unique_ptr<mir::VTSwitcher> override
+    {
+        std::lock_guard<decltype(state->call_mutex)> lock{state->call_mutex};
+        return state->wrapped->create_vt_switcher();
+    }
+
+    auto acquire_device(int major, int minor, std::unique_ptr<mir::Device::Observer> observer)
+        -> std::future<std::unique_ptr<mir::Device>> override
+    {
+        auto const lease = state->lease(makedev(major, minor));
+
+        std::future<std::unique_ptr<mir::Device>> device;
+        {
+            std::lock_guard<decltype(state->call_mutex)> lock{state->call_mutex};
+            device = state->wrapped->acquire_device(major, minor, std::move(observer));
+        }
+
+        // The device stays leased until the probe is done with it (or the future)
+        return std::async(
+            std::launch::deferred,
+            [state = state, lease, device = std::move(device)]() mutable -> std::unique_ptr<mir::Device>
+            {
+                return std::make_unique<LeasedDevice>(device.get(), lease, state);
+            });
+    }
+
+private:
+    struct State : std::enable_shared_from_this<State>
+    {
+        explicit State(std::shared_ptr<mir::ConsoleServices> const& wrapped) :
+            wrapped{wrapped}
+        {
+        }
+
+        auto lease(dev_t devnum) -> std::shared_ptr<void>
+        {
+            std::unique_lock<decltype(leased_mutex)> lock{leased_mutex};
+            leased_cv.wait(lock, [&] { return leased.count(devnum) == 0; });
+            leased.insert(devnum);
+
+            return {
+                nullptr,
+                [self = shared_from_this(), devnum](void*)
+                {
+                    {
+                        std::lock_guard<decltype(self->leased_mutex)> lock{self->leased_mutex};
+                        self->leased.erase(devnum);
+                    }
+                    self->leased_cv.notify_all();
+                }};
+        }
+
+        std::shared_ptr<mir::ConsoleServices> const wrapped;
+        std::mutex call_mutex;
+
+        std::mutex leased_mutex;
+        std::condition_variable leased_cv;
+        std::set<dev_t> leased;
+    };
+
+    class LeasedDevice : public mir::Device
+    {
+    public:
+        LeasedDevice(
+            std::unique_ptr<mir::Device> device,
+            std::shared_ptr<void> const& lease,
+            std::shared_ptr<State> const& state) :
+            device{std::move(device)},
+            lease{lease},
+            state{state}
+        {
+        }
+
+        ~LeasedDevice()
+        {
+            std::lock_guard<decltype(state->call_mutex)> lock{state->call_mutex};
+            device.reset();
+        }
+
+    private:
+        std::unique_ptr<mir::Device> device;
+        std::shared_ptr<void> const lease;
+        std::shared_ptr<State> const state;
+    };
+
+    std::shared_ptr<State> const state;
+};
+
+auto probe_as(
+    ModuleType type,
+    mir::SharedLibrary& module,
+    mir::options::ProgramOption const& options,
+    std::shared_ptr<mir::ConsoleServices> const& console) -> mir::graphics::PlatformPriority
+{
+    switch (type)
+    {
+    case ModuleType::Rendering:
+        return mir::graphics::probe_rendering_module(module, options, console);
+    case ModuleType::Display:
+        return mir::graphics::probe_display_module(module, options, console);
+    }
+
+    BOOST_THROW_EXCEPTION((std::logic_error{"Invalid module type"}));
+}
+
 auto modules_for_device(
     ModuleType type,
     std::vector<std::shared_ptr<mir::SharedLibrary>> const& modules,
     mir::options::ProgramOption const& options,
-    std::shared_ptr<mir::ConsoleServices> const& console)
+    std::shared_ptr<mir::ConsoleServices> const& console,
+    mir::graphics::PlatformPriority& priority)
 -> std::vector<std::shared_ptr<mir::SharedLibrary>>
 {
+    /* Each probe opens and queries devices, which can take a while, so probe
+     * every module at once. The results are collected in module order, so the
+     * choice is the same as probing one after another.
+     */
+    auto const probing_console = std::make_shared<ProbingConsoleServices>(console);
+
+    std::vector<std::future<mir::graphics::PlatformPriority>> priorities;
+    for (auto& module : modules)
+    {
+        priorities.push_back(std::async(
+            std::launch::async,
+            [&, module]() { return probe_as(type, *module, options, probing_console); }));
+    }
+
     mir::graphics::PlatformPriority best_priority_so_far = mir::graphics::unsupported;
     std::vector<std::shared_ptr<mir::SharedLibrary>> best_modules_so_far;
-    for (auto& module : modules)
+    for (auto i = 0u; i != modules.size(); ++i)
     {
         try
         {
@@ -105,25 +261,16 @@ auto modules_for_device(
              * For now, hopefully “load each platform that claims to best support (at least some)
              * device” will work.
              */
-            mir::graphics::PlatformPriority module_priority;
-            switch (type)
-            {
-            case ModuleType::Rendering:
-                module_priority = mir::graphics::probe_rendering_module(*module, options, console);
-                break;
-            case ModuleType::Display:
-                module_priority = mir::graphics::probe_display_module(*module, options, console);
-                break;
-            }
+            auto const module_priority = priorities[i].get();
             if (module_priority > best_priority_so_far)
             {
                 best_priority_so_far = module_priority;
                 best_modules_so_far.clear();
-                best_modules_so_far.push_back(module);
+                best_modules_so_far.push_back(modules[i]);
             }
             else if (module_priority == best_priority_so_far)
             {
-                best_modules_so_far.push_back(module);
+                best_modules_so_far.push_back(modules[i]);
             }
         }
         catch (std::runtime_error const&)
@@ -132,30 +279,108 @@ auto modules_for_device(
     }
     if (best_priority_so_far > mir::graphics::unsupported)
     {
+        priority = best_priority_so_far;
         return best_modules_so_far;
     }
     BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to find any platforms for current system"}));
 }
+
+auto modules_from_paths(
+    ModuleType type,
+    std::vector<mir::graphics::ProbedModule> const& probed,
+    mir::options::ProgramOption const& options,
+    std::shared_ptr<mir::ConsoleServices> const& console)
+-> std::vector<std::shared_ptr<mir::SharedLibrary>>
+{
+    std::vector<std::shared_ptr<mir::SharedLibrary>> modules;
+    try
+    {
+        for (auto const& entry : probed)
+        {
+            /* A module that claims a different priority has found something different (a new
+             * driver, say) about the system, and a module that wasn't chosen could now be better.
+             */
+            auto const module = std::make_shared<mir::SharedLibrary>(entry.path);
+            auto const priority = probe_as(type, *module, options, console);
+            if (priority <= mir::graphics::unsupported || priority != entry.priority)
+                return {};
+
+            modules.push_back(module);
+        }
+    }
+    catch (std::runtime_error const&)
+    {
+        return {};
+    }
+
+    return modules;
+}
 }
 
 auto mir::graphics::display_modules_for_device(
     std::vector<std::shared_ptr<SharedLibrary>> const& modules,
     options::ProgramOption const& options,
     std::shared_ptr<ConsoleServices> const& console) -> std::vector<std::shared_ptr<SharedLibrary>>
+{
+    PlatformPriority priority{unsupported};
+    return display_modules_for_device(modules, options, console, priority);
+}
+
+auto mir::graphics::display_modules_for_device(
+    std::vector<std::shared_ptr<SharedLibrary>> const& modules,
+    options::ProgramOption const& options,
+    std::shared_ptr<ConsoleServices> const& console,
+    PlatformPriority& priority) -> std::vector<std::shared_ptr<SharedLibrary>>
 {
     return modules_for_device(
         ModuleType::Display,
         modules,
         options,
-        console);
+        console,
+        priority);
 }
 
 auto mir::graphics::rendering_modules_for_device(
     std::vector<std::shared_ptr<SharedLibrary>> const& modules,
     options::ProgramOption const& options,
     std::shared_ptr<ConsoleServices> const& console) -> std::vector<std::shared_ptr<SharedLibrary>>
+{
+    PlatformPriority priority{unsupported};
+    return rendering_modules_for_device(modules, options, console, priority);
+}
+
+auto mir::graphics::rendering_modules_for_device(
+    std::vector<std::shared_ptr<SharedLibrary>> const& modules,
+    options::ProgramOption const& options,
+    std::shared_ptr<ConsoleServices> const& console,
+    PlatformPriority& priority) -> std::vector<std::shared_ptr<SharedLibrary>>
 {
     return modules_for_device(
+        ModuleType::Rendering,
+        modules,
+        options,
+        console,
+        priority);
+}
+
+auto mir::graphics::display_modules_from_paths(
+    std::vector<ProbedModule> const& modules,
+    options::ProgramOption const& options,
+    std::shared_ptr<ConsoleServices> const& console) -> std::vector<std::shared_ptr<SharedLibrary>>
+{
+    return modules_from_paths(
+        ModuleType::Display,
+        modules,
+        options,
+        console);
+}
+
+auto mir::graphics::rendering_modules_from_paths(
+    std::vector<ProbedModule> const& modules,
+    options::ProgramOption const& options,
+    std::shared_ptr<ConsoleServices> const& console) -> std::vector<std::shared_ptr<SharedLibrary>>
+{
+    return modules_from_paths(
         ModuleType::Rendering,
         modules,
         options,
@@ -21,6 +21,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 #include "mir/shared_library.h"
 #include "mir/options/program_option.h"
 #include "mir/graphics/platform.h"
@@ -43,15 +44,54 @@ auto probe_rendering_module(
     options::ProgramOption const& options,
     std::shared_ptr<ConsoleServices> const& console) -> PlatformPriority;
 
+/// A module chosen by an earlier probe, and the priority it claimed then
+struct ProbedModule
+{
+    std::string path;
+    PlatformPriority priority;
+};
+
+auto display_modules_for_device(
+    std::vector<std::shared_ptr<SharedLibrary>> const& modules,
+    options::ProgramOption const& options,
+    std::shared_ptr<ConsoleServices> const& console)
+    -> std::vector<std::shared_ptr<SharedLibrary>>;
+
+/// As above, also setting \p priority to the priority the chosen modules claimed
 auto display_modules_for_device(
+    std::vector<std::shared_ptr<SharedLibrary>> const& modules,
+    options::ProgramOption const& options,
+    std::shared_ptr<ConsoleServices> const& console,
+    PlatformPriority& priority)
+    -> std::vector<std::shared_ptr<SharedLibrary>>;
+
+auto rendering_modules_for_device(
     std::vector<std::shared_ptr<SharedLibrary>> const& modules,
     options::ProgramOption const& options,
     std::shared_ptr<ConsoleServices> const& console)
     -> std::vector<std::shared_ptr<SharedLibrary>>;
 
+/// As above, also setting \p priority to the priority the chosen modules claimed
 auto rendering_modules_for_device(
     std::vector<std::shared_ptr<SharedLibrary>> const& modules,
     options::ProgramOption const& options,
+    std::shared_ptr<ConsoleServices> const& console,
+    PlatformPriority& priority)
+    -> std::vector<std::shared_ptr<SharedLibrary>>;
+
+/// Loads and probes \p modules, as chosen by an earlier probe
+/// \return the modules, or none if any fails to load or now claims a different priority
+auto display_modules_from_paths(
+    std::vector<ProbedModule> const& modules,
+    options::ProgramOption const& options,
+    std::shared_ptr<ConsoleServices> const& console)
+    -> std::vector<std::shared_ptr<SharedLibrary>>;
+
+/// Loads and probes \p modules, as chosen by an earlier probe
+/// \return the modules, or none if any fails to load or now claims a different priority
+auto rendering_modules_from_paths(
+    std::vector<ProbedModule> const& modules,
+    options::ProgramOption const& options,
     std::shared_ptr<ConsoleServices> const& console)
     -> std::vector<std::shared_ptr<SharedLibrary>>;
 }
@@ -0,0 +1,224 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform_probe_cache.h"
+#include "mir/shared_library.h"
+#include "mir/log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mg = mir::graphics;
+
+namespace
+{
+auto directory_entries(std::string const& path) -> std::vector<std::string>
+{
+    std::vector<std::string> entries;
+
+    if (auto const dir = opendir(path.c_str()))
+    {
+        while (auto const entry = readdir(dir))
+        {
+            if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, ".."))
+                entries.emplace_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+
+    std::sort(begin(entries), end(entries));
+    return entries;
+}
+
+auto hash(std::string const& key) -> uint64_t
+{
+    // FNV-1a: stable across builds, unlike std::hash
+    uint64_t result = 0xcbf29ce484222325;
+    for (unsigned char c : key)
+    {
+        result ^= c;
+        result *= 0x100000001b3;
+    }
+    return result;
+}
+
+auto key_for(std::string const& platform_path) -> std::string
+{
+    std::stringstream key;
+    key << platform_path << '\n';
+
+    // The modules that could be probed...
+    for (auto const& name : directory_entries(platform_path))
+    {
+        struct stat info;
+        if (stat((platform_path + "/" + name).c_str(), &info) == 0)
+        {
+            key << name << ' ' << info.st_size << ' '
+                << info.st_mtim.tv_sec << '.' << info.st_mtim.tv_nsec << '\n';
+        }
+    }
+
+    // ...the devices they would find, and the drivers they would find them using...
+    std::string const drm_devices{"/sys/class/drm"};
+    for (auto const& name : directory_entries(drm_devices))
+    {
+        if (auto const device = realpath((drm_devices + "/" + name).c_str(), nullptr))
+        {
+            key << device;
+            free(device);
+        }
+        if (auto const driver = realpath((drm_devices + "/" + name + "/device/driver").c_str(), nullptr))
+        {
+            key << ' ' << driver;
+            free(driver);
+        }
+        key << '\n';
+    }
+
+    // ...and the options they would see
+    {
+        std::ifstream cmdline{"/proc/self/cmdline", std::ios::binary};
+        key << std::string{std::istreambuf_iterator<char>{cmdline}, std::istreambuf_iterator<char>{}} << '\n';
+    }
+
+    std::vector<std::string> environment;
+    for (auto var = environ; var && *var; ++var)
+    {
+        if (strncmp(*var, "MIR_SERVER_", strlen("MIR_SERVER_")) == 0 ||
+            strncmp(*var, "DISPLAY=", strlen("DISPLAY=")) == 0 ||
+            strncmp(*var, "WAYLAND_DISPLAY=", strlen("WAYLAND_DISPLAY=")) == 0)
+        {
+            environment.emplace_back(*var);
+        }
+    }
+    std::sort(begin(environment), end(environment));
+    for (auto const& var : environment)
+        key << var << '\n';
+
+    char digest[17];
+    snprintf(digest, sizeof digest, "%016llx", static_cast<unsigned long long>(hash(key.str())));
+    return digest;
+}
+
+auto path_of(mir::SharedLibrary const& module) -> std::string
+{
+    // Every graphics module has this, and it tells us which file it came from
+    Dl_info info;
+    auto const symbol = module.load_function<void(*)()>("describe_graphics_module");
+    if (!dladdr(reinterpret_cast<void*>(symbol), &info) || !info.dli_fname)
+        return {};
+
+    return info.dli_fname;
+}
+}
+
+mg::PlatformProbeCache::PlatformProbeCache(std::string cache_file, std::string const& platform_path) :
+    cache_file{std::move(cache_file)},
+    key{key_for(platform_path)}
+{
+}
+
+auto mg::PlatformProbeCache::lookup(std::string const& kind) const -> std::vector<ProbedModule>
+{
+    std::vector<ProbedModule> modules;
+    for (auto const& entry : read_entries())
+    {
+        if (entry.first == kind)
+            modules.push_back(entry.second);
+    }
+    return modules;
+}
+
+void mg::PlatformProbeCache::store(
+    std::string const& kind,
+    std::vector<std::shared_ptr<SharedLibrary>> const& modules,
+    PlatformPriority priority)
+{
+    auto entries = read_entries();
+    entries.erase(
+        std::remove_if(begin(entries), end(entries), [&](auto const& entry) { return entry.first == kind; }),
+        end(entries));
+
+    try
+    {
+        for (auto const& module : modules)
+        {
+            auto const path = path_of(*module);
+            if (path.empty())
+                return;
+            entries.emplace_back(kind, ProbedModule{path, priority});
+        }
+    }
+    catch (std::runtime_error const&)
+    {
+        // Not a graphics module: don't remember a partial choice
+        return;
+    }
+
+    // Write to a temporary file and rename it, so a later start never sees a partial file
+    auto const temp_filename = cache_file + "." + std::to_string(getpid());
+    {
+        std::ofstream out{temp_filename, std::ios::trunc};
+        out << key << '\n';
+        for (auto const& entry : entries)
+            out << entry.first << ' ' << entry.second.priority << ' ' << entry.second.path << '\n';
+
+        if (!out)
+        {
+            mir::log_debug("Failed to write platform probe cache %s", temp_filename.c_str());
+            unlink(temp_filename.c_str());
+            return;
+        }
+    }
+
+    if (rename(temp_filename.c_str(), cache_file.c_str()))
+    {
+        mir::log_debug("Failed to write platform probe cache %s", cache_file.c_str());
+        unlink(temp_filename.c_str());
+    }
+}
+
+auto mg::PlatformProbeCache::read_entries() const -> std::vector<std::pair<std::string, ProbedModule>>
+{
+    std::ifstream in{cache_file};
+
+    std::string line;
+    if (!std::getline(in, line) || line != key)
+        return {};
+
+    std::vector<std::pair<std::string, ProbedModule>> entries;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields{line};
+        std::string kind;
+        uint32_t priority;
+        std::string path;
+        if (fields >> kind >> priority && fields.get() == ' ' && std::getline(fields, path))
+            entries.emplace_back(kind, ProbedModule{path, static_cast<PlatformPriority>(priority)});
+    }
+    return entries;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_PLATFORM_PROBE_CACHE_H_
+#define MIR_GRAPHICS_PLATFORM_PROBE_CACHE_H_
+
+#include "platform_probe.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+/// Remembers which platform modules were chosen by probing, so that starting
+/// again on an unchanged system can load only those modules.
+///
+/// The choice is only reused if the modules in the platform directory (their
+/// names, sizes and modification times), the DRM devices and their drivers, the
+/// command line and the MIR_SERVER_*, DISPLAY and WAYLAND_DISPLAY environment
+/// are all unchanged.
+class PlatformProbeCache
+{
+public:
+    /// \param cache_file    where the choice is stored
+    /// \param platform_path the directory the modules are probed from
+    PlatformProbeCache(std::string cache_file, std::string const& platform_path);
+
+    /// The modules chosen as \p kind, or none if nothing was stored for the
+    /// current system
+    auto lookup(std::string const& kind) const -> std::vector<ProbedModule>;
+
+    /// Records \p modules, which claimed \p priority, as the choice of \p kind
+    /// for the current system
+    void store(
+        std::string const& kind,
+        std::vector<std::shared_ptr<SharedLibrary>> const& modules,
+        PlatformPriority priority);
+
+private:
+    std::string const cache_file;
+    std::string const key;
+
+    /// The "kind priority path" lines in the file, if it was stored for the current system
+    auto read_entries() const -> std::vector<std::pair<std::string, ProbedModule>>;
+};
+}
+}
+
+#endif // MIR_GRAPHICS_PLATFORM_PROBE_CACHE_H_
@@ -0,0 +1,41 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/solid_color_buffer.h"
+
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+mg::SolidColorBuffer::SolidColorBuffer(geom::Size size, glm::vec4 const& premultiplied_color)
+    : size_{size},
+      color_{premultiplied_color}
+{
+}
+
+auto mg::SolidColorBuffer::size() const -> geom::Size
+{
+    return size_;
+}
+
+auto mg::SolidColorBuffer::pixel_format() const -> MirPixelFormat
+{
+    return color_.a < 1.0f ? mir_pixel_format_abgr_8888 : mir_pixel_format_xbgr_8888;
+}
+
+auto mg::SolidColorBuffer::native_buffer_base() -> NativeBufferBase*
+{
+    return this;
+}
@@ -271,7 +271,9 @@ mir::DefaultServerConfiguration::the_input_reading_multiplexer()
     return input_reading_multiplexer(
         []() -> std::shared_ptr<mir::dispatch::MultiplexingDispatchable>
         {
-            return std::make_shared<mir::dispatch::MultiplexingDispatchable>();
+            // Only dispatched by the input thread
+            return std::make_shared<mir::dispatch::MultiplexingDispatchable>(
+                mir::dispatch::DispatchThreading::single);
         }
     );
 }
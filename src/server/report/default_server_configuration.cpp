@@ -115,3 +115,12 @@ auto mir::DefaultServerConfiguration::the_shell_report() -> std::shared_ptr<shel
         });
 }
 
+auto mir::DefaultServerConfiguration::the_client_resource_report() -> std::shared_ptr<frontend::ClientResourceReport>
+{
+    return client_resource_report(
+        [this]()->std::shared_ptr<frontend::ClientResourceReport>
+        {
+            return report_factory(options::client_resource_report_opt)->create_client_resource_report();
+        });
+}
+
@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_resource_report.h"
+
+#include "mir/logging/logger.h"
+
+#include <sstream>
+
+namespace ml = mir::logging;
+namespace mrl = mir::report::logging;
+
+namespace
+{
+char const* const component = "client-resources";
+}
+
+mrl::ClientResourceReport::ClientResourceReport(std::shared_ptr<ml::Logger> const& logger) :
+    logger(logger)
+{
+}
+
+void mrl::ClientResourceReport::usage_sampled(frontend::ClientResourceUsage const& usage)
+{
+    std::stringstream ss;
+    ss << "usage_sampled(pid=" << usage.pid
+       << ") requests/s=" << usage.requests_per_second
+       << " commits/s=" << usage.commits_per_second
+       << " buffers=" << usage.buffers_held
+       << " buffer_bytes=" << usage.buffer_bytes_held
+       << " - INFO total requests=" << usage.requests
+       << " commits=" << usage.commits
+       << " frames_dropped=" << usage.frames_dropped;
+
+    logger->log(ml::Severity::informational, ss.str(), component);
+}
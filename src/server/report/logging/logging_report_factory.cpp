@@ -18,6 +18,7 @@
 
 #include "../logging_report_factory.h"
 
+#include "client_resource_report.h"
 #include "compositor_report.h"
 #include "display_report.h"
 #include "scene_report.h"
@@ -71,3 +72,8 @@ std::shared_ptr<mir::shell::ShellReport> mir::report::LoggingReportFactory::crea
 {
     return std::make_shared<mir::logging::ShellReport>(logger);
 }
+
+std::shared_ptr<mir::frontend::ClientResourceReport> mr::LoggingReportFactory::create_client_resource_report()
+{
+    return std::make_shared<logging::ClientResourceReport>(logger);
+}
@@ -59,3 +59,8 @@ std::shared_ptr<mir::shell::ShellReport> mir::report::LttngReportFactory::create
 {
     BOOST_THROW_EXCEPTION(std::logic_error("Not implemented"));
 }
+
+std::shared_ptr<mir::frontend::ClientResourceReport> mir::report::LttngReportFactory::create_client_resource_report()
+{
+    BOOST_THROW_EXCEPTION(std::logic_error("Not implemented"));
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_NULL_CLIENT_RESOURCE_REPORT_H_
+#define MIR_REPORT_NULL_CLIENT_RESOURCE_REPORT_H_
+
+#include "mir/frontend/client_resource_report.h"
+
+namespace mir
+{
+namespace report
+{
+namespace null
+{
+class ClientResourceReport : public frontend::ClientResourceReport
+{
+public:
+    void usage_sampled(frontend::ClientResourceUsage const& /*usage*/) override;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_NULL_CLIENT_RESOURCE_REPORT_H_ */
@@ -18,6 +18,7 @@
 
 #include "../null_report_factory.h"
 
+#include "client_resource_report.h"
 #include "compositor_report.h"
 #include "display_report.h"
 #include "input_report.h"
@@ -61,6 +62,11 @@ std::shared_ptr<mir::shell::ShellReport> mir::report::NullReportFactory::create_
     return std::make_shared<null::ShellReport>();
 }
 
+std::shared_ptr<mir::frontend::ClientResourceReport> mir::report::NullReportFactory::create_client_resource_report()
+{
+    return std::make_shared<null::ClientResourceReport>();
+}
+
 std::shared_ptr<mir::compositor::CompositorReport> mir::report::null_compositor_report()
 {
     return NullReportFactory{}.create_compositor_report();
@@ -28,6 +28,10 @@ namespace compositor
 {
 class CompositorReport;
 }
+namespace frontend
+{
+class ClientResourceReport;
+}
 namespace graphics
 {
 class DisplayReport;
@@ -57,6 +61,7 @@ public:
     virtual std::shared_ptr<input::SeatObserver> create_seat_report() = 0;
     virtual std::shared_ptr<SharedLibraryProberReport> create_shared_library_prober_report() = 0;
     virtual std::shared_ptr<shell::ShellReport> create_shell_report() = 0;
+    virtual std::shared_ptr<frontend::ClientResourceReport> create_client_resource_report() = 0;
 
 protected:
     ReportFactory() = default;
@@ -118,5 +118,10 @@ mir::report::Reports::Reports(
       seat_observer_multiplexer{server.the_seat_observer_registrar()}
 {
     display_configuration_multiplexer->register_interest(display_configuration_report);
-    seat_observer_multiplexer->register_interest(seat_report);
+
+    // The seat is notified of every input event: don't have each one queued on the main loop only to be discarded
+    if (parse_report_option(options.get<std::string>(mo::seat_report_opt)) != ReportOutput::Discarded)
+    {
+        seat_observer_multiplexer->register_interest(seat_report);
+    }
 }
@@ -21,6 +21,7 @@
 
 #include "mir/scene/clipboard.h"
 #include "mir/observer_multiplexer.h"
+#include "mir/immediate_executor.h"
 
 #include <mutex>
 
@@ -28,7 +29,8 @@ namespace mir
 {
 namespace scene
 {
-class ClipboardObserverMultiplexer: mir::Executor, public ObserverMultiplexer<ClipboardObserver>
+// By default, dispatch events immediately. The user can override this behavior by setting their own executor.
+class ClipboardObserverMultiplexer: mir::ImmediateExecutor, public ObserverMultiplexer<ClipboardObserver>
 {
 public:
     ClipboardObserverMultiplexer()
@@ -36,12 +38,6 @@ public:
     {
     }
 
-    // By default, dispatch events immediately. The user can override this behavior by setting their own executor.
-    void spawn(std::function<void()>&& work) override
-    {
-        work();
-    }
-
     void paste_source_set(std::shared_ptr<ClipboardSource> const& source) override
     {
         for_each_observer(&ClipboardObserver::paste_source_set, source);
@@ -246,6 +246,23 @@ auto weak(std::shared_ptr<ms::SurfaceObservers>& observers) -> std::weak_ptr<ms:
 {
     return observers;
 }
+
+auto contains_stream(std::list<ms::StreamInfo> const& layers, std::shared_ptr<mc::BufferStream> const& stream) -> bool
+{
+    return std::any_of(begin(layers), end(layers), [&](auto const& layer) { return layer.stream == stream; });
+}
+
+auto same_layers(std::list<ms::StreamInfo> const& lhs, std::list<ms::StreamInfo> const& rhs) -> bool
+{
+    return std::equal(begin(lhs), end(lhs), begin(rhs), end(rhs), [](auto const& l, auto const& r)
+        {
+            return l.stream == r.stream &&
+                   l.displacement == r.displacement &&
+                   l.size == r.size &&
+                   l.src_bounds == r.src_bounds &&
+                   l.opaque_region == r.opaque_region;
+        });
+}
 }
 
 ms::BasicSurface::BasicSurface(
@@ -793,25 +810,28 @@ std::shared_ptr<ms::Surface> ms::BasicSurface::parent() const
 
 namespace
 {
+/// A surface layer as of one frame, shared by the compositors drawing it
+struct LayerSnapshot
+{
+    std::shared_ptr<mc::BufferStream> const stream;
+    geom::Rectangle const position;
+    std::experimental::optional<geom::Rectangle> const clip_area;
+    std::experimental::optional<geom::RectangleF> const src_bounds;
+    std::vector<geom::Rectangle> const opaque_region;
+    glm::mat4 const transformation;
+    float const alpha;
+    mg::Renderable::ID const id;
+};
+
 //This class avoids locking for long periods of time by copying (or lazy-copying)
 class SurfaceSnapshot : public mg::Renderable
 {
 public:
     SurfaceSnapshot(
-        std::shared_ptr<mc::BufferStream> const& stream,
-        void const* compositor_id,
-        geom::Rectangle const& position,
-        std::experimental::optional<geom::Rectangle> const& clip_area,
-        glm::mat4 const& transform,
-        float alpha,
-        mg::Renderable::ID id)
-    : underlying_buffer_stream{stream},
-      compositor_id{compositor_id},
-      alpha_{alpha},
-      screen_position_(position),
-      clip_area_(clip_area),
-      transformation_(transform),
-      id_(id)
+        std::shared_ptr<LayerSnapshot const> layer,
+        void const* compositor_id)
+    : layer{std::move(layer)},
+      compositor_id{compositor_id}
     {
     }
 
@@ -822,36 +842,37 @@ public:
     std::shared_ptr<mg::Buffer> buffer() const override
     {
         if (!compositor_buffer)
-            compositor_buffer = underlying_buffer_stream->lock_compositor_buffer(compositor_id);
+            compositor_buffer = layer->stream->lock_compositor_buffer(compositor_id);
         return compositor_buffer;
     }
 
     geom::Rectangle screen_position() const override
-    { return screen_position_; }
+    { return layer->position; }
 
     std::experimental::optional<geom::Rectangle> clip_area() const override
-    { return clip_area_; }
+    { return layer->clip_area; }
+
+    std::experimental::optional<geom::RectangleF> src_bounds() const override
+    { return layer->src_bounds; }
+
+    std::vector<geom::Rectangle> opaque_region() const override
+    { return layer->opaque_region; }
 
     float alpha() const override
-    { return alpha_; }
+    { return layer->alpha; }
 
     glm::mat4 transformation() const override
-    { return transformation_; }
+    { return layer->transformation; }
 
     bool shaped() const override
-    { return mg::contains_alpha(underlying_buffer_stream->pixel_format()); }
+    { return mg::contains_alpha(layer->stream->pixel_format()); }
 
     mg::Renderable::ID id() const override
-    { return id_; }
+    { return layer->id; }
 private:
-    std::shared_ptr<mc::BufferStream> const underlying_buffer_stream;
+    std::shared_ptr<LayerSnapshot const> const layer;
     std::shared_ptr<mg::Buffer> mutable compositor_buffer;
     void const*const compositor_id;
-    float const alpha_;
-    geom::Rectangle const screen_position_;
-    std::experimental::optional<geom::Rectangle> const clip_area_;
-    glm::mat4 const transformation_;
-    mg::Renderable::ID const id_;
 };
 }
 
@@ -886,32 +907,50 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
     geom::Point surface_top_left;
     {
         std::lock_guard<std::mutex> lock(guard);
-        for(auto& layer : layers)
-            layer.stream->set_frame_posted_callback([](auto){});
 
-        layers = s;
+        // Clients (such as Wayland subsurface trees) resend all their streams when any one changes
+        if (same_layers(layers, s))
+            return;
 
+        // Streams that are only moved or restacked keep their callbacks
         for(auto& layer : layers)
-            layer.stream->set_frame_posted_callback(
-                [this, observers = weak(observers)](auto const& size)
-                {
-                    if (auto const o = observers.lock())
-                        o->frame_posted(this, 1, size);
-                });
+        {
+            if (!contains_stream(s, layer.stream))
+                layer.stream->set_frame_posted_callback([](auto){});
+        }
+
+        for(auto& layer : s)
+        {
+            if (!contains_stream(layers, layer.stream))
+                layer.stream->set_frame_posted_callback(
+                    [this, observers = weak(observers)](auto const& size)
+                    {
+                        if (auto const o = observers.lock())
+                            o->frame_posted(this, 1, size);
+                    });
+        }
+
+        layers = s;
         surface_top_left = surface_rect.top_left;
     }
     observers->moved_to(this, surface_top_left);
 }
 
 mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) const
+{
+    return std::move(generate_renderables_for({id}).front());
+}
+
+auto ms::BasicSurface::generate_renderables_for(std::vector<mc::CompositorID> const& ids) const
+    -> std::vector<mg::RenderableList>
 {
     std::lock_guard<std::mutex> lock(guard);
-    mg::RenderableList list;
+    std::vector<mg::RenderableList> lists(ids.size());
     
     if (clip_area_)
     {
         if (!surface_rect.overlaps(clip_area_.value()))
-            return list;
+            return lists;
     }
 
     auto const content_top_left_ = content_top_left(lock);
@@ -926,14 +965,34 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
-            list.emplace_back(std::make_shared<SurfaceSnapshot>(
-                info.stream, id,
-                geom::Rectangle{content_top_left_ + info.displacement, std::move(size)},
+            std::experimental::optional<geom::RectangleF> src_bounds;
+            if (info.src_bounds.is_set())
+                src_bounds = info.src_bounds.value();
+
+            geom::Rectangle const position{content_top_left_ + info.displacement, std::move(size)};
+
+            std::vector<geom::Rectangle> opaque_region;
+            for (auto rect : info.opaque_region)
+            {
+                rect.top_left = position.top_left + as_displacement(rect.top_left);
+                rect = rect.intersection_with(position);
+                if (rect.size.width.as_int() > 0 && rect.size.height.as_int() > 0)
+                    opaque_region.push_back(rect);
+            }
+
+            auto const layer = std::make_shared<LayerSnapshot const>(LayerSnapshot{
+                info.stream,
+                position,
                 clip_area_,
-                transformation_matrix, surface_alpha, info.stream.get()));
+                src_bounds,
+                std::move(opaque_region),
+                transformation_matrix, surface_alpha, info.stream.get()});
+
+            for (auto i = 0u; i != ids.size(); ++i)
+                lists[i].emplace_back(std::make_shared<SurfaceSnapshot>(layer, ids[i]));
         }
     }
-    return list;
+    return lists;
 }
 
 void ms::BasicSurface::set_confine_pointer_state(MirPointerConfinementState state)
@@ -109,6 +109,8 @@ public:
     bool visible() const override;
 
     graphics::RenderableList generate_renderables(compositor::CompositorID id) const override;
+    auto generate_renderables_for(std::vector<compositor::CompositorID> const& ids) const
+        -> std::vector<graphics::RenderableList> override;
     int buffers_ready_for_compositor(void const* compositor_id) const override;
 
     MirWindowType type() const override;
@@ -30,6 +30,7 @@
 #include "mir/graphics/display.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/observer_multiplexer.h"
+#include "mir/immediate_executor.h"
 
 #include <boost/throw_exception.hpp>
 
@@ -43,16 +44,12 @@ namespace ms = mir::scene;
 namespace mg = mir::graphics;
 namespace msh = mir::shell;
 
-struct ms::SessionManager::SessionObservers : mir::Executor, mir::ObserverMultiplexer<ms::SessionListener>
+struct ms::SessionManager::SessionObservers : mir::ImmediateExecutor, mir::ObserverMultiplexer<ms::SessionListener>
 {
     SessionObservers()
         : ObserverMultiplexer<ms::SessionListener>(static_cast<Executor&>(*this))
     {
     }
-    void spawn(std::function<void()>&& work) override
-    {
-        work();
-    }
 
     void starting(std::shared_ptr<Session> const& session) override
     {
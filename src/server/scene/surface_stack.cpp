@@ -124,6 +124,22 @@ struct SurfaceDepthLayerObserver : ms::NullSurfaceObserver
         stack->raise(surface);
     }
 
+    void frame_posted(ms::Surface const* surface, int /*frames_available*/, geom::Size const& /*size*/) override
+    {
+        stack->surface_posted_frame(surface);
+    }
+
+    // Changes to how the surface is drawn make the compositors' shared snapshot stale
+    void attrib_changed(ms::Surface const*, MirWindowAttrib, int) override { stack->surface_changed(); }
+    void window_resized_to(ms::Surface const*, geom::Size const&) override { stack->surface_changed(); }
+    void content_resized_to(ms::Surface const*, geom::Size const&) override { stack->surface_changed(); }
+    void moved_to(ms::Surface const*, geom::Point const&) override { stack->surface_changed(); }
+    void hidden_set_to(ms::Surface const*, bool) override { stack->surface_changed(); }
+    void alpha_set_to(ms::Surface const*, float) override { stack->surface_changed(); }
+    void orientation_set_to(ms::Surface const*, MirOrientation) override { stack->surface_changed(); }
+    void transformation_set_to(ms::Surface const*, glm::mat4 const&) override { stack->surface_changed(); }
+    void renamed(ms::Surface const*, char const*) override { stack->surface_changed(); }
+
 private:
     ms::SurfaceStack* stack;
 };
@@ -152,33 +168,79 @@ ms::SurfaceStack::~SurfaceStack() noexcept(true)
 
 mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id)
 {
-    RecursiveReadLock lg(guard);
+    return std::move(scene_elements_for_group({id}).front());
+}
+
+auto ms::SurfaceStack::scene_elements_for_group(std::vector<mc::CompositorID> const& ids)
+    -> std::vector<mc::SceneElementSequence>
+{
+    std::lock_guard<decltype(frame_mutex)> lock{frame_mutex};
+
+    // The compositors of other outputs draw the same frame, so usually find their elements waiting
+    auto const taken = [this](mc::CompositorID id) { return !frame.sequences.count(id); };
+    if (frame.generation != scene_generation || std::any_of(begin(ids), end(ids), taken))
+        snapshot_frame(ids);
 
     scene_changed = false;
-    mc::SceneElementSequence elements;
+    std::vector<mc::SceneElementSequence> sequences;
+    for (auto const id : ids)
+    {
+        auto const sequence = frame.sequences.find(id);
+        sequences.push_back(std::move(sequence->second));
+        frame.sequences.erase(sequence);
+    }
+    return sequences;
+}
+
+void ms::SurfaceStack::snapshot_frame(std::vector<mc::CompositorID> const& ids)
+{
+    RecursiveReadLock lg(guard);
+
+    // Changes made while we traverse the scene make this snapshot stale
+    frame.generation = scene_generation;
+
+    std::vector<mc::CompositorID> all_ids{begin(registered_compositors), end(registered_compositors)};
+    for (auto const id : ids)
+    {
+        if (!registered_compositors.count(id))
+            all_ids.push_back(id);
+    }
+
+    std::vector<mc::SceneElementSequence> sequences(all_ids.size());
     for (auto const& layer : surface_layers)
     {
         for (auto const& surface : layer)
         {
             if (surface->visible())
             {
-                for (auto& renderable : surface->generate_renderables(id))
+                auto const& tracker = rendering_trackers[surface.get()];
+                auto renderables = surface->generate_renderables_for(all_ids);
+                for (auto i = 0u; i != all_ids.size(); ++i)
                 {
-                    elements.emplace_back(
-                        std::make_shared<SurfaceSceneElement>(
-                            surface->name(),
-                            renderable,
-                            rendering_trackers[surface.get()],
-                            id));
+                    for (auto& renderable : renderables[i])
+                    {
+                        sequences[i].emplace_back(
+                            std::make_shared<SurfaceSceneElement>(
+                                surface->name(),
+                                renderable,
+                                tracker,
+                                all_ids[i]));
+                    }
                 }
             }
         }
     }
     for (auto const& renderable : overlays)
     {
-        elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
+        // Overlays keep no per-compositor state, so one element serves every sequence
+        auto const element = std::make_shared<OverlaySceneElement>(renderable);
+        for (auto& elements : sequences)
+            elements.emplace_back(element);
     }
-    return elements;
+
+    frame.sequences.clear();
+    for (auto i = 0u; i != all_ids.size(); ++i)
+        frame.sequences.emplace(all_ids[i], std::move(sequences[i]));
 }
 
 int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
@@ -186,35 +248,77 @@ int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
     RecursiveReadLock lg(guard);
 
     int result = scene_changed ? 1 : 0;
-    for (auto const& layer : surface_layers)
+
+    // Only surfaces that have posted frames since this compositor last consumed them.
+    // They're taken (not copied) so the surfaces can be asked without holding
+    // pending_frames_mutex; any that post meanwhile are pending afresh.
+    std::set<Surface const*> candidates;
     {
-        for (auto const& surface : layer)
+        std::lock_guard<decltype(pending_frames_mutex)> lock{pending_frames_mutex};
+        auto const pending = pending_frames.find(id);
+        if (pending != pending_frames.end())
+            candidates.swap(pending->second);
+    }
+
+    for (auto candidate = candidates.begin(); candidate != candidates.end();)
+    {
+        auto const surface = *candidate;
+
+        // Note that we ask the surface and not a Renderable.
+        // This is because we don't want to waste time and resources
+        // on a snapshot till we're sure we need it...
+        auto const ready = surface->buffers_ready_for_compositor(id);
+
+        if (ready > result && surface->visible())
         {
-            if (surface->visible())
-            {
-                auto const tracker = rendering_trackers.find(surface.get());
-                if (tracker != rendering_trackers.end() && tracker->second->is_exposed_in(id))
-                {
-                    // Note that we ask the surface and not a Renderable.
-                    // This is because we don't want to waste time and resources
-                    // on a snapshot till we're sure we need it...
-                    int ready = surface->buffers_ready_for_compositor(id);
-                    if (ready > result)
-                        result = ready;
-                }
-            }
+            auto const tracker = rendering_trackers.find(surface);
+            if (tracker != rendering_trackers.end() && tracker->second->is_exposed_in(id))
+                result = ready;
         }
+
+        // Until it posts again, nothing new will come from this surface. One that is
+        // hidden or covered stays pending while it has frames, for when it is shown.
+        candidate = ready ? std::next(candidate) : candidates.erase(candidate);
+    }
+
+    if (!candidates.empty())
+    {
+        std::lock_guard<decltype(pending_frames_mutex)> lock{pending_frames_mutex};
+        auto const pending = pending_frames.find(id);
+        if (pending != pending_frames.end())
+            pending->second.merge(candidates);
     }
+
     return result;
 }
 
+void ms::SurfaceStack::surface_posted_frame(Surface const* surface)
+{
+    ++scene_generation;
+    std::lock_guard<decltype(pending_frames_mutex)> lock{pending_frames_mutex};
+    for (auto& compositor : pending_frames)
+        compositor.second.insert(surface);
+}
+
+void ms::SurfaceStack::surface_changed()
+{
+    ++scene_generation;
+}
+
 void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
 {
     RecursiveWriteLock lg(guard);
 
     registered_compositors.insert(cid);
+    ++scene_generation;
 
     update_rendering_tracker_compositors();
+
+    // A new compositor has yet to consume anything
+    std::lock_guard<decltype(pending_frames_mutex)> lock{pending_frames_mutex};
+    auto& pending = pending_frames[cid];
+    for (auto const& tracker : rendering_trackers)
+        pending.insert(tracker.first);
 }
 
 void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
@@ -222,8 +326,12 @@ void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
     RecursiveWriteLock lg(guard);
 
     registered_compositors.erase(cid);
+    ++scene_generation;
 
     update_rendering_tracker_compositors();
+
+    std::lock_guard<decltype(pending_frames_mutex)> lock{pending_frames_mutex};
+    pending_frames.erase(cid);
 }
 
 void ms::SurfaceStack::add_input_visualization(
@@ -232,6 +340,7 @@ void ms::SurfaceStack::add_input_visualization(
     {
         RecursiveWriteLock lg(guard);
         overlays.push_back(overlay);
+        ++scene_generation;
     }
     emit_scene_changed();
 }
@@ -248,6 +357,7 @@ void ms::SurfaceStack::remove_input_visualization(
             BOOST_THROW_EXCEPTION(std::runtime_error("Attempt to remove an overlay which was never added or which has been previously removed"));
         }
         overlays.erase(p);
+        ++scene_generation;
     }
     
     emit_scene_changed();
@@ -258,6 +368,7 @@ void ms::SurfaceStack::emit_scene_changed()
     {
         RecursiveWriteLock lg(guard);
         scene_changed = true;
+        ++scene_generation;
     }
     observers.scene_changed();
 }
@@ -272,6 +383,8 @@ void ms::SurfaceStack::add_surface(
         create_rendering_tracker_for(surface);
         surface->add_observer(surface_observer);
     }
+    // It may have posted frames before we were observing it
+    surface_posted_frame(surface.get());
     surface->set_reception_mode(input_mode);
     observers.surface_added(surface);
 
@@ -293,9 +406,14 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
             if (surface != layer.end())
             {
                 layer.erase(surface);
+                ++scene_generation;
                 rendering_trackers.erase(keep_alive.get());
                 keep_alive->remove_observer(surface_observer);
                 found_surface = true;
+
+                std::lock_guard<decltype(pending_frames_mutex)> lock{pending_frames_mutex};
+                for (auto& compositor : pending_frames)
+                    compositor.second.erase(keep_alive.get());
                 break;
             }
         }
@@ -457,6 +575,7 @@ void ms::SurfaceStack::insert_surface_at_top_of_depth_layer(std::shared_ptr<Surf
     if (surface_layers.size() <= depth_index)
         surface_layers.resize(depth_index + 1);
     surface_layers[depth_index].push_back(surface);
+    ++scene_generation;
 }
 
 void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observer)
@@ -79,6 +79,8 @@ public:
 
     // From Scene
     compositor::SceneElementSequence scene_elements_for(compositor::CompositorID id) override;
+    auto scene_elements_for_group(std::vector<compositor::CompositorID> const& ids)
+        -> std::vector<compositor::SceneElementSequence> override;
     int frames_pending(compositor::CompositorID) const override;
     void register_compositor(compositor::CompositorID id) override;
     void unregister_compositor(compositor::CompositorID id) override;
@@ -89,6 +91,11 @@ public:
     virtual void remove_surface(std::weak_ptr<Surface> const& surface) override;
 
     void raise(Surface const* surface);
+
+    /// Notes that \p surface has a new frame for the registered compositors
+    void surface_posted_frame(Surface const* surface);
+    /// Notes that a surface has changed how it is drawn
+    void surface_changed();
     virtual void raise(std::weak_ptr<Surface> const& surface) override;
     void raise(SurfaceSet const& surfaces) override;
 
@@ -115,6 +122,9 @@ private:
     void create_rendering_tracker_for(std::shared_ptr<Surface> const&);
     void update_rendering_tracker_compositors();
     void insert_surface_at_top_of_depth_layer(std::shared_ptr<Surface> const& surface);
+    /// Replaces the frame with the current scene, for \p ids and every registered compositor.
+    /// Requires frame_mutex to be held.
+    void snapshot_frame(std::vector<compositor::CompositorID> const& ids);
 
     RecursiveReadWriteMutex mutable guard;
 
@@ -128,11 +138,29 @@ private:
      * The inner vectors contain the list of surfaces on each layer (bottom to top)
      */
     std::vector<std::vector<std::shared_ptr<Surface>>> surface_layers;
-    std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
+    std::map<Surface const*,std::shared_ptr<RenderingTracker>> rendering_trackers;
     std::set<compositor::CompositorID> registered_compositors;
+
+    /// For each compositor, the surfaces that may have frames it has yet to consume
+    std::mutex mutable pending_frames_mutex;
+    std::map<compositor::CompositorID, std::set<Surface const*>> mutable pending_frames;
     
     std::vector<std::shared_ptr<graphics::Renderable>> overlays;
 
+    /// Counts changes to the scene (including new frames), so compositors can tell if the frame is stale
+    std::atomic<unsigned long> scene_generation{0};
+
+    /// The scene as last traversed, shared by the compositors of every output
+    struct Frame
+    {
+        unsigned long generation{0};
+        /// The elements each compositor has yet to take. Each compositor takes its
+        /// elements once, as they lock buffers on its behalf.
+        std::map<compositor::CompositorID, compositor::SceneElementSequence> sequences;
+    };
+    std::mutex frame_mutex;
+    Frame frame;
+
     Observers observers;
     std::atomic<bool> scene_changed;
     std::shared_ptr<SurfaceObserver> surface_observer;
@@ -95,6 +95,7 @@ struct TemporaryCompositeEventFilter : public mi::CompositeEventFilter
     MACRO(gl_config)\
     MACRO(host_lifecycle_event_listener)\
     MACRO(input_dispatcher)\
+    MACRO(input_report)\
     MACRO(input_targeter)\
     MACRO(logger)\
     MACRO(prompt_session_listener)\
@@ -22,6 +22,7 @@
 #include "input.h"
 
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/solid_color_buffer.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/geometry/displacement.h"
 #include "mir/log.h"
@@ -472,17 +473,6 @@ void msd::Renderer::update_state(WindowState const& window_state, InputState con
     right_border_size = window_state.right_border_rect().size;
     bottom_border_size = window_state.bottom_border_rect().size;
 
-    size_t length{0};
-    length = std::max(length, area(left_border_size));
-    length = std::max(length, area(right_border_size));
-    length = std::max(length, area(bottom_border_size));
-
-    if (length != solid_color_pixels_length)
-    {
-        solid_color_pixels_length = length;
-        solid_color_pixels.reset(); // force a reallocation next time it's needed
-    }
-
     if (window_state.titlebar_rect().size != titlebar_size)
     {
         titlebar_size = window_state.titlebar_rect().size;
@@ -497,7 +487,6 @@ void msd::Renderer::update_state(WindowState const& window_state, InputState con
     {
         current_theme = new_theme;
         needs_titlebar_redraw = true;
-        needs_solid_color_redraw = true;
     }
 
     if (window_state.window_name() != name)
@@ -604,43 +593,33 @@ auto msd::Renderer::render_left_border() -> std::experimental::optional<std::sha
 {
     if (!area(left_border_size))
         return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), left_border_size);
+    return make_solid_color_buffer(left_border_size);
 }
 
 auto msd::Renderer::render_right_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
     if (!area(right_border_size))
         return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), right_border_size);
+    return make_solid_color_buffer(right_border_size);
 }
 
 auto msd::Renderer::render_bottom_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
     if (!area(bottom_border_size))
         return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), bottom_border_size);
+    return make_solid_color_buffer(bottom_border_size);
 }
 
-void msd::Renderer::update_solid_color_pixels()
+auto msd::Renderer::make_solid_color_buffer(
+    geometry::Size size) -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!solid_color_pixels)
-    {
-        solid_color_pixels = alloc_pixels(geom::Size{solid_color_pixels_length, 1});
-        needs_solid_color_redraw = true;
-    }
-
-    if (needs_solid_color_redraw)
-    {
-        render_row(
-            solid_color_pixels.get(), geom::Size{solid_color_pixels_length, 1},
-            geom::Point{}, geom::Width{solid_color_pixels_length},
-            current_theme->background_color);
-    }
+    auto const pixel = current_theme->background_color;
+    auto const channel = [pixel](int shift) { return ((pixel >> shift) & 0xFF) / 255.0f; };
 
-    needs_solid_color_redraw = false;
+    // Like the pixels we draw, the theme colours are premultiplied ARGB
+    return std::make_shared<mg::SolidColorBuffer>(
+        size,
+        glm::vec4{channel(16), channel(8), channel(0), channel(24)});
 }
 
 auto msd::Renderer::make_buffer(
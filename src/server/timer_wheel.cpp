@@ -0,0 +1,210 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/time/timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace mt = mir::time;
+
+// Level n has slots a tick << (slot_bits * n) wide, and holds the timers due
+// in the next slots << (slot_bits * (n + 1)) ticks (but not in the next level
+// down's range). When current reaches the start of a level's slot, its timers
+// are moved down ("cascaded"). So a level's slot for the current time is always
+// empty, unless it holds timers a whole lap of the level ahead.
+namespace
+{
+auto const no_tick = std::numeric_limits<std::uint64_t>::max();
+
+auto rotate_right(std::uint64_t bits, unsigned int n) -> std::uint64_t
+{
+    n &= 63;
+    return n ? (bits >> n) | (bits << (64 - n)) : bits;
+}
+
+auto lowest_set_bit(std::uint64_t bits) -> unsigned int
+{
+    return __builtin_ctzll(bits);
+}
+}
+
+mt::TimerWheel::TimerWheel(Timestamp origin) :
+    origin{origin}
+{
+    static_assert(slots == 64, "occupied needs a bit for each slot");
+}
+
+void mt::TimerWheel::add(Timer& timer, Timestamp deadline)
+{
+    if (timer.scheduled())
+        unlink(timer);
+
+    timer.deadline_ = deadline;
+    timer.tick = tick_of(deadline);
+    link(timer);
+}
+
+void mt::TimerWheel::remove(Timer& timer)
+{
+    if (timer.scheduled())
+        unlink(timer);
+}
+
+void mt::TimerWheel::expire(Timestamp now, std::vector<Timer*>& due)
+{
+    auto const now_tick = tick_of(now);
+
+    for (;;)
+    {
+        // Before now_tick everything in the slot is due; at it, maybe not yet
+        for (auto timer = wheel[0][current & (slots - 1)]; timer;)
+        {
+            auto const next = timer->next;
+            if (timer->deadline_ <= now)
+            {
+                unlink(*timer);
+                due.push_back(timer);
+            }
+            timer = next;
+        }
+
+        if (current >= now_tick)
+            break;
+
+        // Skip to the next tick that has timers, or needs timers moving down
+        auto next = now_tick;
+        for (auto level = 0u; level != levels; ++level)
+            next = std::min(next, next_tick_in(level));
+
+        current = std::max(next, current + 1);
+        cascade();
+    }
+}
+
+auto mt::TimerWheel::next_wakeup() const -> Timestamp
+{
+    auto earliest = Timestamp::max();
+
+    if (auto const tick = next_tick_in(0); tick != no_tick)
+    {
+        for (auto timer = wheel[0][tick & (slots - 1)]; timer; timer = timer->next)
+            earliest = std::min(earliest, timer->deadline_);
+    }
+
+    for (auto level = 1u; level != levels; ++level)
+    {
+        if (auto const tick = next_tick_in(level); tick != no_tick)
+            earliest = std::min(earliest, origin + std::chrono::milliseconds{tick});
+    }
+
+    return earliest;
+}
+
+auto mt::TimerWheel::empty() const -> bool
+{
+    return std::all_of(begin(occupied), end(occupied), [](auto bits) { return bits == 0; });
+}
+
+auto mt::TimerWheel::tick_of(Timestamp time) const -> std::uint64_t
+{
+    if (time <= origin)
+        return 0;
+
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time - origin).count();
+}
+
+void mt::TimerWheel::link(Timer& timer)
+{
+    // A timer that is already due goes in the current slot
+    auto const tick = std::max(timer.tick, current);
+    auto const delta = tick - current;
+
+    auto level = 0u;
+    while (level + 1 != levels && delta >= (std::uint64_t{1} << (slot_bits * (level + 1))))
+        ++level;
+
+    // One beyond the wheel's reach waits in its furthest slot, and is placed again from there
+    auto const reach = std::uint64_t{1} << (slot_bits * levels);
+    auto const slot_tick = delta < reach ? tick : current + reach - 1;
+
+    timer.level = level;
+    timer.slot = (slot_tick >> (slot_bits * level)) & (slots - 1);
+
+    auto& head = wheel[timer.level][timer.slot];
+    timer.prev = nullptr;
+    timer.next = head;
+    if (head)
+        head->prev = &timer;
+    head = &timer;
+
+    occupied[timer.level] |= std::uint64_t{1} << timer.slot;
+}
+
+void mt::TimerWheel::unlink(Timer& timer)
+{
+    auto& head = wheel[timer.level][timer.slot];
+
+    if (timer.prev)
+        timer.prev->next = timer.next;
+    else
+        head = timer.next;
+
+    if (timer.next)
+        timer.next->prev = timer.prev;
+
+    if (!head)
+        occupied[timer.level] &= ~(std::uint64_t{1} << timer.slot);
+
+    timer.prev = timer.next = nullptr;
+    timer.level = Timer::unscheduled;
+}
+
+void mt::TimerWheel::cascade()
+{
+    for (auto level = 1u; level != levels; ++level)
+    {
+        auto const shift = slot_bits * level;
+        if (current & ((std::uint64_t{1} << shift) - 1))
+            break;
+
+        auto timer = wheel[level][(current >> shift) & (slots - 1)];
+        while (timer)
+        {
+            auto const next = timer->next;
+            unlink(*timer);
+            link(*timer);
+            timer = next;
+        }
+    }
+}
+
+auto mt::TimerWheel::next_tick_in(unsigned int level) const -> std::uint64_t
+{
+    auto const bits = occupied[level];
+    if (!bits)
+        return no_tick;
+
+    auto const shift = slot_bits * level;
+    auto const rotated = rotate_right(bits, (current >> shift) & (slots - 1));
+
+    if (level == 0)
+        return current + lowest_set_bit(rotated);
+
+    // This level's slot for the current time only holds timers a lap ahead
+    auto const ahead = (rotated & ~std::uint64_t{1}) ? lowest_set_bit(rotated & ~std::uint64_t{1}) : slots;
+    return ((current >> shift) + ahead) << shift;
+}
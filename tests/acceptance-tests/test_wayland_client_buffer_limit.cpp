@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/test/wayland_test_client.h"
+
+#include "mir/shell/shell_wrapper.h"
+#include "mir/scene/surface.h"
+
+#include "mir_test_framework/headless_test.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <mutex>
+
+namespace msh = mir::shell;
+namespace ms = mir::scene;
+namespace mt = mir::test;
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+/// Records the last surface clients created
+struct SurfaceRecorder : msh::ShellWrapper
+{
+    using msh::ShellWrapper::ShellWrapper;
+
+    auto create_surface(
+        std::shared_ptr<ms::Session> const& session,
+        ms::SurfaceCreationParameters const& params,
+        std::shared_ptr<ms::SurfaceObserver> const& observer) -> std::shared_ptr<ms::Surface> override
+    {
+        auto const result = ShellWrapper::create_surface(session, params, observer);
+        std::lock_guard<std::mutex> lock{mutex};
+        surface = result;
+        return result;
+    }
+
+    auto last_surface() const -> std::shared_ptr<ms::Surface>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return surface.lock();
+    }
+
+    std::mutex mutable mutex;
+    std::weak_ptr<ms::Surface> surface;
+};
+
+struct WaylandClientBufferLimit : mtf::HeadlessTest
+{
+    void SetUp() override
+    {
+        add_to_environment("MIR_SERVER_MAX_CLIENT_BUFFERS", "1");
+        server.wrap_shell([this](std::shared_ptr<msh::Shell> const& wrapped)
+            {
+                auto const result = std::make_shared<SurfaceRecorder>(wrapped);
+                recorder = result;
+                return result;
+            });
+
+        start_server();
+        client = std::make_unique<mt::WaylandTestClient>(server.open_wayland_client_socket());
+        window = std::make_unique<mt::WaylandTestClient::Window>(*client, geom::Size{100, 100});
+        client->roundtrip();
+    }
+
+    void TearDown() override
+    {
+        window.reset();
+        client.reset();
+        stop_server();
+    }
+
+    /// Commits \p buffer to the window and waits for the compositor to have consumed it, or dropped it
+    void commit_and_wait_for_frame(wl_buffer* buffer)
+    {
+        bool done{false};
+        static wl_callback_listener const listener{
+            [](void* data, wl_callback* callback, uint32_t)
+            {
+                *static_cast<bool*>(data) = true;
+                wl_callback_destroy(callback);
+            }};
+
+        wl_callback_add_listener(wl_surface_frame(window->surface), &listener, &done);
+        wl_surface_attach(window->surface, buffer, 0, 0);
+        wl_surface_commit(window->surface);
+
+        while (!done && wl_display_get_error(client->display) == 0)
+            client->roundtrip();
+    }
+
+    /// Commits \p buffer (of \p size) until it is shown. Commits are dropped while the
+    /// client is over its limit, but the compositor consumes the buffers it has queued.
+    auto commit_until_shown(wl_buffer* buffer, geom::Size size) -> bool
+    {
+        auto const surface = recorder->last_surface();
+        auto const deadline = std::chrono::steady_clock::now() + 10s;
+        while (surface && std::chrono::steady_clock::now() < deadline)
+        {
+            commit_and_wait_for_frame(buffer);
+            if (surface->window_size() == size)
+                return true;
+        }
+        return false;
+    }
+
+    std::shared_ptr<SurfaceRecorder> recorder;
+    std::unique_ptr<mt::WaylandTestClient> client;
+    std::unique_ptr<mt::WaylandTestClient::Window> window;
+};
+}
+
+TEST_F(WaylandClientBufferLimit, buffer_on_screen_does_not_count_against_the_limit)
+{
+    mt::WaylandTestClient::Buffer const bigger{client->shm, geom::Size{200, 200}};
+
+    EXPECT_TRUE(commit_until_shown(bigger.buffer, geom::Size{200, 200}));
+}
+
+TEST_F(WaylandClientBufferLimit, client_with_several_surfaces_on_screen_can_keep_drawing)
+{
+    mt::WaylandTestClient::Subsurface const first{*client, window->surface, geom::Size{10, 10}};
+    mt::WaylandTestClient::Subsurface const second{*client, window->surface, geom::Size{10, 10}};
+    mt::WaylandTestClient::Buffer const bigger{client->shm, geom::Size{200, 200}};
+
+    EXPECT_TRUE(commit_until_shown(bigger.buffer, geom::Size{200, 200}));
+}
@@ -0,0 +1,324 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/test/wayland_test_client.h"
+#include "linux_explicit_synchronization_unstable_v1.h"
+#include "single_pixel_buffer_v1.h"
+
+#include "mir_test_framework/headless_test.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/types.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+
+namespace mt = mir::test;
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace
+{
+// The kernel's sw_sync debugfs interface (not part of its uapi headers)
+struct sw_sync_create_fence_data
+{
+    __u32 value;
+    char name[32];
+    __s32 fence;
+};
+#define SW_SYNC_IOC_CREATE_FENCE _IOWR('W', 0, struct sw_sync_create_fence_data)
+
+/// A timeline to create sync_file fences on, if the kernel exposes sw_sync to us
+class SwSyncTimeline
+{
+public:
+    SwSyncTimeline() :
+        timeline{open("/sys/kernel/debug/sync/sw_sync", O_RDWR | O_CLOEXEC)}
+    {
+    }
+
+    auto available() const -> bool { return timeline != mir::Fd::invalid; }
+
+    /// A fence that isn't signalled until the timeline is (and so isn't, in these tests)
+    auto fence() -> mir::Fd
+    {
+        sw_sync_create_fence_data data{};
+        data.value = ++next_value;
+        strncpy(data.name, "mir-test", sizeof(data.name) - 1);
+        if (ioctl(timeline, SW_SYNC_IOC_CREATE_FENCE, &data) < 0)
+            return mir::Fd{};
+        return mir::Fd{data.fence};
+    }
+
+private:
+    mir::Fd const timeline;
+    __u32 next_value{0};
+};
+
+/// The client's side of a zwp_linux_buffer_release_v1
+struct BufferRelease
+{
+    enum class State { pending, fenced, immediate };
+
+    explicit BufferRelease(zwp_linux_buffer_release_v1* release)
+    {
+        zwp_linux_buffer_release_v1_add_listener(release, &listener, this);
+    }
+
+    State state{State::pending};
+    mir::Fd fence;
+
+    static zwp_linux_buffer_release_v1_listener const listener;
+};
+
+zwp_linux_buffer_release_v1_listener const BufferRelease::listener{
+    [](void* data, zwp_linux_buffer_release_v1* release, int32_t fence)
+    {
+        auto const self = static_cast<BufferRelease*>(data);
+        self->state = BufferRelease::State::fenced;
+        self->fence = mir::Fd{fence};
+        zwp_linux_buffer_release_v1_destroy(release);
+    },
+    [](void* data, zwp_linux_buffer_release_v1* release)
+    {
+        static_cast<BufferRelease*>(data)->state = BufferRelease::State::immediate;
+        zwp_linux_buffer_release_v1_destroy(release);
+    }};
+
+geom::Size const buffer_size{20, 20};
+
+struct WaylandExplicitSync : mtf::HeadlessTest
+{
+    void SetUp() override
+    {
+        server.set_enabled_wayland_extensions({
+            "wl_shell",
+            "wp_single_pixel_buffer_manager_v1",
+            "zwp_linux_explicit_synchronization_v1"});
+
+        start_server();
+        client = std::make_unique<mt::WaylandTestClient>(server.open_wayland_client_socket());
+        explicit_sync = static_cast<zwp_linux_explicit_synchronization_v1*>(
+            client->bind(zwp_linux_explicit_synchronization_v1_interface, 1));
+        ASSERT_THAT(explicit_sync, NotNull());
+
+        window = std::make_unique<mt::WaylandTestClient::Window>(*client, buffer_size);
+        surface_sync = zwp_linux_explicit_synchronization_v1_get_synchronization(explicit_sync, window->surface);
+        client->roundtrip();
+    }
+
+    void TearDown() override
+    {
+        zwp_linux_surface_synchronization_v1_destroy(surface_sync);
+        window.reset();
+        zwp_linux_explicit_synchronization_v1_destroy(explicit_sync);
+        client.reset();
+        stop_server();
+    }
+
+    auto get_release() -> std::unique_ptr<BufferRelease>
+    {
+        return std::make_unique<BufferRelease>(zwp_linux_surface_synchronization_v1_get_release(surface_sync));
+    }
+
+    /// Releases are sent once the compositor has finished with the buffer, so can take a few roundtrips
+    void wait_for_release_of(BufferRelease const& release)
+    {
+        auto const deadline = std::chrono::steady_clock::now() + 5s;
+        while (release.state == BufferRelease::State::pending &&
+               client->protocol_error() < 0 &&
+               std::chrono::steady_clock::now() < deadline)
+        {
+            client->roundtrip();
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    void expect_surface_sync_error(int error)
+    {
+        EXPECT_THAT(client->protocol_error(), Eq(error));
+        EXPECT_THAT(client->protocol_error_interface(), Eq(zwp_linux_surface_synchronization_v1_interface.name));
+    }
+
+    std::unique_ptr<mt::WaylandTestClient> client;
+    zwp_linux_explicit_synchronization_v1* explicit_sync{nullptr};
+    std::unique_ptr<mt::WaylandTestClient::Window> window;
+    zwp_linux_surface_synchronization_v1* surface_sync{nullptr};
+    SwSyncTimeline timeline;
+};
+}
+
+TEST_F(WaylandExplicitSync, second_synchronization_for_surface_is_protocol_error)
+{
+    auto const second = zwp_linux_explicit_synchronization_v1_get_synchronization(explicit_sync, window->surface);
+    client->roundtrip();
+
+    EXPECT_THAT(client->protocol_error(), Eq(ZWP_LINUX_EXPLICIT_SYNCHRONIZATION_V1_ERROR_SYNCHRONIZATION_EXISTS));
+    EXPECT_THAT(client->protocol_error_interface(), Eq(zwp_linux_explicit_synchronization_v1_interface.name));
+
+    zwp_linux_surface_synchronization_v1_destroy(second);
+}
+
+TEST_F(WaylandExplicitSync, fence_that_is_not_a_sync_file_is_protocol_error)
+{
+    mir::Fd const not_a_fence{eventfd(0, EFD_CLOEXEC)};
+
+    zwp_linux_surface_synchronization_v1_set_acquire_fence(surface_sync, not_a_fence);
+    client->roundtrip();
+
+    expect_surface_sync_error(ZWP_LINUX_SURFACE_SYNCHRONIZATION_V1_ERROR_INVALID_FENCE);
+}
+
+TEST_F(WaylandExplicitSync, second_fence_for_commit_is_protocol_error)
+{
+    if (!timeline.available())
+        GTEST_SKIP() << "Needs sw_sync to create fences";
+
+    zwp_linux_surface_synchronization_v1_set_acquire_fence(surface_sync, timeline.fence());
+    zwp_linux_surface_synchronization_v1_set_acquire_fence(surface_sync, timeline.fence());
+    client->roundtrip();
+
+    expect_surface_sync_error(ZWP_LINUX_SURFACE_SYNCHRONIZATION_V1_ERROR_DUPLICATE_FENCE);
+}
+
+TEST_F(WaylandExplicitSync, second_release_for_commit_is_protocol_error)
+{
+    auto const first = get_release();
+    auto const second = get_release();
+    client->roundtrip();
+
+    expect_surface_sync_error(ZWP_LINUX_SURFACE_SYNCHRONIZATION_V1_ERROR_DUPLICATE_RELEASE);
+}
+
+TEST_F(WaylandExplicitSync, release_without_attach_is_protocol_error)
+{
+    auto const release = get_release();
+    wl_surface_commit(window->surface);
+    client->roundtrip();
+
+    expect_surface_sync_error(ZWP_LINUX_SURFACE_SYNCHRONIZATION_V1_ERROR_NO_BUFFER);
+}
+
+TEST_F(WaylandExplicitSync, fence_for_null_buffer_is_protocol_error)
+{
+    if (!timeline.available())
+        GTEST_SKIP() << "Needs sw_sync to create fences";
+
+    wl_surface_attach(window->surface, nullptr, 0, 0);
+    zwp_linux_surface_synchronization_v1_set_acquire_fence(surface_sync, timeline.fence());
+    wl_surface_commit(window->surface);
+    client->roundtrip();
+
+    expect_surface_sync_error(ZWP_LINUX_SURFACE_SYNCHRONIZATION_V1_ERROR_NO_BUFFER);
+}
+
+TEST_F(WaylandExplicitSync, fence_for_shm_buffer_is_protocol_error)
+{
+    if (!timeline.available())
+        GTEST_SKIP() << "Needs sw_sync to create fences";
+
+    mt::WaylandTestClient::Buffer shm_buffer{client->shm, buffer_size};
+    wl_surface_attach(window->surface, shm_buffer.buffer, 0, 0);
+    zwp_linux_surface_synchronization_v1_set_acquire_fence(surface_sync, timeline.fence());
+    wl_surface_commit(window->surface);
+    client->roundtrip();
+
+    expect_surface_sync_error(ZWP_LINUX_SURFACE_SYNCHRONIZATION_V1_ERROR_UNSUPPORTED_BUFFER);
+}
+
+TEST_F(WaylandExplicitSync, fence_for_single_pixel_buffer_is_protocol_error)
+{
+    if (!timeline.available())
+        GTEST_SKIP() << "Needs sw_sync to create fences";
+
+    auto const manager = static_cast<wp_single_pixel_buffer_manager_v1*>(
+        client->bind(wp_single_pixel_buffer_manager_v1_interface, 1));
+    ASSERT_THAT(manager, NotNull());
+    auto const pixel = wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(manager, 0, 0, 0, UINT32_MAX);
+
+    wl_surface_attach(window->surface, pixel, 0, 0);
+    zwp_linux_surface_synchronization_v1_set_acquire_fence(surface_sync, timeline.fence());
+    wl_surface_commit(window->surface);
+    client->roundtrip();
+
+    expect_surface_sync_error(ZWP_LINUX_SURFACE_SYNCHRONIZATION_V1_ERROR_UNSUPPORTED_BUFFER);
+
+    wl_buffer_destroy(pixel);
+    wp_single_pixel_buffer_manager_v1_destroy(manager);
+}
+
+TEST_F(WaylandExplicitSync, shm_buffer_gets_immediate_release)
+{
+    mt::WaylandTestClient::Buffer shm_buffer{client->shm, buffer_size};
+    wl_surface_attach(window->surface, shm_buffer.buffer, 0, 0);
+    auto const release = get_release();
+    wl_surface_commit(window->surface);
+
+    // Nothing else holds the buffer once it is replaced
+    mt::WaylandTestClient::Buffer next_buffer{client->shm, buffer_size};
+    wl_surface_attach(window->surface, next_buffer.buffer, 0, 0);
+    wl_surface_commit(window->surface);
+    wait_for_release_of(*release);
+
+    EXPECT_THAT(client->protocol_error(), Eq(-1));
+    EXPECT_THAT(release->state, Eq(BufferRelease::State::immediate));
+}
+
+TEST_F(WaylandExplicitSync, buffer_replaced_before_commit_gets_immediate_release)
+{
+    mt::WaylandTestClient::Buffer shm_buffer{client->shm, buffer_size};
+    auto const subsurface = std::make_unique<mt::WaylandTestClient::Subsurface>(
+        *client, window->surface, buffer_size);
+    auto const subsurface_sync =
+        zwp_linux_explicit_synchronization_v1_get_synchronization(explicit_sync, subsurface->surface);
+
+    // A synchronized subsurface caches its state until the parent commits
+    wl_surface_attach(subsurface->surface, shm_buffer.buffer, 0, 0);
+    auto const release = std::make_unique<BufferRelease>(
+        zwp_linux_surface_synchronization_v1_get_release(subsurface_sync));
+    wl_surface_commit(subsurface->surface);
+
+    mt::WaylandTestClient::Buffer next_buffer{client->shm, buffer_size};
+    wl_surface_attach(subsurface->surface, next_buffer.buffer, 0, 0);
+    wl_surface_commit(subsurface->surface);
+    wait_for_release_of(*release);
+
+    EXPECT_THAT(client->protocol_error(), Eq(-1));
+    EXPECT_THAT(release->state, Eq(BufferRelease::State::immediate));
+
+    zwp_linux_surface_synchronization_v1_destroy(subsurface_sync);
+}
+
+TEST_F(WaylandExplicitSync, null_attach_gets_immediate_release)
+{
+    wl_surface_attach(window->surface, nullptr, 0, 0);
+    auto const release = get_release();
+    wl_surface_commit(window->surface);
+    wait_for_release_of(*release);
+
+    EXPECT_THAT(client->protocol_error(), Eq(-1));
+    EXPECT_THAT(release->state, Eq(BufferRelease::State::immediate));
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/test/wayland_test_client.h"
+
+#include "mir/shell/shell_wrapper.h"
+#include "mir/shell/surface_specification.h"
+
+#include "mir_test_framework/headless_test.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <mutex>
+
+namespace msh = mir::shell;
+namespace ms = mir::scene;
+namespace mt = mir::test;
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+/// Records the last input shape clients set on their surfaces
+struct InputShapeRecorder : msh::ShellWrapper
+{
+    using msh::ShellWrapper::ShellWrapper;
+
+    void modify_surface(
+        std::shared_ptr<ms::Session> const& session,
+        std::shared_ptr<ms::Surface> const& surface,
+        msh::SurfaceSpecification const& modifications) override
+    {
+        if (modifications.input_shape.is_set())
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            input_shape = modifications.input_shape.value();
+        }
+        ShellWrapper::modify_surface(session, surface, modifications);
+    }
+
+    auto last_input_shape() const -> std::vector<geom::Rectangle>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return input_shape;
+    }
+
+    std::mutex mutable mutex;
+    std::vector<geom::Rectangle> input_shape;
+};
+
+struct WaylandRegion : mtf::HeadlessTest
+{
+    void SetUp() override
+    {
+        server.wrap_shell([this](std::shared_ptr<msh::Shell> const& wrapped)
+            {
+                auto const result = std::make_shared<InputShapeRecorder>(wrapped);
+                recorder = result;
+                return result;
+            });
+
+        start_server();
+        client = std::make_unique<mt::WaylandTestClient>(server.open_wayland_client_socket());
+        window = std::make_unique<mt::WaylandTestClient::Window>(*client, geom::Size{100, 100});
+        region = wl_compositor_create_region(client->compositor);
+        client->roundtrip();
+    }
+
+    void TearDown() override
+    {
+        wl_region_destroy(region);
+        window.reset();
+        client.reset();
+        stop_server();
+    }
+
+    void commit_as_input_region()
+    {
+        wl_surface_set_input_region(window->surface, region);
+        wl_surface_commit(window->surface);
+        client->roundtrip();
+    }
+
+    std::shared_ptr<InputShapeRecorder> recorder;
+    std::unique_ptr<mt::WaylandTestClient> client;
+    std::unique_ptr<mt::WaylandTestClient::Window> window;
+    wl_region* region;
+};
+}
+
+TEST_F(WaylandRegion, subtracting_from_middle_of_region_leaves_the_surrounding_area)
+{
+    wl_region_add(region, 0, 0, 30, 30);
+    wl_region_subtract(region, 10, 10, 10, 10);
+    commit_as_input_region();
+
+    EXPECT_THAT(recorder->last_input_shape(), UnorderedElementsAre(
+        geom::Rectangle{{0, 0}, {30, 10}},
+        geom::Rectangle{{0, 20}, {30, 10}},
+        geom::Rectangle{{0, 10}, {10, 10}},
+        geom::Rectangle{{20, 10}, {10, 10}}));
+}
+
+TEST_F(WaylandRegion, subtracting_whole_region_leaves_nothing)
+{
+    wl_region_add(region, 0, 0, 30, 30);
+    wl_region_add(region, 50, 0, 30, 30);
+    commit_as_input_region();
+    ASSERT_THAT(recorder->last_input_shape(), SizeIs(2));
+
+    wl_region_subtract(region, 0, 0, 100, 100);
+    commit_as_input_region();
+
+    // An empty input region reaches the shell as a single empty rectangle
+    EXPECT_THAT(recorder->last_input_shape(), ElementsAre(geom::Rectangle{}));
+}
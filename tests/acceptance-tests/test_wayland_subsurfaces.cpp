@@ -0,0 +1,298 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/test/wayland_test_client.h"
+
+#include "mir/shell/shell_wrapper.h"
+#include "mir/shell/surface_specification.h"
+#include "mir/scene/surface_creation_parameters.h"
+
+#include "mir_test_framework/headless_test.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace msh = mir::shell;
+namespace ms = mir::scene;
+namespace mt = mir::test;
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+/// Records the streams, and how often the streams and input shape are modified, of the surfaces clients create
+struct SurfaceDataRecorder : msh::ShellWrapper
+{
+    using msh::ShellWrapper::ShellWrapper;
+
+    auto create_surface(
+        std::shared_ptr<ms::Session> const& session,
+        ms::SurfaceCreationParameters const& params,
+        std::shared_ptr<ms::SurfaceObserver> const& observer) -> std::shared_ptr<ms::Surface> override
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (params.streams.is_set())
+                streams = params.streams.value();
+        }
+        return ShellWrapper::create_surface(session, params, observer);
+    }
+
+    void modify_surface(
+        std::shared_ptr<ms::Session> const& session,
+        std::shared_ptr<ms::Surface> const& surface,
+        msh::SurfaceSpecification const& modifications) override
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (modifications.streams.is_set())
+            {
+                streams = modifications.streams.value();
+                ++streams_modifications;
+            }
+            if (modifications.input_shape.is_set())
+                ++input_shape_modifications;
+        }
+        ShellWrapper::modify_surface(session, surface, modifications);
+    }
+
+    /// The streams, from bottom to top, identified by their position in the window
+    auto stacking() const -> std::vector<geom::Displacement>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        std::vector<geom::Displacement> result;
+        for (auto const& stream : streams)
+            result.push_back(stream.displacement);
+        return result;
+    }
+
+    std::mutex mutable mutex;
+    std::vector<msh::StreamSpecification> streams;
+    std::atomic<int> streams_modifications{0};
+    std::atomic<int> input_shape_modifications{0};
+};
+
+geom::Size const window_size{100, 100};
+geom::Displacement const window_origin{0, 0};
+
+struct WaylandSubsurfaces : mtf::HeadlessTest
+{
+    void SetUp() override
+    {
+        server.wrap_shell([this](std::shared_ptr<msh::Shell> const& wrapped)
+            {
+                auto const result = std::make_shared<SurfaceDataRecorder>(wrapped);
+                recorder = result;
+                return result;
+            });
+
+        start_server();
+        client = std::make_unique<mt::WaylandTestClient>(server.open_wayland_client_socket());
+        window = std::make_unique<mt::WaylandTestClient::Window>(*client, window_size);
+        client->roundtrip();
+    }
+
+    void TearDown() override
+    {
+        window.reset();
+        client.reset();
+        stop_server();
+    }
+
+    /// Creates a subsurface of \p parent at \p position, mapped by the next commit of the window
+    auto create_subsurface(wl_surface* parent, geom::Displacement position)
+        -> std::unique_ptr<mt::WaylandTestClient::Subsurface>
+    {
+        auto result = std::make_unique<mt::WaylandTestClient::Subsurface>(*client, parent, geom::Size{10, 10});
+        wl_subsurface_set_position(result->subsurface, position.dx.as_int(), position.dy.as_int());
+        wl_surface_commit(result->surface);
+        return result;
+    }
+
+    void commit_window()
+    {
+        wl_surface_commit(window->surface);
+        client->roundtrip();
+    }
+
+    std::shared_ptr<SurfaceDataRecorder> recorder;
+    std::unique_ptr<mt::WaylandTestClient> client;
+    std::unique_ptr<mt::WaylandTestClient::Window> window;
+};
+
+geom::Displacement const first_position{10, 10};
+geom::Displacement const second_position{20, 20};
+}
+
+TEST_F(WaylandSubsurfaces, subsurfaces_are_stacked_above_parent_in_creation_order)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    auto const second = create_subsurface(window->surface, second_position);
+    commit_window();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, first_position, second_position));
+}
+
+TEST_F(WaylandSubsurfaces, subsurface_can_be_placed_above_sibling)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    auto const second = create_subsurface(window->surface, second_position);
+    commit_window();
+
+    wl_subsurface_place_above(first->subsurface, second->surface);
+    commit_window();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, second_position, first_position));
+}
+
+TEST_F(WaylandSubsurfaces, subsurface_can_be_placed_below_sibling)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    auto const second = create_subsurface(window->surface, second_position);
+    commit_window();
+
+    wl_subsurface_place_below(second->subsurface, first->surface);
+    commit_window();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, second_position, first_position));
+}
+
+TEST_F(WaylandSubsurfaces, subsurface_can_be_placed_below_parent)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    auto const second = create_subsurface(window->surface, second_position);
+    commit_window();
+
+    wl_subsurface_place_below(second->subsurface, window->surface);
+    commit_window();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(second_position, window_origin, first_position));
+}
+
+TEST_F(WaylandSubsurfaces, subsurface_placed_below_parent_can_be_placed_above_it_again)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    commit_window();
+
+    wl_subsurface_place_below(first->subsurface, window->surface);
+    commit_window();
+    wl_subsurface_place_above(first->subsurface, window->surface);
+    commit_window();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, first_position));
+}
+
+TEST_F(WaylandSubsurfaces, restacking_takes_effect_on_parent_commit)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    auto const second = create_subsurface(window->surface, second_position);
+    commit_window();
+
+    wl_subsurface_place_above(first->subsurface, second->surface);
+    client->roundtrip();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, first_position, second_position));
+
+    commit_window();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, second_position, first_position));
+}
+
+TEST_F(WaylandSubsurfaces, restacking_children_of_synchronized_subsurface_is_cached_with_its_state)
+{
+    geom::Displacement const child_offset{5, 5};
+    auto const first = create_subsurface(window->surface, first_position);
+    auto const child = create_subsurface(first->surface, child_offset);
+    commit_window();
+
+    wl_subsurface_place_below(child->subsurface, first->surface);
+    wl_surface_commit(first->surface);
+    client->roundtrip();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, first_position, first_position + child_offset));
+
+    commit_window();
+
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, first_position + child_offset, first_position));
+}
+
+TEST_F(WaylandSubsurfaces, placing_relative_to_non_sibling_is_protocol_error)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    auto const unrelated = wl_compositor_create_surface(client->compositor);
+
+    wl_subsurface_place_above(first->subsurface, unrelated);
+    client->roundtrip();
+
+    EXPECT_THAT(client->protocol_error(), Eq(WL_SUBSURFACE_ERROR_BAD_SURFACE));
+    EXPECT_THAT(client->protocol_error_interface(), Eq(wl_subsurface_interface.name));
+
+    wl_surface_destroy(unrelated);
+}
+
+TEST_F(WaylandSubsurfaces, placing_relative_to_self_is_protocol_error)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+
+    wl_subsurface_place_below(first->subsurface, first->surface);
+    client->roundtrip();
+
+    EXPECT_THAT(client->protocol_error(), Eq(WL_SUBSURFACE_ERROR_BAD_SURFACE));
+}
+
+TEST_F(WaylandSubsurfaces, unchanged_surface_data_is_not_sent_to_shell)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    wl_subsurface_set_desync(first->subsurface);
+    commit_window();
+
+    int const streams_modifications = recorder->streams_modifications;
+    int const input_shape_modifications = recorder->input_shape_modifications;
+
+    mt::WaylandTestClient::Buffer same_size{client->shm, geom::Size{10, 10}};
+    wl_surface_attach(first->surface, same_size.buffer, 0, 0);
+    wl_surface_commit(first->surface);
+    client->roundtrip();
+
+    EXPECT_THAT(recorder->streams_modifications.load(), Eq(streams_modifications));
+    EXPECT_THAT(recorder->input_shape_modifications.load(), Eq(input_shape_modifications));
+}
+
+TEST_F(WaylandSubsurfaces, moving_subsurface_without_input_region_sends_only_streams_to_shell)
+{
+    auto const first = create_subsurface(window->surface, first_position);
+    auto const empty_region = wl_compositor_create_region(client->compositor);
+    wl_surface_set_input_region(first->surface, empty_region);
+    wl_region_destroy(empty_region);
+    wl_surface_commit(first->surface);
+    commit_window();
+
+    int const streams_modifications = recorder->streams_modifications;
+    int const input_shape_modifications = recorder->input_shape_modifications;
+
+    wl_subsurface_set_position(first->subsurface, second_position.dx.as_int(), second_position.dy.as_int());
+    wl_surface_commit(first->surface);
+    commit_window();
+
+    EXPECT_THAT(recorder->streams_modifications.load(), Eq(streams_modifications + 1));
+    EXPECT_THAT(recorder->input_shape_modifications.load(), Eq(input_shape_modifications));
+    EXPECT_THAT(recorder->stacking(), ElementsAre(window_origin, second_position));
+}
@@ -100,11 +100,33 @@ public:
         return std::experimental::optional<geometry::Rectangle>();
     }
 
+    void set_src_bounds(geometry::RectangleF const& bounds)
+    {
+        src = bounds;
+    }
+
+    std::experimental::optional<geometry::RectangleF> src_bounds() const override
+    {
+        return src;
+    }
+
+    void set_opaque_region(std::vector<geometry::Rectangle> const& region)
+    {
+        opaque = region;
+    }
+
+    std::vector<geometry::Rectangle> opaque_region() const override
+    {
+        return opaque;
+    }
+
 private:
     std::shared_ptr<graphics::Buffer> buf;
     mir::geometry::Rectangle rect;
     float opacity;
     bool rectangular;
+    std::experimental::optional<geometry::RectangleF> src;
+    std::vector<geometry::Rectangle> opaque;
 };
 
 } // namespace doubles
@@ -51,6 +51,8 @@ struct MockRenderable : public graphics::Renderable
     MOCK_CONST_METHOD0(buffer, std::shared_ptr<graphics::Buffer>());
     MOCK_CONST_METHOD0(screen_position, geometry::Rectangle());
     MOCK_CONST_METHOD0(clip_area, std::experimental::optional<geometry::Rectangle>());
+    MOCK_CONST_METHOD0(src_bounds, std::experimental::optional<geometry::RectangleF>());
+    MOCK_CONST_METHOD0(opaque_region, std::vector<geometry::Rectangle>());
     MOCK_CONST_METHOD0(alpha, float());
     MOCK_CONST_METHOD0(transformation, glm::mat4());
     MOCK_CONST_METHOD0(visible, bool());
@@ -94,6 +94,7 @@ struct StubBufferAllocator : public graphics::GraphicBufferAllocator
             resource,
             std::move(executor),
             std::make_shared<graphics::common::EGLContextExecutor>(std::make_unique<test::doubles::NullGLContext>()),
+            graphics::wayland::ShmRelease::when_destroyed,
             std::move(on_consumed));
     }
 };
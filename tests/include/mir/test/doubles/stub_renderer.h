@@ -21,6 +21,8 @@
 
 #include "mir/renderer/renderer.h"
 #include "mir/graphics/renderable.h"
+#include "mir/graphics/buffer.h"
+#include "mir/renderer/sw/pixel_source.h"
 #include <thread>
 
 namespace mir
@@ -39,8 +41,13 @@ public:
 
     void render(graphics::RenderableList const& renderables) const override
     {
+        // We need to consume a buffer to unblock client tests
         for (auto const& r : renderables)
-            r->buffer(); // We need to consume a buffer to unblock client tests
+        {
+            auto const buffer = r->buffer();
+            if (auto const pixels = dynamic_cast<renderer::software::PixelSource*>(buffer->native_buffer_base()))
+                pixels->read([](unsigned char const*) {});
+        }
         // Yield to reduce runtime under valgrind
         std::this_thread::yield();
     }
@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_TEST_FRAMEWORK_INPUT_LATENCY_H_
+#define MIR_TEST_FRAMEWORK_INPUT_LATENCY_H_
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace input
+{
+class EventFilter;
+class InputReport;
+}
+}
+
+namespace mir_test_framework
+{
+/**
+ * Collects timestamps of input events as they pass through the server.
+ *
+ * Events are identified by their event time, which the evdev platform takes
+ * from the kernel timestamp of the injected evdev frame. That timestamp is
+ * the injection time; each later stage is timestamped on the same clock when
+ * the event reaches it, giving a latency per stage.
+ */
+class InputLatencyRecorder
+{
+public:
+    enum class Stage
+    {
+        kernel,     ///< Read from libinput by the evdev platform
+        dispatch,   ///< Reached the input dispatcher (end of the event filter chain)
+        send,       ///< Sent to a client by the Wayland frontend
+        receipt,    ///< Received by a Wayland client
+    };
+
+    struct Distribution
+    {
+        std::size_t count;
+        std::chrono::nanoseconds min;
+        std::chrono::nanoseconds median;
+        std::chrono::nanoseconds p95;
+        std::chrono::nanoseconds p99;
+        std::chrono::nanoseconds max;
+    };
+
+    /// Record an event with the given event time reaching a stage (now)
+    void record(Stage stage, std::chrono::nanoseconds event_time);
+
+    /// Record an event reaching a client; Wayland only carries millisecond timestamps
+    void record_receipt(std::chrono::milliseconds event_time);
+
+    /// Latency from injection to the stage, for each event that reached it
+    auto latencies(Stage stage) const -> std::vector<std::chrono::nanoseconds>;
+
+    auto distribution(Stage stage) const -> Distribution;
+
+    /// An InputReport recording the kernel and send stages
+    auto input_report() -> std::shared_ptr<mir::input::InputReport>;
+
+    /// An EventFilter, to be appended to the composite event filter, recording the dispatch stage
+    auto event_filter() -> std::shared_ptr<mir::input::EventFilter>;
+
+private:
+    struct Sample
+    {
+        std::chrono::nanoseconds event_time;
+        std::chrono::nanoseconds at;
+    };
+
+    auto now() -> std::chrono::nanoseconds;
+
+    std::mutex mutable mutex;
+    /// The clock the injected event timestamps were taken from, chosen on first use
+    int clock_id{-1};
+    std::vector<Sample> samples[4];
+};
+
+auto to_string(InputLatencyRecorder::Stage stage) -> char const*;
+}
+
+#endif /* MIR_TEST_FRAMEWORK_INPUT_LATENCY_H_ */
@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/test/wayland_test_client.h"
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace mt = mir::test;
+namespace geom = mir::geometry;
+
+wl_registry_listener const mt::WaylandTestClient::registry_listener{
+    &WaylandTestClient::handle_global,
+    &WaylandTestClient::handle_global_remove};
+
+wl_buffer_listener const mt::WaylandTestClient::Buffer::listener{
+    [](void* data, wl_buffer*)
+    {
+        auto const self = static_cast<Buffer*>(data);
+        self->released = true;
+        if (self->on_release)
+            self->on_release();
+    }};
+
+wl_shell_surface_listener const mt::WaylandTestClient::Window::listener{
+    [](void*, wl_shell_surface* shell_surface, uint32_t serial) { wl_shell_surface_pong(shell_surface, serial); },
+    [](void*, wl_shell_surface*, uint32_t, int32_t, int32_t) {},
+    [](void*, wl_shell_surface*) {}};
+
+mt::WaylandTestClient::WaylandTestClient(mir::Fd const& socket) :
+    display{wl_display_connect_to_fd(dup(socket))},
+    registry{display ? wl_display_get_registry(display) : nullptr}
+{
+    if (!display)
+        throw std::runtime_error{"Failed to connect to Wayland server"};
+
+    wl_registry_add_listener(registry, &registry_listener, this);
+    roundtrip();
+
+    compositor = static_cast<wl_compositor*>(bind(wl_compositor_interface, 4));
+    subcompositor = static_cast<wl_subcompositor*>(bind(wl_subcompositor_interface, 1));
+    shm = static_cast<wl_shm*>(bind(wl_shm_interface, 1));
+    shell = static_cast<wl_shell*>(bind(wl_shell_interface, 1));
+
+    if (!compositor || !subcompositor || !shm || !shell)
+        throw std::runtime_error{"Wayland server is missing required globals"};
+}
+
+mt::WaylandTestClient::~WaylandTestClient()
+{
+    wl_shell_destroy(shell);
+    wl_shm_destroy(shm);
+    wl_subcompositor_destroy(subcompositor);
+    wl_compositor_destroy(compositor);
+    wl_registry_destroy(registry);
+    wl_display_disconnect(display);
+}
+
+void mt::WaylandTestClient::roundtrip()
+{
+    wl_display_roundtrip(display);
+}
+
+auto mt::WaylandTestClient::bind(wl_interface const& interface, uint32_t version) -> void*
+{
+    auto const global = globals.find(interface.name);
+    if (global == globals.end())
+        return nullptr;
+
+    return wl_registry_bind(registry, global->second, &interface, version);
+}
+
+auto mt::WaylandTestClient::protocol_error() const -> int
+{
+    if (wl_display_get_error(display) != EPROTO)
+        return -1;
+
+    wl_interface const* interface;
+    uint32_t id;
+    return wl_display_get_protocol_error(display, &interface, &id);
+}
+
+auto mt::WaylandTestClient::protocol_error_interface() const -> std::string
+{
+    wl_interface const* interface{nullptr};
+    uint32_t id;
+    wl_display_get_protocol_error(display, &interface, &id);
+    return interface ? interface->name : "";
+}
+
+void mt::WaylandTestClient::handle_global(
+    void* data,
+    wl_registry*,
+    uint32_t id,
+    char const* interface,
+    uint32_t)
+{
+    static_cast<WaylandTestClient*>(data)->globals[interface] = id;
+}
+
+mt::WaylandTestClient::Buffer::Buffer(wl_shm* shm, geom::Size size) :
+    buffer{[&]
+        {
+            auto const stride = size.width.as_int() * 4;
+            auto const bytes = stride * size.height.as_int();
+            mir::Fd const pool_fd{memfd_create("wayland-test-client", MFD_CLOEXEC)};
+            if (ftruncate(pool_fd, bytes) < 0)
+                throw std::system_error{errno, std::system_category(), "Failed to size shm pool"};
+
+            auto const pool = wl_shm_create_pool(shm, pool_fd, bytes);
+            auto const buffer = wl_shm_pool_create_buffer(
+                pool, 0, size.width.as_int(), size.height.as_int(), stride, WL_SHM_FORMAT_XRGB8888);
+            // The buffer keeps the pool's memory
+            wl_shm_pool_destroy(pool);
+            return buffer;
+        }()}
+{
+    wl_buffer_add_listener(buffer, &listener, this);
+}
+
+mt::WaylandTestClient::Buffer::~Buffer()
+{
+    wl_buffer_destroy(buffer);
+}
+
+mt::WaylandTestClient::Window::Window(WaylandTestClient& client, geom::Size size, State state) :
+    surface{wl_compositor_create_surface(client.compositor)},
+    shell_surface{wl_shell_get_shell_surface(client.shell, surface)},
+    buffer{client.shm, size}
+{
+    wl_shell_surface_add_listener(shell_surface, &listener, this);
+    if (state == State::fullscreen)
+        wl_shell_surface_set_fullscreen(shell_surface, WL_SHELL_SURFACE_FULLSCREEN_METHOD_DEFAULT, 0, nullptr);
+    else
+        wl_shell_surface_set_toplevel(shell_surface);
+    wl_surface_attach(surface, buffer.buffer, 0, 0);
+    wl_surface_commit(surface);
+}
+
+mt::WaylandTestClient::Window::~Window()
+{
+    wl_shell_surface_destroy(shell_surface);
+    wl_surface_destroy(surface);
+}
+
+mt::WaylandTestClient::Subsurface::Subsurface(WaylandTestClient& client, wl_surface* parent, geom::Size size) :
+    surface{wl_compositor_create_surface(client.compositor)},
+    subsurface{wl_subcompositor_get_subsurface(client.subcompositor, surface, parent)},
+    buffer{client.shm, size}
+{
+    wl_surface_attach(surface, buffer.buffer, 0, 0);
+    wl_surface_commit(surface);
+}
+
+mt::WaylandTestClient::Subsurface::~Subsurface()
+{
+    wl_subsurface_destroy(subsurface);
+    wl_surface_destroy(surface);
+}
@@ -178,6 +178,12 @@ void glUniform2f(GLint location, GLfloat x, GLfloat y)
     global_mock_gl->glUniform2f(location, x, y);
 }
 
+void glUniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glUniform4fv(location, count, value);
+}
+
 void glBindBuffer(GLenum buffer, GLuint name)
 {
     CHECK_GLOBAL_VOID_MOCK();
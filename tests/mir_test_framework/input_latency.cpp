@@ -0,0 +1,218 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir_test_framework/input_latency.h"
+
+#include "mir/input/event_filter.h"
+#include "mir/input/input_report.h"
+#include "mir_toolkit/events/event.h"
+#include "mir_toolkit/events/input/input_event.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <map>
+
+#include <time.h>
+
+namespace mi = mir::input;
+namespace mtf = mir_test_framework;
+
+using namespace std::chrono;
+
+namespace
+{
+auto read_clock(clockid_t clock_id) -> nanoseconds
+{
+    timespec ts;
+    clock_gettime(clock_id, &ts);
+    return seconds{ts.tv_sec} + nanoseconds{ts.tv_nsec};
+}
+
+class RecordingInputReport : public mi::InputReport
+{
+public:
+    RecordingInputReport(mtf::InputLatencyRecorder& recorder) :
+        recorder{recorder}
+    {
+    }
+
+    void received_event_from_kernel(int64_t when, int /*type*/, int /*code*/, int /*value*/) override
+    {
+        recorder.record(mtf::InputLatencyRecorder::Stage::kernel, nanoseconds{when});
+    }
+
+    void published_key_event(int /*dest_fd*/, uint32_t /*seq_id*/, int64_t event_time) override
+    {
+        recorder.record(mtf::InputLatencyRecorder::Stage::send, nanoseconds{event_time});
+    }
+
+    void published_motion_event(int /*dest_fd*/, uint32_t /*seq_id*/, int64_t event_time) override
+    {
+        recorder.record(mtf::InputLatencyRecorder::Stage::send, nanoseconds{event_time});
+    }
+
+    void opened_input_device(char const* /*device_name*/, char const* /*input_platform*/) override
+    {
+    }
+
+    void failed_to_open_input_device(char const* /*device_name*/, char const* /*input_platform*/) override
+    {
+    }
+
+private:
+    mtf::InputLatencyRecorder& recorder;
+};
+
+class RecordingEventFilter : public mi::EventFilter
+{
+public:
+    RecordingEventFilter(mtf::InputLatencyRecorder& recorder) :
+        recorder{recorder}
+    {
+    }
+
+    bool handle(MirEvent const& event) override
+    {
+        if (mir_event_get_type(&event) == mir_event_type_input)
+        {
+            auto const input_event = mir_event_get_input_event(&event);
+            recorder.record(
+                mtf::InputLatencyRecorder::Stage::dispatch,
+                nanoseconds{mir_input_event_get_event_time(input_event)});
+        }
+
+        return false;
+    }
+
+private:
+    mtf::InputLatencyRecorder& recorder;
+};
+
+auto percentile(std::vector<nanoseconds> const& sorted, unsigned percent) -> nanoseconds
+{
+    return sorted[((sorted.size() - 1) * percent) / 100];
+}
+}
+
+auto mtf::InputLatencyRecorder::now() -> nanoseconds
+{
+    return read_clock(clock_id);
+}
+
+void mtf::InputLatencyRecorder::record(Stage stage, nanoseconds event_time)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (clock_id < 0)
+    {
+        // The event timestamps come from whatever clock the injector used
+        // (normally CLOCK_MONOTONIC, but some replay tools use wall-clock
+        // time). Pick whichever is closest so stage timestamps are comparable.
+        auto const mono_delta = std::abs(read_clock(CLOCK_MONOTONIC).count() - event_time.count());
+        auto const real_delta = std::abs(read_clock(CLOCK_REALTIME).count() - event_time.count());
+        clock_id = mono_delta <= real_delta ? CLOCK_MONOTONIC : CLOCK_REALTIME;
+    }
+
+    samples[static_cast<int>(stage)].push_back({event_time, now()});
+}
+
+void mtf::InputLatencyRecorder::record_receipt(milliseconds event_time)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    // A client can't receive anything before the server has sent it, so the clock is chosen
+    if (clock_id >= 0)
+        samples[static_cast<int>(Stage::receipt)].push_back({event_time, now()});
+}
+
+auto mtf::InputLatencyRecorder::latencies(Stage stage) const -> std::vector<nanoseconds>
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    std::vector<nanoseconds> result;
+
+    if (stage != Stage::receipt)
+    {
+        for (auto const& sample : samples[static_cast<int>(stage)])
+            result.push_back(sample.at - sample.event_time);
+
+        return result;
+    }
+
+    // Wayland truncates event times to milliseconds: recover the precise
+    // injection time by matching against the events the server sent.
+    std::map<milliseconds::rep, std::deque<nanoseconds>> sent;
+    for (auto const& sample : samples[static_cast<int>(Stage::send)])
+        sent[duration_cast<milliseconds>(sample.event_time).count()].push_back(sample.event_time);
+
+    for (auto const& sample : samples[static_cast<int>(Stage::receipt)])
+    {
+        auto& candidates = sent[duration_cast<milliseconds>(sample.event_time).count()];
+        if (!candidates.empty())
+        {
+            result.push_back(sample.at - candidates.front());
+            candidates.pop_front();
+        }
+    }
+
+    return result;
+}
+
+auto mtf::InputLatencyRecorder::distribution(Stage stage) const -> Distribution
+{
+    auto sorted = latencies(stage);
+
+    if (sorted.empty())
+        return {0, {}, {}, {}, {}, {}};
+
+    std::sort(begin(sorted), end(sorted));
+
+    return {
+        sorted.size(),
+        sorted.front(),
+        percentile(sorted, 50),
+        percentile(sorted, 95),
+        percentile(sorted, 99),
+        sorted.back()};
+}
+
+auto mtf::InputLatencyRecorder::input_report() -> std::shared_ptr<mi::InputReport>
+{
+    return std::make_shared<RecordingInputReport>(*this);
+}
+
+auto mtf::InputLatencyRecorder::event_filter() -> std::shared_ptr<mi::EventFilter>
+{
+    return std::make_shared<RecordingEventFilter>(*this);
+}
+
+auto mtf::to_string(InputLatencyRecorder::Stage stage) -> char const*
+{
+    switch (stage)
+    {
+    case InputLatencyRecorder::Stage::kernel:
+        return "kernel";
+    case InputLatencyRecorder::Stage::dispatch:
+        return "dispatch";
+    case InputLatencyRecorder::Stage::send:
+        return "send";
+    case InputLatencyRecorder::Stage::receipt:
+        return "receipt";
+    }
+
+    return "unknown";
+}
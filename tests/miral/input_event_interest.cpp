@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <mir/events/event_builders.h>
+#include <mir_toolkit/events/input/input_event.h>
+
+#include <xkbcommon/xkbcommon-keysyms.h>
+
+using namespace miral;
+using namespace testing;
+namespace mt = mir::test;
+namespace mev = mir::events;
+
+namespace
+{
+Rectangle const display_area_a{{0, 0}, {640, 480}};
+Rectangle const display_area_b{{640, 0}, {640, 480}};
+
+struct InputFastPath : mt::TestWindowManagerTools
+{
+    void SetUp() override
+    {
+        notify_configuration_applied(create_fake_display_configuration({display_area_a, display_area_b}));
+        basic_window_manager.add_session(session);
+    }
+
+    auto pointer_motion_to(Point position) -> mir::EventUPtr
+    {
+        return mev::make_pointer_event(
+            0, std::chrono::nanoseconds{++timestamp}, {}, mir_input_event_modifier_none,
+            mir_pointer_action_motion, 0,
+            position.x.as_int(), position.y.as_int(), 0, 0, 0, 0);
+    }
+
+    auto key_down() -> mir::EventUPtr
+    {
+        return mev::make_key_event(
+            0, std::chrono::nanoseconds{++timestamp}, {}, mir_keyboard_action_down,
+            XKB_KEY_a, 30, mir_input_event_modifier_none);
+    }
+
+    static auto pointer_event(mir::EventUPtr const& event) -> MirPointerEvent const*
+    {
+        return mir_input_event_get_pointer_event(mir_event_get_input_event(event.get()));
+    }
+
+    static auto keyboard_event(mir::EventUPtr const& event) -> MirKeyboardEvent const*
+    {
+        return mir_input_event_get_keyboard_event(mir_event_get_input_event(event.get()));
+    }
+
+    int64_t timestamp{0};
+};
+}
+
+TEST_F(InputFastPath, pointer_event_the_policy_wants_is_handled_by_the_policy)
+{
+    auto const event = pointer_motion_to({10, 10});
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(_)).WillOnce(Return(true));
+
+    EXPECT_TRUE(basic_window_manager.handle_pointer_event(pointer_event(event)));
+}
+
+TEST_F(InputFastPath, pointer_event_the_policy_declines_bypasses_the_policy)
+{
+    auto const event = pointer_motion_to({10, 10});
+
+    ON_CALL(*window_manager_policy, wants_pointer_event(_)).WillByDefault(Return(false));
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(_)).Times(0);
+
+    EXPECT_FALSE(basic_window_manager.handle_pointer_event(pointer_event(event)));
+}
+
+TEST_F(InputFastPath, keyboard_event_the_policy_declines_bypasses_the_policy)
+{
+    auto const event = key_down();
+
+    ON_CALL(*window_manager_policy, wants_keyboard_event(_)).WillByDefault(Return(false));
+    EXPECT_CALL(*window_manager_policy, handle_keyboard_event(_)).Times(0);
+
+    EXPECT_FALSE(basic_window_manager.handle_keyboard_event(keyboard_event(event)));
+}
+
+TEST_F(InputFastPath, pointer_event_the_policy_declines_still_moves_the_cursor)
+{
+    ON_CALL(*window_manager_policy, wants_pointer_event(_)).WillByDefault(Return(false));
+
+    basic_window_manager.handle_pointer_event(pointer_event(pointer_motion_to({700, 10})));
+    EXPECT_THAT(basic_window_manager.active_output(), Eq(display_area_b));
+
+    basic_window_manager.handle_pointer_event(pointer_event(pointer_motion_to({10, 10})));
+    EXPECT_THAT(basic_window_manager.active_output(), Eq(display_area_a));
+}
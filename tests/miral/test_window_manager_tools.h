@@ -22,6 +22,7 @@
 #include "basic_window_manager.h"
 
 #include <miral/canonical_window_manager.h>
+#include <miral/input_event_interest.h>
 
 #include <mir/shell/surface_specification.h>
 #include <mir/scene/surface_creation_parameters.h>
@@ -41,13 +42,23 @@ namespace test
 {
 
 struct MockWindowManagerPolicy
-    : miral::CanonicalWindowManagerPolicy
+    : miral::CanonicalWindowManagerPolicy, miral::InputEventInterest
 {
-    using miral::CanonicalWindowManagerPolicy::CanonicalWindowManagerPolicy;
+    explicit MockWindowManagerPolicy(miral::WindowManagerTools const& tools) :
+        miral::CanonicalWindowManagerPolicy{tools}
+    {
+        ON_CALL(*this, wants_keyboard_event(testing::_)).WillByDefault(testing::Return(true));
+        ON_CALL(*this, wants_touch_event(testing::_)).WillByDefault(testing::Return(true));
+        ON_CALL(*this, wants_pointer_event(testing::_)).WillByDefault(testing::Return(true));
+    }
+
+    MOCK_METHOD1(handle_touch_event, bool(MirTouchEvent const* event));
+    MOCK_METHOD1(handle_pointer_event, bool(MirPointerEvent const* event));
+    MOCK_METHOD1(handle_keyboard_event, bool(MirKeyboardEvent const* event));
 
-    bool handle_touch_event(MirTouchEvent const* /*event*/) { return false; }
-    bool handle_pointer_event(MirPointerEvent const* /*event*/) { return false; }
-    bool handle_keyboard_event(MirKeyboardEvent const* /*event*/) { return false; }
+    MOCK_CONST_METHOD1(wants_keyboard_event, bool(MirKeyboardEvent const* event));
+    MOCK_CONST_METHOD1(wants_touch_event, bool(MirTouchEvent const* event));
+    MOCK_CONST_METHOD1(wants_pointer_event, bool(MirPointerEvent const* event));
 
     MOCK_METHOD1(advise_new_window, void (miral::WindowInfo const& window_info));
     MOCK_METHOD2(advise_move_to, void(miral::WindowInfo const& window_info, mir::geometry::Point top_left));
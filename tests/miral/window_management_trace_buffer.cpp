@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "window_management_trace_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sstream>
+#include <thread>
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+int64_t const records_per_ring = 8;
+
+MATCHER_P2(IsRecord, call, first_arg, "")
+{
+    return arg.call == call && arg.arg_count > 0 && arg.args[0] == first_arg;
+}
+}
+
+struct WindowManagementTraceBuffer : Test
+{
+    void record(uint16_t call, std::initializer_list<int64_t> args)
+    {
+        buffer.record(call, args.begin(), args.size());
+    }
+
+    miral::WindowManagementTraceBuffer buffer{{"first", "second"}, records_per_ring};
+};
+
+TEST_F(WindowManagementTraceBuffer, records_calls_and_arguments)
+{
+    record(0, {1, 2, 3});
+    record(1, {4});
+
+    auto const records = buffer.snapshot(1min);
+
+    ASSERT_THAT(records.size(), Eq(2u));
+    EXPECT_THAT(records[0].call, Eq(0));
+    EXPECT_THAT(records[0].arg_count, Eq(3));
+    EXPECT_THAT(records[0].args[2], Eq(3));
+    EXPECT_THAT(records[1].call, Eq(1));
+    EXPECT_THAT(records[1].arg_count, Eq(1));
+    EXPECT_THAT(records[1].args[0], Eq(4));
+}
+
+TEST_F(WindowManagementTraceBuffer, excess_arguments_are_dropped)
+{
+    record(0, {1, 2, 3, 4, 5, 6, 7, 8});
+
+    auto const records = buffer.snapshot(1min);
+
+    ASSERT_THAT(records.size(), Eq(1u));
+    EXPECT_THAT(records[0].arg_count, Eq(miral::WindowManagementTraceRecord::max_args));
+    EXPECT_THAT(records[0].args[miral::WindowManagementTraceRecord::max_args - 1], Eq(6));
+}
+
+TEST_F(WindowManagementTraceBuffer, keeps_only_the_most_recent_records)
+{
+    for (int64_t i = 0; i != 3 * records_per_ring; ++i)
+        record(0, {i});
+
+    auto const records = buffer.snapshot(1min);
+
+    ASSERT_THAT(records.size(), Eq(static_cast<std::size_t>(records_per_ring)));
+    EXPECT_THAT(records.front(), IsRecord(0, 2 * records_per_ring));
+    EXPECT_THAT(records.back(), IsRecord(0, 3 * records_per_ring - 1));
+}
+
+TEST_F(WindowManagementTraceBuffer, merges_threads_in_timestamp_order)
+{
+    record(0, {1});
+    std::thread{[this] { record(1, {2}); }}.join();
+    record(0, {3});
+
+    auto const records = buffer.snapshot(1min);
+
+    ASSERT_THAT(records.size(), Eq(3u));
+    EXPECT_THAT(records[0], IsRecord(0, 1));
+    EXPECT_THAT(records[1], IsRecord(1, 2));
+    EXPECT_THAT(records[2], IsRecord(0, 3));
+    EXPECT_THAT(records[1].thread, Ne(records[0].thread));
+    EXPECT_THAT(records[2].thread, Eq(records[0].thread));
+}
+
+TEST_F(WindowManagementTraceBuffer, dump_starts_with_header_and_call_names)
+{
+    record(1, {42});
+
+    std::stringstream out;
+    buffer.dump(out, 1min);
+    auto const dump = out.str();
+
+    EXPECT_THAT(dump.substr(0, 8), Eq("MIRALWMT"));
+    EXPECT_THAT(dump, HasSubstr(std::string{"first\0second\0", 13}));
+    EXPECT_THAT(dump.size(), Gt(sizeof(miral::WindowManagementTraceRecord)));
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include "mir/dispatch/multiplexing_dispatchable.h"
+#include "mir/test/test_dispatchable.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <dlfcn.h>
+#include <poll.h>
+#include <sys/epoll.h>
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace md = mir::dispatch;
+namespace mt = mir::test;
+
+using namespace testing;
+
+namespace
+{
+// The epoll and poll calls made by the process: these wrap libc's to count them
+std::atomic<unsigned long> syscalls{0};
+
+template<typename Function>
+auto real(char const* name) -> Function*
+{
+    return reinterpret_cast<Function*>(dlsym(RTLD_NEXT, name));
+}
+}
+
+extern "C" int epoll_wait(int epfd, epoll_event* events, int maxevents, int timeout)
+{
+    static auto const real_epoll_wait = real<int(int, epoll_event*, int, int)>("epoll_wait");
+    ++syscalls;
+    return real_epoll_wait(epfd, events, maxevents, timeout);
+}
+
+extern "C" int epoll_ctl(int epfd, int op, int fd, epoll_event* event)
+{
+    static auto const real_epoll_ctl = real<int(int, int, int, epoll_event*)>("epoll_ctl");
+    ++syscalls;
+    return real_epoll_ctl(epfd, op, fd, event);
+}
+
+extern "C" int poll(pollfd* fds, nfds_t nfds, int timeout)
+{
+    static auto const real_poll = real<int(pollfd*, nfds_t, int)>("poll");
+    ++syscalls;
+    return real_poll(fds, nfds, timeout);
+}
+
+namespace
+{
+/// Benchmark parameters: how the multiplexer is dispatched, and how many sources are ready at each wakeup
+struct MultiplexingDispatchBenchmark : mt::MicroBenchmark, WithParamInterface<std::tuple<md::DispatchThreading, int>>
+{
+    MultiplexingDispatchBenchmark()
+    {
+        for (auto i = 0; i != ready_sources; ++i)
+        {
+            sources.push_back(std::make_shared<mt::TestDispatchable>([this] { ++dispatched; }));
+            multiplexer.add_watch(sources.back());
+        }
+    }
+
+    /// What the input thread does on waking: poll the multiplexer, then dispatch until it is idle
+    void wake_and_dispatch()
+    {
+        for (auto const& source : sources)
+            source->trigger();
+
+        pollfd pfd{multiplexer.watch_fd(), POLLIN, 0};
+        while (poll(&pfd, 1, 0) > 0)
+            multiplexer.dispatch(md::FdEvent::readable);
+    }
+
+    auto name() const -> std::string
+    {
+        return std::string{"multiplexer_"} +
+            (std::get<0>(GetParam()) == md::DispatchThreading::single ? "single_" : "concurrent_") +
+            std::to_string(ready_sources) + "_ready";
+    }
+
+    int const ready_sources{std::get<1>(GetParam())};
+    md::MultiplexingDispatchable multiplexer{std::get<0>(GetParam())};
+    std::vector<std::shared_ptr<mt::TestDispatchable>> sources;
+    unsigned long dispatched{0};
+};
+}
+
+TEST_P(MultiplexingDispatchBenchmark, wakeup)
+{
+    measure(name(), [this] { wake_and_dispatch(); });
+
+    // Count separately, so the timing harness's own calls don't skew the count
+    auto const wakeups = 1000;
+    dispatched = 0;
+    auto const syscalls_before = syscalls.load();
+    for (auto i = 0; i != wakeups; ++i)
+        wake_and_dispatch();
+    auto const epoll_and_poll_calls = syscalls.load() - syscalls_before;
+
+    ASSERT_THAT(dispatched, Eq(static_cast<unsigned long>(wakeups * ready_sources)));
+
+    auto const per_event = double(epoll_and_poll_calls) / dispatched;
+    RecordProperty(name() + "_syscalls_per_event", std::to_string(per_event));
+    std::cout << "[ BENCHMARK] " << name() << ": " << per_event << " poll/epoll calls per event" << std::endl;
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Dispatch,
+    MultiplexingDispatchBenchmark,
+    Combine(Values(md::DispatchThreading::concurrent, md::DispatchThreading::single), Values(1, 4, 16)));
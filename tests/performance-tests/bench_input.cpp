@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include "src/server/input/surface_input_dispatcher.h"
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/frontend_wayland/wayland_executor.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/events/event_builders.h"
+#include "mir/input/input_reception_mode.h"
+#include "mir/test/doubles/stub_buffer_stream.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <wayland-server-core.h>
+
+#include <memory>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mi = mir::input;
+namespace ms = mir::scene;
+namespace mf = mir::frontend;
+namespace mr = mir::report;
+namespace mev = mir::events;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+MirInputDeviceId const device_id{7};
+std::vector<uint8_t> const no_cookie{};
+
+auto pointer_motion_to(geom::Point position) -> mir::EventUPtr
+{
+    return mev::make_pointer_event(
+        device_id, std::chrono::nanoseconds{0}, no_cookie,
+        mir_input_event_modifier_none, mir_pointer_action_motion, 0,
+        position.x.as_int(), position.y.as_int(),
+        0, 0, 1, 1);
+}
+
+struct EventBenchmark : mt::MicroBenchmark
+{
+};
+
+/// Benchmark parameter: number of surfaces in the scene
+struct InputDispatchBenchmark : mt::MicroBenchmark, WithParamInterface<unsigned>
+{
+    void SetUp() override
+    {
+        for (auto i = 0; i != static_cast<int>(GetParam()); ++i)
+        {
+            auto const surface = std::make_shared<ms::BasicSurface>(
+                nullptr /* session */,
+                "bench",
+                geom::Rectangle{{(i * 97) % 1520, (i * 53) % 780}, {400, 300}},
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo>{{std::make_shared<mtd::StubBufferStream>(), {}, geom::Size{400, 300}}},
+                std::shared_ptr<mg::CursorImage>{},
+                report);
+            scene->add_surface(surface, mi::InputReceptionMode::normal);
+        }
+
+        dispatcher->start();
+    }
+
+    void TearDown() override
+    {
+        dispatcher->stop();
+    }
+
+    std::shared_ptr<ms::SceneReport> const report = mr::null_scene_report();
+    std::shared_ptr<ms::SurfaceStack> const scene = std::make_shared<ms::SurfaceStack>(report);
+    std::shared_ptr<mi::SurfaceInputDispatcher> const dispatcher =
+        std::make_shared<mi::SurfaceInputDispatcher>(scene);
+};
+
+/// Benchmark parameter: number of work items queued before each dispatch
+struct WaylandExecutorBenchmark : mt::MicroBenchmark, WithParamInterface<unsigned>
+{
+    ~WaylandExecutorBenchmark()
+    {
+        wl_event_loop_destroy(event_loop);
+    }
+
+    wl_event_loop* const event_loop{wl_event_loop_create()};
+};
+}
+
+TEST_F(EventBenchmark, make_pointer_event)
+{
+    measure("make_pointer_event", []
+        {
+            pointer_motion_to({100, 100});
+        });
+}
+
+TEST_F(EventBenchmark, make_key_event)
+{
+    measure("make_key_event", []
+        {
+            mev::make_key_event(
+                device_id, std::chrono::nanoseconds{0}, no_cookie,
+                mir_keyboard_action_down, 0, 30, mir_input_event_modifier_none);
+        });
+}
+
+TEST_P(InputDispatchBenchmark, pointer_motion)
+{
+    std::vector<std::shared_ptr<MirEvent const>> motion;
+    for (auto x = 0; x < 1920; x += 16)
+        motion.push_back(pointer_motion_to({x, (x * 9) / 16}));
+
+    auto next = 0u;
+
+    measure("dispatch_pointer_motion_" + std::to_string(GetParam()) + "_surfaces", [&]
+        {
+            dispatcher->dispatch(motion[next++ % motion.size()]);
+        });
+}
+
+TEST_P(InputDispatchBenchmark, key_press)
+{
+    std::shared_ptr<MirEvent const> const key = mev::make_key_event(
+        device_id, std::chrono::nanoseconds{0}, no_cookie,
+        mir_keyboard_action_down, 0, 30, mir_input_event_modifier_none);
+
+    measure("dispatch_key_" + std::to_string(GetParam()) + "_surfaces", [&]
+        {
+            dispatcher->dispatch(key);
+        });
+}
+
+INSTANTIATE_TEST_SUITE_P(Surfaces, InputDispatchBenchmark, Values(1u, 10u, 100u, 500u));
+
+TEST_P(WaylandExecutorBenchmark, spawn_and_dispatch)
+{
+    auto const batch = GetParam();
+    mf::WaylandExecutor executor{event_loop};
+    unsigned executed{0};
+
+    measure("wayland_executor_" + std::to_string(batch) + "_work_items", [&]
+        {
+            for (auto i = 0u; i != batch; ++i)
+                executor.spawn([&executed] { ++executed; });
+
+            wl_event_loop_dispatch(event_loop, 0);
+        });
+
+    EXPECT_THAT(executed, Gt(0u));
+}
+
+INSTANTIATE_TEST_SUITE_P(Batches, WaylandExecutorBenchmark, Values(1u, 16u, 256u));
@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/compositor/occlusion.h"
+#include "src/server/compositor/multi_monitor_arbiter.h"
+#include "src/server/compositor/dropping_schedule.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/input/input_reception_mode.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_buffer_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mr = mir::report;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+geom::Size const output_size{1920, 1080};
+geom::Size const surface_size{400, 300};
+
+/// Benchmark parameters: (number of surfaces, number of outputs)
+struct SceneBenchmark : mt::MicroBenchmark, WithParamInterface<std::tuple<unsigned, unsigned>>
+{
+    void SetUp() override
+    {
+        std::tie(surface_count, output_count) = GetParam();
+
+        for (auto i = 0u; i != output_count; ++i)
+        {
+            outputs.push_back(geom::Rectangle{
+                {output_size.width.as_int() * static_cast<int>(i), 0},
+                output_size});
+        }
+
+        for (auto const& output : outputs)
+            stack.register_compositor(&output);
+
+        // Cascade surfaces over the whole display area so that they overlap
+        // each other and straddle output boundaries
+        auto const span_x = output_size.width.as_int() * static_cast<int>(output_count) - surface_size.width.as_int();
+        auto const span_y = output_size.height.as_int() - surface_size.height.as_int();
+
+        for (auto i = 0u; i != surface_count; ++i)
+        {
+            auto const n = static_cast<int>(i);
+            geom::Point const top_left{(n * 97) % span_x, (n * 53) % span_y};
+            auto const surface = std::make_shared<ms::BasicSurface>(
+                nullptr /* session */,
+                "bench",
+                geom::Rectangle{top_left, surface_size},
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo>{{std::make_shared<mtd::StubBufferStream>(), {}, surface_size}},
+                std::shared_ptr<mg::CursorImage>{},
+                report);
+            stack.add_surface(surface, mir::input::InputReceptionMode::normal);
+            surfaces.push_back(surface);
+        }
+    }
+
+    void TearDown() override
+    {
+        for (auto const& surface : surfaces)
+            stack.remove_surface(surface);
+
+        for (auto const& output : outputs)
+            stack.unregister_compositor(&output);
+    }
+
+    auto label(char const* operation) const -> std::string
+    {
+        return std::string{operation} + "_" + std::to_string(surface_count) + "_surfaces_" +
+            std::to_string(output_count) + "_outputs";
+    }
+
+    unsigned surface_count;
+    unsigned output_count;
+    std::vector<geom::Rectangle> outputs;
+    std::shared_ptr<ms::SceneReport> const report = mr::null_scene_report();
+    ms::SurfaceStack stack{report};
+    std::vector<std::shared_ptr<ms::Surface>> surfaces;
+};
+
+/// Benchmark parameters: number of compositors (outputs) sharing a stream
+struct ArbiterBenchmark : mt::MicroBenchmark, WithParamInterface<unsigned>
+{
+    std::shared_ptr<mc::DroppingSchedule> const schedule = std::make_shared<mc::DroppingSchedule>();
+    mc::MultiMonitorArbiter arbiter{schedule};
+    std::vector<std::shared_ptr<mg::Buffer>> const buffers{
+        std::make_shared<mtd::StubBuffer>(),
+        std::make_shared<mtd::StubBuffer>(),
+        std::make_shared<mtd::StubBuffer>()};
+};
+}
+
+TEST_P(SceneBenchmark, scene_elements_for)
+{
+    measure(label("scene_elements_for"), [this]
+        {
+            for (auto const& output : outputs)
+                stack.scene_elements_for(&output);
+        });
+}
+
+TEST_P(SceneBenchmark, filter_occlusions_from)
+{
+    std::vector<mc::SceneElementSequence> scenes;
+    for (auto const& output : outputs)
+        scenes.push_back(stack.scene_elements_for(&output));
+
+    // Filtering mutates its input, so each iteration works on a copy; the
+    // cost of copying is included but is small compared to the filtering.
+    measure(label("filter_occlusions_from"), [&]
+        {
+            for (auto i = 0u; i != outputs.size(); ++i)
+            {
+                auto elements = scenes[i];
+                mc::filter_occlusions_from(elements, outputs[i]);
+            }
+        });
+}
+
+TEST_P(SceneBenchmark, frames_pending)
+{
+    measure(label("frames_pending"), [this]
+        {
+            for (auto const& output : outputs)
+                stack.frames_pending(&output);
+        });
+}
+
+TEST_P(SceneBenchmark, surface_at)
+{
+    std::vector<geom::Point> probes;
+    for (auto const& output : outputs)
+    {
+        for (auto x = 0; x < output.size.width.as_int(); x += 240)
+        {
+            for (auto y = 0; y < output.size.height.as_int(); y += 216)
+                probes.push_back(output.top_left + geom::Displacement{x, y});
+        }
+    }
+
+    measure(label("surface_at"), [&]
+        {
+            for (auto const& probe : probes)
+                stack.surface_at(probe);
+        });
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SurfacesAndOutputs,
+    SceneBenchmark,
+    Combine(Values(1u, 10u, 100u, 500u), Values(1u, 2u, 6u)));
+
+TEST_P(ArbiterBenchmark, compositor_acquire)
+{
+    auto const compositor_count = GetParam();
+    std::vector<int> compositors(compositor_count);
+    auto next = 0u;
+
+    measure("compositor_acquire_" + std::to_string(compositor_count) + "_outputs", [&]
+        {
+            // A client commits a new frame, then every output composites it
+            schedule->schedule(buffers[next++ % buffers.size()]);
+            for (auto const& compositor : compositors)
+                arbiter.compositor_acquire(&compositor);
+        });
+}
+
+TEST_P(ArbiterBenchmark, buffer_ready_for)
+{
+    auto const compositor_count = GetParam();
+    std::vector<int> compositors(compositor_count);
+    schedule->schedule(buffers.front());
+    for (auto const& compositor : compositors)
+        arbiter.compositor_acquire(&compositor);
+
+    measure("buffer_ready_for_" + std::to_string(compositor_count) + "_outputs", [&]
+        {
+            for (auto const& compositor : compositors)
+                arbiter.buffer_ready_for(&compositor);
+        });
+}
+
+INSTANTIATE_TEST_SUITE_P(Outputs, ArbiterBenchmark, Values(1u, 2u, 6u));
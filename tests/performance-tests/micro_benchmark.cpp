@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro_benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+auto mir::test::MicroBenchmark::minimum_time() -> std::chrono::milliseconds
+{
+    if (auto const value = getenv("MIR_MICRO_BENCHMARK_MIN_TIME_MS"))
+    {
+        if (auto const ms = atoi(value); ms > 0)
+            return std::chrono::milliseconds{ms};
+    }
+
+    return std::chrono::milliseconds{200};
+}
+
+auto mir::test::MicroBenchmark::report(
+    std::string const& name,
+    std::vector<std::chrono::nanoseconds>& batch_times,
+    unsigned long iterations) -> BenchmarkResult
+{
+    std::sort(begin(batch_times), end(batch_times));
+
+    BenchmarkResult const result{
+        batch_times[batch_times.size()/2],
+        batch_times.front(),
+        iterations};
+
+    RecordProperty(name + "_ns", std::to_string(result.median.count()));
+    RecordProperty(name + "_best_ns", std::to_string(result.best.count()));
+
+    std::cout << "[ BENCHMARK] " << name << ": "
+              << result.median.count() << " ns/iteration (best "
+              << result.best.count() << " ns, "
+              << result.iterations << " iterations)" << std::endl;
+
+    return result;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_TEST_MICRO_BENCHMARK_H_
+#define MIR_TEST_MICRO_BENCHMARK_H_
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace mir { namespace test {
+
+/// Result of timing a single operation: the median and best wall-clock time
+/// per iteration over a number of independently timed batches.
+struct BenchmarkResult
+{
+    std::chrono::nanoseconds median;
+    std::chrono::nanoseconds best;
+    unsigned long iterations;
+};
+
+/**
+ * A fixture for headless micro-benchmarks of server hot paths.
+ *
+ * Each measurement runs the operation in batches until at least
+ * MIR_MICRO_BENCHMARK_MIN_TIME_MS (default 200ms) has elapsed, and records
+ * the median time per iteration as a test property so that it appears in
+ * the gtest XML output (--gtest_output=xml) collected by CI.
+ */
+class MicroBenchmark : public testing::Test
+{
+protected:
+    template<typename Operation>
+    auto measure(std::string const& name, Operation&& operation) -> BenchmarkResult
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Warm caches and any lazily-initialised state
+        for (auto i = 0u; i != warm_up_iterations; ++i)
+            operation();
+
+        std::vector<std::chrono::nanoseconds> batch_times;
+        unsigned long total_iterations{0};
+        auto const deadline = clock::now() + minimum_time();
+
+        do
+        {
+            auto const start = clock::now();
+            for (auto i = 0u; i != batch_size; ++i)
+                operation();
+            batch_times.push_back((clock::now() - start) / batch_size);
+            total_iterations += batch_size;
+        }
+        while (clock::now() < deadline);
+
+        return report(name, batch_times, total_iterations);
+    }
+
+private:
+    static unsigned const warm_up_iterations = 16;
+    static unsigned const batch_size = 64;
+
+    static auto minimum_time() -> std::chrono::milliseconds;
+
+    auto report(
+        std::string const& name,
+        std::vector<std::chrono::nanoseconds>& batch_times,
+        unsigned long iterations) -> BenchmarkResult;
+};
+
+} } // namespace mir::test
+
+#endif // MIR_TEST_MICRO_BENCHMARK_H_
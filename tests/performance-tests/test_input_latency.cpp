@@ -0,0 +1,306 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir_test_framework/headless_test.h"
+#include "mir_test_framework/executable_path.h"
+#include "mir_test_framework/input_latency.h"
+#include "mir_test_framework/udev_environment.h"
+#include "mir/input/composite_event_filter.h"
+#include "mir/test/wayland_test_client.h"
+#include "mir/fd.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace mt = mir::test;
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+using namespace std::chrono;
+using namespace std::literals::chrono_literals;
+using namespace testing;
+
+namespace
+{
+int const output_width = 1600;
+int const output_height = 1600;
+
+/// A minimal fullscreen wl_shell client that timestamps the input events it receives
+class LatencyClient
+{
+public:
+    LatencyClient(mir::Fd const& socket, mtf::InputLatencyRecorder& recorder) :
+        recorder{recorder},
+        connection{socket},
+        display{connection.display},
+        seat{static_cast<wl_seat*>(connection.bind(wl_seat_interface, 1))},
+        stop_fd{eventfd(0, EFD_CLOEXEC)}
+    {
+        if (!seat)
+            throw std::runtime_error{"Wayland server is missing required globals"};
+
+        wl_seat_add_listener(seat, &seat_listener, this);
+        connection.roundtrip();
+
+        // The contents are never read, so the unwritten pages are never allocated
+        window = std::make_unique<mt::WaylandTestClient::Window>(
+            connection,
+            geom::Size{output_width, output_height},
+            mt::WaylandTestClient::Window::State::fullscreen);
+        connection.roundtrip();
+
+        dispatch_thread = std::thread{[this] { dispatch_until_stopped(); }};
+    }
+
+    ~LatencyClient()
+    {
+        eventfd_write(stop_fd, 1);
+        dispatch_thread.join();
+
+        if (pointer) wl_pointer_destroy(pointer);
+        if (keyboard) wl_keyboard_destroy(keyboard);
+        window.reset();
+        wl_seat_destroy(seat);
+    }
+
+private:
+    void dispatch_until_stopped()
+    {
+        pollfd fds[] = {{wl_display_get_fd(display), POLLIN, 0}, {stop_fd, POLLIN, 0}};
+
+        for (;;)
+        {
+            while (wl_display_prepare_read(display) != 0)
+                wl_display_dispatch_pending(display);
+            wl_display_flush(display);
+
+            if (poll(fds, 2, -1) < 0 || (fds[1].revents & POLLIN))
+            {
+                wl_display_cancel_read(display);
+                return;
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                wl_display_read_events(display);
+                wl_display_dispatch_pending(display);
+            }
+            else
+            {
+                wl_display_cancel_read(display);
+            }
+        }
+    }
+
+    void received(uint32_t time)
+    {
+        recorder.record_receipt(milliseconds{time});
+    }
+
+    static void handle_capabilities(void* data, wl_seat* seat, uint32_t capabilities)
+    {
+        auto const self = static_cast<LatencyClient*>(data);
+
+        if ((capabilities & WL_SEAT_CAPABILITY_POINTER) && !self->pointer)
+        {
+            self->pointer = wl_seat_get_pointer(seat);
+            wl_pointer_add_listener(self->pointer, &pointer_listener, self);
+        }
+
+        if ((capabilities & WL_SEAT_CAPABILITY_KEYBOARD) && !self->keyboard)
+        {
+            self->keyboard = wl_seat_get_keyboard(seat);
+            wl_keyboard_add_listener(self->keyboard, &keyboard_listener, self);
+        }
+    }
+
+    static void handle_name(void*, wl_seat*, char const*) {}
+
+    static void pointer_enter(void*, wl_pointer*, uint32_t, wl_surface*, wl_fixed_t, wl_fixed_t) {}
+    static void pointer_leave(void*, wl_pointer*, uint32_t, wl_surface*) {}
+
+    static void pointer_motion(void* data, wl_pointer*, uint32_t time, wl_fixed_t, wl_fixed_t)
+    {
+        static_cast<LatencyClient*>(data)->received(time);
+    }
+
+    static void pointer_button(void* data, wl_pointer*, uint32_t, uint32_t time, uint32_t, uint32_t)
+    {
+        static_cast<LatencyClient*>(data)->received(time);
+    }
+
+    static void pointer_axis(void* data, wl_pointer*, uint32_t time, uint32_t, wl_fixed_t)
+    {
+        static_cast<LatencyClient*>(data)->received(time);
+    }
+
+    static void keyboard_keymap(void*, wl_keyboard*, uint32_t, int32_t fd, uint32_t)
+    {
+        close(fd);
+    }
+
+    static void keyboard_enter(void*, wl_keyboard*, uint32_t, wl_surface*, wl_array*) {}
+    static void keyboard_leave(void*, wl_keyboard*, uint32_t, wl_surface*) {}
+
+    static void keyboard_key(void* data, wl_keyboard*, uint32_t, uint32_t time, uint32_t, uint32_t)
+    {
+        static_cast<LatencyClient*>(data)->received(time);
+    }
+
+    static void keyboard_modifiers(void*, wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) {}
+
+    static constexpr wl_seat_listener seat_listener{handle_capabilities, handle_name};
+    static constexpr wl_pointer_listener pointer_listener{
+        pointer_enter, pointer_leave, pointer_motion, pointer_button, pointer_axis};
+    static constexpr wl_keyboard_listener keyboard_listener{
+        keyboard_keymap, keyboard_enter, keyboard_leave, keyboard_key, keyboard_modifiers};
+
+    mtf::InputLatencyRecorder& recorder;
+    mt::WaylandTestClient connection;
+    wl_display* const display;
+    wl_seat* const seat;
+    mir::Fd const stop_fd;
+
+    wl_pointer* pointer{nullptr};
+    wl_keyboard* keyboard{nullptr};
+    std::unique_ptr<mt::WaylandTestClient::Window> window;
+
+    std::thread dispatch_thread;
+};
+
+constexpr wl_seat_listener LatencyClient::seat_listener;
+constexpr wl_pointer_listener LatencyClient::pointer_listener;
+constexpr wl_keyboard_listener LatencyClient::keyboard_listener;
+
+/// Parameters: (evdev device, evemu recording replayed on it, number of Wayland clients)
+using Scenario = std::tuple<char const*, char const*, int>;
+
+struct InputLatency : mtf::HeadlessTest, WithParamInterface<Scenario>
+{
+    InputLatency()
+    {
+        // Use the real evdev platform on top of the umockdev testbed
+        add_to_environment("MIR_SERVER_PLATFORM_INPUT_LIB", mtf::server_input_platform("input-evdev").c_str());
+        add_to_environment("MIR_SERVER_ENABLE_INPUT", "on");
+
+        server.override_the_input_report([this] { return recorder.input_report(); });
+        server.add_init_callback([this] { server.the_composite_event_filter()->append(dispatch_filter); });
+    }
+
+    void SetUp() override
+    {
+        char const* device;
+        char const* recording;
+        int client_count;
+        std::tie(device, recording, client_count) = GetParam();
+
+        udev.add_standard_device(device);
+        start_server();
+
+        for (auto i = 0; i != client_count; ++i)
+            clients.push_back(std::make_unique<LatencyClient>(server.open_wayland_client_socket(), recorder));
+
+        // Replaying starts (at the recorded rate) when libinput reads the device
+        udev.load_device_evemu(recording);
+    }
+
+    void TearDown() override
+    {
+        clients.clear();
+        stop_server();
+    }
+
+    /// Wait until no new events have reached the clients for a while
+    void wait_for_replay_to_finish()
+    {
+        auto const deadline = steady_clock::now() + 30s;
+        std::size_t received{0};
+
+        do
+        {
+            std::this_thread::sleep_for(500ms);
+            auto const now_received = recorder.latencies(mtf::InputLatencyRecorder::Stage::receipt).size();
+            if (now_received == received && received > 0)
+                break;
+            received = now_received;
+        }
+        while (steady_clock::now() < deadline);
+    }
+
+    void report_latencies()
+    {
+        using Stage = mtf::InputLatencyRecorder::Stage;
+
+        for (auto const stage : {Stage::kernel, Stage::dispatch, Stage::send, Stage::receipt})
+        {
+            auto const d = recorder.distribution(stage);
+            auto const prefix = std::string{mtf::to_string(stage)} + "_";
+
+            RecordProperty(prefix + "count", std::to_string(d.count));
+            RecordProperty(prefix + "median_us", std::to_string(duration_cast<microseconds>(d.median).count()));
+            RecordProperty(prefix + "p95_us", std::to_string(duration_cast<microseconds>(d.p95).count()));
+            RecordProperty(prefix + "p99_us", std::to_string(duration_cast<microseconds>(d.p99).count()));
+            RecordProperty(prefix + "max_us", std::to_string(duration_cast<microseconds>(d.max).count()));
+
+            std::cout << "[ LATENCY  ] " << mtf::to_string(stage) << ": " << d.count << " events, "
+                      << "min " << duration_cast<microseconds>(d.min).count() << "us, "
+                      << "median " << duration_cast<microseconds>(d.median).count() << "us, "
+                      << "p95 " << duration_cast<microseconds>(d.p95).count() << "us, "
+                      << "p99 " << duration_cast<microseconds>(d.p99).count() << "us, "
+                      << "max " << duration_cast<microseconds>(d.max).count() << "us" << std::endl;
+        }
+    }
+
+    mtf::UdevEnvironment udev;
+    mtf::InputLatencyRecorder recorder;
+    std::shared_ptr<mir::input::EventFilter> const dispatch_filter{recorder.event_filter()};
+    std::vector<std::unique_ptr<LatencyClient>> clients;
+};
+}
+
+TEST_P(InputLatency, replayed_events_reach_clients)
+{
+    wait_for_replay_to_finish();
+    report_latencies();
+
+    using Stage = mtf::InputLatencyRecorder::Stage;
+    EXPECT_THAT(recorder.distribution(Stage::dispatch).count, Gt(0u));
+    EXPECT_THAT(recorder.distribution(Stage::receipt).count, Gt(0u));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Recordings,
+    InputLatency,
+    Values(
+        Scenario{"laptop-mouse", "laptop-mouse-motion", 1},
+        Scenario{"laptop-mouse", "laptop-mouse-motion", 10},
+        Scenario{"laptop-mouse", "laptop-mouse-motion", 50},
+        Scenario{"laptop-mouse", "laptop-mouse-click", 1},
+        Scenario{"laptop-mouse", "laptop-mouse-click", 10},
+        Scenario{"laptop-mouse", "laptop-mouse-click", 50},
+        Scenario{"laptop-keyboard", "laptop-keyboard-hello", 1},
+        Scenario{"laptop-keyboard", "laptop-keyboard-hello", 10},
+        Scenario{"laptop-keyboard", "laptop-keyboard-hello", 50}));
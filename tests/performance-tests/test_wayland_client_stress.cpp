@@ -0,0 +1,327 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir_test_framework/headless_test.h"
+#include "mir/test/wayland_test_client.h"
+#include "mir/shell/focus_controller.h"
+#include "mir/fd.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace mt = mir::test;
+namespace mtf = mir_test_framework;
+namespace geom = mir::geometry;
+
+using namespace std::chrono;
+using namespace std::literals::chrono_literals;
+using namespace testing;
+
+namespace
+{
+int const max_buffer_width = 128;
+int const max_buffer_height = 128;
+int const rounds = 60;
+
+/**
+ * A wl_shell client with a double-buffered shm surface.
+ *
+ * Clients have no thread of their own: the benchmark drives all of them from
+ * one thread, so that hundreds of clients don't need hundreds of threads.
+ */
+class StressClient
+{
+public:
+    explicit StressClient(mir::Fd const& socket) :
+        connection{socket}
+    {
+        create_surface();
+    }
+
+    ~StressClient()
+    {
+        destroy_surface();
+    }
+
+    void create_surface()
+    {
+        window = std::make_unique<mt::WaylandTestClient::Window>(connection, geom::Size{width, height});
+        create_buffers();
+        commit();
+    }
+
+    void destroy_surface()
+    {
+        destroy_buffers();
+        window.reset();
+    }
+
+    void resize(int new_width, int new_height)
+    {
+        destroy_buffers();
+        width = new_width;
+        height = new_height;
+        create_buffers();
+        commit();
+    }
+
+    /// Attach and commit whichever buffer the server has released
+    void commit()
+    {
+        auto const free = std::find_if(begin(buffers), end(buffers), [](Buffer const& b) { return !b.busy; });
+        if (free == end(buffers))
+        {
+            ++stalled_commits;
+            return;
+        }
+
+        wl_surface_attach(window->surface, free->shm->buffer, 0, 0);
+        wl_surface_damage(window->surface, 0, 0, width, height);
+        free->busy = true;
+        free->committed = steady_clock::now();
+        wl_surface_commit(window->surface);
+    }
+
+    /// Whether all committed buffers have been released
+    auto idle() const -> bool
+    {
+        return std::none_of(begin(buffers), end(buffers), [](Buffer const& b) { return b.busy; });
+    }
+
+    mt::WaylandTestClient connection;
+
+    /// Time from wl_surface.commit to wl_buffer.release, per released buffer
+    std::vector<nanoseconds> commit_to_release;
+    unsigned stalled_commits{0};
+
+private:
+    struct Buffer
+    {
+        std::unique_ptr<mt::WaylandTestClient::Buffer> shm;
+        bool busy;
+        steady_clock::time_point committed;
+    };
+
+    void create_buffers()
+    {
+        for (auto& b : buffers)
+        {
+            b = {std::make_unique<mt::WaylandTestClient::Buffer>(connection.shm, geom::Size{width, height}), false, {}};
+            b.shm->on_release = [this, &b]
+                {
+                    b.busy = false;
+                    commit_to_release.push_back(steady_clock::now() - b.committed);
+                };
+        }
+    }
+
+    /// Destroying a buffer the server holds is allowed; it just never sees a release
+    void destroy_buffers()
+    {
+        for (auto& b : buffers)
+            b.shm.reset();
+    }
+
+    std::unique_ptr<mt::WaylandTestClient::Window> window;
+
+    int width{max_buffer_width / 2};
+    int height{max_buffer_height / 2};
+    std::array<Buffer, 2> buffers;
+};
+
+/// Resident set size of this process (both the server and the clients)
+auto resident_bytes() -> long
+{
+    long pages{0};
+    long resident{0};
+    std::ifstream{"/proc/self/statm"} >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+auto cpu_time(clockid_t clock) -> nanoseconds
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return seconds{ts.tv_sec} + nanoseconds{ts.tv_nsec};
+}
+
+auto percentile(std::vector<nanoseconds> const& sorted, double p) -> nanoseconds
+{
+    if (sorted.empty())
+        return {};
+
+    return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(p * sorted.size()))];
+}
+
+struct WaylandClientStress : mtf::HeadlessTest, WithParamInterface<int>
+{
+    void SetUp() override
+    {
+        start_server();
+
+        std::promise<clockid_t> wayland_clock;
+        server.run_on_wayland_display([&wayland_clock](wl_display*)
+            {
+                clockid_t clock;
+                pthread_getcpuclockid(pthread_self(), &clock);
+                wayland_clock.set_value(clock);
+            });
+        wayland_thread_clock = wayland_clock.get_future().get();
+    }
+
+    void TearDown() override
+    {
+        clients.clear();
+        stop_server();
+    }
+
+    void connect_clients(int count)
+    {
+        for (auto i = 0; i != count; ++i)
+            clients.push_back(std::make_unique<StressClient>(server.open_wayland_client_socket()));
+    }
+
+    /// Dispatch all clients' events until every committed buffer is released (or we give up)
+    void dispatch_until_idle(steady_clock::duration timeout)
+    {
+        auto const deadline = steady_clock::now() + timeout;
+        std::vector<pollfd> fds;
+
+        for (;;)
+        {
+            fds.clear();
+            auto busy = false;
+            for (auto const& client : clients)
+            {
+                wl_display_dispatch_pending(client->connection.display);
+                wl_display_flush(client->connection.display);
+                fds.push_back({wl_display_get_fd(client->connection.display), POLLIN, 0});
+                busy = busy || !client->idle();
+            }
+
+            auto const remaining = duration_cast<milliseconds>(deadline - steady_clock::now());
+            if (!busy || remaining <= 0ms)
+                return;
+
+            if (poll(fds.data(), fds.size(), remaining.count()) <= 0)
+                return;
+
+            for (auto i = 0u; i != fds.size(); ++i)
+            {
+                if (fds[i].revents & POLLIN)
+                    wl_display_dispatch(clients[i]->connection.display);
+            }
+        }
+    }
+
+    void report(std::string const& name, std::string const& value, std::string const& unit)
+    {
+        RecordProperty(name, value);
+        std::cout << "[ STRESS   ] " << name << ": " << value << unit << std::endl;
+    }
+
+    clockid_t wayland_thread_clock;
+    std::vector<std::unique_ptr<StressClient>> clients;
+};
+}
+
+TEST_P(WaylandClientStress, create_commit_resize_destroy_and_focus_churn)
+{
+    auto const client_count = GetParam();
+
+    auto const resident_before = resident_bytes();
+    connect_clients(client_count);
+    dispatch_until_idle(10s);
+    auto const resident_after = resident_bytes();
+
+    auto const focus_controller = server.the_focus_controller();
+    auto const cpu_before = cpu_time(wayland_thread_clock);
+    auto const wall_before = steady_clock::now();
+
+    for (auto round = 0; round != rounds; ++round)
+    {
+        for (auto i = 0u; i != clients.size(); ++i)
+        {
+            auto& client = *clients[i];
+
+            // Stagger the churn so each round has a mix of operations
+            switch ((round + i) % 10)
+            {
+            case 3:
+                client.resize(max_buffer_width / 2 + round % (max_buffer_width / 2), max_buffer_height / 2);
+                break;
+
+            case 7:
+                client.destroy_surface();
+                client.create_surface();
+                break;
+
+            default:
+                client.commit();
+            }
+        }
+
+        focus_controller->focus_next_session();
+        dispatch_until_idle(5s);
+    }
+
+    auto const wall_time = steady_clock::now() - wall_before;
+    auto const wayland_cpu = cpu_time(wayland_thread_clock) - cpu_before;
+
+    std::vector<nanoseconds> latencies;
+    unsigned stalled{0};
+    for (auto const& client : clients)
+    {
+        latencies.insert(end(latencies), begin(client->commit_to_release), end(client->commit_to_release));
+        stalled += client->stalled_commits;
+    }
+    std::sort(begin(latencies), end(latencies));
+
+    auto const client_rounds = client_count * rounds;
+    auto const us = [](nanoseconds t) { return std::to_string(duration_cast<microseconds>(t).count()); };
+
+    report("clients", std::to_string(client_count), "");
+    report("wall_time_ms", std::to_string(duration_cast<milliseconds>(wall_time).count()), "ms");
+    report("wayland_cpu_ms", std::to_string(duration_cast<milliseconds>(wayland_cpu).count()), "ms");
+    report("wayland_cpu_per_client_round_us", us(wayland_cpu / client_rounds), "us");
+    report("commit_to_release_count", std::to_string(latencies.size()), "");
+    report("commit_to_release_median_us", us(percentile(latencies, 0.5)), "us");
+    report("commit_to_release_p95_us", us(percentile(latencies, 0.95)), "us");
+    report("commit_to_release_p99_us", us(percentile(latencies, 0.99)), "us");
+    report("commit_to_release_max_us", us(latencies.empty() ? nanoseconds{} : latencies.back()), "us");
+    report("stalled_commits", std::to_string(stalled), "");
+    report("resident_kib_per_client", std::to_string((resident_after - resident_before) / client_count / 1024), "KiB");
+
+    EXPECT_THAT(latencies.size(), Gt(0u));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ClientCounts,
+    WaylandClientStress,
+    Values(10, 100, 300));
@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/buffer_mailbox.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace testing;
+namespace mtd = mir::test::doubles;
+namespace mg = mir::graphics;
+namespace mc = mir::compositor;
+
+namespace
+{
+struct BufferMailbox : Test
+{
+    BufferMailbox()
+    {
+        for (auto i = 0; i != 5; ++i)
+            buffers.emplace_back(std::make_shared<mtd::StubBuffer>());
+    }
+
+    std::vector<std::shared_ptr<mg::Buffer>> buffers;
+    mc::BufferMailbox mailbox;
+    int const compositor1{0};
+    int const compositor2{0};
+};
+}
+
+TEST_F(BufferMailbox, is_empty_until_a_buffer_is_submitted)
+{
+    EXPECT_TRUE(mailbox.empty());
+    EXPECT_THAT(mailbox.latest(), IsNull());
+    EXPECT_THAT(mailbox.acquire(&compositor1), IsNull());
+    EXPECT_FALSE(mailbox.ready_for(&compositor1));
+}
+
+TEST_F(BufferMailbox, gives_compositors_the_latest_buffer)
+{
+    for (auto const& buffer : buffers)
+        mailbox.submit(buffer);
+
+    EXPECT_THAT(mailbox.acquire(&compositor1), Eq(buffers.back()));
+    EXPECT_THAT(mailbox.acquire(&compositor2), Eq(buffers.back()));
+    EXPECT_THAT(mailbox.latest(), Eq(buffers.back()));
+}
+
+TEST_F(BufferMailbox, is_ready_for_each_compositor_until_it_acquires_the_latest_buffer)
+{
+    mailbox.submit(buffers[0]);
+    EXPECT_TRUE(mailbox.ready_for(&compositor1));
+    EXPECT_TRUE(mailbox.ready_for(&compositor2));
+
+    mailbox.acquire(&compositor1);
+    EXPECT_FALSE(mailbox.ready_for(&compositor1));
+    EXPECT_TRUE(mailbox.ready_for(&compositor2));
+
+    mailbox.submit(buffers[1]);
+    EXPECT_TRUE(mailbox.ready_for(&compositor1));
+}
+
+TEST_F(BufferMailbox, is_ready_when_the_same_buffer_is_resubmitted)
+{
+    mailbox.submit(buffers[0]);
+    mailbox.acquire(&compositor1);
+
+    mailbox.submit(buffers[0]);
+
+    EXPECT_TRUE(mailbox.ready_for(&compositor1));
+}
+
+TEST_F(BufferMailbox, releases_buffers_that_are_replaced)
+{
+    for (auto const& buffer : buffers)
+        mailbox.submit(buffer);
+
+    for (auto i = 0u; i != buffers.size() - 1; ++i)
+        EXPECT_TRUE(buffers[i].unique());
+    EXPECT_FALSE(buffers.back().unique());
+}
+
+TEST_F(BufferMailbox, take_empties_the_mailbox)
+{
+    mailbox.submit(buffers[0]);
+
+    EXPECT_THAT(mailbox.take(), Eq(buffers[0]));
+    EXPECT_TRUE(mailbox.empty());
+    EXPECT_TRUE(buffers[0].unique());
+}
+
+TEST_F(BufferMailbox, tracks_more_compositors_than_it_remembers)
+{
+    std::vector<int> compositors(20);
+    mailbox.submit(buffers[0]);
+
+    for (auto const& compositor : compositors)
+        EXPECT_THAT(mailbox.acquire(&compositor), Eq(buffers[0]));
+
+    // The most recent compositors are remembered...
+    EXPECT_FALSE(mailbox.ready_for(&compositors.back()));
+
+    // ...and a forgotten one is shown the buffer again
+    for (auto const& compositor : compositors)
+        EXPECT_THAT(mailbox.acquire(&compositor), Eq(buffers[0]));
+}
+
+TEST_F(BufferMailbox, compositors_always_see_a_submitted_buffer_while_another_thread_submits)
+{
+    std::atomic<bool> done{false};
+    mailbox.submit(buffers[0]);
+
+    std::thread submitter{[&]
+        {
+            for (auto i = 0; i != 10000; ++i)
+                mailbox.submit(buffers[i % buffers.size()]);
+            done = true;
+        }};
+
+    auto const compositor = [&](void const* id)
+        {
+            while (!done)
+            {
+                auto const buffer = mailbox.acquire(id);
+                ASSERT_THAT(buffer, NotNull());
+                ASSERT_THAT(std::find(begin(buffers), end(buffers), buffer), Ne(end(buffers)));
+            }
+        };
+    std::thread compositor_thread{compositor, &compositor2};
+    compositor(&compositor1);
+
+    submitter.join();
+    compositor_thread.join();
+}
@@ -210,6 +210,40 @@ TEST_F(DefaultDisplayBufferCompositor, calls_renderer_in_sequence)
     }));
 }
 
+TEST_F(DefaultDisplayBufferCompositor, renders_only_what_the_display_buffer_leaves_to_composite)
+{
+    using namespace testing;
+
+    /// Overlays the top renderable, leaving the rest to be composited
+    struct OverlaysTopRenderable : NiceMock<mtd::MockDisplayBuffer>
+    {
+        bool overlay_top(mg::RenderableList& renderlist) override
+        {
+            renderlist.pop_back();
+            return false;
+        }
+    } overlaying_buffer;
+
+    ON_CALL(overlaying_buffer, transformation())
+        .WillByDefault(Return(no_transformation));
+    ON_CALL(overlaying_buffer, view_area())
+        .WillByDefault(Return(screen));
+
+    EXPECT_CALL(mock_renderer, suspend())
+        .Times(0);
+    EXPECT_CALL(mock_renderer, render(ContainerEq(mg::RenderableList{big})));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        overlaying_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({
+        big,
+        small
+    }));
+}
+
 TEST_F(DefaultDisplayBufferCompositor, rotates_viewport)
 {   // Regression test for LP: #1643488
     using namespace testing;
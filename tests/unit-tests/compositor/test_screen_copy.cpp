@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/screen_copy.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct ScreenCopy : Test
+{
+    auto request(geom::Rectangle const& area, bool wait_for_damage) -> mc::ScreenCopy::Request
+    {
+        return {
+            area,
+            area.size,
+            history,
+            wait_for_damage,
+            [this](mc::ScreenCopy::Result&& result) { results.push_back(std::move(result)); }};
+    }
+
+    void composite(geom::Rectangle const& view_area)
+    {
+        auto copies = screen_copy.copies_for(view_area, renderables);
+        for (auto& readback : copies.readbacks)
+            readback.read = true;
+        copies.complete(std::chrono::steady_clock::now());
+    }
+
+    int frames_scheduled = 0;
+    mc::ScreenCopy screen_copy{[this] { ++frames_scheduled; }};
+    std::shared_ptr<mc::ScreenCopy::DamageHistory> const history = mc::ScreenCopy::new_damage_history();
+    std::shared_ptr<mtd::FakeRenderable> const window = std::make_shared<mtd::FakeRenderable>(10, 10, 20, 20);
+    mg::RenderableList renderables{window};
+    std::vector<mc::ScreenCopy::Result> results;
+
+    geom::Rectangle const output{{0, 0}, {100, 100}};
+};
+}
+
+TEST_F(ScreenCopy, copy_schedules_a_frame_and_is_read_back_from_it)
+{
+    auto const pending = screen_copy.copy(request(output, false));
+
+    EXPECT_THAT(frames_scheduled, Eq(1));
+
+    composite(output);
+
+    ASSERT_THAT(results.size(), Eq(1u));
+    EXPECT_TRUE(results[0].succeeded);
+}
+
+TEST_F(ScreenCopy, copy_is_only_read_back_from_the_output_showing_it)
+{
+    auto const pending = screen_copy.copy(request(output, false));
+
+    composite({{100, 0}, {100, 100}});
+    EXPECT_THAT(results.size(), Eq(0u));
+
+    composite(output);
+    EXPECT_THAT(results.size(), Eq(1u));
+}
+
+TEST_F(ScreenCopy, released_copy_is_cancelled)
+{
+    screen_copy.copy(request(output, false));
+
+    composite(output);
+
+    EXPECT_THAT(results.size(), Eq(0u));
+}
+
+TEST_F(ScreenCopy, first_copy_damages_everything)
+{
+    auto const pending = screen_copy.copy(request(output, true));
+
+    EXPECT_THAT(frames_scheduled, Eq(0));
+
+    composite(output);
+
+    ASSERT_THAT(results.size(), Eq(1u));
+    EXPECT_THAT(results[0].damage, ElementsAre(geom::Rectangle{{0, 0}, {100, 100}}));
+}
+
+TEST_F(ScreenCopy, copy_waiting_for_damage_waits_for_a_change)
+{
+    auto pending = screen_copy.copy(request(output, true));
+    composite(output);
+    results.clear();
+
+    pending = screen_copy.copy(request(output, true));
+    composite(output);
+    EXPECT_THAT(results.size(), Eq(0u));
+
+    renderables.push_back(std::make_shared<mtd::FakeRenderable>(50, 50, 10, 10));
+    composite(output);
+
+    ASSERT_THAT(results.size(), Eq(1u));
+    EXPECT_THAT(results[0].damage, ElementsAre(geom::Rectangle{{50, 50}, {10, 10}}));
+}
+
+TEST_F(ScreenCopy, damage_covers_where_a_window_was_and_is)
+{
+    auto pending = screen_copy.copy(request(output, true));
+    composite(output);
+    results.clear();
+
+    renderables = {std::make_shared<mtd::FakeRenderable>(40, 10, 20, 20)};
+    pending = screen_copy.copy(request(output, true));
+    composite(output);
+
+    ASSERT_THAT(results.size(), Eq(1u));
+    EXPECT_THAT(results[0].damage, UnorderedElementsAre(
+        geom::Rectangle{{40, 10}, {20, 20}},
+        geom::Rectangle{{10, 10}, {20, 20}}));
+}
+
+TEST_F(ScreenCopy, damage_is_in_copy_pixels)
+{
+    auto pending = screen_copy.copy(request(output, true));
+    composite(output);
+    results.clear();
+
+    renderables.push_back(std::make_shared<mtd::FakeRenderable>(50, 50, 10, 10));
+    auto scaled_request = request(output, true);
+    scaled_request.size = {200, 200};
+    pending = screen_copy.copy(std::move(scaled_request));
+    composite(output);
+
+    ASSERT_THAT(results.size(), Eq(1u));
+    EXPECT_THAT(results[0].damage, ElementsAre(geom::Rectangle{{100, 100}, {20, 20}}));
+}
@@ -490,3 +490,76 @@ TEST(MultiplexingDispatchableTest, automatic_removals_are_threadsafe)
     
     dispatchee->trigger();
 }
+
+TEST(MultiplexingDispatchableTest, single_threaded_dispatch_handles_every_ready_dispatchee)
+{
+    int a_dispatched{0};
+    auto dispatchee_a = std::make_shared<mt::TestDispatchable>([&a_dispatched]() { ++a_dispatched; });
+
+    int b_dispatched{0};
+    auto dispatchee_b = std::make_shared<mt::TestDispatchable>([&b_dispatched]() { ++b_dispatched; });
+
+    md::MultiplexingDispatchable dispatcher{md::DispatchThreading::single};
+    dispatcher.add_watch(dispatchee_a);
+    dispatcher.add_watch(dispatchee_b);
+
+    dispatchee_a->trigger();
+    dispatchee_b->trigger();
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(a_dispatched, testing::Eq(1));
+    EXPECT_THAT(b_dispatched, testing::Eq(1));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, single_threaded_dispatch_keeps_dispatching_until_fd_is_unreadable)
+{
+    int dispatched{0};
+    auto dispatchee = std::make_shared<mt::TestDispatchable>([&dispatched]() { ++dispatched; });
+    md::MultiplexingDispatchable dispatcher{md::DispatchThreading::single};
+    dispatcher.add_watch(dispatchee);
+
+    int const trigger_count{10};
+
+    for (int i = 0; i < trigger_count; ++i)
+    {
+        dispatchee->trigger();
+    }
+
+    for (int i = 0; i < trigger_count; ++i)
+    {
+        ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+        dispatcher.dispatch(md::FdEvent::readable);
+    }
+
+    EXPECT_THAT(dispatched, testing::Eq(trigger_count));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, single_threaded_dispatch_skips_dispatchee_removed_earlier_in_batch)
+{
+    md::MultiplexingDispatchable dispatcher{md::DispatchThreading::single};
+
+    bool a_dispatched{false};
+    bool b_dispatched{false};
+    std::shared_ptr<mt::TestDispatchable> dispatchee_a;
+    std::shared_ptr<mt::TestDispatchable> dispatchee_b;
+
+    // Whichever is dispatched first removes the other
+    dispatchee_a = std::make_shared<mt::TestDispatchable>(
+        [&]() { a_dispatched = true; dispatcher.remove_watch(dispatchee_b); });
+    dispatchee_b = std::make_shared<mt::TestDispatchable>(
+        [&]() { b_dispatched = true; dispatcher.remove_watch(dispatchee_a); });
+
+    dispatcher.add_watch(dispatchee_a);
+    dispatcher.add_watch(dispatchee_b);
+
+    dispatchee_a->trigger();
+    dispatchee_b->trigger();
+
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_NE(a_dispatched, b_dispatched);
+}
@@ -285,3 +285,44 @@ TEST_F(TestRectangles, remove_only_removes_one_instance)
         EXPECT_THAT(rectangles.size(), Eq(i));
     }
 }
+
+TEST_F(TestRectangles, subtract_from_middle_leaves_the_surrounding_area)
+{
+    rectangles.add({{0, 0}, {30, 30}});
+
+    rectangles.subtract({{10, 10}, {10, 10}});
+
+    EXPECT_THAT(contents_of(rectangles), UnorderedElementsAre(
+        Rectangle{{0, 0}, {30, 10}},
+        Rectangle{{0, 20}, {30, 10}},
+        Rectangle{{0, 10}, {10, 10}},
+        Rectangle{{20, 10}, {10, 10}}));
+}
+
+TEST_F(TestRectangles, subtract_over_an_edge_leaves_the_rest)
+{
+    rectangles.add({{0, 0}, {30, 30}});
+
+    rectangles.subtract({{20, -5}, {20, 40}});
+
+    EXPECT_THAT(contents_of(rectangles), ElementsAre(Rectangle{{0, 0}, {20, 30}}));
+}
+
+TEST_F(TestRectangles, subtract_outside_leaves_rectangles_unchanged)
+{
+    rectangles.add({{0, 0}, {30, 30}});
+
+    rectangles.subtract({{40, 40}, {10, 10}});
+
+    EXPECT_THAT(contents_of(rectangles), ElementsAre(Rectangle{{0, 0}, {30, 30}}));
+}
+
+TEST_F(TestRectangles, subtract_applies_to_every_rectangle)
+{
+    rectangles.add({{0, 0}, {30, 30}});
+    rectangles.add({{50, 0}, {30, 30}});
+
+    rectangles.subtract({{0, 0}, {100, 100}});
+
+    EXPECT_THAT(rectangles.size(), Eq(0u));
+}
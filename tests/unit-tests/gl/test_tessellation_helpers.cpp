@@ -147,3 +147,34 @@ TEST_F(Tessellation, tex_coords_0_or_1_when_transformed)
     mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {x, y});
     expect_tex_coords_1_or_0(primitive);
 }
+
+TEST_F(Tessellation, tex_coords_cover_src_bounds)
+{
+    ON_CALL(renderable, buffer())
+        .WillByDefault(Return(std::make_shared<mtd::StubBuffer>(geom::Size{100, 50})));
+    ON_CALL(renderable, src_bounds())
+        .WillByDefault(Return(geom::RectangleF{{25.0f, 10.0f}, {50.0f, 20.0f}}));
+
+    mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {});
+
+    for (int i = 0; i < primitive.nvertices; i++)
+    {
+        EXPECT_THAT(primitive.vertices[i].texcoord[0], AnyOf(FloatEq(0.25f), FloatEq(0.75f))) << "for i = " << i;
+        EXPECT_THAT(primitive.vertices[i].texcoord[1], AnyOf(FloatEq(0.2f), FloatEq(0.6f))) << "for i = " << i;
+    }
+    EXPECT_THAT(bounding_box(primitive), Eq(BoundingBox::from(rect)));
+}
+
+TEST_F(Tessellation, part_of_renderable_gets_matching_tex_coords)
+{
+    geom::Rectangle const part{{9, 16}, {5, 10}};
+
+    mgl::Primitive const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {}, part);
+
+    for (int i = 0; i < primitive.nvertices; i++)
+    {
+        EXPECT_THAT(primitive.vertices[i].texcoord[0], AnyOf(FloatEq(0.5f), FloatEq(1.0f))) << "for i = " << i;
+        EXPECT_THAT(primitive.vertices[i].texcoord[1], AnyOf(FloatEq(0.5f), FloatEq(1.0f))) << "for i = " << i;
+    }
+    EXPECT_THAT(bounding_box(primitive), Eq(BoundingBox::from(part)));
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/common/server/buffer_from_wl_shm.h"
+#include "src/platforms/common/server/egl_context_executor.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/texture.h"
+#include "mir/fd.h"
+
+#include "mir/test/doubles/explicit_executor.h"
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
+#include "mir/test/doubles/null_gl_context.h"
+
+#include <wayland-server.h>
+#include <wayland-server-protocol.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cerrno>
+#include <system_error>
+
+#include <sys/socket.h>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace mgw = mir::graphics::wayland;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+uint32_t const buffer_id{2}; // The first id a client would use after wl_display's
+
+/// A server with one client, which has created a wl_shm buffer
+struct BufferFromWlShm : Test
+{
+    BufferFromWlShm()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create socketpair"};
+        client_end = mir::Fd{fds[1]};
+
+        wl_display_init_shm(display);
+        client = wl_client_create(display, fds[0]);
+
+        // wl_shm_buffer_create() is deprecated for compositors, but is the way to get a wl_shm buffer without a
+        // client library
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+        wl_shm_buffer_create(client, buffer_id, 4, 4, 16, WL_SHM_FORMAT_XRGB8888);
+#pragma GCC diagnostic pop
+        buffer = wl_client_get_object(client, buffer_id);
+    }
+
+    ~BufferFromWlShm()
+    {
+        wl_client_destroy(client);
+        wl_display_destroy(display);
+    }
+
+    auto import(mgw::ShmRelease release) -> std::shared_ptr<mg::Buffer>
+    {
+        return mgw::buffer_from_wl_shm(buffer, wayland_executor, egl_delegate, release, []{});
+    }
+
+    void bind(mg::Buffer& imported)
+    {
+        dynamic_cast<mg::gl::Texture&>(*imported.native_buffer_base()).bind();
+    }
+
+    /// Whether the client has been sent wl_buffer.release
+    auto client_sees_release() -> bool
+    {
+        wayland_executor->execute();
+        wl_client_flush(client);
+
+        uint32_t message[2];
+        auto const bytes = recv(client_end, message, sizeof message, MSG_DONTWAIT);
+        return bytes == sizeof message &&
+               message[0] == buffer_id &&
+               (message[1] & 0xffff) == WL_BUFFER_RELEASE;
+    }
+
+    NiceMock<mtd::MockEGL> mock_egl;
+    NiceMock<mtd::MockGL> mock_gl;
+
+    wl_display* const display{wl_display_create()};
+    wl_client* client;
+    mir::Fd client_end;
+    wl_resource* buffer;
+
+    std::shared_ptr<mtd::ExplicitExectutor> const wayland_executor{std::make_shared<mtd::ExplicitExectutor>()};
+    std::shared_ptr<mgc::EGLContextExecutor> const egl_delegate{
+        std::make_shared<mgc::EGLContextExecutor>(std::make_unique<mtd::NullGLContext>())};
+};
+}
+
+TEST_F(BufferFromWlShm, buffer_released_after_upload_is_released_on_bind)
+{
+    auto const imported = import(mgw::ShmRelease::after_upload);
+
+    EXPECT_FALSE(client_sees_release());
+
+    bind(*imported);
+
+    EXPECT_TRUE(client_sees_release());
+}
+
+TEST_F(BufferFromWlShm, buffer_released_after_upload_is_released_once)
+{
+    auto imported = import(mgw::ShmRelease::after_upload);
+
+    bind(*imported);
+    bind(*imported);
+    EXPECT_TRUE(client_sees_release());
+
+    imported.reset();
+    EXPECT_FALSE(client_sees_release());
+}
+
+TEST_F(BufferFromWlShm, buffer_released_when_destroyed_is_not_released_on_bind)
+{
+    auto imported = import(mgw::ShmRelease::when_destroyed);
+
+    bind(*imported);
+
+    EXPECT_FALSE(client_sees_release());
+
+    imported.reset();
+
+    EXPECT_TRUE(client_sees_release());
+}
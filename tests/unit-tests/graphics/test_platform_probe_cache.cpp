@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/graphics/platform_probe_cache.h"
+#include "mir/shared_library.h"
+
+#include "mir_test_framework/executable_path.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <system_error>
+
+#include <sys/stat.h>
+
+namespace mg = mir::graphics;
+namespace mtf = mir_test_framework;
+
+using namespace testing;
+
+namespace
+{
+MATCHER_P2(IsProbedModule, path, priority, "")
+{
+    return arg.path == path && arg.priority == priority;
+}
+
+struct PlatformProbeCache : Test
+{
+    PlatformProbeCache()
+    {
+        // Can't use std::string, as mkdtemp mutates its argument.
+        auto tmp_name = std::unique_ptr<char[], std::function<void(char*)>>{strdup("/tmp/mir_probe_cache_XXXXXX"),
+                                                                            [](char* data) {free(data);}};
+        if (mkdtemp(tmp_name.get()) == NULL)
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create temporary directory"};
+        }
+        temp_dir = std::string{tmp_name.get()};
+        platform_path = temp_dir + "/platforms";
+        cache_file = temp_dir + "/probe-cache";
+
+        mkdir(platform_path.c_str(), 0700);
+        add_module_file("graphics-a.so");
+    }
+
+    ~PlatformProbeCache()
+    {
+        // Can't do anything useful in case of failure...
+        system(("rm -rf " + temp_dir).c_str());
+    }
+
+    void add_module_file(std::string const& name)
+    {
+        std::ofstream{platform_path + "/" + name} << name;
+    }
+
+    std::string temp_dir;
+    std::string platform_path;
+    std::string cache_file;
+
+    std::string const module_path{mtf::server_platform("graphics-dummy.so")};
+    std::vector<std::shared_ptr<mir::SharedLibrary>> const modules{std::make_shared<mir::SharedLibrary>(module_path)};
+};
+}
+
+TEST_F(PlatformProbeCache, nothing_is_found_before_anything_is_stored)
+{
+    mg::PlatformProbeCache cache{cache_file, platform_path};
+
+    EXPECT_THAT(cache.lookup("display"), IsEmpty());
+}
+
+TEST_F(PlatformProbeCache, stored_modules_are_found_by_a_later_cache)
+{
+    mg::PlatformProbeCache{cache_file, platform_path}.store("display", modules, mg::best);
+
+    mg::PlatformProbeCache later_cache{cache_file, platform_path};
+
+    EXPECT_THAT(later_cache.lookup("display"), ElementsAre(IsProbedModule(module_path, mg::best)));
+    EXPECT_THAT(later_cache.lookup("rendering"), IsEmpty());
+}
+
+TEST_F(PlatformProbeCache, each_kind_of_module_is_remembered_with_its_priority)
+{
+    mg::PlatformProbeCache{cache_file, platform_path}.store("display", modules, mg::supported);
+    mg::PlatformProbeCache{cache_file, platform_path}.store("rendering", modules, mg::dummy);
+
+    mg::PlatformProbeCache later_cache{cache_file, platform_path};
+
+    EXPECT_THAT(later_cache.lookup("display"), ElementsAre(IsProbedModule(module_path, mg::supported)));
+    EXPECT_THAT(later_cache.lookup("rendering"), ElementsAre(IsProbedModule(module_path, mg::dummy)));
+}
+
+TEST_F(PlatformProbeCache, stored_modules_are_forgotten_when_the_platform_modules_change)
+{
+    mg::PlatformProbeCache{cache_file, platform_path}.store("display", modules, mg::best);
+
+    add_module_file("graphics-b.so");
+    mg::PlatformProbeCache later_cache{cache_file, platform_path};
+
+    EXPECT_THAT(later_cache.lookup("display"), IsEmpty());
+}
@@ -285,3 +285,33 @@ TEST_F(ServerPlatformProbeMockDRM, IgnoresNonPlatformModules)
         std::make_shared<StubConsoleServices>());
     EXPECT_THAT(selected_modules, Not(IsEmpty()));
 }
+
+TEST(ServerPlatformProbe, LoadsCachedModuleThatClaimsTheSamePriority)
+{
+    using namespace testing;
+    mir::options::ProgramOption options;
+    std::vector<mir::graphics::ProbedModule> const cached{
+        {mtf::server_platform("graphics-dummy.so"), mir::graphics::PlatformPriority::dummy}};
+
+    auto const selected_modules = mir::graphics::display_modules_from_paths(
+        cached,
+        options,
+        std::make_shared<mtd::NullConsoleServices>());
+
+    EXPECT_THAT(selected_modules, SizeIs(1));
+}
+
+TEST(ServerPlatformProbe, RejectsCachedModuleThatNowClaimsADifferentPriority)
+{
+    using namespace testing;
+    mir::options::ProgramOption options;
+    std::vector<mir::graphics::ProbedModule> const cached{
+        {mtf::server_platform("graphics-dummy.so"), mir::graphics::PlatformPriority::best}};
+
+    auto const selected_modules = mir::graphics::display_modules_from_paths(
+        cached,
+        options,
+        std::make_shared<mtd::NullConsoleServices>());
+
+    EXPECT_THAT(selected_modules, IsEmpty());
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/logging/async_logger.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ml = mir::logging;
+
+using namespace testing;
+
+namespace
+{
+struct AsyncLogger : Test
+{
+    auto messages() -> std::vector<std::string>
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        std::vector<std::string> result;
+        for (auto const& entry : written)
+            result.push_back(entry.message);
+        return result;
+    }
+
+    std::mutex mutex;
+    std::vector<ml::LogEntry> written;
+
+    std::unique_ptr<ml::AsyncLogger> logger = std::make_unique<ml::AsyncLogger>(
+        [this](std::vector<ml::LogEntry> const& batch)
+        {
+            std::lock_guard<decltype(mutex)> lock{mutex};
+            written.insert(end(written), begin(batch), end(batch));
+        },
+        8);
+};
+}
+
+TEST_F(AsyncLogger, writes_messages_in_order)
+{
+    logger->log(ml::Severity::informational, "one", "test");
+    logger->log(ml::Severity::warning, "two", "test");
+    logger->log(ml::Severity::debug, "three", "test");
+
+    logger.reset();
+
+    EXPECT_THAT(messages(), ElementsAre("one", "two", "three"));
+    EXPECT_THAT(written[1].severity, Eq(ml::Severity::warning));
+    EXPECT_THAT(written[1].component, Eq("test"));
+}
+
+TEST_F(AsyncLogger, writes_critical_messages_before_log_returns)
+{
+    logger->log(ml::Severity::error, "queued", "test");
+    logger->log(ml::Severity::critical, "fatal", "test");
+
+    EXPECT_THAT(messages(), ElementsAre("queued", "fatal"));
+}
+
+TEST_F(AsyncLogger, summarises_repeated_messages)
+{
+    logger->log(ml::Severity::warning, "first", "test");
+    for (auto i = 0; i != 5; ++i)
+        logger->log(ml::Severity::warning, "again", "test");
+    logger->log(ml::Severity::warning, "last", "test");
+
+    logger.reset();
+
+    // The batches may split the run, so count what was summarised
+    auto const all = messages();
+    ASSERT_THAT(all.front(), Eq("first"));
+    ASSERT_THAT(all.back(), Eq("last"));
+
+    auto again = 0;
+    for (auto const& message : all)
+    {
+        int count;
+        if (message == "again")
+            ++again;
+        else if (sscanf(message.c_str(), "last message repeated %d", &count) == 1)
+            again += count;
+    }
+    EXPECT_THAT(again, Eq(5));
+    EXPECT_THAT(std::count(begin(all), end(all), "again"), Lt(5));
+}
+
+TEST_F(AsyncLogger, summarises_a_run_of_repeated_messages_without_further_logging)
+{
+    for (auto i = 0; i != 3; ++i)
+        logger->log(ml::Severity::warning, "again", "test");
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!Matches(Contains(HasSubstr("last message repeated")))(messages()) &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+
+    EXPECT_THAT(messages(), Contains(HasSubstr("last message repeated")));
+}
+
+TEST_F(AsyncLogger, writes_messages_logged_in_a_forked_child_before_log_returns)
+{
+    auto const pid = fork();
+    ASSERT_THAT(pid, Ge(0));
+
+    if (pid == 0)
+    {
+        // The child has no writer thread, so this would otherwise never be written
+        logger->log(ml::Severity::informational, "from child", "test");
+        _exit(messages() == std::vector<std::string>{"from child"} ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    int status;
+    ASSERT_THAT(waitpid(pid, &status, 0), Eq(pid));
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_THAT(WEXITSTATUS(status), Eq(EXIT_SUCCESS));
+}
+
+TEST_F(AsyncLogger, drops_and_reports_messages_when_a_thread_logs_faster_than_they_are_written)
+{
+    std::mutex gate_mutex;
+    std::condition_variable gate_cv;
+    bool writer_blocked = false;
+    bool open_gate = false;
+
+    logger = std::make_unique<ml::AsyncLogger>(
+        [&](std::vector<ml::LogEntry> const& batch)
+        {
+            {
+                std::unique_lock<decltype(gate_mutex)> lock{gate_mutex};
+                writer_blocked = true;
+                gate_cv.notify_all();
+                gate_cv.wait(lock, [&] { return open_gate; });
+            }
+            std::lock_guard<decltype(mutex)> lock{mutex};
+            written.insert(end(written), begin(batch), end(batch));
+        },
+        8);
+
+    logger->log(ml::Severity::informational, "blocks the writer", "test");
+    {
+        std::unique_lock<decltype(gate_mutex)> lock{gate_mutex};
+        gate_cv.wait(lock, [&] { return writer_blocked; });
+    }
+
+    for (auto i = 0; i != 11; ++i)
+        logger->log(ml::Severity::informational, "message " + std::to_string(i), "test");
+
+    {
+        std::lock_guard<decltype(gate_mutex)> lock{gate_mutex};
+        open_gate = true;
+    }
+    gate_cv.notify_all();
+
+    logger->log(ml::Severity::critical, "flush", "test");
+
+    EXPECT_THAT(logger->dropped(), Eq(3u));
+    EXPECT_THAT(messages(), Contains(HasSubstr("3 log messages dropped")));
+    EXPECT_THAT(messages(), Contains("message 7"));
+    EXPECT_THAT(messages(), Not(Contains("message 8")));
+}
+
+TEST_F(AsyncLogger, writes_messages_from_every_thread)
+{
+    auto const threads = 4;
+    auto const per_thread = 5;   // Fewer than the buffer holds, so nothing is dropped
+
+    std::vector<std::thread> loggers;
+    for (auto t = 0; t != threads; ++t)
+    {
+        loggers.emplace_back([this, t]
+            {
+                for (auto i = 0; i != per_thread; ++i)
+                    logger->log(ml::Severity::informational, std::to_string(t) + "/" + std::to_string(i), "test");
+            });
+    }
+    for (auto& thread : loggers)
+        thread.join();
+
+    logger.reset();
+
+    EXPECT_THAT(messages().size(), Eq(std::size_t(threads * per_thread)));
+}
@@ -29,8 +29,10 @@
 #include <mir/test/doubles/mock_gl.h>
 #include <mir/test/doubles/mock_egl.h>
 #include <src/renderers/gl/renderer.h>
+#include <mir/gl/tessellation_helpers.h>
 #include <mir/test/doubles/stub_gl_display_buffer.h>
 #include <mir/test/doubles/mock_gl_display_buffer.h>
+#include <mir/graphics/solid_color_buffer.h>
 
 using testing::SetArgPointee;
 using testing::InSequence;
@@ -492,3 +494,255 @@ TEST_F(GLRenderer, sets_viewport_downscaled_wide)
 
     mrg::Renderer renderer(mock_display_buffer);
 }
+
+namespace
+{
+auto make_renderable(
+    std::shared_ptr<mg::Buffer> const& buffer,
+    mir::geometry::Rectangle const& position,
+    bool shaped) -> std::shared_ptr<testing::NiceMock<mtd::MockRenderable>>
+{
+    auto renderable = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*renderable, id()).WillByDefault(Return(renderable.get()));
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(buffer));
+    ON_CALL(*renderable, shaped()).WillByDefault(Return(shaped));
+    ON_CALL(*renderable, alpha()).WillByDefault(Return(1.0f));
+    ON_CALL(*renderable, transformation()).WillByDefault(Return(glm::mat4{1}));
+    ON_CALL(*renderable, screen_position()).WillByDefault(Return(position));
+    return renderable;
+}
+}
+
+TEST_F(GLRenderer, batched_draw_path_uploads_all_vertices_in_one_buffer)
+{
+    mg::RenderableList const renderables{
+        make_renderable(mock_buffer, {{0, 0}, {10, 10}}, false),
+        make_renderable(mock_buffer, {{20, 0}, {10, 10}}, false),
+        make_renderable(mock_buffer, {{40, 0}, {10, 10}}, false)};
+
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(mgl::Vertex), _, _)).Times(1);
+    EXPECT_CALL(mock_gl, glEnableVertexAttribArray(_)).Times(2);
+    {
+        InSequence seq;
+        EXPECT_CALL(mock_gl, glDrawArrays(_, 0, 4));
+        EXPECT_CALL(mock_gl, glDrawArrays(_, 4, 4));
+        EXPECT_CALL(mock_gl, glDrawArrays(_, 8, 4));
+    }
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawPath::batched);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, batched_draw_path_sets_shared_state_once)
+{
+    mg::RenderableList const renderables{
+        make_renderable(mock_buffer, {{0, 0}, {10, 10}}, false),
+        make_renderable(mock_buffer, {{20, 0}, {10, 10}}, false),
+        make_renderable(mock_buffer, {{40, 0}, {10, 10}}, false)};
+
+    EXPECT_CALL(mock_gl, glUseProgram(stub_program)).Times(1);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(1);
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND)).Times(0);
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawPath::batched);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, batched_draw_path_groups_renderables_that_dont_overlap)
+{
+    mg::RenderableList const renderables{
+        make_renderable(mock_buffer, {{0, 0}, {10, 10}}, false),
+        make_renderable(mock_buffer, {{20, 0}, {10, 10}}, true),
+        make_renderable(mock_buffer, {{40, 0}, {10, 10}}, false)};
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 0, _));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 8, _));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 4, _));
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawPath::batched);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, batched_draw_path_keeps_overlapping_renderables_in_order)
+{
+    mg::RenderableList const renderables{
+        make_renderable(mock_buffer, {{0, 0}, {10, 10}}, false),
+        make_renderable(mock_buffer, {{5, 5}, {10, 10}}, true),
+        make_renderable(mock_buffer, {{10, 10}, {10, 10}}, false)};
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 0, _));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 4, _));
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 8, _));
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawPath::batched);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, draws_solid_color_buffer_without_a_texture)
+{
+    auto const solid_color = std::make_shared<mg::SolidColorBuffer>(
+        mir::geometry::Size{10, 10}, glm::vec4{0.5f, 0.25f, 0.0f, 1.0f});
+    mg::RenderableList const renderables{make_renderable(solid_color, {{0, 0}, {10, 10}}, false)};
+
+    EXPECT_CALL(mock_gl, glBindTexture(_, _)).Times(0);
+    EXPECT_CALL(mock_gl, glUniform4fv(_, 1, _)).Times(1);
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(1);
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, batched_draw_path_sets_each_solid_color_once)
+{
+    auto const red = std::make_shared<mg::SolidColorBuffer>(
+        mir::geometry::Size{1, 1}, glm::vec4{1.0f, 0.0f, 0.0f, 1.0f});
+    auto const blue = std::make_shared<mg::SolidColorBuffer>(
+        mir::geometry::Size{1, 1}, glm::vec4{0.0f, 0.0f, 1.0f, 1.0f});
+    mg::RenderableList const renderables{
+        make_renderable(red, {{0, 0}, {10, 10}}, false),
+        make_renderable(red, {{20, 0}, {10, 10}}, false),
+        make_renderable(blue, {{40, 0}, {10, 10}}, false)};
+
+    EXPECT_CALL(mock_gl, glBindTexture(_, _)).Times(0);
+    EXPECT_CALL(mock_gl, glUniform4fv(_, 1, _)).Times(2);
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(3);
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawPath::batched);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, draws_opaque_region_of_rgba_surface_without_blending)
+{
+    auto const window = make_renderable(mock_buffer, {{0, 0}, {10, 10}}, true);
+    ON_CALL(*window, opaque_region()).WillByDefault(Return(std::vector<mir::geometry::Rectangle>{{{0, 2}, {10, 6}}}));
+    mg::RenderableList const renderables{window};
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, batched_draw_path_batches_opaque_region_with_opaque_renderables)
+{
+    auto const window = make_renderable(mock_buffer, {{20, 0}, {10, 10}}, true);
+    ON_CALL(*window, opaque_region()).WillByDefault(Return(std::vector<mir::geometry::Rectangle>{{{20, 2}, {10, 6}}}));
+    mg::RenderableList const renderables{
+        make_renderable(mock_buffer, {{0, 0}, {10, 10}}, false),
+        window};
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 0, _));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 4, _));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 8, _));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, 12, _));
+
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawPath::batched);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, custom_tessellation_of_rgba_surface_with_opaque_region_is_blended_as_a_whole)
+{
+    struct TwoHalvesRenderer : mrg::Renderer
+    {
+        using mrg::Renderer::Renderer;
+
+        void tessellate(std::vector<mir::gl::Primitive>& primitives, mg::Renderable const& renderable) const override
+        {
+            auto const whole = renderable.screen_position();
+            mir::geometry::Size const half{whole.size.width.as_int() / 2, whole.size.height};
+            primitives = {
+                mir::gl::tessellate_renderable_into_rectangle(renderable, {}, {whole.top_left, half}),
+                mir::gl::tessellate_renderable_into_rectangle(
+                    renderable, {}, {{whole.left().as_int() + half.width.as_int(), whole.top().as_int()}, half})};
+        }
+    };
+
+    auto const window = make_renderable(mock_buffer, {{0, 0}, {10, 10}}, true);
+    ON_CALL(*window, opaque_region()).WillByDefault(Return(std::vector<mir::geometry::Rectangle>{{{0, 2}, {10, 6}}}));
+    mg::RenderableList const renderables{window};
+
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(0);
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND)).Times(2);
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(2);
+
+    TwoHalvesRenderer renderer(display_buffer);
+    renderer.render(renderables);
+}
+
+TEST_F(GLRenderer, reads_back_before_swapping_buffers)
+{
+    mrg::Renderer renderer(mock_display_buffer);
+    std::vector<mrg::Renderer::Readback> readbacks{{mir::geometry::Rectangle{{0, 0}, {1, 1}}, {1, 1}, {}, false}};
+    renderer.set_viewport({{0, 0}, {1, 1}});
+    ON_CALL(mock_gl, glGetIntegerv(GL_VIEWPORT, _))
+        .WillByDefault(testing::Invoke([](GLenum, GLint* viewport)
+            { viewport[0] = 0; viewport[1] = 0; viewport[2] = 1; viewport[3] = 1; }));
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_gl, glReadPixels(_, _, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, _));
+    EXPECT_CALL(mock_display_buffer, swap_buffers());
+
+    renderer.render_and_read_back(renderable_list, readbacks);
+}
+
+TEST_F(GLRenderer, readback_is_xrgb_top_row_first)
+{
+    mrg::Renderer renderer(display_buffer);
+    std::vector<mrg::Renderer::Readback> readbacks{{mir::geometry::Rectangle{{1, 2}, {3, 4}}, {3, 4}, {}, false}};
+
+    ON_CALL(mock_gl, glGetIntegerv(GL_VIEWPORT, _))
+        .WillByDefault(testing::Invoke([](GLenum, GLint* viewport)
+            { viewport[0] = 0; viewport[1] = 0; viewport[2] = 3; viewport[3] = 4; }));
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, 3, 4, GL_RGBA, GL_UNSIGNED_BYTE, _))
+        .WillOnce(testing::Invoke([](GLint, GLint, GLsizei width, GLsizei height, GLenum, GLenum, GLvoid* pixels)
+            {
+                // RGBA, with the bottom row first
+                auto rgba = static_cast<unsigned char*>(pixels);
+                for (int row = 0; row != height; ++row)
+                {
+                    for (int column = 0; column != width; ++column, rgba += 4)
+                    {
+                        rgba[0] = row; rgba[1] = column; rgba[2] = 0xb; rgba[3] = 0xa;
+                    }
+                }
+            }));
+
+    renderer.render_and_read_back(renderable_list, readbacks);
+
+    ASSERT_TRUE(readbacks[0].read);
+    ASSERT_THAT(readbacks[0].pixels.size(), testing::Eq(3u * 4u * 4u));
+    auto const& top_left = readbacks[0].pixels;
+    EXPECT_THAT(top_left[0], testing::Eq(0xb));
+    EXPECT_THAT(top_left[1], testing::Eq(0));
+    EXPECT_THAT(top_left[2], testing::Eq(3));
+    EXPECT_THAT(top_left[3], testing::Eq(0xa));
+}
+
+TEST_F(GLRenderer, readback_outside_viewport_is_not_read)
+{
+    mrg::Renderer renderer(display_buffer);
+    std::vector<mrg::Renderer::Readback> readbacks{{mir::geometry::Rectangle{{0, 0}, {3, 4}}, {3, 4}, {}, false}};
+
+    EXPECT_CALL(mock_gl, glReadPixels(_, _, _, _, _, _, _)).Times(0);
+
+    renderer.render_and_read_back(renderable_list, readbacks);
+
+    EXPECT_FALSE(readbacks[0].read);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/gl/program_binary_cache.h"
+
+#include <mir/test/doubles/mock_gl.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace mtd = mir::test::doubles;
+namespace mrg = mir::renderer::gl;
+
+using namespace testing;
+
+namespace
+{
+GLenum const stub_format = 0x1234;
+
+// What the fake driver holds for each program
+std::map<GLuint, std::string> program_binaries;
+std::map<GLuint, bool> program_linked;
+
+void fake_get_program_binary(GLuint program, GLsizei buf_size, GLsizei* length, GLenum* format, void* binary)
+{
+    auto const& data = program_binaries[program];
+    auto const size = std::min<GLsizei>(buf_size, data.size());
+    memcpy(binary, data.data(), size);
+    *length = size;
+    *format = stub_format;
+}
+
+void fake_program_binary(GLuint program, GLenum format, void const* binary, GLint length)
+{
+    std::string const data{static_cast<char const*>(binary), static_cast<std::size_t>(length)};
+    program_linked[program] = format == stub_format && data.find("valid") == 0;
+    program_binaries[program] = data;
+}
+
+struct ProgramBinaryCache : Test
+{
+    ProgramBinaryCache()
+    {
+        program_binaries.clear();
+        program_linked.clear();
+
+        ON_CALL(mock_gl, glGetProgramiv(_, GL_PROGRAM_BINARY_LENGTH_OES, _))
+            .WillByDefault(Invoke([](GLuint program, GLenum, GLint* length)
+                { *length = program_binaries[program].size(); }));
+        ON_CALL(mock_gl, glGetProgramiv(_, GL_LINK_STATUS, _))
+            .WillByDefault(Invoke([](GLuint program, GLenum, GLint* ok)
+                { *ok = program_linked[program] ? GL_TRUE : GL_FALSE; }));
+
+        // Can't use std::string, as mkdtemp mutates its argument.
+        auto tmp_name = std::unique_ptr<char[], std::function<void(char*)>>{strdup("/tmp/mir_program_cache_XXXXXX"),
+                                                                            [](char* data) {free(data);}};
+        if (mkdtemp(tmp_name.get()) == NULL)
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create temporary directory"};
+        }
+        cache_dir = std::string{tmp_name.get()};
+    }
+
+    ~ProgramBinaryCache()
+    {
+        // Can't do anything useful in case of failure...
+        system(("rm -rf " + cache_dir).c_str());
+    }
+
+    auto make_cache(std::string const& dir) -> std::unique_ptr<mrg::ProgramBinaryCache>
+    {
+        return std::make_unique<mrg::ProgramBinaryCache>(dir, &fake_get_program_binary, &fake_program_binary);
+    }
+
+    NiceMock<mtd::MockGL> mock_gl;
+    std::string cache_dir;
+
+    GLuint const linked_program = 1;
+    GLuint const new_program = 2;
+};
+}
+
+TEST_F(ProgramBinaryCache, stored_binary_loads_into_another_program)
+{
+    auto const cache = make_cache("");
+    program_binaries[linked_program] = "valid binary";
+
+    cache->store("key", linked_program);
+
+    EXPECT_TRUE(cache->load("key", new_program));
+    EXPECT_THAT(program_binaries[new_program], Eq("valid binary"));
+}
+
+TEST_F(ProgramBinaryCache, binary_for_another_key_is_not_loaded)
+{
+    auto const cache = make_cache(cache_dir);
+    program_binaries[linked_program] = "valid binary";
+
+    cache->store("key", linked_program);
+
+    EXPECT_FALSE(cache->load("another key", new_program));
+    EXPECT_THAT(program_binaries.count(new_program), Eq(0u));
+}
+
+TEST_F(ProgramBinaryCache, stored_binary_is_loaded_by_a_later_cache)
+{
+    program_binaries[linked_program] = "valid binary";
+    make_cache(cache_dir)->store("key", linked_program);
+
+    auto const later_cache = make_cache(cache_dir);
+
+    EXPECT_TRUE(later_cache->load("key", new_program));
+    EXPECT_THAT(program_binaries[new_program], Eq("valid binary"));
+}
+
+TEST_F(ProgramBinaryCache, binary_rejected_by_the_driver_is_not_loaded)
+{
+    program_binaries[linked_program] = "stale binary";
+    make_cache(cache_dir)->store("key", linked_program);
+
+    auto const later_cache = make_cache(cache_dir);
+
+    EXPECT_FALSE(later_cache->load("key", new_program));
+}
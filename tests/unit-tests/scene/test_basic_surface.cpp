@@ -415,6 +415,30 @@ TEST_F(BasicSurfaceTest, test_surface_set_transformation_updates_transform)
     EXPECT_EQ(trans, got);
 }
 
+TEST_F(BasicSurfaceTest, renderables_for_several_compositors_share_the_surface_state)
+{
+    using namespace testing;
+
+    int const compositor1{0}, compositor2{0};
+    auto const buffer1 = std::make_shared<mtd::StubBuffer>();
+    auto const buffer2 = std::make_shared<mtd::StubBuffer>();
+    EXPECT_CALL(*mock_buffer_stream, lock_compositor_buffer(&compositor1))
+        .WillOnce(Return(buffer1));
+    EXPECT_CALL(*mock_buffer_stream, lock_compositor_buffer(&compositor2))
+        .WillOnce(Return(buffer2));
+
+    auto const lists = surface.generate_renderables_for({&compositor1, &compositor2});
+    ASSERT_THAT(lists.size(), Eq(2u));
+    ASSERT_THAT(lists[0].size(), Eq(1u));
+    ASSERT_THAT(lists[1].size(), Eq(1u));
+
+    EXPECT_THAT(lists[0][0]->id(), Eq(lists[1][0]->id()));
+    EXPECT_THAT(lists[0][0]->screen_position(), Eq(lists[1][0]->screen_position()));
+    EXPECT_THAT(lists[0][0]->transformation(), Eq(lists[1][0]->transformation()));
+    EXPECT_THAT(lists[0][0]->buffer(), Eq(buffer1));
+    EXPECT_THAT(lists[1][0]->buffer(), Eq(buffer2));
+}
+
 TEST_F(BasicSurfaceTest, test_surface_is_opaque_by_default)
 {
     using namespace testing;
@@ -1354,6 +1378,27 @@ TEST_F(BasicSurfaceTest, registers_frame_callbacks_on_set_streams)
     surface.set_streams(streams);
 }
 
+TEST_F(BasicSurfaceTest, setting_unchanged_streams_does_not_notify)
+{
+    EXPECT_CALL(mock_callback, call()).Times(0);
+
+    surface.set_streams(streams);
+}
+
+TEST_F(BasicSurfaceTest, restacking_streams_keeps_frame_callbacks)
+{
+    using namespace testing;
+
+    auto buffer_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    surface.set_streams({{mock_buffer_stream, {0,0}, {}}, {buffer_stream, {0,0}, {}}});
+
+    EXPECT_CALL(*mock_buffer_stream, set_frame_posted_callback(_)).Times(0);
+    EXPECT_CALL(*buffer_stream, set_frame_posted_callback(_)).Times(0);
+    EXPECT_CALL(mock_callback, call()).Times(AtLeast(1));
+
+    surface.set_streams({{buffer_stream, {10,10}, {}}, {mock_buffer_stream, {0,0}, {}}});
+}
+
 TEST_F(BasicSurfaceTest, showing_brings_all_streams_up_to_date)
 {
     using namespace testing;
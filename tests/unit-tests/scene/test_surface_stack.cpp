@@ -269,6 +269,38 @@ TEST_F(SurfaceStack, scene_counts_pending_accurately)
     }
 }
 
+TEST_F(SurfaceStack, scene_counts_frames_posted_before_compositor_registered)
+{
+    using namespace testing;
+    ms::SurfaceStack stack{report};
+
+    auto stream = std::make_shared<mc::Stream>(geom::Size{ 1, 1 }, mir_pixel_format_abgr_8888);
+
+    auto surface = std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        std::string("stub"),
+        geom::Rectangle{{},{}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo> { { stream, {}, {} } },
+        std::shared_ptr<mg::CursorImage>(),
+        report);
+    stack.add_surface(surface, default_params.input_mode);
+    surface->configure(mir_window_attrib_visibility,
+                       mir_window_visibility_exposed);
+
+    post_a_frame(*stream);
+    stack.register_compositor(this);
+
+    EXPECT_EQ(1, stack.frames_pending(this));
+
+    for (auto& element : stack.scene_elements_for(this))
+        element->renderable()->buffer();
+
+    EXPECT_EQ(0, stack.frames_pending(this));
+    post_a_frame(*stream);
+    EXPECT_EQ(1, stack.frames_pending(this));
+}
+
 TEST_F(SurfaceStack, scene_doesnt_count_pending_frames_from_occluded_surfaces)
 {  // Regression test for LP: #1418081
     using namespace testing;
@@ -297,6 +329,36 @@ TEST_F(SurfaceStack, scene_doesnt_count_pending_frames_from_occluded_surfaces)
     EXPECT_EQ(0, stack.frames_pending(this));
 }
 
+TEST_F(SurfaceStack, scene_counts_frames_posted_while_occluded_once_exposed)
+{
+    using namespace testing;
+
+    ms::SurfaceStack stack{report};
+    stack.register_compositor(this);
+    auto stream = std::make_shared<mtd::StubBufferStream>();
+    auto surface = std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        std::string("stub"),
+        geom::Rectangle{{},{}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo> { { stream, {}, {} } },
+        std::shared_ptr<mg::CursorImage>(),
+        report);
+
+    stack.add_surface(surface, default_params.input_mode);
+    for (auto const& elem : stack.scene_elements_for(this))
+        elem->occluded();
+
+    post_a_frame(*stream);
+    post_a_frame(*stream);
+    EXPECT_EQ(0, stack.frames_pending(this));
+
+    for (auto const& elem : stack.scene_elements_for(this))
+        elem->rendered();
+
+    EXPECT_EQ(2, stack.frames_pending(this));
+}
+
 TEST_F(SurfaceStack, scene_doesnt_count_pending_frames_from_partially_exposed_surfaces)
 {  // Regression test for LP: #1499039
     using namespace testing;
@@ -700,6 +762,42 @@ TEST_F(SurfaceStack, generates_scene_elements_that_allow_only_one_buffer_acquisi
     elements.front()->renderable()->buffer();
 }
 
+TEST_F(SurfaceStack, scene_elements_for_group_acquire_buffers_for_each_compositor)
+{
+    using namespace testing;
+
+    mc::CompositorID const compositor_id2{&compositor_id};
+
+    auto mock_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    auto const buffer1 = std::make_shared<mtd::StubBuffer>();
+    auto const buffer2 = std::make_shared<mtd::StubBuffer>();
+    EXPECT_CALL(*mock_stream, lock_compositor_buffer(compositor_id))
+        .WillOnce(Return(buffer1));
+    EXPECT_CALL(*mock_stream, lock_compositor_buffer(compositor_id2))
+        .WillOnce(Return(buffer2));
+
+    auto const surface = std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        std::string("stub"),
+        geom::Rectangle{geom::Point{3, 4},geom::Size{1, 2}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo> { { mock_stream, {}, {} } },
+        std::shared_ptr<mg::CursorImage>(),
+        report);
+    stack.add_surface(surface, default_params.input_mode);
+
+    auto const sequences = stack.scene_elements_for_group({compositor_id2, compositor_id});
+    ASSERT_THAT(sequences.size(), Eq(2u));
+    ASSERT_THAT(sequences[0].size(), Eq(1u));
+    ASSERT_THAT(sequences[1].size(), Eq(1u));
+
+    EXPECT_THAT(sequences[0].front()->renderable()->buffer(), Eq(buffer2));
+    EXPECT_THAT(sequences[1].front()->renderable()->buffer(), Eq(buffer1));
+    EXPECT_THAT(
+        sequences[0].front()->renderable()->screen_position(),
+        Eq(sequences[1].front()->renderable()->screen_position()));
+}
+
 namespace
 {
 struct MockConfigureSurface : public ms::BasicSurface
@@ -767,6 +865,128 @@ TEST_F(SurfaceStack, exposes_rendered_surface)
     elements2.back()->rendered();
 }
 
+TEST_F(SurfaceStack, scene_elements_for_group_track_visibility_per_compositor)
+{
+    using namespace testing;
+
+    mc::CompositorID const compositor_id2{&compositor_id};
+
+    stack.register_compositor(compositor_id);
+    stack.register_compositor(compositor_id2);
+
+    auto const mock_surface = std::make_shared<MockConfigureSurface>();
+    stack.add_surface(mock_surface, default_params.input_mode);
+
+    auto const sequences = stack.scene_elements_for_group({compositor_id, compositor_id2});
+    ASSERT_THAT(sequences.size(), Eq(2u));
+    ASSERT_THAT(sequences[0].size(), Eq(1u));
+    ASSERT_THAT(sequences[1].size(), Eq(1u));
+
+    EXPECT_CALL(*mock_surface, configure(mir_window_attrib_visibility, mir_window_visibility_exposed));
+
+    sequences[0].back()->occluded();
+    sequences[1].back()->rendered();
+}
+
+namespace
+{
+struct CountingSurface : public ms::BasicSurface
+{
+    CountingSurface() :
+        ms::BasicSurface(
+            {},
+            {},
+            {{},{}},
+            mir_pointer_unconfined,
+            std::list<ms::StreamInfo> { { std::make_shared<mtd::StubBufferStream>(), {}, {} } },
+            {},
+            mir::report::null_scene_report())
+    {
+    }
+
+    auto generate_renderables_for(std::vector<mc::CompositorID> const& ids) const
+        -> std::vector<mg::RenderableList> override
+    {
+        ++traversals;
+        return ms::BasicSurface::generate_renderables_for(ids);
+    }
+
+    int mutable traversals{0};
+};
+}
+
+TEST_F(SurfaceStack, compositors_of_other_outputs_share_a_traversal_of_the_scene)
+{
+    using namespace testing;
+
+    mc::CompositorID const compositor_id2{&compositor_id};
+
+    stack.register_compositor(compositor_id);
+    stack.register_compositor(compositor_id2);
+
+    auto const surface = std::make_shared<CountingSurface>();
+    stack.add_surface(surface, default_params.input_mode);
+
+    EXPECT_THAT(stack.scene_elements_for(compositor_id), SizeIs(1));
+    EXPECT_THAT(stack.scene_elements_for(compositor_id2), SizeIs(1));
+    EXPECT_THAT(surface->traversals, Eq(1));
+}
+
+TEST_F(SurfaceStack, compositor_drawing_again_traverses_the_scene_again)
+{
+    using namespace testing;
+
+    stack.register_compositor(compositor_id);
+
+    auto const surface = std::make_shared<CountingSurface>();
+    stack.add_surface(surface, default_params.input_mode);
+
+    stack.scene_elements_for(compositor_id);
+    stack.scene_elements_for(compositor_id);
+
+    EXPECT_THAT(surface->traversals, Eq(2));
+}
+
+TEST_F(SurfaceStack, shared_traversal_is_not_used_once_the_scene_changes)
+{
+    using namespace testing;
+
+    mc::CompositorID const compositor_id2{&compositor_id};
+
+    stack.register_compositor(compositor_id);
+    stack.register_compositor(compositor_id2);
+
+    auto const surface = std::make_shared<CountingSurface>();
+    stack.add_surface(surface, default_params.input_mode);
+
+    stack.scene_elements_for(compositor_id);
+    surface->move_to({10, 20});
+
+    auto const elements = stack.scene_elements_for(compositor_id2);
+    ASSERT_THAT(elements, SizeIs(1));
+    EXPECT_THAT(elements.front()->renderable()->screen_position().top_left, Eq(geom::Point{10, 20}));
+    EXPECT_THAT(surface->traversals, Eq(2));
+}
+
+TEST_F(SurfaceStack, shared_traversal_is_not_used_once_a_frame_is_posted)
+{
+    using namespace testing;
+
+    mc::CompositorID const compositor_id2{&compositor_id};
+
+    stack.register_compositor(compositor_id);
+    stack.register_compositor(compositor_id2);
+
+    auto const surface = std::make_shared<CountingSurface>();
+    stack.add_surface(surface, default_params.input_mode);
+
+    stack.scene_elements_for(compositor_id);
+    stack.surface_posted_frame(surface.get());
+    stack.scene_elements_for(compositor_id2);
+
+    EXPECT_THAT(surface->traversals, Eq(2));
+}
+
 TEST_F(SurfaceStack, occludes_surface_when_unregistering_all_compositors_that_rendered_it)
 {
     using namespace testing;
@@ -913,6 +1133,28 @@ TEST_F(SurfaceStack, overlays_appear_at_top_of_renderlist)
             SceneElementForStream(mt::fake_shared(r))));
 }
 
+TEST_F(SurfaceStack, overlays_appear_in_every_sequence_of_a_group)
+{
+    using namespace ::testing;
+
+    mc::CompositorID const compositor_id2{&compositor_id};
+    mtd::StubRenderable r;
+
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_input_visualization(mt::fake_shared(r));
+
+    auto const sequences = stack.scene_elements_for_group({compositor_id, compositor_id2});
+    ASSERT_THAT(sequences.size(), Eq(2u));
+    for (auto const& elements : sequences)
+    {
+        EXPECT_THAT(
+            elements,
+            ElementsAre(
+                SceneElementForStream(stub_buffer_stream1),
+                SceneElementForStream(mt::fake_shared(r))));
+    }
+}
+
 TEST_F(SurfaceStack, removed_overlays_are_removed)
 {
     using namespace ::testing;
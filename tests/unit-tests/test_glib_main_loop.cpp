@@ -792,6 +792,93 @@ TEST_F(GLibMainLoopTest, dispatches_actions_resumed_externally)
     EXPECT_THAT(actions, ElementsAre(1, 0));
 }
 
+TEST_F(GLibMainLoopTest, dispatches_resumed_actions_in_the_order_they_were_enqueued)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    void const* const owner1_ptr{&actions};
+    int const owner2{0};
+
+    ml.enqueue(owner1_ptr, [&] { actions.push_back(0); });
+    ml.enqueue(&owner2, [&] { actions.push_back(1); });
+    ml.enqueue(owner1_ptr, [&] { actions.push_back(2); });
+    ml.enqueue(
+        &owner2,
+        [&]
+        {
+            actions.push_back(3);
+            ml.resume_processing_for(owner1_ptr);
+            ml.enqueue(owner1_ptr, [&] { actions.push_back(4); ml.stop(); });
+        });
+
+    ml.pause_processing_for(owner1_ptr);
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(1, 3, 0, 2, 4));
+}
+
+TEST_F(GLibMainLoopTest, actions_of_owner_resumed_within_a_batch_do_not_overtake_its_held_action)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    void const* const owner1_ptr{&actions};
+    int const owner2{0};
+
+    ml.enqueue(owner1_ptr, [&] { actions.push_back(0); });
+    ml.enqueue(
+        &owner2,
+        [&]
+        {
+            actions.push_back(1);
+            ml.resume_processing_for(owner1_ptr);
+        });
+    ml.enqueue(owner1_ptr, [&] { actions.push_back(2); ml.stop(); });
+
+    ml.pause_processing_for(owner1_ptr);
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(1, 0, 2));
+}
+
+TEST_F(GLibMainLoopTest, dispatches_burst_of_actions_enqueued_from_another_thread)
+{
+    using namespace testing;
+
+    int const num_actions{100};
+    std::vector<int> actions;
+    int const owner{0};
+    mt::Signal loop_running;
+
+    ml.enqueue(&owner, [&] { loop_running.raise(); });
+
+    std::thread t{
+        [&]
+        {
+            loop_running.wait_for(std::chrono::seconds{5});
+            for (int i = 0; i < num_actions; ++i)
+            {
+                ml.enqueue(
+                    &owner,
+                    [&,i]
+                    {
+                        actions.push_back(i);
+                        if (i == num_actions - 1)
+                            ml.stop();
+                    });
+            }
+        }};
+
+    ml.run();
+
+    t.join();
+
+    EXPECT_THAT(actions, ContainerEq(values_from_to(0, num_actions - 1)));
+}
+
 TEST_F(GLibMainLoopTest, propagates_exception_from_server_action)
 {
     // Execute in forked process to work around
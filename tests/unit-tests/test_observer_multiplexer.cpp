@@ -735,3 +735,72 @@ TEST(ObserverMultiplexer, unregister_interest_prevents_dispatch_of_already_queue
 
     EXPECT_THAT(call_count, Eq(1));
 }
+
+TEST(ObserverMultiplexer, observer_only_receives_registered_notifications)
+{
+    using namespace testing;
+
+    mtd::ExplicitExectutor executor;
+    TestObserverMultiplexer multiplexer{executor};
+
+    auto const observer = std::make_shared<NiceMock<MockObserver>>();
+    multiplexer.register_interest(observer, executor, {&TestObserver::multi_argument_observation});
+
+    EXPECT_CALL(*observer, observation_made(_)).Times(0);
+    EXPECT_CALL(*observer, multi_argument_observation(StrEq("Ming"), 2, 3.0f));
+
+    multiplexer.observation_made("Flash");
+    multiplexer.multi_argument_observation("Ming", 2, 3.0f);
+
+    executor.execute();
+}
+
+TEST(ObserverMultiplexer, uninterested_observer_does_not_use_its_executor)
+{
+    using namespace testing;
+
+    class CountingExecutor : public mir::Executor
+    {
+    public:
+        void spawn(std::function<void()>&& work) override
+        {
+            ++spawn_count;
+            work();
+        }
+
+        int spawn_count{0};
+    } counting_executor;
+
+    mtd::ExplicitExectutor default_executor;
+    TestObserverMultiplexer multiplexer{default_executor};
+
+    auto const observer = std::make_shared<NiceMock<MockObserver>>();
+    multiplexer.register_interest(observer, counting_executor, {&TestObserver::multi_argument_observation});
+
+    multiplexer.observation_made("Are you not entertained?");
+    EXPECT_THAT(counting_executor.spawn_count, Eq(0));
+
+    multiplexer.multi_argument_observation("Are you not entertained?", 1, 1.0f);
+    EXPECT_THAT(counting_executor.spawn_count, Eq(1));
+}
+
+TEST(ObserverMultiplexer, observers_with_immediate_executor_are_called_inline)
+{
+    using namespace testing;
+
+    ThreadedExecutor default_executor;
+    mir::ImmediateExecutor immediate_executor;
+    TestObserverMultiplexer multiplexer{default_executor};
+
+    auto const observer = std::make_shared<NiceMock<MockObserver>>();
+    multiplexer.register_interest(observer, immediate_executor);
+
+    auto const this_thread = std::this_thread::get_id();
+    std::thread::id called_on;
+    EXPECT_CALL(*observer, observation_made(StrEq("Hodor")))
+        .WillOnce(InvokeWithoutArgs([&] { called_on = std::this_thread::get_id(); }));
+
+    multiplexer.observation_made("Hodor");
+
+    EXPECT_THAT(called_on, Eq(this_thread));
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/time/timer_wheel.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <random>
+
+namespace mt = mir::time;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct TestTimer : mt::TimerWheel::Timer
+{
+    explicit TestTimer(int id) : id{id} {}
+    int const id;
+};
+
+struct TimerWheel : Test
+{
+    auto expire(mt::Timestamp now) -> std::vector<int>
+    {
+        std::vector<mt::TimerWheel::Timer*> due;
+        wheel.expire(now, due);
+
+        std::vector<int> ids;
+        for (auto const timer : due)
+            ids.push_back(static_cast<TestTimer*>(timer)->id);
+        std::sort(begin(ids), end(ids));
+        return ids;
+    }
+
+    mt::Timestamp const origin{std::chrono::steady_clock::now()};
+    mt::TimerWheel wheel{origin};
+};
+}
+
+TEST_F(TimerWheel, is_empty_initially)
+{
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_THAT(wheel.next_wakeup(), Eq(mt::Timestamp::max()));
+    EXPECT_THAT(expire(origin + 1h), IsEmpty());
+}
+
+TEST_F(TimerWheel, timer_is_due_at_its_deadline_and_not_before)
+{
+    TestTimer timer{1};
+    wheel.add(timer, origin + 10ms);
+
+    EXPECT_TRUE(timer.scheduled());
+    EXPECT_THAT(expire(origin + 9ms), IsEmpty());
+    EXPECT_THAT(expire(origin + 10ms), ElementsAre(1));
+    EXPECT_FALSE(timer.scheduled());
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST_F(TimerWheel, timer_is_not_due_earlier_within_its_tick)
+{
+    TestTimer timer{1};
+    wheel.add(timer, origin + 10ms + 500us);
+
+    EXPECT_THAT(expire(origin + 10ms), IsEmpty());
+    EXPECT_THAT(expire(origin + 10ms + 500us), ElementsAre(1));
+}
+
+TEST_F(TimerWheel, overdue_timer_is_due_immediately)
+{
+    EXPECT_THAT(expire(origin + 100ms), IsEmpty());
+
+    TestTimer timer{1};
+    wheel.add(timer, origin + 5ms);
+
+    EXPECT_THAT(wheel.next_wakeup(), Eq(origin + 5ms));
+    EXPECT_THAT(expire(origin + 100ms), ElementsAre(1));
+}
+
+TEST_F(TimerWheel, removed_timer_is_not_due)
+{
+    TestTimer timer{1};
+    wheel.add(timer, origin + 10ms);
+    wheel.remove(timer);
+
+    EXPECT_FALSE(timer.scheduled());
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_THAT(expire(origin + 1s), IsEmpty());
+}
+
+TEST_F(TimerWheel, adding_again_replaces_the_deadline)
+{
+    TestTimer timer{1};
+    wheel.add(timer, origin + 10ms);
+    wheel.add(timer, origin + 3s);
+
+    EXPECT_THAT(expire(origin + 1s), IsEmpty());
+    EXPECT_THAT(timer.deadline(), Eq(origin + 3s));
+    EXPECT_THAT(expire(origin + 3s), ElementsAre(1));
+}
+
+TEST_F(TimerWheel, timers_due_together_expire_together)
+{
+    TestTimer first{1}, second{2}, third{3};
+    wheel.add(first, origin + 70ms);
+    wheel.add(second, origin + 70ms);
+    wheel.add(third, origin + 80ms);
+
+    EXPECT_THAT(expire(origin + 75ms), ElementsAre(1, 2));
+    EXPECT_THAT(expire(origin + 80ms), ElementsAre(3));
+}
+
+TEST_F(TimerWheel, next_wakeup_is_never_after_the_earliest_deadline)
+{
+    TestTimer near{1}, far{2};
+    wheel.add(far, origin + 1h);
+    EXPECT_THAT(wheel.next_wakeup(), Le(origin + 1h));
+
+    wheel.add(near, origin + 20ms);
+    EXPECT_THAT(wheel.next_wakeup(), Eq(origin + 20ms));
+}
+
+TEST_F(TimerWheel, distant_timers_expire_at_their_deadline)
+{
+    std::vector<std::chrono::milliseconds> const delays{
+        63ms, 64ms, 65ms, 4095ms, 4096ms, 4097ms, 262143ms, 262144ms, 262145ms,
+        16777215ms, 16777216ms, 16777217ms, 100000000ms};
+
+    std::vector<std::unique_ptr<TestTimer>> timers;
+    for (auto const& delay : delays)
+    {
+        timers.push_back(std::make_unique<TestTimer>(delay.count()));
+        wheel.add(*timers.back(), origin + delay);
+    }
+
+    // Step from wakeup to wakeup, as the main loop does
+    std::vector<int> expired;
+    while (!wheel.empty())
+    {
+        auto const now = wheel.next_wakeup();
+        for (auto const id : expire(now))
+        {
+            EXPECT_THAT(now, Eq(origin + std::chrono::milliseconds{id}));
+            expired.push_back(id);
+        }
+    }
+
+    std::vector<int> expected;
+    for (auto const& delay : delays)
+        expected.push_back(delay.count());
+    EXPECT_THAT(expired, ContainerEq(expected));
+}
+
+TEST_F(TimerWheel, random_timers_expire_in_deadline_order)
+{
+    std::mt19937 random{42};
+    std::uniform_int_distribution<int> delay{0, 300000};
+
+    std::vector<std::unique_ptr<TestTimer>> timers;
+    for (auto i = 0; i != 1000; ++i)
+    {
+        timers.push_back(std::make_unique<TestTimer>(delay(random)));
+        wheel.add(*timers.back(), origin + std::chrono::milliseconds{timers.back()->id});
+    }
+    for (auto i = 0; i < 1000; i += 3)
+        wheel.remove(*timers[i]);
+
+    auto now = origin;
+    int last = -1;
+    while (!wheel.empty())
+    {
+        // Uneven steps, sometimes skipping wakeups
+        now = std::max(now + std::chrono::milliseconds{delay(random) % 500}, wheel.next_wakeup());
+        for (auto const id : expire(now))
+        {
+            EXPECT_THAT(origin + std::chrono::milliseconds{id}, Le(now));
+            EXPECT_THAT(id, Ge(last));
+            last = id;
+        }
+    }
+
+    for (auto i = 0; i != 1000; ++i)
+        EXPECT_THAT(timers[i]->scheduled(), Eq(false));
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/linux_explicit_synchronization_v1.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
+#include "mir/graphics/explicit_sync_buffer.h"
+#include "mir/fd.h"
+
+#include "mir/test/doubles/explicit_executor.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <wayland-server.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+namespace mir
+{
+namespace wayland
+{
+extern struct wl_interface const zwp_linux_buffer_release_v1_interface_data;
+}
+}
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace mw = mir::wayland;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+uint32_t const release_id{2}; // The first id a client would use after wl_display's
+uint32_t const fenced_release_opcode{0};
+uint32_t const immediate_release_opcode{1};
+
+/// A buffer that is drawn with, leaving a fence for its release, once draw() is called
+struct StubExplicitSyncBuffer : mtd::StubBuffer, mg::ExplicitSyncBuffer
+{
+    ~StubExplicitSyncBuffer()
+    {
+        if (on_release)
+            on_release(std::move(release_fence));
+    }
+
+    auto native_buffer_base() -> mg::NativeBufferBase* override
+    {
+        return this;
+    }
+
+    void set_acquire_fence(mir::Fd) override
+    {
+    }
+
+    auto acquire_fence_signalled() const -> bool override
+    {
+        return true;
+    }
+
+    void set_release_fence_handler(std::function<void(mir::Fd)> handler) override
+    {
+        on_release = std::move(handler);
+    }
+
+    void draw()
+    {
+        // Any fd stands in for the sync_file the renderer would create
+        release_fence = mir::Fd{eventfd(0, EFD_CLOEXEC)};
+    }
+
+    std::function<void(mir::Fd)> on_release;
+    mir::Fd release_fence;
+};
+
+/// A server with one client, which has asked for a zwp_linux_buffer_release_v1
+struct BufferWithRelease : Test
+{
+    BufferWithRelease()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create socketpair"};
+        client_end = mir::Fd{fds[1]};
+
+        client = wl_client_create(display, fds[0]);
+        auto const resource = wl_resource_create(client, &mw::zwp_linux_buffer_release_v1_interface_data, 1, release_id);
+        release = new mw::LinuxBufferReleaseV1{resource, mw::LinuxBufferReleaseV1::Version<1>{}};
+    }
+
+    ~BufferWithRelease()
+    {
+        wl_client_destroy(client);
+        wl_display_destroy(display);
+    }
+
+    /// The opcode of the release event the client has been sent, if any, and the fd that came with it
+    auto client_sees_release() -> std::pair<std::optional<uint32_t>, mir::Fd>
+    {
+        wayland_executor->execute();
+        wl_client_flush(client);
+
+        uint32_t message[2];
+        iovec iov{message, sizeof message};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+
+        auto const bytes = recvmsg(client_end, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (bytes != sizeof message || message[0] != release_id)
+            return {std::nullopt, mir::Fd{}};
+
+        mir::Fd fence;
+        if (auto const cmsg = CMSG_FIRSTHDR(&msg); cmsg && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            int fd;
+            memcpy(&fd, CMSG_DATA(cmsg), sizeof fd);
+            fence = mir::Fd{fd};
+        }
+        return {message[1] & 0xffff, fence};
+    }
+
+    wl_display* const display{wl_display_create()};
+    wl_client* client;
+    mir::Fd client_end;
+    mw::LinuxBufferReleaseV1* release;
+
+    std::shared_ptr<mtd::ExplicitExectutor> const wayland_executor{std::make_shared<mtd::ExplicitExectutor>()};
+};
+}
+
+TEST_F(BufferWithRelease, drawn_explicit_sync_buffer_gets_fenced_release_when_destroyed)
+{
+    auto drawn = std::make_shared<StubExplicitSyncBuffer>();
+    auto buffer = mf::buffer_with_release(drawn, mw::make_weak(release), wayland_executor);
+
+    drawn->draw();
+    buffer.reset();
+    EXPECT_THAT(client_sees_release().first, Eq(std::nullopt));
+
+    drawn.reset();
+
+    auto const [opcode, fence] = client_sees_release();
+    EXPECT_THAT(opcode, Eq(fenced_release_opcode));
+    EXPECT_THAT(fence, Ne(mir::Fd::invalid));
+}
+
+TEST_F(BufferWithRelease, undrawn_explicit_sync_buffer_gets_immediate_release)
+{
+    auto buffer = mf::buffer_with_release(
+        std::make_shared<StubExplicitSyncBuffer>(), mw::make_weak(release), wayland_executor);
+
+    buffer.reset();
+
+    EXPECT_THAT(client_sees_release().first, Eq(immediate_release_opcode));
+}
+
+TEST_F(BufferWithRelease, implicit_sync_buffer_gets_immediate_release_when_last_reference_is_dropped)
+{
+    auto buffer = mf::buffer_with_release(
+        std::make_shared<mtd::StubBuffer>(), mw::make_weak(release), wayland_executor);
+    auto compositor_reference = buffer;
+
+    buffer.reset();
+    EXPECT_THAT(client_sees_release().first, Eq(std::nullopt));
+
+    compositor_reference.reset();
+    EXPECT_THAT(client_sees_release().first, Eq(immediate_release_opcode));
+}
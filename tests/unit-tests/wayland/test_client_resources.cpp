@@ -0,0 +1,230 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/frontend/client_resources.h"
+
+#include "mir/test/doubles/advanceable_clock.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mf = mir::frontend;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct MockClientResourceReport : mf::ClientResourceReport
+{
+    MOCK_METHOD1(usage_sampled, void(mf::ClientResourceUsage const&));
+};
+
+struct ClientResources : Test
+{
+    auto resources_with(mf::ClientResources::Limits const& limits) -> std::shared_ptr<mf::ClientResources>
+    {
+        return std::make_shared<mf::ClientResources>(limits, clock, report, true);
+    }
+
+    auto not_consumed() -> std::shared_ptr<std::atomic<bool>>
+    {
+        return std::make_shared<std::atomic<bool>>(false);
+    }
+
+    auto a_buffer() -> std::shared_ptr<mtd::StubBuffer>
+    {
+        return std::make_shared<mtd::StubBuffer>(geom::Size{10, 20});
+    }
+
+    std::shared_ptr<mtd::AdvanceableClock> const clock{std::make_shared<mtd::AdvanceableClock>()};
+    std::shared_ptr<NiceMock<MockClientResourceReport>> const report{
+        std::make_shared<NiceMock<MockClientResourceReport>>()};
+    pid_t const pid{42};
+};
+}
+
+TEST_F(ClientResources, counts_requests_and_commits)
+{
+    auto const resources = resources_with({});
+    auto const account = resources->open_account(pid);
+
+    for (auto i = 0; i != 5; ++i)
+        account->request_dispatched();
+    account->commit(nullptr, nullptr, false);
+    account->commit(nullptr, nullptr, false);
+
+    auto const usage = account->usage();
+    EXPECT_THAT(usage.pid, Eq(pid));
+    EXPECT_THAT(usage.requests, Eq(5u));
+    EXPECT_THAT(usage.commits, Eq(2u));
+}
+
+TEST_F(ClientResources, reports_rates_once_a_second)
+{
+    auto const resources = resources_with({});
+    auto const account = resources->open_account(pid);
+
+    for (auto i = 0; i != 5; ++i)
+        account->request_dispatched();
+    account->commit(nullptr, nullptr, false);
+
+    EXPECT_CALL(*report, usage_sampled(AllOf(
+        Field(&mf::ClientResourceUsage::requests_per_second, Eq(5u)),
+        Field(&mf::ClientResourceUsage::commits_per_second, Eq(1u)))));
+
+    clock->advance_by(1s);
+    account->request_dispatched();
+}
+
+TEST_F(ClientResources, idle_client_has_zero_rates)
+{
+    auto const resources = resources_with({});
+    auto const account = resources->open_account(pid);
+
+    account->request_dispatched();
+    clock->advance_by(1s);
+    account->request_dispatched();
+    clock->advance_by(5s);
+
+    auto const usage = account->usage();
+    EXPECT_THAT(usage.requests_per_second, Eq(0u));
+    EXPECT_THAT(usage.commits_per_second, Eq(0u));
+}
+
+TEST_F(ClientResources, counts_buffers_until_released)
+{
+    auto const resources = resources_with({});
+    auto const account = resources->open_account(pid);
+
+    auto first = a_buffer();
+    auto const second = a_buffer();
+    EXPECT_TRUE(account->commit(first, not_consumed(), false));
+    EXPECT_TRUE(account->commit(second, not_consumed(), false));
+
+    EXPECT_THAT(account->usage().buffers_held, Eq(2u));
+    EXPECT_THAT(account->usage().buffer_bytes_held, Eq(2u * 10 * 20 * 4));
+
+    first.reset();
+
+    EXPECT_THAT(account->usage().buffers_held, Eq(1u));
+    EXPECT_THAT(account->usage().buffer_bytes_held, Eq(10u * 20 * 4));
+}
+
+TEST_F(ClientResources, drops_buffers_beyond_max_buffers_queued)
+{
+    mf::ClientResources::Limits limits;
+    limits.max_buffers_queued = 2;
+    auto const resources = resources_with(limits);
+    auto const account = resources->open_account(pid);
+
+    auto first = a_buffer();
+    auto const second = a_buffer();
+    auto const third = a_buffer();
+
+    EXPECT_TRUE(account->commit(first, not_consumed(), false));
+    EXPECT_TRUE(account->commit(second, not_consumed(), false));
+    EXPECT_FALSE(account->commit(third, not_consumed(), false));
+    EXPECT_THAT(account->usage().frames_dropped, Eq(1u));
+
+    first.reset();
+
+    EXPECT_TRUE(account->commit(third, not_consumed(), false));
+}
+
+TEST_F(ClientResources, buffers_consumed_by_the_compositor_are_not_queued)
+{
+    mf::ClientResources::Limits limits;
+    limits.max_buffers_queued = 1;
+    auto const resources = resources_with(limits);
+    auto const account = resources->open_account(pid);
+
+    // A consumed buffer stays on screen, held by the compositor, until it is replaced
+    auto const first = a_buffer();
+    auto const second = a_buffer();
+    auto const first_consumed = not_consumed();
+
+    EXPECT_TRUE(account->commit(first, first_consumed, false));
+    EXPECT_FALSE(account->commit(second, not_consumed(), false));
+
+    *first_consumed = true;
+
+    auto const second_consumed = not_consumed();
+    EXPECT_TRUE(account->commit(second, second_consumed, false));
+    *second_consumed = true;
+    EXPECT_TRUE(account->commit(a_buffer(), not_consumed(), false));
+    EXPECT_THAT(account->usage().buffers_held, Eq(2u));
+}
+
+TEST_F(ClientResources, buffers_with_nothing_to_consume_are_not_queued)
+{
+    mf::ClientResources::Limits limits;
+    limits.max_buffers_queued = 1;
+    auto const resources = resources_with(limits);
+    auto const account = resources->open_account(pid);
+
+    auto const first = a_buffer();
+    auto const second = a_buffer();
+
+    EXPECT_TRUE(account->commit(first, nullptr, false));
+    EXPECT_TRUE(account->commit(second, nullptr, false));
+}
+
+TEST_F(ClientResources, only_counts_requests_when_reporting_or_limiting)
+{
+    mf::ClientResources::Limits limits;
+    EXPECT_FALSE((mf::ClientResources{limits, clock, report, false}.counts_requests()));
+    EXPECT_TRUE((mf::ClientResources{limits, clock, report, true}.counts_requests()));
+
+    limits.max_buffers_queued = 1;
+    EXPECT_TRUE((mf::ClientResources{limits, clock, report, false}.counts_requests()));
+}
+
+TEST_F(ClientResources, throttles_commits_to_hidden_surfaces)
+{
+    mf::ClientResources::Limits limits;
+    limits.max_hidden_commits_per_second = 2;
+    auto const resources = resources_with(limits);
+    auto const account = resources->open_account(pid);
+
+    EXPECT_TRUE(account->commit(a_buffer(), not_consumed(), true));
+    EXPECT_TRUE(account->commit(a_buffer(), not_consumed(), true));
+    EXPECT_FALSE(account->commit(a_buffer(), not_consumed(), true));
+    EXPECT_TRUE(account->commit(a_buffer(), not_consumed(), false)) << "Visible surfaces are not throttled";
+
+    clock->advance_by(1s);
+
+    EXPECT_TRUE(account->commit(a_buffer(), not_consumed(), true));
+    EXPECT_THAT(account->usage().frames_dropped, Eq(1u));
+}
+
+TEST_F(ClientResources, lists_usage_of_connected_clients)
+{
+    auto const resources = resources_with({});
+    auto const first = resources->open_account(1);
+    auto second = resources->open_account(2);
+
+    EXPECT_THAT(resources->usage(), ElementsAre(
+        Field(&mf::ClientResourceUsage::pid, Eq(1)),
+        Field(&mf::ClientResourceUsage::pid, Eq(2))));
+
+    second.reset();
+
+    EXPECT_THAT(resources->usage(), ElementsAre(Field(&mf::ClientResourceUsage::pid, Eq(1))));
+}
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# coding: utf-8
+
+# Copyright © 2021 Canonical Ltd.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 or 3
+# as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Decode a binary window management trace written by a MirAL server
+started with --window-management-trace-file (see
+src/miral/window_management_trace_buffer.cpp for the format)."""
+
+import struct
+import sys
+
+MAGIC = b'MIRALWMT'
+FORMAT_VERSION = 1
+RECORD = struct.Struct('=QHHHH6q')
+UNSET = -2**63
+
+
+def read_cstring(data, offset):
+    end = data.index(b'\0', offset)
+    return data[offset:end].decode('utf-8'), end + 1
+
+
+def format_arg(value):
+    if value == UNSET:
+        return '-'
+    # Object identities are addresses: show them as such
+    if value > 0xffffffff or value < -0xffffffff:
+        return hex(value & 0xffffffffffffffff)
+    return str(value)
+
+
+def decode(data, out):
+    if data[:8] != MAGIC:
+        raise ValueError('not a window management trace')
+
+    version, record_size, call_count = struct.unpack_from('=III', data, 8)
+    if version != FORMAT_VERSION or record_size != RECORD.size:
+        raise ValueError('unsupported trace version {} (record size {})'.format(version, record_size))
+
+    offset = 20
+    calls = []
+    for _ in range(call_count):
+        name, offset = read_cstring(data, offset)
+        calls.append(name)
+
+    record_count, = struct.unpack_from('=Q', data, offset)
+    offset += 8
+
+    start = None
+    for index in range(record_count):
+        timestamp, call, thread, arg_count, _, *args = RECORD.unpack_from(data, offset + index * RECORD.size)
+        if start is None:
+            start = timestamp
+
+        name = calls[call] if call < len(calls) else 'call#{}'.format(call)
+        out.write('{:12.6f} [{}] {}({})\n'.format(
+            (timestamp - start) / 1e9,
+            thread,
+            name,
+            ', '.join(format_arg(arg) for arg in args[:arg_count])))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.stderr.write('usage: {} <trace-file>\n'.format(sys.argv[0]))
+        return 1
+
+    with open(sys.argv[1], 'rb') as trace:
+        decode(trace.read(), sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())